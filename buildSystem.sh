@@ -5,9 +5,27 @@
 # This build script creates the cosine app.
 # Chris G. 07/23/2021
 #*****************************************************************************
-g++ -I include -g -O0 -o test/noisyCosine src/noisyCosine.cc src/Nco.cc src/PhaseAccumulator.cc src/FirFilter.cc src/NlmsNoiseCanceller.cc
+g++ -I include -g -O0 -o test/noisyCosine src/noisyCosine.cc src/Nco.cc src/PhaseAccumulator.cc src/FirFilter.cc src/MemoryArena.cc src/NlmsNoiseCanceller.cc src/DenormalGuard.cc src/SampleConverter.cc
 
-g++ -I include -g -O0 -o test/noiseCanceller src/noiseCanceller.cc src/FirFilter.cc src/NlmsNoiseCanceller.cc
+g++ -I include -g -O0 -o test/noiseCanceller src/noiseCanceller.cc src/FirFilter.cc src/MemoryArena.cc src/NlmsNoiseCanceller.cc src/DenormalGuard.cc src/MultirateNoiseCanceller.cc src/CascadedNoiseCanceller.cc src/SegmentedNoiseCanceller.cc src/LatencyHistogram.cc src/PerformanceCounters.cc src/ComplexNlmsNoiseCanceller.cc src/SampleConverter.cc src/SampleReader.cc src/SampleWriter.cc src/AsyncBlockIo.cc -lpthread
 
-g++ -I include -g -O0 -o test/systemTest src/systemTest.cc src/Nco.cc src/PhaseAccumulator.cc src/FirFilter.cc src/NlmsNoiseCanceller.cc
+g++ -I include -g -O0 -o test/systemTest src/systemTest.cc src/Nco.cc src/PhaseAccumulator.cc src/FirFilter.cc src/MemoryArena.cc src/NlmsNoiseCanceller.cc src/DenormalGuard.cc src/SampleConverter.cc src/MultirateNoiseCanceller.cc src/ComplexNlmsNoiseCanceller.cc src/ProcessingNode.cc src/SignalGraph.cc src/SignalNodes.cc -lpthread
 
+g++ -I include -g -O0 -o test/sweepCanceller src/sweepCanceller.cc src/FirFilter.cc src/MemoryArena.cc src/NlmsNoiseCanceller.cc src/DenormalGuard.cc src/SampleConverter.cc -lpthread
+
+g++ -I include -g -O2 -o test/driftBenchmark src/driftBenchmark.cc src/Nco.cc src/PhaseAccumulator.cc src/FirFilter.cc src/MemoryArena.cc src/NlmsNoiseCanceller.cc src/DenormalGuard.cc src/SampleConverter.cc
+
+
+g++ -I include -g -O2 -o test/denormalBenchmark src/denormalBenchmark.cc src/Nco.cc src/PhaseAccumulator.cc src/FirFilter.cc src/MemoryArena.cc src/NlmsNoiseCanceller.cc src/DenormalGuard.cc src/SampleConverter.cc src/PerformanceCounters.cc
+
+g++ -I include -g -O2 -o test/sparseBenchmark src/sparseBenchmark.cc src/FirFilter.cc src/MemoryArena.cc src/NlmsNoiseCanceller.cc src/DenormalGuard.cc src/SampleConverter.cc
+
+g++ -I include -g -O2 -o test/freezeBenchmark src/freezeBenchmark.cc src/FirFilter.cc src/MemoryArena.cc src/NlmsNoiseCanceller.cc src/DenormalGuard.cc src/SampleConverter.cc
+
+g++ -I include -g -O2 -o test/batchCanceller src/batchCanceller.cc src/FirFilter.cc src/MemoryArena.cc src/NlmsNoiseCanceller.cc src/DenormalGuard.cc src/SampleConverter.cc src/SampleReader.cc src/AsyncBlockIo.cc -lpthread
+
+g++ -I include -g -O2 -o test/regressionTest src/regressionTest.cc src/Nco.cc src/PhaseAccumulator.cc src/FirFilter.cc src/MemoryArena.cc src/NlmsNoiseCanceller.cc src/DenormalGuard.cc src/SampleConverter.cc src/MultirateNoiseCanceller.cc
+
+g++ -I include -g -O2 -o test/rlsBenchmark src/rlsBenchmark.cc src/RlsNoiseCanceller.cc src/FirFilter.cc src/MemoryArena.cc src/NlmsNoiseCanceller.cc src/DenormalGuard.cc src/SampleConverter.cc
+
+g++ -I include -g -O2 -o test/tapSweepBenchmark src/tapSweepBenchmark.cc src/FirFilter.cc src/MemoryArena.cc src/NlmsNoiseCanceller.cc src/DenormalGuard.cc src/SampleConverter.cc
@@ -0,0 +1,189 @@
+//**************************************************************************
+// file name: AsyncBlockIo.h
+//**************************************************************************
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+// This class implements asynchronous, read-ahead and write-behind I/O on
+// a pair of file descriptors, so that a processing loop doesn't wait for
+// the disk (or the pipe) while there is work to do.  Each direction has
+// a ring of queueDepth buffers of blockSize bytes.  Reads are issued
+// ahead of the caller into every free buffer, and written buffers are
+// handed off as soon as they are full, so the caller only waits when
+// the ring is empty (reads) or full (writes).
+//
+// The read() and write() calls copy bytes in and out of the ring, the
+// same as fread() and fwrite(), so the stream may be consumed in pieces
+// of any size.  Blocks are always transferred in stream order.
+//
+// On Linux, io_uring is used when the kernel provides it; it is set up
+// with raw system calls, so no library is needed.  Regular files are
+// read and written at explicit offsets with the whole ring in flight.
+// Pipes have no offsets, so only one request per direction is kept in
+// flight for them, which still overlaps I/O with processing.  When
+// io_uring is not available (or not allowed), one thread per direction
+// performs the transfers instead.
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+#ifndef __ASYNCBLOCKIO__
+#define __ASYNCBLOCKIO__
+
+#include <stdint.h>
+#include <pthread.h>
+
+class AsyncBlockIo
+{
+  //***************************** operations **************************
+
+  public:
+
+  AsyncBlockIo(int inputDescriptor,
+               int outputDescriptor,
+               uint32_t blockSize,
+               int queueDepth,
+               bool allowUring);
+
+  ~AsyncBlockIo(void);
+
+  uint32_t read(void *bufferPtr,uint32_t count);
+  uint32_t write(const void *bufferPtr,uint32_t count);
+  void flush(void);
+  bool writeAt(uint64_t offset,const void *bufferPtr,uint32_t count);
+
+  bool isUsingUring(void);
+  bool isOutputSeekable(void);
+  bool hasFailed(void);
+
+  // The largest number of buffers per direction.
+  static const int MAX_QUEUE_DEPTH = 32;
+
+  private:
+
+  // The states of a buffer.  A read buffer is idle until it is issued,
+  // busy while it is being filled, and ready until it has been
+  // consumed.  A write buffer is idle while it is being filled, queued
+  // once it is full, and busy while it is being written.
+  enum SlotState
+  {
+    SLOT_IDLE,
+    SLOT_QUEUED,
+    SLOT_BUSY,
+    SLOT_READY
+  };
+
+  // One buffer of a ring.
+  struct Slot
+  {
+    uint8_t *dataPtr;
+
+    // The number of bytes in the buffer, the number that have been
+    // transferred, and the file offset of the first byte.
+    uint32_t length;
+    uint32_t transferred;
+    uint64_t offset;
+
+    SlotState state;
+
+    // For reads, this indicates that the stream ended in this buffer.
+    bool endOfStream;
+  };
+
+  // One direction of transfer.
+  struct Ring
+  {
+    int descriptor;
+    bool seekable;
+    bool writing;
+
+    Slot slots[MAX_QUEUE_DEPTH];
+
+    // The buffer that the caller is using, the next buffer to issue,
+    // and the buffer that the transfer thread is working on.
+    int currentIndex;
+    int issueIndex;
+    int threadIndex;
+
+    // The position within the current buffer.
+    uint32_t position;
+
+    // The file offset of the next buffer to issue.
+    uint64_t nextOffset;
+
+    // The number of io_uring requests in flight.
+    int inFlight;
+
+    // This indicates that the end of the input has been reached.
+    bool ended;
+
+    // The instance that owns the ring, and its transfer thread.
+    AsyncBlockIo *ownerPtr;
+    bool threadRunning;
+    pthread_t thread;
+  };
+
+  //*******************************************************************
+  // Utility functions.
+  //*******************************************************************
+  bool initializeRing(Ring *ringPtr,int descriptor,bool writing);
+  void releaseRing(Ring *ringPtr);
+
+  // These manage io_uring.
+  bool setupUring(void);
+  void releaseUring(void);
+  void submitUring(Ring *ringPtr,int index);
+  void cancelUring(Ring *ringPtr);
+  void enterUring(unsigned toSubmit,unsigned minComplete);
+  void reapUring(bool wait);
+  void completeUring(Ring *ringPtr,int index,int result);
+
+  // These start transfers and wait for them.
+  void issueTransfers(Ring *ringPtr);
+  void startTransfer(Ring *ringPtr,int index);
+  void queueSlot(Ring *ringPtr,uint32_t length);
+  void setSlotState(Slot *slotPtr,SlotState state);
+  void waitForSlot(Ring *ringPtr,int index);
+  bool isSlotPending(Ring *ringPtr,Slot *slotPtr);
+
+  // This performs one transfer on a transfer thread.
+  void transferSlot(Ring *ringPtr,Slot *slotPtr);
+
+  // This is the entry point of the transfer threads.
+  static void *transferThread(void *argPtr);
+
+  //*******************************************************************
+  // Attributes.
+  //*******************************************************************
+  // The size of each buffer, and the number of buffers per direction.
+  uint32_t blockSize;
+  int queueDepth;
+
+  // The input and output rings.
+  Ring inputRing;
+  Ring outputRing;
+
+  // This indicates that an I/O error has occurred.
+  bool failed;
+
+  // The io_uring instance, or -1 when the transfer threads are used.
+  int uringDescriptor;
+
+  // The mapped io_uring rings and their fields.
+  void *submissionRingPtr;
+  void *completionRingPtr;
+  void *submissionEntriesPtr;
+  size_t submissionRingSize;
+  size_t completionRingSize;
+  size_t submissionEntriesSize;
+  unsigned *submissionTailPtr;
+  unsigned *submissionMaskPtr;
+  unsigned *submissionArrayPtr;
+  unsigned *completionHeadPtr;
+  unsigned *completionTailPtr;
+  unsigned *completionMaskPtr;
+  void *completionEntriesPtr;
+
+  // These synchronize the transfer threads with the caller.
+  pthread_mutex_t mutex;
+  pthread_cond_t changed;
+  bool stopping;
+};
+
+#endif // __ASYNCBLOCKIO__
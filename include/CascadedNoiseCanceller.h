@@ -0,0 +1,144 @@
+//**************************************************************************
+// file name: CascadedNoiseCanceller.h
+//**************************************************************************
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+// This class implements a cascade of NLMS noise cancellers, in which the
+// output of each stage is the input of the next.  A single canceller
+// with one delay removes one kind of noise well; stages with different
+// orders and delays can remove noise of different character, in the
+// same way as a pipe of noiseCanceller processes, but without the
+// conversions and the copies through the pipes.  Each stage has its own
+// filter order, delay, and convergence factor, and getStage() provides
+// access to each stage so that its modes can be set.
+//
+// The samples pass through the stages in sub-blocks of SUBBLOCK_SIZE
+// samples, so a sub-block stays in the cache from the first stage to
+// the last.  Between the stages, the samples are kept in one buffer per
+// stage of CHUNK_SIZE samples, and longer blocks are processed in
+// chunks of that size.
+//
+// The stages may be pipelined across threads.  The stages are divided
+// into contiguous groups of about equal cost (the sum of the filter
+// orders), and each group is run by one thread, the caller being the
+// first.  A chunk is processed in steps: in step n, group g processes
+// sub-block n - g, so each sub-block moves one group further per step,
+// and all of the groups are busy once the pipeline has filled.  The
+// threads meet at a barrier after each step.  Each stage sees exactly
+// the same samples in the same order as it does with one thread, so the
+// output doesn't depend on the number of threads.
+//
+// The state of all of the stages can be written to a stream and read
+// back, so that a run can be resumed where it stopped.
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+#ifndef __CASCADEDNOISECANCELLER__
+#define __CASCADEDNOISECANCELLER__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "NlmsNoiseCanceller.h"
+
+class CascadedNoiseCanceller
+{
+  //***************************** operations **************************
+
+  public:
+
+  CascadedNoiseCanceller(int numberOfStages,
+                         int *filterLengthsPtr,
+                         int *referenceDelaysPtr,
+                         float *betasPtr);
+
+  ~CascadedNoiseCanceller(void);
+
+  void acceptData(int16_t *bufferPtr,
+                  uint32_t bufferLength,
+                  int16_t *outputBufferPtr);
+
+  void acceptData(float *bufferPtr,
+                  uint32_t bufferLength,
+                  float *outputBufferPtr);
+
+  void setNumberOfThreads(int numberOfThreads);
+  int getNumberOfThreads(void);
+  int getNumberOfStages(void);
+  int getLatency(void);
+  NlmsNoiseCanceller *getStage(int stage);
+  bool writeState(FILE *streamPtr);
+  bool readState(FILE *streamPtr);
+
+  // The largest number of samples that are processed at a time, and the
+  // number of samples that pass through the stages together.
+  static const uint32_t CHUNK_SIZE = 4096;
+  static const uint32_t SUBBLOCK_SIZE = 256;
+
+  private:
+
+  // This is passed to each pipeline thread.
+  struct Worker
+  {
+    CascadedNoiseCanceller *ownerPtr;
+    int threadIndex;
+  };
+
+  //*******************************************************************
+  // Utility functions.
+  //*******************************************************************
+  // This divides the stages among the threads.
+  void assignStages(void);
+
+  // These start and stop the pipeline threads.
+  void startThreads(void);
+  void stopThreads(void);
+
+  // These process one chunk, and one step of a chunk.
+  void processChunk(float *bufferPtr,uint32_t count,float *outputBufferPtr);
+  void processStep(int threadIndex,int step);
+
+  // This is the entry point of the pipeline threads.
+  static void *stageWorker(void *argPtr);
+
+  // This passes a scratch block to the float acceptData().
+  static void filterBlock(void *contextPtr,
+                          float *bufferPtr,
+                          uint32_t bufferLength,
+                          float *outputBufferPtr);
+
+  //*******************************************************************
+  // Attributes.
+  //*******************************************************************
+  int numberOfStages;
+
+  // The sum of the reference delays of the stages.
+  int latency;
+
+  // The stages, and the output buffer of each stage but the last.
+  NlmsNoiseCanceller **stagePtrs;
+  float **stageOutputPtrs;
+
+  // The number of threads, including the caller, and the first stage
+  // of each thread (with one more entry, which is numberOfStages).
+  int numberOfThreads;
+  int *firstStagePtr;
+
+  // The pipeline threads, and their arguments.
+  pthread_t *threadsPtr;
+  Worker *workersPtr;
+
+  // The chunk that is being processed.
+  float *chunkInputPtr;
+  float *chunkOutputPtr;
+  uint32_t chunkCount;
+  int numberOfSteps;
+
+  // This tells the threads to exit.
+  bool done;
+
+  // These synchronize the start of each chunk and the end of each step.
+  pthread_barrier_t startBarrier;
+  pthread_barrier_t stepBarrier;
+};
+
+#endif // __CASCADEDNOISECANCELLER__
@@ -0,0 +1,90 @@
+//**************************************************************************
+// file name: ComplexNlmsNoiseCanceller.h
+//**************************************************************************
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+// This class implements an adaptive noise canceller for complex-valued
+// (I/Q) baseband signals.  It is the complex counterpart of the
+// NlmsNoiseCanceller class: the filter has complex coefficients, and a
+// normalized LMS algorithm with a conjugate update is used for the
+// coefficient update equation.  Samples are accepted as interleaved
+// I/Q pairs in either float (cf32) or signed 16-bit (cs16) format.
+//
+// The coefficients and the filter state are stored with the real and
+// imaginary parts in separate arrays.  This way, each complex
+// multiply-accumulate maps onto SIMD lanes without any shuffling.
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+#ifndef __COMPLEXNLMSNOISECANCELLER__
+#define __COMPLEXNLMSNOISECANCELLER__
+
+#include <stdint.h>
+
+#include "FirFilter.h"
+
+class ComplexNlmsNoiseCanceller
+{
+  //***************************** operations **************************
+
+  public:
+
+  ComplexNlmsNoiseCanceller(int filterLength,int referenceDelay,float beta);
+  ~ComplexNlmsNoiseCanceller(void);
+
+  void acceptData(int16_t *bufferPtr,
+                  uint32_t bufferLength,
+                  int16_t *outputBufferPtr);
+
+  void acceptData(float *bufferPtr,
+                  uint32_t bufferLength,
+                  float *outputBufferPtr);
+
+  private:
+
+  //*******************************************************************
+  // Utility functions.
+  //*******************************************************************
+  // Abstract the implementation of the pipeline.
+  void shiftSampleIntoPipeline(float xI,float xQ);
+
+  // This performs the complex convolution and the energy computation.
+  void dotProduct(float *yIPtr,float *yQPtr,float *energyPtr);
+
+  // This performs the conjugate coefficient update.
+  void updateCoefficients(float mu,float eI,float eQ);
+
+  // This performs the adaptive filtering function.
+  void filterData(float xI,float xQ,float *dHatIPtr,float *dHatQPtr);
+
+  // This passes a scratch block to the float acceptData().
+  static void filterBlock(void *contextPtr,
+                          float *bufferPtr,
+                          uint32_t bufferLength,
+                          float *outputBufferPtr);
+
+  //*******************************************************************
+  // Attributes.
+  //*******************************************************************
+  // The number of taps in the filter.
+  int filterLength;
+
+  // The number of samples to delay the input data, x, so
+  //  that the reference signal, d(n) = x(n - n0), can be formed.
+  int referenceDelay;
+
+  // The adaptive filtering update (normalized step-size) parameter.
+  float beta;
+
+  // Storage for the real and imaginary parts of the coefficients.
+  float *coefficientsIPtr;
+  float *coefficientsQPtr;
+
+  // Storage for the real and imaginary parts of the filter state.
+  float *filterStateIPtr;
+  float *filterStateQPtr;
+
+  // These filters are used as delay lines for the I and Q components.
+  FirFilter *delayLineIPtr;
+  FirFilter *delayLineQPtr;
+};
+
+#endif // __COMPLEXNLMSNOISECANCELLER__
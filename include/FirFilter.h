@@ -4,13 +4,22 @@
 //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
 // This class implements a signal processing block known as a FIR filter.
 // A circular buffer is used to maintain filter state so that data does
-// not actually need to be copied when advancing the pipeline.
+// not actually need to be copied when advancing the pipeline.  The
+// coefficients and the filter state can be placed in a MemoryArena
+// that is supplied by the caller.  Instances can be moved but not
+// copied, and they can be reconfigured to any length that fits in the
+// storage that they already have.  The filter state can be written to
+// a stream and read back, so that processing can be resumed later.
 //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
 
 #ifndef __FIRFILTER__
 #define __FIRFILTER__
 
+#include <stdio.h>
 #include <stdint.h>
+#include <stddef.h>
+
+#include "MemoryArena.h"
 
 class FirFilter
 {
@@ -21,17 +30,55 @@ class FirFilter
   FirFilter(int filterLength,
             float *coefficientsPtr);
 
+  FirFilter(int filterLength,
+            float *coefficientsPtr,
+            MemoryArena *arenaPtr);
+
+  FirFilter(FirFilter &&other);
+  FirFilter &operator=(FirFilter &&other);
+
+  // The storage is owned, so copying is not allowed.
+  FirFilter(const FirFilter &other) = delete;
+  FirFilter &operator=(const FirFilter &other) = delete;
+
   ~FirFilter(void);
 
+  bool reconfigure(int filterLength,float *coefficientsPtr);
+  int getCapacity(void);
   void resetFilterState(void);
+  void setCoefficient(int index,float value);
   float filterData(float x);
+  void shiftData(float x);
+  float delayData(float x);
+  bool writeState(FILE *streamPtr);
+  bool readState(FILE *streamPtr);
+
+  static size_t getStorageRequirement(int filterLength);
 
-  //***************************** attributes **************************
   private:
 
+  //*******************************************************************
+  // Utility functions.
+  //*******************************************************************
+  // This allocates and initializes the storage for both constructors.
+  void initialize(int filterLength,
+                  float *coefficientsPtr,
+                  MemoryArena *arenaPtr);
+
+  // This takes the storage of another instance and leaves it empty.
+  void takeStorage(FirFilter &other);
+
+  // This releases the storage if it was allocated from the heap.
+  void releaseStorage(void);
+
+  //***************************** attributes **************************
+
   // The number of taps in the filter.
   int filterLength;
 
+  // The number of taps that the storage can hold.
+  int filterCapacity;
+
   // Pointer to the storage for the filter coefficients.
   float *coefficientStoragePtr;
 
@@ -41,6 +88,10 @@ class FirFilter
   // Current ring buffer index.
   int ringBufferIndex;
 
+  // This indicates whether the storage was allocated from the heap
+  // (true) or from an arena (false).
+  bool ownsStorage;
+
 };
 
 #endif // __FIRFILTER__
@@ -0,0 +1,73 @@
+//**************************************************************************
+// file name: LatencyHistogram.h
+//**************************************************************************
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+// This class implements a histogram of time intervals, such as the time
+// that it takes to process each block of samples.  Intervals are given
+// in nanoseconds.  Intervals below 64ns each get their own bin, and
+// every octave above that is split into 32 bins, so any interval is
+// placed in a bin that is no wider than about 3% of its value.  The
+// histogram has a fixed size no matter how many intervals are recorded,
+// and recording an interval costs a few operations, so it can be left
+// running in a real-time loop.
+//
+// Percentiles are reported as the upper edge of the bin that contains
+// them (or the largest recorded interval, if that is smaller), so they
+// never understate the interval.
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+#ifndef __LATENCYHISTOGRAM__
+#define __LATENCYHISTOGRAM__
+
+#include <stdint.h>
+
+class LatencyHistogram
+{
+  //***************************** operations **************************
+
+  public:
+
+  LatencyHistogram(void);
+
+  ~LatencyHistogram(void);
+
+  void reset(void);
+  void record(uint64_t interval);
+
+  uint64_t getCount(void);
+  uint64_t getMinimum(void);
+  uint64_t getMaximum(void);
+  double getMean(void);
+  uint64_t getPercentile(double percentile);
+
+  // The number of bins per octave, and the number of intervals that
+  // get bins of their own.
+  static const int BINS_PER_OCTAVE = 32;
+  static const int LINEAR_BINS = 2 * BINS_PER_OCTAVE;
+
+  // Enough bins for any 64-bit interval.
+  static const int NUMBER_OF_BINS = LINEAR_BINS + (58 * BINS_PER_OCTAVE);
+
+  private:
+
+  //*******************************************************************
+  // Utility functions.
+  //*******************************************************************
+  // These map between intervals and bins.
+  static int getBinIndex(uint64_t interval);
+  static uint64_t getBinUpperEdge(int index);
+
+  //*******************************************************************
+  // Attributes.
+  //*******************************************************************
+  // The number of intervals in each bin.
+  uint64_t bins[NUMBER_OF_BINS];
+
+  // Exact statistics of the recorded intervals.
+  uint64_t count;
+  uint64_t minimum;
+  uint64_t maximum;
+  double total;
+};
+
+#endif // __LATENCYHISTOGRAM__
@@ -0,0 +1,56 @@
+//**************************************************************************
+// file name: MemoryArena.h
+//**************************************************************************
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+// This class implements a simple arena (bump) allocator.  One block of
+// memory, aligned on a cache line boundary, is allocated when the arena
+// is created, and allocations are carved from it in order.  Every
+// allocation is rounded up to a multiple of the cache line size, so
+// each buffer starts on its own cache line.  Memory is never released
+// individually; it is released all at once when the arena is reset or
+// destroyed.  This lets the buffers of many signal processing blocks
+// be created quickly and be laid out contiguously in memory.  Objects
+// that take storage from an arena must be destroyed before the arena.
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+#ifndef __MEMORYARENA__
+#define __MEMORYARENA__
+
+#include <stdint.h>
+#include <stddef.h>
+
+class MemoryArena
+{
+  //***************************** operations **************************
+
+  public:
+
+  MemoryArena(size_t capacity);
+  ~MemoryArena(void);
+
+  void *allocate(size_t size);
+  float *allocateFloats(int count);
+  void reset(void);
+  bool isValid(void);
+  size_t getCapacity(void);
+  size_t getBytesUsed(void);
+
+  static size_t roundUp(size_t size);
+
+  // Allocations start on multiples of this many bytes.
+  static const size_t ALIGNMENT = 64;
+
+  //***************************** attributes **************************
+  private:
+
+  // The block of memory from which allocations are made.
+  uint8_t *storagePtr;
+
+  // The size of the block in bytes.
+  size_t capacity;
+
+  // The offset of the next allocation.
+  size_t offset;
+};
+
+#endif // __MEMORYARENA__
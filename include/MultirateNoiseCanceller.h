@@ -0,0 +1,111 @@
+//**************************************************************************
+// file name: MultirateNoiseCanceller.h
+//**************************************************************************
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+// This class implements a signal processing block that runs an adaptive
+// noise canceller at a reduced sample rate.  The input is lowpass
+// filtered and decimated, the noise canceller processes the decimated
+// signal, and the output is interpolated back to the input sample rate.
+// When the signal of interest occupies a small part of the band (such
+// as speech that is sampled at 24000S/s), the canceller needs fewer
+// taps at the reduced rate, and it runs less often, so its cost drops
+// by roughly the square of the decimation factor.
+//
+// The decimator and the interpolator share one windowed-sinc lowpass
+// filter.  The decimator computes an output only for every Mth input
+// sample, and the interpolator is split into M polyphase branches, so
+// neither one computes samples that are thrown away or that are known
+// to be zero.  The block accepts and produces samples at the input
+// rate, one output sample per input sample, with a constant latency
+// that is reported by getLatency().
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+#ifndef __MULTIRATENOISECANCELLER__
+#define __MULTIRATENOISECANCELLER__
+
+#include <stdint.h>
+
+#include "FirFilter.h"
+#include "NlmsNoiseCanceller.h"
+
+class MultirateNoiseCanceller
+{
+  //***************************** operations **************************
+
+  public:
+
+  MultirateNoiseCanceller(int decimationFactor,
+                          int filterLength,
+                          int referenceDelay,
+                          float beta);
+
+  ~MultirateNoiseCanceller(void);
+
+  void acceptData(int16_t *bufferPtr,
+                  uint32_t bufferLength,
+                  int16_t *outputBufferPtr);
+
+  void acceptData(float *bufferPtr,
+                  uint32_t bufferLength,
+                  float *outputBufferPtr);
+
+  int getDecimationFactor(void);
+  int getLatency(void);
+  NlmsNoiseCanceller *getCanceller(void);
+
+  // The number of taps of the lowpass filter per polyphase branch.
+  static const int TAPS_PER_PHASE = 24;
+
+  private:
+
+  //*******************************************************************
+  // Utility functions.
+  //*******************************************************************
+  // This designs the lowpass filter.
+  void designLowpassFilter(float *coefficientsPtr,int length);
+
+  // These decimate a block of input samples, and interpolate the
+  // output samples of the block once the canceller has run.
+  uint32_t decimateBlock(float *bufferPtr,
+                         uint32_t bufferLength,
+                         float *decimatedPtr);
+  void interpolateBlock(float *processedPtr,
+                        uint32_t bufferLength,
+                        float *outputBufferPtr);
+
+  // This passes a scratch block to the float acceptData().
+  static void filterBlock(void *contextPtr,
+                          float *bufferPtr,
+                          uint32_t bufferLength,
+                          float *outputBufferPtr);
+
+  //*******************************************************************
+  // Attributes.
+  //*******************************************************************
+  // The ratio of the input sample rate to the processing sample rate.
+  int decimationFactor;
+
+  // The number of taps of the lowpass filter.
+  int lowpassLength;
+
+  // The reference delay of the canceller at the reduced rate.
+  int referenceDelay;
+
+  // The anti-alias filter of the decimator.
+  FirFilter *decimatorPtr;
+
+  // One branch of the interpolation filter per output phase.
+  FirFilter **interpolatorPtrs;
+
+  // The noise canceller that runs at the reduced rate.
+  NlmsNoiseCanceller *cancellerPtr;
+
+  // The interpolated samples of the current low rate sample.
+  float *pendingOutputPtr;
+
+  // The position of the current input sample within a group of
+  // decimationFactor samples.
+  int phase;
+};
+
+#endif // __MULTIRATENOISECANCELLER__
@@ -5,6 +5,72 @@
 // This class implements a signal processing block known as an adaptive
 // noise canceller.  A normalized LMS (least mean square) algorithm is
 // used for the coefficient update equation.
+//
+// All of the storage of an instance (the coefficients, the filter state,
+// and the delay line) is placed in one MemoryArena, so that it is
+// contiguous and aligned on cache line boundaries.  A caller that
+// creates many cancellers can supply one arena for all of them, sized
+// with getStorageRequirement(); otherwise, each instance creates a
+// private arena of its own.
+//
+// Instances can be moved (for example, into a std::vector) but not
+// copied.  The filter order, the reference delay, and the convergence
+// factor can be changed with reconfigure(), which reuses the storage of
+// the instance whenever the new values fit; reserve() provides room
+// ahead of time.
+//
+// For long, sparse noise paths, an improved proportionate NLMS (IPNLMS)
+// update can be selected.  Each tap gets a step-size gain that is a mix
+// of a uniform gain and a gain that is proportional to the magnitude of
+// the tap, so large taps converge quickly while small taps still adapt.
+// An active-tap mask can also be enabled.  The taps are grouped into
+// segments, and segments whose taps have all converged to near zero
+// are updated only every few samples, which saves most of the update
+// cost of very long filters.
+//
+// A variable step-size (VSS) policy can be enabled.  The convergence
+// factor then moves between a minimum value and the value given to the
+// constructor, driven by the correlation of successive errors: while
+// the filter is still learning, the errors are correlated and a large
+// step is used, and once it has converged, the errors are uncorrelated
+// and a small step gives a low misadjustment.  The policy costs a few
+// operations per sample.
+//
+// Once the filter has converged on a stationary noise source, the
+// coefficients can be frozen.  A frozen canceller skips the energy
+// computation and the coefficient update, and it filters blocks of
+// samples with a block convolution whose inner loop runs across the
+// block, so it vectorizes.  Freezing can be requested directly, or it
+// can happen automatically once the error power stops changing, in
+// which case adaptation resumes by itself when the error power rises.
+//
+// When a second sensor picks up the noise without the signal, the
+// canceller can run in dual-input mode, the classic two-sensor
+// structure.  The samples of the second sensor are the reference that
+// is filtered, the samples of the first sensor are the desired signal,
+// the delay line is bypassed, and the output is the error, which is the
+// signal of the first sensor with the noise removed.  The same update
+// options and the same frozen block path apply.
+//
+// For long filters, the taps can be stored interleaved: the filter state
+// and the weights of each group of TAP_GROUP_SIZE taps sit next to each
+// other in one array of groups, and the shift of the state, the output,
+// and the energy are computed in one pass over it, with the update in a
+// second pass.  The separate layout makes four passes over two arrays,
+// so the interleaved layout moves about half as much memory once the
+// filter no longer fits in a cache.  The weights of the interleaved
+// layout may also be stored as bfloat16 or IEEE half precision values,
+// with the arithmetic still done in float, which cuts the storage from
+// 8 to 6 bytes per tap.  A bfloat16 weight keeps 8 significant bits, so
+// updates smaller than about 1/256 of a weight are lost; a half keeps
+// 11 bits, but it can't represent weights beyond 65504 or below about
+// 6e-8.  The interleaved layouts always use the NLMS update with float
+// accumulation.
+//
+// The adaptive state of an instance (the taps, the delay line, and the
+// state of the update policies) can be written to a stream and read back
+// into an instance that is configured the same way, so that a long run
+// can be resumed where it stopped with exactly the same output.
 //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
 
 #ifndef __NLMSNOISECANCELLER__
@@ -13,6 +79,46 @@
 #include <stdint.h>
 
 #include "FirFilter.h"
+#include "MemoryArena.h"
+
+// These select how sums are accumulated.  Coefficients and filter state
+// are always stored as float.
+//
+//   ACCUMULATE_FLOAT - Plain float accumulation (fastest).
+//   ACCUMULATE_PAIRWISE - Pairwise summation of the dot products, so the
+//   rounding error grows with log(N) rather than N.
+//   ACCUMULATE_KAHAN - Compensated (Kahan) summation of the dot
+//   products, and a compensated coefficient update so that small
+//   updates are not lost to rounding over long runs.
+//   ACCUMULATE_DOUBLE - The dot products are accumulated in double
+//   precision, and the update step is computed in double precision.
+enum AccumulationMode
+{
+  ACCUMULATE_FLOAT,
+  ACCUMULATE_PAIRWISE,
+  ACCUMULATE_KAHAN,
+  ACCUMULATE_DOUBLE
+};
+
+// These select how the taps are stored.
+//
+//   TAPS_SEPARATE - The weights and the filter state are separate arrays.
+//   TAPS_INTERLEAVED - The weights and the filter state of each group
+//   of taps are stored together.
+enum TapLayout
+{
+  TAPS_SEPARATE,
+  TAPS_INTERLEAVED
+};
+
+// These select the storage format of the weights of the interleaved
+// layout.  The arithmetic is always done in float.
+enum WeightFormat
+{
+  WEIGHTS_FLOAT32,
+  WEIGHTS_BFLOAT16,
+  WEIGHTS_FLOAT16
+};
 
 class NlmsNoiseCanceller
 {
@@ -21,8 +127,24 @@ class NlmsNoiseCanceller
   public:
 
   NlmsNoiseCanceller(int filterLength,int referenceDelay,float beta);
+
+  NlmsNoiseCanceller(int filterLength,
+                     int referenceDelay,
+                     float beta,
+                     MemoryArena *arenaPtr);
+
+  NlmsNoiseCanceller(NlmsNoiseCanceller &&other);
+  NlmsNoiseCanceller &operator=(NlmsNoiseCanceller &&other);
+
+  // The storage is owned, so copying is not allowed.
+  NlmsNoiseCanceller(const NlmsNoiseCanceller &other) = delete;
+  NlmsNoiseCanceller &operator=(const NlmsNoiseCanceller &other) = delete;
+
   ~NlmsNoiseCanceller(void);
 
+  bool reconfigure(int filterLength,int referenceDelay,float beta);
+  void reserve(int maxFilterLength,int maxReferenceDelay);
+
   void acceptData(int16_t *bufferPtr,
                   uint32_t bufferLength,
                   int16_t *outputBufferPtr);
@@ -31,19 +153,163 @@ class NlmsNoiseCanceller
                   uint32_t bufferLength,
                   float *outputBufferPtr);
 
+  // Dual-input mode: the reference comes from a second sensor.
+  void acceptData(int16_t *primaryPtr,
+                  int16_t *referencePtr,
+                  uint32_t bufferLength,
+                  int16_t *outputBufferPtr);
+
+  void acceptData(float *primaryPtr,
+                  float *referencePtr,
+                  uint32_t bufferLength,
+                  float *outputBufferPtr);
+
+  void setAccumulationMode(AccumulationMode mode);
+  void setDenormalProtection(bool enable);
+  void setDitherLevel(float level);
+  void setProportionateUpdate(bool enable,float alpha);
+  void setActiveTapThreshold(float threshold);
+  void setVariableStepSize(bool enable,float betaMin);
+  float getStepSize(void);
+  void setFrozen(bool frozen);
+  void setAutomaticFreeze(bool enable,float tolerance);
+  bool isFrozen(void);
+  void setTapLayout(TapLayout layout,WeightFormat format);
+  int getActiveTapCount(void);
+  int getFilterLength(void);
+  void getCoefficients(float *coefficientsPtr);
+  bool writeState(FILE *streamPtr);
+  bool readState(FILE *streamPtr);
+
+  static size_t getStorageRequirement(int filterLength,int referenceDelay);
+
+  // The number of taps in a segment of the active-tap mask.
+  static const int SEGMENT_SIZE = 16;
+
+  // The number of samples between evaluations of the active-tap mask.
+  static const int MASK_INTERVAL = 256;
+
+  // Inactive segments are still updated once every this many samples,
+  // so that they can become active again if the noise path changes.
+  static const int PROBE_PERIOD = 8;
+
+  // The smoothing factor of the error statistics and of the step size
+  // of the variable step-size policy.  The time constant is about 100
+  // samples.
+  static constexpr float VSS_SMOOTHING = 0.99f;
+
+  // The largest number of samples per block of the frozen path.
+  static const int FROZEN_BLOCK_SIZE = 64;
+
+  // The number of samples over which the error power is measured when
+  // deciding to freeze or to resume.
+  static const int FREEZE_WINDOW = 512;
+
+  // The number of successive windows whose error power has to stay
+  // within the tolerance before the coefficients are frozen.
+  static const int STABLE_WINDOWS = 8;
+
+  // Adaptation resumes when the error power of a window exceeds the
+  // error power at the time of freezing by this factor (3dB).
+  static constexpr float RESUME_RATIO = 2.0f;
+
+  // The number of taps in a group of the interleaved layout.  The state
+  // of a group fills one cache line.
+  static const int TAP_GROUP_SIZE = 16;
+
   private:
 
   //*******************************************************************
   // Utility functions.
   //*******************************************************************
+  // This allocates and initializes the storage for both constructors.
+  void initialize(int filterLength,
+                  int referenceDelay,
+                  float beta,
+                  MemoryArena *arenaPtr);
+
+  // These manage the storage of the instance.
+  void allocateStorage(int filterCapacity,
+                       int delayCapacity,
+                       MemoryArena *arenaPtr);
+  void *allocateAuxiliary(size_t size,bool *onHeapPtr);
+  void allocateCompensation(void);
+  void allocateSegments(void);
+  void allocateFrozenHistory(void);
+  void allocateTapGroups(void);
+  void resetSegments(void);
+  void releaseStorage(void);
+  void takeStorage(NlmsNoiseCanceller &other);
+
   // Abstract the implementation of the pipeline.
   void shiftSampleIntoPipeline(float x);
 
   // This performs linear convolution.
   float dotProduct(float *aPtr,float *bPtr,int n);
+  float pairwiseDotProduct(float *aPtr,float *bPtr,int n);
+  float kahanDotProduct(float *aPtr,float *bPtr,int n);
+  float doubleDotProduct(float *aPtr,float *bPtr,int n);
+
+  // This performs the coefficient update equation.
+  void updateCoefficients(float e,float den);
+
+  // This adapts the step size from the error statistics.
+  void updateStepSize(float e);
 
-  // This performs the adaptive filtering function.
+  // These perform the proportionate (IPNLMS) filtering function.
+  float filterDataProportionate(float d);
+  void updateActiveTapMask(void);
+
+  // This adds dither to an input sample.
+  float addDither(float x);
+
+  // These perform the adaptive filtering function.
   float filterData(float x);
+  float filterDataDual(float d,float x);
+  float adaptSample(float d);
+
+  // These manage and filter the interleaved layout.
+  int getTapGroupStride(void);
+  void packTaps(void);
+  void unpackTaps(void);
+  void decodeWeights(uint8_t *weightsPtr,float *wPtr);
+  void encodeWeights(float *wPtr,uint8_t *weightsPtr);
+  float filterDataInterleaved(float x,float d);
+
+  // These convert between float and the compact weight formats.
+  static uint16_t encodeBfloat16(float value);
+  static float decodeBfloat16(uint16_t value);
+  static uint16_t encodeFloat16(float value);
+  static float decodeFloat16(uint16_t value);
+
+  // These write and read the arrays of the saved state.
+  static bool writeValues(FILE *streamPtr,
+                          const void *valuesPtr,
+                          size_t size,
+                          size_t count);
+  static bool readValues(FILE *streamPtr,
+                         void *valuesPtr,
+                         size_t size,
+                         size_t count);
+  static bool writeOptionalValues(FILE *streamPtr,
+                                  const void *valuesPtr,
+                                  size_t size,
+                                  size_t count);
+  static bool readOptionalValues(FILE *streamPtr,
+                                 void *valuesPtr,
+                                 size_t size,
+                                 size_t count);
+
+  // These manage the frozen state and perform its filtering function.
+  void trackErrorPower(float e);
+  void evaluateErrorPower(void);
+  void enterFrozenState(void);
+  void leaveFrozenState(void);
+  uint32_t getFrozenBlockCount(uint32_t remaining);
+  void filterBlockFrozen(float *bufferPtr,
+                         float *primaryPtr,
+                         int count,
+                         float *outputBufferPtr);
 
   //*******************************************************************
   // Attributes.
@@ -56,16 +322,139 @@ class NlmsNoiseCanceller
   int referenceDelay;
 
   // The adaptive filtering update (normalized step-size) parameter.
+  // When the variable step-size policy is enabled, this is the largest
+  // step size.
   float beta;
 
+  // The step size that is used by the update.  This is beta unless the
+  // variable step-size policy is enabled.
+  float stepSize;
+
+  // The largest filter length and reference delay that the storage
+  // can hold.
+  int filterCapacity;
+  int delayCapacity;
+
   // Pointer to the storage for the filter coefficients.
   float *coefficientStoragePtr;
 
   // Pointer to the filter state (previous samples).
   float *filterStatePtr;
 
-  // This filter is used as a delay line.
+  // This filter is used as a delay line.  The object itself lives in
+  // the arena.
   FirFilter *delayLinePtr;
+
+  // The arena that holds the storage of this instance.
+  MemoryArena *arenaPtr;
+
+  // The arena that this instance created for itself, or NULL when the
+  // caller supplied the arena.
+  MemoryArena *privateArenaPtr;
+
+  // The accumulation policy for sums.
+  AccumulationMode accumulationMode;
+
+  // Running compensation for each coefficient.  This is only allocated
+  // when Kahan accumulation is selected.
+  float *compensationPtr;
+
+  // This indicates that the compensation storage had to be allocated
+  // from the heap because the arena was full.
+  bool compensationOnHeap;
+
+  // This indicates whether FTZ/DAZ is enabled while processing.
+  bool denormalProtection;
+
+  // The peak amplitude of the dither that is added to the input.  A
+  // value of 0 disables dither.
+  float ditherLevel;
+
+  // The state of the dither generator.
+  uint32_t ditherState;
+
+  // This indicates whether the proportionate (IPNLMS) update is used.
+  bool proportionateUpdate;
+
+  // The IPNLMS mixing parameter in the range of [-1,1).  A value of -1
+  // gives NLMS, and values near 1 give a fully proportionate update.
+  float alpha;
+
+  // The L1 norm of each segment of coefficients, followed by one
+  // flag per segment that indicates whether the segment is active.
+  // These are only allocated when the proportionate update is used.
+  float *segmentNormPtr;
+  uint8_t *segmentActivePtr;
+
+  // This indicates that the segment storage had to be allocated
+  // from the heap because the arena was full.
+  bool segmentsOnHeap;
+
+  // A segment is active when its largest tap magnitude is at least this
+  // fraction of the largest tap magnitude of the filter.  A value of 0
+  // disables the mask.
+  float activeTapThreshold;
+
+  // Sample counters for mask evaluation and for probing.
+  int maskCounter;
+  int probeCounter;
+
+  // This indicates whether the variable step-size policy is used.
+  bool variableStepSize;
+
+  // The smallest step size of the variable step-size policy.
+  float betaMin;
+
+  // Smoothed estimates of e(n)e(n-1) and e(n)^2, and the prior error.
+  float errorCorrelation;
+  float errorPower;
+  float previousError;
+
+  // This indicates that the coefficients are frozen.
+  bool frozen;
+
+  // This indicates whether freezing and resuming happen automatically.
+  bool automaticFreeze;
+
+  // The error power is stable when it changes by less than this
+  // fraction from one window to the next.
+  float freezeTolerance;
+
+  // The sum of e(n)^2 over the current window, and the number of
+  // samples in it.
+  float windowEnergy;
+  int windowCounter;
+
+  // The number of successive stable windows, the error power of the
+  // last window, and the error power at the time of freezing.
+  int stableWindows;
+  float previousWindowPower;
+  float frozenPower;
+
+  // The most recent filterLength input samples in time order, followed
+  // by room for one block.  This is only allocated when freezing is
+  // used.
+  float *frozenHistoryPtr;
+
+  // This indicates that the history storage had to be allocated from
+  // the heap because the arena was full.
+  bool frozenHistoryOnHeap;
+
+  // The layout of the taps, and the format of the weights of the
+  // interleaved layout.
+  TapLayout tapLayout;
+  WeightFormat weightFormat;
+
+  // The groups of the interleaved layout.  Each group holds the state
+  // of TAP_GROUP_SIZE taps followed by their weights.  This is only
+  // allocated when the interleaved layout is used, and it is then the
+  // only up to date copy of the taps, except that the frozen path uses
+  // the separate coefficients and its own history.
+  uint8_t *tapGroupPtr;
+
+  // This indicates that the group storage had to be allocated from the
+  // heap because the arena was full.
+  bool tapGroupsOnHeap;
 };
 
 #endif // __NLMSNOISECANCELLER__
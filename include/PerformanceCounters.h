@@ -0,0 +1,103 @@
+//**************************************************************************
+// file name: PerformanceCounters.h
+//**************************************************************************
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+// This class counts hardware events, such as cycles, cache misses, and
+// branch misses, over the blocks of samples that a processing loop
+// hands to a canceller, so that a slowdown can be traced to its cause:
+// subnormal arithmetic shows up as cycles without extra instructions,
+// a working set that outgrows the cache shows up as L1 and LLC misses,
+// and data-dependent branches (such as the wrap of a ring buffer) show
+// up as branch misses.
+//
+// The counters are opened with perf_event_open() as one group, so they
+// all count over exactly the same intervals, and one read() returns all
+// of them.  Only user space events of the calling thread are counted.
+// Events that the processor or the kernel doesn't provide (a virtual
+// machine often has no hardware counters at all) are left out, and the
+// task clock, a software event, is always included so that there is
+// something to compare against.
+//
+// The caller brackets each block with start() and stop(), and stop() is
+// given the number of samples in the block.  The totals can then be
+// reported per sample and per block.
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+#ifndef __PERFORMANCECOUNTERS__
+#define __PERFORMANCECOUNTERS__
+
+#include <stdint.h>
+
+// The events that are counted.
+enum PerformanceEvent
+{
+  EVENT_CYCLES,
+  EVENT_INSTRUCTIONS,
+  EVENT_L1D_MISSES,
+  EVENT_LLC_MISSES,
+  EVENT_BRANCH_MISSES,
+  EVENT_TASK_CLOCK,
+  NUMBER_OF_EVENTS
+};
+
+class PerformanceCounters
+{
+  //***************************** operations **************************
+
+  public:
+
+  PerformanceCounters(void);
+
+  ~PerformanceCounters(void);
+
+  bool isAvailable(void);
+  bool isSupported(PerformanceEvent event);
+
+  void reset(void);
+  void start(void);
+  void stop(uint64_t count);
+
+  uint64_t getTotal(PerformanceEvent event);
+  double getPerSample(PerformanceEvent event);
+  double getPerBlock(PerformanceEvent event);
+  uint64_t getNumberOfBlocks(void);
+  uint64_t getNumberOfSamples(void);
+
+  static const char *getName(PerformanceEvent event);
+
+  private:
+
+  //*******************************************************************
+  // Utility functions.
+  //*******************************************************************
+  // This opens one event and adds it to the group.
+  void openEvent(PerformanceEvent event,uint32_t type,uint64_t config);
+
+  // This reads the current values of the group.
+  bool readCounters(uint64_t *valuesPtr);
+
+  //*******************************************************************
+  // Attributes.
+  //*******************************************************************
+  // The descriptor of each event, or -1 if it isn't supported.  The
+  // first event that opens is the leader of the group.
+  int descriptors[NUMBER_OF_EVENTS];
+  int leaderDescriptor;
+
+  // The position of each event in a read of the group.
+  int groupIndex[NUMBER_OF_EVENTS];
+  int numberOfOpenEvents;
+
+  // The values at the start of the current block, and the totals over
+  // all of the blocks.
+  uint64_t startValues[NUMBER_OF_EVENTS];
+  uint64_t totals[NUMBER_OF_EVENTS];
+
+  uint64_t numberOfBlocks;
+  uint64_t numberOfSamples;
+
+  // This indicates that start() read the counters successfully.
+  bool started;
+};
+
+#endif // __PERFORMANCECOUNTERS__
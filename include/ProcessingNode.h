@@ -0,0 +1,74 @@
+//**************************************************************************
+// file name: ProcessingNode.h
+//**************************************************************************
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+// This class is the base class of the nodes of a SignalGraph.  A node
+// has a fixed number of input ports and output ports, and each port has
+// a type that determines the layout of its samples.  The graph calls
+// process() with one buffer per port, each holding a block of samples,
+// so a node does its work a block at a time rather than a sample at a
+// time.
+//
+// A node that reads each input sample before it writes the output
+// sample with the same index can report that with canProcessInPlace().
+// The graph may then hand it the same buffer for input port 0 and output
+// port 0, which saves a buffer and keeps the data in cache.
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+#ifndef __PROCESSINGNODE__
+#define __PROCESSINGNODE__
+
+#include <stdint.h>
+
+// These describe the samples that flow through a port.
+//
+//   PORT_REAL - One float per sample.
+//   PORT_COMPLEX - Two floats per sample, interleaved as I, Q.
+enum PortType
+{
+  PORT_REAL,
+  PORT_COMPLEX
+};
+
+class ProcessingNode
+{
+  //***************************** operations **************************
+
+  public:
+
+  ProcessingNode(const char *namePtr,int numberOfInputs,int numberOfOutputs);
+
+  virtual ~ProcessingNode(void);
+
+  const char *getName(void);
+  int getNumberOfInputs(void);
+  int getNumberOfOutputs(void);
+
+  virtual PortType getInputType(int port);
+  virtual PortType getOutputType(int port);
+  virtual bool canProcessInPlace(void);
+
+  // Process count samples.  There is one buffer pointer per port.
+  virtual void process(float **inputPtrs,
+                       float **outputPtrs,
+                       uint32_t count) = 0;
+
+  static int getPortWidth(PortType type);
+
+  // The largest number of ports in either direction.
+  static const int MAX_PORTS = 4;
+
+  protected:
+
+  //*******************************************************************
+  // Attributes.
+  //*******************************************************************
+  // The name that is displayed when the graph is described.
+  const char *namePtr;
+
+  // The number of ports in each direction.
+  int numberOfInputs;
+  int numberOfOutputs;
+};
+
+#endif // __PROCESSINGNODE__
@@ -0,0 +1,157 @@
+//**************************************************************************
+// file name: RlsNoiseCanceller.h
+//**************************************************************************
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+// This class implements an adaptive noise canceller that uses a
+// recursive least squares (RLS) algorithm for the adaptation.  It has
+// the same structure and the same acceptData() interface as the
+// NlmsNoiseCanceller class: the reference signal is the input delayed
+// by referenceDelay samples, and the output is the estimate of the
+// reference that the filter makes from the most recent filterLength
+// input samples.  RLS whitens the input as it adapts, so it converges
+// in a few filter lengths no matter how colored the noise is, where
+// NLMS slows down with the eigenvalue spread of the input.
+//
+// The forgetting factor, lambda (slightly less than 1), sets the memory
+// of the algorithm to about 1 / (1 - lambda) samples.  The
+// regularization, delta, is the initial energy of the least squares
+// problem; it keeps the early estimates from blowing up.
+//
+// Two algorithms are provided.
+//
+//   RLS_TRANSVERSAL - The standard RLS algorithm, which propagates the
+//   inverse correlation matrix of the input.  It costs O(N^2) per
+//   sample.  The matrix is kept in double precision, and it is kept
+//   exactly symmetric, since float precision is not enough for it to
+//   stay positive definite over long runs.
+//
+//   RLS_LATTICE - The a priori RLS lattice with error feedback, which
+//   orthogonalizes the input with a lattice of backward prediction
+//   errors and costs O(N) per sample.  The reflection coefficients are
+//   updated from the errors that they produce, which makes the
+//   recursion numerically stable in float precision.  To keep the
+//   energies away from zero during silence, (1 - lambda) * delta is
+//   added to them at every sample, so they never decay below delta.
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+#ifndef __RLSNOISECANCELLER__
+#define __RLSNOISECANCELLER__
+
+#include <stdint.h>
+
+#include "FirFilter.h"
+
+// The RLS algorithms that are supported.
+enum RlsAlgorithm
+{
+  RLS_TRANSVERSAL,
+  RLS_LATTICE
+};
+
+class RlsNoiseCanceller
+{
+  //***************************** operations **************************
+
+  public:
+
+  RlsNoiseCanceller(int filterLength,
+                    int referenceDelay,
+                    float lambda,
+                    float delta,
+                    RlsAlgorithm algorithm);
+
+  ~RlsNoiseCanceller(void);
+
+  void acceptData(int16_t *bufferPtr,
+                  uint32_t bufferLength,
+                  int16_t *outputBufferPtr);
+
+  void acceptData(float *bufferPtr,
+                  uint32_t bufferLength,
+                  float *outputBufferPtr);
+
+  void reset(void);
+  void setDenormalProtection(bool enable);
+  RlsAlgorithm getAlgorithm(void);
+  int getFilterLength(void);
+
+  private:
+
+  //*******************************************************************
+  // Utility functions.
+  //*******************************************************************
+  // Abstract the implementation of the pipeline.
+  void shiftSampleIntoPipeline(float x);
+
+  // These perform the adaptive filtering function.
+  float filterData(float x);
+  float filterDataTransversal(float d);
+  float filterDataLattice(float x,float d);
+
+  // This passes a scratch block to the float acceptData().
+  static void filterBlock(void *contextPtr,
+                          float *bufferPtr,
+                          uint32_t bufferLength,
+                          float *outputBufferPtr);
+
+  //*******************************************************************
+  // Attributes.
+  //*******************************************************************
+  // The number of taps in the filter.
+  int filterLength;
+
+  // The number of samples to delay the input data, x, so
+  //  that the reference signal, d(n) = x(n - n0), can be formed.
+  int referenceDelay;
+
+  // The forgetting factor and the regularization.
+  float lambda;
+  float delta;
+
+  RlsAlgorithm algorithm;
+
+  // This indicates whether subnormal values are flushed to zero.
+  bool denormalProtection;
+
+  // This filter is used as a delay line.
+  FirFilter *delayLinePtr;
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Transversal RLS.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // The filter state, {x(n) x(n-1) ... x(n - N + 1)}.
+  float *filterStatePtr;
+
+  // The coefficients, the inverse correlation matrix (N x N, row
+  // major), and the product of the matrix and the filter state.
+  double *coefficientsPtr;
+  double *inverseCorrelationPtr;
+  double *gainPtr;
+
+  // The trace of the initial inverse correlation matrix.  The matrix
+  // is not allowed to grow past this when the input is quiet.
+  double maxTrace;
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // RLS lattice.  Index m refers to stage m of the lattice.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // The forward and backward prediction error energies.
+  float *forwardEnergyPtr;
+  float *backwardEnergyPtr;
+
+  // The forward and backward reflection coefficients of stage m + 1.
+  float *forwardReflectionPtr;
+  float *backwardReflectionPtr;
+
+  // The joint process (regression) coefficients.
+  float *regressionPtr;
+
+  // The a priori backward prediction errors and the conversion factors
+  // of the previous sample.
+  float *previousBackwardErrorPtr;
+  float *previousConversionPtr;
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+};
+
+#endif // __RLSNOISECANCELLER__
@@ -0,0 +1,115 @@
+//**************************************************************************
+// file name: SampleConverter.h
+//**************************************************************************
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+// This class provides block conversions between the sample formats that
+// are supported by the sample I/O layer and the float representation
+// that is used by the signal processing blocks.  Each conversion is a
+// simple loop over a block of samples so that the compiler can
+// vectorize it.  Conversions between interleaved and per-channel
+// (planar) layouts are also provided.  Aligned buffer allocation is
+// provided here so that all staging buffers start on a cache line
+// boundary.
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+#ifndef __SAMPLECONVERTER__
+#define __SAMPLECONVERTER__
+
+#include <stdint.h>
+#include <stddef.h>
+
+// The sample formats that are supported.  All formats are little endian.
+enum SampleFormat
+{
+  SAMPLE_FORMAT_S16,
+  SAMPLE_FORMAT_S32,
+  SAMPLE_FORMAT_F32
+};
+
+// The float block filter that filterInt16() converts through.  The
+// context is the object that owns the filter.
+typedef void (*BlockFilter)(void *contextPtr,
+                            float *bufferPtr,
+                            uint32_t bufferLength,
+                            float *outputBufferPtr);
+
+class SampleConverter
+{
+  //***************************** operations **************************
+
+  public:
+
+  static int getSampleSize(SampleFormat format);
+  static bool parseFormat(const char *namePtr,SampleFormat *formatPtr);
+
+  static void toFloat(const void *inputPtr,
+                      SampleFormat format,
+                      uint32_t numberOfSamples,
+                      float fullScale,
+                      float *outputPtr);
+
+  static void fromFloat(const float *inputPtr,
+                        uint32_t numberOfSamples,
+                        float fullScale,
+                        SampleFormat format,
+                        void *outputPtr);
+
+  static void int16ToFloat(const int16_t *inputPtr,
+                           uint32_t numberOfSamples,
+                           float scale,
+                           float *outputPtr);
+
+  static void int32ToFloat(const int32_t *inputPtr,
+                           uint32_t numberOfSamples,
+                           float scale,
+                           float *outputPtr);
+
+  static void floatToFloat(const float *inputPtr,
+                           uint32_t numberOfSamples,
+                           float scale,
+                           float *outputPtr);
+
+  static void floatToInt16(const float *inputPtr,
+                           uint32_t numberOfSamples,
+                           float scale,
+                           int16_t *outputPtr);
+
+  static void floatToInt32(const float *inputPtr,
+                           uint32_t numberOfSamples,
+                           float scale,
+                           int32_t *outputPtr);
+
+  static void deinterleave(const float *inputPtr,
+                           int numberOfChannels,
+                           uint32_t numberOfFrames,
+                           float **outputPtrs);
+
+  static void interleave(float **inputPtrs,
+                         int numberOfChannels,
+                         uint32_t numberOfFrames,
+                         float *outputPtr);
+
+  static void filterInt16(BlockFilter filterPtr,
+                          void *contextPtr,
+                          const int16_t *inputPtr,
+                          uint32_t numberOfFrames,
+                          uint32_t samplesPerFrame,
+                          int16_t *outputPtr);
+
+  static void *allocateAligned(size_t size);
+  static void releaseAligned(void *bufferPtr);
+
+  //***************************** attributes **************************
+
+  // All aligned buffers start on a cache line boundary.
+  static const size_t ALIGNMENT = 64;
+
+  // The number of frames in one tile of a transpose.
+  static const uint32_t TRANSPOSE_TILE_SIZE = 64;
+
+  // The number of samples in the scratch block that filterInt16()
+  // converts through.
+  static const uint32_t SCRATCH_BLOCK_SIZE = 256;
+};
+
+#endif // __SAMPLECONVERTER__
@@ -0,0 +1,108 @@
+//**************************************************************************
+// file name: SampleReader.h
+//**************************************************************************
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+// This class implements a streaming sample reader.  WAV and RF64 files
+// are recognized by their headers, and anything else is treated as
+// headerless (raw) data of a caller-specified format.  Samples are
+// delivered to the caller as interleaved float frames.  The stream is
+// read in blocks through a large aligned staging buffer, so the reader
+// works equally well with files and with pipes.
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+#ifndef __SAMPLEREADER__
+#define __SAMPLEREADER__
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "SampleConverter.h"
+#include "AsyncBlockIo.h"
+
+// The container formats that are supported.
+enum SampleContainer
+{
+  SAMPLE_CONTAINER_RAW,
+  SAMPLE_CONTAINER_WAV,
+  SAMPLE_CONTAINER_RF64
+};
+
+class SampleReader
+{
+  //***************************** operations **************************
+
+  public:
+
+  SampleReader(FILE *streamPtr,
+               SampleFormat rawFormat,
+               int rawNumberOfChannels,
+               float fullScale);
+
+  SampleReader(AsyncBlockIo *ioPtr,
+               SampleFormat rawFormat,
+               int rawNumberOfChannels,
+               float fullScale);
+
+  ~SampleReader(void);
+
+  bool isValid(void);
+  SampleContainer getContainer(void);
+  SampleFormat getFormat(void);
+  int getNumberOfChannels(void);
+  uint32_t getSampleRate(void);
+
+  uint32_t readFrames(float *bufferPtr,uint32_t maxFrames);
+
+  private:
+
+  //*******************************************************************
+  // Utility functions.
+  //*******************************************************************
+  void initialize(SampleFormat rawFormat,
+                  int rawNumberOfChannels,
+                  float fullScale);
+
+  uint32_t readBytes(void *bufferPtr,uint32_t count);
+  uint32_t readStream(void *bufferPtr,uint32_t count);
+  bool skipBytes(uint64_t count);
+  bool parseWaveHeader(void);
+
+  //*******************************************************************
+  // Attributes.
+  //*******************************************************************
+  // The stream from which samples are read.  When ioPtr is not NULL,
+  // samples are read through it instead.
+  FILE *streamPtr;
+  AsyncBlockIo *ioPtr;
+
+  // This indicates whether the stream header was understood.
+  bool valid;
+
+  // The format of the stream.
+  SampleContainer container;
+  SampleFormat format;
+  int numberOfChannels;
+  uint32_t sampleRate;
+
+  // The float value of a full scale sample.
+  float fullScale;
+
+  // The number of bytes in one frame (one sample of each channel).
+  uint32_t frameSize;
+
+  // The number of data bytes that remain.  A value of UINT64_MAX
+  // indicates that the stream is read until end of file.
+  uint64_t bytesRemaining;
+
+  // Bytes that were consumed while probing for a header.  For raw
+  // streams, these are the first data bytes.
+  uint8_t probeBuffer[12];
+  uint32_t probeLength;
+  uint32_t probeIndex;
+
+  // Aligned staging buffer for undecoded samples.
+  uint8_t *stagingBufferPtr;
+  uint32_t stagingBufferSize;
+};
+
+#endif // __SAMPLEREADER__
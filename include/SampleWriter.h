@@ -0,0 +1,98 @@
+//**************************************************************************
+// file name: SampleWriter.h
+//**************************************************************************
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+// This class implements a streaming sample writer.  Interleaved float
+// frames are converted to the requested sample format and written as
+// raw data or as a WAV or RF64 file.  WAV files reserve room for an
+// RF64 ds64 chunk, so when the output is seekable and grows beyond the
+// 4GB limit of a WAV file, the header is promoted to RF64 on close.
+// When the output is not seekable, the header sizes are left marked as
+// unknown, which is the usual convention for streamed WAV data.
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+#ifndef __SAMPLEWRITER__
+#define __SAMPLEWRITER__
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "SampleConverter.h"
+#include "SampleReader.h"
+#include "AsyncBlockIo.h"
+
+class SampleWriter
+{
+  //***************************** operations **************************
+
+  public:
+
+  SampleWriter(FILE *streamPtr,
+               SampleContainer container,
+               SampleFormat format,
+               int numberOfChannels,
+               uint32_t sampleRate,
+               float fullScale);
+
+  SampleWriter(AsyncBlockIo *ioPtr,
+               SampleContainer container,
+               SampleFormat format,
+               int numberOfChannels,
+               uint32_t sampleRate,
+               float fullScale);
+
+  ~SampleWriter(void);
+
+  uint32_t writeFrames(const float *bufferPtr,uint32_t numberOfFrames);
+  void flush(void);
+  void close(void);
+
+  private:
+
+  //*******************************************************************
+  // Utility functions.
+  //*******************************************************************
+  void initialize(SampleContainer container,
+                  SampleFormat format,
+                  int numberOfChannels,
+                  uint32_t sampleRate,
+                  float fullScale);
+
+  void writeWaveHeader(bool finalHeader);
+  uint32_t writeStream(const void *bufferPtr,uint32_t count);
+
+  //*******************************************************************
+  // Attributes.
+  //*******************************************************************
+  // The stream to which samples are written.  When ioPtr is not NULL,
+  // samples are written through it instead.
+  FILE *streamPtr;
+  AsyncBlockIo *ioPtr;
+
+  // This indicates whether the header can be patched on close.
+  bool seekable;
+
+  // This indicates whether close() has been called.
+  bool closed;
+
+  // The format of the stream.
+  SampleContainer container;
+  SampleFormat format;
+  int numberOfChannels;
+  uint32_t sampleRate;
+
+  // The float value of a full scale sample.
+  float fullScale;
+
+  // The number of bytes in one frame (one sample of each channel).
+  uint32_t frameSize;
+
+  // The number of sample bytes that have been written.
+  uint64_t dataSize;
+
+  // Aligned staging buffer for encoded samples.
+  uint8_t *stagingBufferPtr;
+  uint32_t stagingBufferSize;
+};
+
+#endif // __SAMPLEWRITER__
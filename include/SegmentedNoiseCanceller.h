@@ -0,0 +1,126 @@
+//**************************************************************************
+// file name: SegmentedNoiseCanceller.h
+//**************************************************************************
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+// This class processes one long recording in segments that run in
+// parallel.  The adaptation of an NLMS canceller is sequential, so a
+// single channel normally keeps one core busy no matter how many there
+// are.  Here, the recording is divided into segments of about equal
+// length, and each segment is processed by its own canceller on
+// whichever thread is free.  The canceller of a segment is created by
+// the thread that takes the segment, and it is released once the
+// segment is done, so memory grows with the number of threads rather
+// than with the number of segments.  The function that is given to
+// setConfigurator() sets the modes of each canceller as it is created.
+//
+// A canceller that starts at the beginning of a segment has not
+// converged, so its first output would be worse than that of a serial
+// run, whose canceller arrives at that point already converged.  To
+// hide this, each canceller starts an overlap before its segment: it
+// adapts over the samples of the overlap, whose output is discarded,
+// and only its output over the segment is kept.  The first segment has
+// nothing before it, so it is identical to a serial run.  The other
+// segments approach the serial output as the overlap grows, so the
+// output is approximate at the boundaries, and the overlap trades work
+// (each segment costs the overlap extra) against accuracy.  There are
+// never more segments than the recording has room for, so that each
+// segment is at least as long as the overlap (and at least 1 sample).
+//
+// The recording is processed with one call, and the cancellers start
+// from their initial state, so an instance processes one recording.
+// Within a segment, the samples are presented in blocks of the size
+// given by setBlockSize(), as they would be by a streaming caller.
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+#ifndef __SEGMENTEDNOISECANCELLER__
+#define __SEGMENTEDNOISECANCELLER__
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "NlmsNoiseCanceller.h"
+
+class SegmentedNoiseCanceller
+{
+  //***************************** operations **************************
+
+  public:
+
+  // This sets the modes of a newly created canceller of a segment.
+  typedef void (*ConfigureFunction)(NlmsNoiseCanceller *cancellerPtr,
+                                    void *argPtr);
+
+  SegmentedNoiseCanceller(int numberOfSegments,
+                          int filterLength,
+                          int referenceDelay,
+                          float beta);
+
+  ~SegmentedNoiseCanceller(void);
+
+  void acceptData(float *bufferPtr,
+                  uint64_t bufferLength,
+                  float *outputBufferPtr);
+
+  void setConfigurator(ConfigureFunction configurePtr,void *argPtr);
+  void setOverlap(uint32_t overlap);
+  uint32_t getOverlap(void);
+  void setBlockSize(uint32_t blockSize);
+  void setNumberOfThreads(int numberOfThreads);
+  int getNumberOfThreads(void);
+  int getNumberOfSegments(void);
+  uint64_t getSegmentStart(int segment,uint64_t bufferLength);
+
+  // The default number of samples that are presented to a canceller at
+  // a time.
+  static const uint32_t DEFAULT_BLOCK_SIZE = 4000;
+
+  private:
+
+  //*******************************************************************
+  // Utility functions.
+  //*******************************************************************
+  // This processes the overlap and the samples of one segment.
+  void processSegment(int segment,float *scratchPtr);
+
+  // This processes segments until there are none left.
+  void processSegments(void);
+
+  // This is the entry point of the worker threads.
+  static void *segmentWorker(void *argPtr);
+
+  //*******************************************************************
+  // Attributes.
+  //*******************************************************************
+  // The number of segments that was asked for, and the number that the
+  // recording is divided into.
+  int requestedSegments;
+  int numberOfSegments;
+
+  // The configuration of the canceller of each segment.
+  int filterLength;
+  int referenceDelay;
+  float beta;
+  ConfigureFunction configurePtr;
+  void *configureArgPtr;
+
+  // The number of samples that each canceller adapts over before its
+  // segment starts.
+  uint32_t overlap;
+
+  // The number of samples that are presented to a canceller at a time.
+  uint32_t blockSize;
+
+  // The number of threads, including the caller.
+  int numberOfThreads;
+
+  // The recording that is being processed.
+  float *inputPtr;
+  float *outputPtr;
+  uint64_t inputLength;
+
+  // The next segment to be processed, which is protected by the mutex.
+  int nextSegment;
+  pthread_mutex_t mutex;
+};
+
+#endif // __SEGMENTEDNOISECANCELLER__
@@ -0,0 +1,146 @@
+//**************************************************************************
+// file name: SignalGraph.h
+//**************************************************************************
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+// This class connects ProcessingNodes into a graph and runs the graph a
+// block at a time.  Nodes are added with addNode(), output ports are
+// connected to input ports of the same type with connect(), and
+// prepare() schedules the nodes and allocates the buffers.  Every call
+// to processBlock() then runs each node once on up to blockSize samples.
+//
+// Each node is given a level: sources are at level 0, and every other
+// node is one level past the deepest node that feeds it.  Nodes of the
+// same level don't depend on each other, so they can run on separate
+// threads; a barrier separates the levels.
+//
+// All buffers are allocated once, from one cache line aligned arena, and
+// a buffer is reused by a later level as soon as the last node that reads
+// it has run.  When a node can process in place and it is the only
+// reader of its input, its output is written over its input.  No
+// samples are copied between nodes.
+//
+// The graph owns its nodes and deletes them when it is destroyed.
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+#ifndef __SIGNALGRAPH__
+#define __SIGNALGRAPH__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "ProcessingNode.h"
+#include "MemoryArena.h"
+
+class SignalGraph
+{
+  //***************************** operations **************************
+
+  public:
+
+  SignalGraph(uint32_t blockSize);
+
+  ~SignalGraph(void);
+
+  int addNode(ProcessingNode *nodePtr);
+
+  bool connect(int sourceNode,int sourcePort,int sinkNode,int sinkPort);
+
+  bool prepare(int numberOfThreads);
+
+  void processBlock(uint32_t count);
+  void run(uint64_t numberOfSamples);
+
+  uint32_t getBlockSize(void);
+  int getNumberOfLevels(void);
+  int getNumberOfBuffers(void);
+  void describe(FILE *streamPtr);
+
+  // The largest number of nodes in a graph.
+  static const int MAX_NODES = 64;
+
+  private:
+
+  // This identifies one port of one node.
+  struct Endpoint
+  {
+    int node;
+    int port;
+  };
+
+  // This is passed to each worker thread.
+  struct WorkerContext
+  {
+    SignalGraph *graphPtr;
+    int threadIndex;
+  };
+
+  //*******************************************************************
+  // Utility functions.
+  //*******************************************************************
+  // These perform the steps of prepare().
+  bool scheduleNodes(void);
+  bool assignBuffers(void);
+  void startWorkers(int numberOfThreads);
+  void stopWorkers(void);
+
+  // This runs this thread's share of the nodes of one level.
+  void processLevel(int level,int threadIndex);
+
+  // This is the entry point of the worker threads.
+  static void *workerThread(void *argPtr);
+
+  //*******************************************************************
+  // Attributes.
+  //*******************************************************************
+  // The largest number of samples per block.
+  uint32_t blockSize;
+
+  // The nodes, in the order that they were added.
+  int numberOfNodes;
+  ProcessingNode *nodePtrs[MAX_NODES];
+
+  // The output port that drives each input port, or a node of -1 when
+  // the input is not connected.
+  Endpoint inputSources[MAX_NODES][ProcessingNode::MAX_PORTS];
+
+  // The number of input ports that each output port drives.
+  int consumerCounts[MAX_NODES][ProcessingNode::MAX_PORTS];
+
+  // The level of each node, and the nodes in order of level.
+  int levels[MAX_NODES];
+  int numberOfLevels;
+  int schedule[MAX_NODES];
+
+  // The index into schedule[] of the first node of each level, plus
+  // one past the last node.
+  int levelStarts[MAX_NODES + 1];
+
+  // The buffer of each output port.
+  int outputBuffers[MAX_NODES][ProcessingNode::MAX_PORTS];
+  int numberOfBuffers;
+
+  // The buffer pointers that are passed to each node.
+  float *inputPtrs[MAX_NODES][ProcessingNode::MAX_PORTS];
+  float *outputPtrs[MAX_NODES][ProcessingNode::MAX_PORTS];
+
+  // The storage of the buffers.
+  MemoryArena *arenaPtr;
+
+  // This indicates that prepare() has succeeded.
+  bool prepared;
+
+  // The calling thread counts as thread 0.
+  int numberOfThreads;
+  pthread_t *threadPtr;
+  WorkerContext *workerContextPtr;
+  pthread_barrier_t barrier;
+
+  // The number of samples of the current block.
+  uint32_t blockCount;
+
+  // This tells the workers to exit.
+  bool stopRequested;
+};
+
+#endif // __SIGNALGRAPH__
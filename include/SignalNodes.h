@@ -0,0 +1,166 @@
+//**************************************************************************
+// file name: SignalNodes.h
+//**************************************************************************
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+// These classes wrap the signal processing blocks of this repository as
+// ProcessingNodes, so that they can be connected into a SignalGraph.
+// Each node creates and owns the block that it wraps.
+//
+//   NcoNode - An Nco.  Output 0 is the in-phase component, and output 1
+//   is the quadrature component.
+//   GaussianNoiseNode - A Gaussian noise source.
+//   AdderNode - The sum of two inputs.
+//   FirFilterNode - A FirFilter.
+//   CancellerNode - An NlmsNoiseCanceller.
+//   MultirateCancellerNode - A MultirateNoiseCanceller.
+//   ComplexCancellerNode - A ComplexNlmsNoiseCanceller, with complex
+//   ports.
+//   FileSinkNode - Writes its input to a file as raw floats.
+//_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+#ifndef __SIGNALNODES__
+#define __SIGNALNODES__
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "ProcessingNode.h"
+#include "Nco.h"
+#include "FirFilter.h"
+#include "NlmsNoiseCanceller.h"
+#include "MultirateNoiseCanceller.h"
+#include "ComplexNlmsNoiseCanceller.h"
+
+class NcoNode : public ProcessingNode
+{
+  public:
+
+  NcoNode(float sampleRate,float frequency);
+  ~NcoNode(void);
+
+  void process(float **inputPtrs,float **outputPtrs,uint32_t count);
+
+  private:
+
+  Nco *ncoPtr;
+};
+
+class GaussianNoiseNode : public ProcessingNode
+{
+  public:
+
+  GaussianNoiseNode(float sigma);
+  ~GaussianNoiseNode(void);
+
+  void process(float **inputPtrs,float **outputPtrs,uint32_t count);
+
+  private:
+
+  // The standard deviation of the noise.
+  float sigma;
+};
+
+class AdderNode : public ProcessingNode
+{
+  public:
+
+  AdderNode(void);
+  ~AdderNode(void);
+
+  bool canProcessInPlace(void);
+  void process(float **inputPtrs,float **outputPtrs,uint32_t count);
+};
+
+class FirFilterNode : public ProcessingNode
+{
+  public:
+
+  FirFilterNode(int filterLength,float *coefficientsPtr);
+  ~FirFilterNode(void);
+
+  FirFilter *getFilter(void);
+
+  bool canProcessInPlace(void);
+  void process(float **inputPtrs,float **outputPtrs,uint32_t count);
+
+  private:
+
+  FirFilter *filterPtr;
+};
+
+class CancellerNode : public ProcessingNode
+{
+  public:
+
+  CancellerNode(int filterLength,int referenceDelay,float beta);
+  ~CancellerNode(void);
+
+  NlmsNoiseCanceller *getCanceller(void);
+
+  bool canProcessInPlace(void);
+  void process(float **inputPtrs,float **outputPtrs,uint32_t count);
+
+  private:
+
+  NlmsNoiseCanceller *cancellerPtr;
+};
+
+class MultirateCancellerNode : public ProcessingNode
+{
+  public:
+
+  MultirateCancellerNode(int decimationFactor,
+                         int filterLength,
+                         int referenceDelay,
+                         float beta);
+  ~MultirateCancellerNode(void);
+
+  MultirateNoiseCanceller *getCanceller(void);
+
+  bool canProcessInPlace(void);
+  void process(float **inputPtrs,float **outputPtrs,uint32_t count);
+
+  private:
+
+  MultirateNoiseCanceller *cancellerPtr;
+};
+
+class ComplexCancellerNode : public ProcessingNode
+{
+  public:
+
+  ComplexCancellerNode(int filterLength,int referenceDelay,float beta);
+  ~ComplexCancellerNode(void);
+
+  PortType getInputType(int port);
+  PortType getOutputType(int port);
+  bool canProcessInPlace(void);
+  void process(float **inputPtrs,float **outputPtrs,uint32_t count);
+
+  private:
+
+  ComplexNlmsNoiseCanceller *cancellerPtr;
+};
+
+class FileSinkNode : public ProcessingNode
+{
+  public:
+
+  FileSinkNode(const char *fileNamePtr,PortType type);
+  ~FileSinkNode(void);
+
+  bool isOpen(void);
+
+  PortType getInputType(int port);
+  void process(float **inputPtrs,float **outputPtrs,uint32_t count);
+
+  private:
+
+  // The type of the samples that are written.
+  PortType type;
+
+  // The output file, or NULL if it could not be opened.
+  FILE *streamPtr;
+};
+
+#endif // __SIGNALNODES__
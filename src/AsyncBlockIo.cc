@@ -0,0 +1,1588 @@
+//************************************************************************
+// file name: AsyncBlockIo.cc
+//************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#include "AsyncBlockIo.h"
+
+using namespace std;
+
+// The alignment of the buffers, which suits direct I/O as well.
+#define BUFFER_ALIGNMENT (4096)
+
+// The user data of the requests that cancel other requests.
+#define CANCEL_USER_DATA (0xffffffffULL)
+
+// The user data of a request holds its direction and its buffer index.
+#define WRITE_USER_DATA (0x10000ULL)
+
+/*****************************************************************************
+
+  Name: AsyncBlockIo
+
+  Purpose: The purpose of this function is to serve as the constructor for
+  an instance of an AsyncBlockIo.  The buffers are allocated, io_uring
+  is set up if it is allowed and available (otherwise the transfer
+  threads are started), and the first reads are issued.  If a buffer
+  can't be allocated, nothing is started, no data is transferred, and
+  hasFailed() returns true, so the caller can fall back to other I/O.
+
+  Calling Sequence: AsyncBlockIo(inputDescriptor,outputDescriptor,
+                                 blockSize,queueDepth,allowUring)
+
+  Inputs:
+
+    inputDescriptor - The descriptor from which data is read, or -1 if
+    there is no input.
+
+    outputDescriptor - The descriptor to which data is written, or -1 if
+    there is no output.
+
+    blockSize - The size of each buffer in bytes.
+
+    queueDepth - The number of buffers per direction, from 1 to
+    MAX_QUEUE_DEPTH.
+
+    allowUring - A flag that indicates whether io_uring may be used.  A
+    value of false forces the transfer threads to be used.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+AsyncBlockIo::AsyncBlockIo(int inputDescriptor,
+                           int outputDescriptor,
+                           uint32_t blockSize,
+                           int queueDepth,
+                           bool allowUring)
+{
+  bool allocated;
+
+  if (queueDepth < 1)
+  {
+    queueDepth = 1;
+  } // if
+
+  if (queueDepth > MAX_QUEUE_DEPTH)
+  {
+    queueDepth = MAX_QUEUE_DEPTH;
+  } // if
+
+  // Save for later use.
+  this->blockSize = blockSize;
+  this->queueDepth = queueDepth;
+
+  failed = false;
+  stopping = false;
+  uringDescriptor = -1;
+
+  pthread_mutex_init(&mutex,NULL);
+  pthread_cond_init(&changed,NULL);
+
+  allocated = initializeRing(&inputRing,inputDescriptor,false);
+  allocated = initializeRing(&outputRing,outputDescriptor,true) && allocated;
+
+  if (!allocated)
+  {
+    // Leave both directions unused, so nothing touches a missing buffer.
+    inputRing.descriptor = -1;
+    outputRing.descriptor = -1;
+    failed = true;
+    return;
+  } // if
+
+  if (allowUring)
+  {
+    setupUring();
+  } // if
+
+  if (uringDescriptor < 0)
+  {
+    // Fall back to one transfer thread per direction.
+    if (inputRing.descriptor >= 0)
+    {
+      pthread_create(&inputRing.thread,NULL,transferThread,&inputRing);
+      inputRing.threadRunning = true;
+    } // if
+
+    if (outputRing.descriptor >= 0)
+    {
+      pthread_create(&outputRing.thread,NULL,transferThread,&outputRing);
+      outputRing.threadRunning = true;
+    } // if
+  } // if
+
+  // Start reading ahead.
+  issueTransfers(&inputRing);
+
+  return;
+
+} // AsyncBlockIo
+
+/*****************************************************************************
+
+  Name: ~AsyncBlockIo
+
+  Purpose: The purpose of this function is to serve as the destructor for
+  an instance of an AsyncBlockIo.  Pending output is written, reads that
+  are still in flight are cancelled, and the resources are released.
+  The descriptors are not closed.
+
+  Calling Sequence: ~AsyncBlockIo()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+AsyncBlockIo::~AsyncBlockIo(void)
+{
+
+  flush();
+
+  pthread_mutex_lock(&mutex);
+  stopping = true;
+  pthread_cond_broadcast(&changed);
+  pthread_mutex_unlock(&mutex);
+
+  if (uringDescriptor >= 0)
+  {
+    // Reads of a pipe may never complete, so cancel them.
+    cancelUring(&inputRing);
+
+    while ((inputRing.inFlight > 0) || (outputRing.inFlight > 0))
+    {
+      reapUring(true);
+    } // while
+  } // if
+  else
+  {
+    if (inputRing.threadRunning)
+    {
+      // The reader may be blocked on a pipe.
+      pthread_cancel(inputRing.thread);
+      pthread_join(inputRing.thread,NULL);
+    } // if
+
+    if (outputRing.threadRunning)
+    {
+      pthread_join(outputRing.thread,NULL);
+    } // if
+  } // else
+
+  // Release resources.
+  releaseRing(&inputRing);
+  releaseRing(&outputRing);
+
+  if (uringDescriptor >= 0)
+  {
+    releaseUring();
+  } // if
+
+  pthread_cond_destroy(&changed);
+  pthread_mutex_destroy(&mutex);
+
+  return;
+
+} // ~AsyncBlockIo
+
+/*****************************************************************************
+
+  Name: initializeRing
+
+  Purpose: The purpose of this function is to set up one direction of
+  transfer.  A descriptor that can be seeked is transferred at explicit
+  offsets, starting from its current position.
+
+  Calling Sequence: success = initializeRing(ringPtr,descriptor,writing)
+
+  Inputs:
+
+    ringPtr - A pointer to the ring.
+
+    descriptor - The descriptor, or -1 if the direction is not used.
+
+    writing - A flag that indicates whether the ring is for output.
+
+  Outputs:
+
+    success - A flag that indicates whether every buffer was allocated.
+    A value of false indicates that at least one buffer is missing.  The
+    buffers that were allocated are released by releaseRing().
+
+*****************************************************************************/
+bool AsyncBlockIo::initializeRing(Ring *ringPtr,int descriptor,bool writing)
+{
+  int i;
+  bool success;
+  off_t position;
+  void *bufferPtr;
+
+  success = true;
+
+  ringPtr->descriptor = descriptor;
+  ringPtr->writing = writing;
+  ringPtr->ownerPtr = this;
+  ringPtr->threadRunning = false;
+  ringPtr->currentIndex = 0;
+  ringPtr->issueIndex = 0;
+  ringPtr->threadIndex = 0;
+  ringPtr->position = 0;
+  ringPtr->inFlight = 0;
+  ringPtr->ended = false;
+
+  // Pipes can't be seeked.
+  ringPtr->seekable = false;
+  ringPtr->nextOffset = 0;
+
+  if (descriptor >= 0)
+  {
+    position = lseek(descriptor,0,SEEK_CUR);
+
+    if (position >= 0)
+    {
+      ringPtr->seekable = true;
+      ringPtr->nextOffset = position;
+    } // if
+  } // if
+
+  for (i = 0; i < MAX_QUEUE_DEPTH; i++)
+  {
+    ringPtr->slots[i].dataPtr = NULL;
+    ringPtr->slots[i].length = 0;
+    ringPtr->slots[i].transferred = 0;
+    ringPtr->slots[i].offset = 0;
+    ringPtr->slots[i].state = SLOT_IDLE;
+    ringPtr->slots[i].endOfStream = false;
+
+    if ((descriptor >= 0) && (i < queueDepth))
+    {
+      if (posix_memalign(&bufferPtr,BUFFER_ALIGNMENT,blockSize) != 0)
+      {
+        bufferPtr = NULL;
+        success = false;
+      } // if
+
+      ringPtr->slots[i].dataPtr = (uint8_t *)bufferPtr;
+    } // if
+  } // for
+
+  return (success);
+
+} // initializeRing
+
+/*****************************************************************************
+
+  Name: releaseRing
+
+  Purpose: The purpose of this function is to release the buffers of one
+  direction of transfer.  For a seekable output, the file position is
+  left at the end of the data that was written.
+
+  Calling Sequence: releaseRing(ringPtr)
+
+  Inputs:
+
+    ringPtr - A pointer to the ring.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void AsyncBlockIo::releaseRing(Ring *ringPtr)
+{
+  int i;
+
+  if (ringPtr->writing && ringPtr->seekable && (uringDescriptor >= 0))
+  {
+    lseek(ringPtr->descriptor,ringPtr->nextOffset,SEEK_SET);
+  } // if
+
+  for (i = 0; i < MAX_QUEUE_DEPTH; i++)
+  {
+    free(ringPtr->slots[i].dataPtr);
+    ringPtr->slots[i].dataPtr = NULL;
+  } // for
+
+  return;
+
+} // releaseRing
+
+/*****************************************************************************
+
+  Name: setupUring
+
+  Purpose: The purpose of this function is to create an io_uring
+  instance and to map its rings.  Raw system calls are used, so no
+  library is needed.
+
+  Calling Sequence: success = setupUring()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    success - A flag that indicates whether io_uring is available.
+
+*****************************************************************************/
+bool AsyncBlockIo::setupUring(void)
+{
+  int descriptor;
+  uint8_t *sqPtr;
+  uint8_t *cqPtr;
+  struct io_uring_params parameters;
+
+  memset(&parameters,0,sizeof(parameters));
+
+  // Room for every buffer of both directions, plus cancellations.
+  descriptor = syscall(__NR_io_uring_setup,
+                       (unsigned)(4 * MAX_QUEUE_DEPTH),
+                       &parameters);
+
+  if (descriptor < 0)
+  {
+    return (false);
+  } // if
+
+  submissionRingSize = parameters.sq_off.array +
+                       (parameters.sq_entries * sizeof(unsigned));
+  completionRingSize = parameters.cq_off.cqes +
+                       (parameters.cq_entries * sizeof(struct io_uring_cqe));
+  submissionEntriesSize = parameters.sq_entries * sizeof(struct io_uring_sqe);
+
+  if (parameters.features & IORING_FEAT_SINGLE_MMAP)
+  {
+    // Both rings share one mapping.
+    if (completionRingSize > submissionRingSize)
+    {
+      submissionRingSize = completionRingSize;
+    } // if
+
+    completionRingSize = submissionRingSize;
+  } // if
+
+  submissionRingPtr = mmap(NULL,submissionRingSize,
+                           PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE,
+                           descriptor,IORING_OFF_SQ_RING);
+
+  if (parameters.features & IORING_FEAT_SINGLE_MMAP)
+  {
+    completionRingPtr = submissionRingPtr;
+  } // if
+  else
+  {
+    completionRingPtr = mmap(NULL,completionRingSize,
+                             PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE,
+                             descriptor,IORING_OFF_CQ_RING);
+  } // else
+
+  submissionEntriesPtr = mmap(NULL,submissionEntriesSize,
+                              PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_POPULATE,
+                              descriptor,IORING_OFF_SQES);
+
+  if ((submissionRingPtr == MAP_FAILED) ||
+      (completionRingPtr == MAP_FAILED) ||
+      (submissionEntriesPtr == MAP_FAILED))
+  {
+    if (submissionRingPtr != MAP_FAILED)
+    {
+      munmap(submissionRingPtr,submissionRingSize);
+    } // if
+
+    if ((completionRingPtr != MAP_FAILED) &&
+        (completionRingPtr != submissionRingPtr))
+    {
+      munmap(completionRingPtr,completionRingSize);
+    } // if
+
+    if (submissionEntriesPtr != MAP_FAILED)
+    {
+      munmap(submissionEntriesPtr,submissionEntriesSize);
+    } // if
+
+    close(descriptor);
+    return (false);
+  } // if
+
+  // Locate the fields of the rings.
+  sqPtr = (uint8_t *)submissionRingPtr;
+  cqPtr = (uint8_t *)completionRingPtr;
+
+  submissionTailPtr = (unsigned *)(sqPtr + parameters.sq_off.tail);
+  submissionMaskPtr = (unsigned *)(sqPtr + parameters.sq_off.ring_mask);
+  submissionArrayPtr = (unsigned *)(sqPtr + parameters.sq_off.array);
+  completionHeadPtr = (unsigned *)(cqPtr + parameters.cq_off.head);
+  completionTailPtr = (unsigned *)(cqPtr + parameters.cq_off.tail);
+  completionMaskPtr = (unsigned *)(cqPtr + parameters.cq_off.ring_mask);
+  completionEntriesPtr = cqPtr + parameters.cq_off.cqes;
+
+  uringDescriptor = descriptor;
+
+  return (true);
+
+} // setupUring
+
+/*****************************************************************************
+
+  Name: releaseUring
+
+  Purpose: The purpose of this function is to unmap the rings and to
+  close the io_uring instance.
+
+  Calling Sequence: releaseUring()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void AsyncBlockIo::releaseUring(void)
+{
+
+  munmap(submissionEntriesPtr,submissionEntriesSize);
+
+  if (completionRingPtr != submissionRingPtr)
+  {
+    munmap(completionRingPtr,completionRingSize);
+  } // if
+
+  munmap(submissionRingPtr,submissionRingSize);
+
+  close(uringDescriptor);
+  uringDescriptor = -1;
+
+  return;
+
+} // releaseUring
+
+/*****************************************************************************
+
+  Name: enterUring
+
+  Purpose: The purpose of this function is to submit requests to the
+  kernel, and optionally to wait for completions.
+
+  Calling Sequence: enterUring(toSubmit,minComplete)
+
+  Inputs:
+
+    toSubmit - The number of new submission entries.
+
+    minComplete - The number of completions to wait for.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void AsyncBlockIo::enterUring(unsigned toSubmit,unsigned minComplete)
+{
+  unsigned flags;
+
+  flags = 0;
+
+  if (minComplete > 0)
+  {
+    flags = IORING_ENTER_GETEVENTS;
+  } // if
+
+  while (syscall(__NR_io_uring_enter,uringDescriptor,toSubmit,minComplete,
+                 flags,NULL,0) < 0)
+  {
+    if (errno != EINTR)
+    {
+      failed = true;
+      break;
+    } // if
+
+    // The entries were not consumed if the call was interrupted.
+  } // while
+
+  return;
+
+} // enterUring
+
+/*****************************************************************************
+
+  Name: submitUring
+
+  Purpose: The purpose of this function is to submit the transfer of the
+  part of a buffer that has not been transferred yet.
+
+  Calling Sequence: submitUring(ringPtr,index)
+
+  Inputs:
+
+    ringPtr - A pointer to the ring.
+
+    index - The index of the buffer.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void AsyncBlockIo::submitUring(Ring *ringPtr,int index)
+{
+  unsigned tail;
+  unsigned entryIndex;
+  struct io_uring_sqe *entryPtr;
+  Slot *slotPtr;
+
+  slotPtr = &ringPtr->slots[index];
+
+  tail = *submissionTailPtr;
+  entryIndex = tail & *submissionMaskPtr;
+  entryPtr = &((struct io_uring_sqe *)submissionEntriesPtr)[entryIndex];
+
+  memset(entryPtr,0,sizeof(*entryPtr));
+
+  if (ringPtr->writing)
+  {
+    entryPtr->opcode = IORING_OP_WRITE;
+    entryPtr->user_data = WRITE_USER_DATA | index;
+  } // if
+  else
+  {
+    entryPtr->opcode = IORING_OP_READ;
+    entryPtr->user_data = index;
+  } // else
+
+  entryPtr->fd = ringPtr->descriptor;
+  entryPtr->addr =
+    (uint64_t)(uintptr_t)&slotPtr->dataPtr[slotPtr->transferred];
+  entryPtr->len = slotPtr->length - slotPtr->transferred;
+
+  if (ringPtr->seekable)
+  {
+    entryPtr->off = slotPtr->offset + slotPtr->transferred;
+  } // if
+  else
+  {
+    // Use the current position of the pipe.
+    entryPtr->off = (uint64_t)-1;
+  } // else
+
+  submissionArrayPtr[entryIndex] = entryIndex;
+
+  // Publish the entry to the kernel.
+  __atomic_store_n(submissionTailPtr,tail + 1,__ATOMIC_RELEASE);
+
+  enterUring(1,0);
+
+  return;
+
+} // submitUring
+
+/*****************************************************************************
+
+  Name: cancelUring
+
+  Purpose: The purpose of this function is to cancel the requests of a
+  ring that are in flight.
+
+  Calling Sequence: cancelUring(ringPtr)
+
+  Inputs:
+
+    ringPtr - A pointer to the ring.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void AsyncBlockIo::cancelUring(Ring *ringPtr)
+{
+  int i;
+  unsigned tail;
+  unsigned entryIndex;
+  struct io_uring_sqe *entryPtr;
+
+  for (i = 0; i < queueDepth; i++)
+  {
+    if (ringPtr->slots[i].state == SLOT_BUSY)
+    {
+      tail = *submissionTailPtr;
+      entryIndex = tail & *submissionMaskPtr;
+      entryPtr = &((struct io_uring_sqe *)submissionEntriesPtr)[entryIndex];
+
+      memset(entryPtr,0,sizeof(*entryPtr));
+      entryPtr->opcode = IORING_OP_ASYNC_CANCEL;
+      entryPtr->fd = -1;
+      entryPtr->user_data = CANCEL_USER_DATA;
+
+      if (ringPtr->writing)
+      {
+        entryPtr->addr = WRITE_USER_DATA | i;
+      } // if
+      else
+      {
+        entryPtr->addr = i;
+      } // else
+
+      submissionArrayPtr[entryIndex] = entryIndex;
+      __atomic_store_n(submissionTailPtr,tail + 1,__ATOMIC_RELEASE);
+
+      enterUring(1,0);
+    } // if
+  } // for
+
+  return;
+
+} // cancelUring
+
+/*****************************************************************************
+
+  Name: reapUring
+
+  Purpose: The purpose of this function is to process the completions
+  that the kernel has posted.
+
+  Calling Sequence: reapUring(wait)
+
+  Inputs:
+
+    wait - A flag that indicates whether to wait for at least one
+    completion.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void AsyncBlockIo::reapUring(bool wait)
+{
+  unsigned head;
+  unsigned tail;
+  uint64_t userData;
+  int result;
+  struct io_uring_cqe *entryPtr;
+
+  head = *completionHeadPtr;
+  tail = __atomic_load_n(completionTailPtr,__ATOMIC_ACQUIRE);
+
+  if ((head == tail) && wait)
+  {
+    enterUring(0,1);
+    tail = __atomic_load_n(completionTailPtr,__ATOMIC_ACQUIRE);
+  } // if
+
+  while (head != tail)
+  {
+    entryPtr = (struct io_uring_cqe *)completionEntriesPtr;
+    entryPtr = &entryPtr[head & *completionMaskPtr];
+
+    userData = entryPtr->user_data;
+    result = entryPtr->res;
+
+    // Give the entry back to the kernel before acting on it.
+    head++;
+    __atomic_store_n(completionHeadPtr,head,__ATOMIC_RELEASE);
+
+    if (userData != CANCEL_USER_DATA)
+    {
+      if (userData & WRITE_USER_DATA)
+      {
+        completeUring(&outputRing,(int)(userData & 0xffff),result);
+      } // if
+      else
+      {
+        completeUring(&inputRing,(int)userData,result);
+      } // else
+    } // if
+  } // while
+
+  return;
+
+} // reapUring
+
+/*****************************************************************************
+
+  Name: completeUring
+
+  Purpose: The purpose of this function is to act on the completion of a
+  request.  A short transfer is continued with another request, so a
+  buffer is only finished when it is full, at the end of the input, or
+  on an error.
+
+  Calling Sequence: completeUring(ringPtr,index,result)
+
+  Inputs:
+
+    ringPtr - A pointer to the ring.
+
+    index - The index of the buffer.
+
+    result - The result of the request: the number of bytes transferred,
+    or a negated error number.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void AsyncBlockIo::completeUring(Ring *ringPtr,int index,int result)
+{
+  Slot *slotPtr;
+
+  slotPtr = &ringPtr->slots[index];
+  ringPtr->inFlight--;
+
+  if (stopping)
+  {
+    // Cancelled or finished during shutdown.
+    slotPtr->state = SLOT_IDLE;
+    return;
+  } // if
+
+  if ((result == -EINTR) || (result == -EAGAIN))
+  {
+    // Try again.
+    startTransfer(ringPtr,index);
+    return;
+  } // if
+
+  if (result > 0)
+  {
+    slotPtr->transferred += result;
+
+    if (slotPtr->transferred < slotPtr->length)
+    {
+      // Transfer the rest.
+      startTransfer(ringPtr,index);
+      return;
+    } // if
+  } // if
+  else
+  {
+    if (result < 0)
+    {
+      failed = true;
+    } // if
+
+    // Nothing more can be transferred.
+    slotPtr->endOfStream = true;
+  } // else
+
+  if (ringPtr->writing)
+  {
+    slotPtr->state = SLOT_IDLE;
+  } // if
+  else
+  {
+    slotPtr->state = SLOT_READY;
+  } // else
+
+  // A pipe may now take its next request.
+  issueTransfers(ringPtr);
+
+  return;
+
+} // completeUring
+
+/*****************************************************************************
+
+  Name: issueTransfers
+
+  Purpose: The purpose of this function is to start the transfers of a
+  ring that are able to start, in stream order.  For reads, these are
+  the idle buffers; for writes, these are the full buffers.  Only one
+  request is kept in flight for a pipe under io_uring.
+
+  Calling Sequence: issueTransfers(ringPtr)
+
+  Inputs:
+
+    ringPtr - A pointer to the ring.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void AsyncBlockIo::issueTransfers(Ring *ringPtr)
+{
+  int index;
+  Slot *slotPtr;
+
+  if ((ringPtr->descriptor < 0) || ringPtr->ended || stopping)
+  {
+    return;
+  } // if
+
+  while (true)
+  {
+    index = ringPtr->issueIndex;
+    slotPtr = &ringPtr->slots[index];
+
+    if ((uringDescriptor >= 0) && !ringPtr->seekable &&
+        (ringPtr->inFlight > 0))
+    {
+      // Requests on a pipe may complete out of order.
+      break;
+    } // if
+
+    if (ringPtr->writing)
+    {
+      if (slotPtr->state != SLOT_QUEUED)
+      {
+        break;
+      } // if
+    } // if
+    else
+    {
+      if (slotPtr->state != SLOT_IDLE)
+      {
+        break;
+      } // if
+
+      // Fill the whole buffer from the next offset.
+      slotPtr->length = blockSize;
+      slotPtr->transferred = 0;
+      slotPtr->offset = ringPtr->nextOffset;
+      slotPtr->endOfStream = false;
+      ringPtr->nextOffset += blockSize;
+    } // else
+
+    startTransfer(ringPtr,index);
+
+    ringPtr->issueIndex = (index + 1) % queueDepth;
+  } // while
+
+  return;
+
+} // issueTransfers
+
+/*****************************************************************************
+
+  Name: startTransfer
+
+  Purpose: The purpose of this function is to hand a buffer to io_uring
+  or to the transfer thread of its ring.
+
+  Calling Sequence: startTransfer(ringPtr,index)
+
+  Inputs:
+
+    ringPtr - A pointer to the ring.
+
+    index - The index of the buffer.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void AsyncBlockIo::startTransfer(Ring *ringPtr,int index)
+{
+
+  if (uringDescriptor >= 0)
+  {
+    ringPtr->slots[index].state = SLOT_BUSY;
+    ringPtr->inFlight++;
+    submitUring(ringPtr,index);
+  } // if
+  else
+  {
+    setSlotState(&ringPtr->slots[index],SLOT_BUSY);
+  } // else
+
+  return;
+
+} // startTransfer
+
+/*****************************************************************************
+
+  Name: queueSlot
+
+  Purpose: The purpose of this function is to queue the current output
+  buffer to be written, and to move on to the next one.
+
+  Calling Sequence: queueSlot(ringPtr,length)
+
+  Inputs:
+
+    ringPtr - A pointer to the output ring.
+
+    length - The number of bytes in the buffer.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void AsyncBlockIo::queueSlot(Ring *ringPtr,uint32_t length)
+{
+  Slot *slotPtr;
+
+  slotPtr = &ringPtr->slots[ringPtr->currentIndex];
+
+  slotPtr->length = length;
+  slotPtr->transferred = 0;
+  slotPtr->offset = ringPtr->nextOffset;
+  ringPtr->nextOffset += length;
+
+  setSlotState(slotPtr,SLOT_QUEUED);
+
+  ringPtr->currentIndex = (ringPtr->currentIndex + 1) % queueDepth;
+  ringPtr->position = 0;
+
+  issueTransfers(ringPtr);
+
+  return;
+
+} // queueSlot
+
+/*****************************************************************************
+
+  Name: setSlotState
+
+  Purpose: The purpose of this function is to change the state of a
+  buffer.  When the transfer threads are used, the change is made under
+  the lock, and the threads are woken.
+
+  Calling Sequence: setSlotState(slotPtr,state)
+
+  Inputs:
+
+    slotPtr - A pointer to the buffer.
+
+    state - The new state.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void AsyncBlockIo::setSlotState(Slot *slotPtr,SlotState state)
+{
+
+  if (uringDescriptor >= 0)
+  {
+    slotPtr->state = state;
+  } // if
+  else
+  {
+    pthread_mutex_lock(&mutex);
+    slotPtr->state = state;
+    pthread_cond_broadcast(&changed);
+    pthread_mutex_unlock(&mutex);
+  } // else
+
+  return;
+
+} // setSlotState
+
+/*****************************************************************************
+
+  Name: waitForSlot
+
+  Purpose: The purpose of this function is to wait until a read buffer
+  has been filled, or until a write buffer has been written.
+
+  Calling Sequence: waitForSlot(ringPtr,index)
+
+  Inputs:
+
+    ringPtr - A pointer to the ring.
+
+    index - The index of the buffer.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void AsyncBlockIo::waitForSlot(Ring *ringPtr,int index)
+{
+  Slot *slotPtr;
+
+  slotPtr = &ringPtr->slots[index];
+
+  if (uringDescriptor >= 0)
+  {
+    while (isSlotPending(ringPtr,slotPtr))
+    {
+      if (ringPtr->inFlight == 0)
+      {
+        // A pipe may have been waiting for its previous request.
+        issueTransfers(ringPtr);
+
+        if (ringPtr->inFlight == 0)
+        {
+          // The submission failed, so nothing will complete.
+          failed = true;
+          slotPtr->state = (ringPtr->writing) ? SLOT_IDLE : SLOT_READY;
+          slotPtr->endOfStream = true;
+          break;
+        } // if
+      } // if
+
+      reapUring(true);
+    } // while
+  } // if
+  else
+  {
+    pthread_mutex_lock(&mutex);
+
+    while (isSlotPending(ringPtr,slotPtr))
+    {
+      pthread_cond_wait(&changed,&mutex);
+    } // while
+
+    pthread_mutex_unlock(&mutex);
+  } // else
+
+  return;
+
+} // waitForSlot
+
+/*****************************************************************************
+
+  Name: isSlotPending
+
+  Purpose: The purpose of this function is to indicate whether the
+  caller must still wait for a buffer.  A read buffer is pending until
+  it has been filled, and a write buffer is pending until it has been
+  written.
+
+  Calling Sequence: pending = isSlotPending(ringPtr,slotPtr)
+
+  Inputs:
+
+    ringPtr - A pointer to the ring.
+
+    slotPtr - A pointer to the buffer.
+
+  Outputs:
+
+    pending - A flag that indicates whether the buffer is pending.
+
+*****************************************************************************/
+bool AsyncBlockIo::isSlotPending(Ring *ringPtr,Slot *slotPtr)
+{
+  bool pending;
+
+  if (ringPtr->writing)
+  {
+    pending = (slotPtr->state == SLOT_BUSY) ||
+              (slotPtr->state == SLOT_QUEUED);
+  } // if
+  else
+  {
+    pending = (slotPtr->state != SLOT_READY);
+  } // else
+
+  return (pending);
+
+} // isSlotPending
+
+/*****************************************************************************
+
+  Name: transferSlot
+
+  Purpose: The purpose of this function is to perform the transfer of a
+  buffer on a transfer thread.  The thread is the only one that uses its
+  descriptor, so the current position of the descriptor is used.  Only
+  a read of the input can be cancelled, since it may wait on a pipe
+  forever.
+
+  Calling Sequence: transferSlot(ringPtr,slotPtr)
+
+  Inputs:
+
+    ringPtr - A pointer to the ring.
+
+    slotPtr - A pointer to the buffer.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void AsyncBlockIo::transferSlot(Ring *ringPtr,Slot *slotPtr)
+{
+  ssize_t result;
+  int oldState;
+
+  while (slotPtr->transferred < slotPtr->length)
+  {
+    if (ringPtr->writing)
+    {
+      result = ::write(ringPtr->descriptor,
+                       &slotPtr->dataPtr[slotPtr->transferred],
+                       slotPtr->length - slotPtr->transferred);
+    } // if
+    else
+    {
+      pthread_setcancelstate(PTHREAD_CANCEL_ENABLE,&oldState);
+
+      result = ::read(ringPtr->descriptor,
+                      &slotPtr->dataPtr[slotPtr->transferred],
+                      slotPtr->length - slotPtr->transferred);
+
+      pthread_setcancelstate(PTHREAD_CANCEL_DISABLE,&oldState);
+    } // else
+
+    if (result > 0)
+    {
+      slotPtr->transferred += result;
+    } // if
+    else
+    {
+      if ((result < 0) && (errno == EINTR))
+      {
+        continue;
+      } // if
+
+      if (result < 0)
+      {
+        failed = true;
+      } // if
+
+      slotPtr->endOfStream = true;
+      break;
+    } // else
+  } // while
+
+  return;
+
+} // transferSlot
+
+/*****************************************************************************
+
+  Name: transferThread
+
+  Purpose: The purpose of this function is to serve as the entry point of
+  a transfer thread.  The thread transfers the buffers of its ring in
+  stream order as they are handed to it, until it is told to stop.
+
+  Calling Sequence: transferThread(argPtr)
+
+  Inputs:
+
+    argPtr - A pointer to the ring.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void *AsyncBlockIo::transferThread(void *argPtr)
+{
+  int oldState;
+  Ring *ringPtr;
+  Slot *slotPtr;
+  AsyncBlockIo *ioPtr;
+
+  ringPtr = (Ring *)argPtr;
+  ioPtr = ringPtr->ownerPtr;
+
+  // Only blocking reads may be cancelled.
+  pthread_setcancelstate(PTHREAD_CANCEL_DISABLE,&oldState);
+
+  pthread_mutex_lock(&ioPtr->mutex);
+
+  while (true)
+  {
+    slotPtr = &ringPtr->slots[ringPtr->threadIndex];
+
+    while ((slotPtr->state != SLOT_BUSY) && !ioPtr->stopping)
+    {
+      pthread_cond_wait(&ioPtr->changed,&ioPtr->mutex);
+    } // while
+
+    if (slotPtr->state != SLOT_BUSY)
+    {
+      // We're done.
+      break;
+    } // if
+
+    pthread_mutex_unlock(&ioPtr->mutex);
+
+    ioPtr->transferSlot(ringPtr,slotPtr);
+
+    pthread_mutex_lock(&ioPtr->mutex);
+
+    if (ringPtr->writing)
+    {
+      slotPtr->state = SLOT_IDLE;
+    } // if
+    else
+    {
+      slotPtr->state = SLOT_READY;
+    } // else
+
+    ringPtr->threadIndex = (ringPtr->threadIndex + 1) % ioPtr->queueDepth;
+
+    pthread_cond_broadcast(&ioPtr->changed);
+  } // while
+
+  pthread_mutex_unlock(&ioPtr->mutex);
+
+  return (NULL);
+
+} // transferThread
+
+/*****************************************************************************
+
+  Name: read
+
+  Purpose: The purpose of this function is to read bytes from the input.
+  Bytes are copied out of the buffers that have been read ahead, and each
+  buffer is reissued as soon as it has been consumed.  The call only
+  waits when the next buffer has not arrived yet.
+
+  Calling Sequence: bytesRead = read(bufferPtr,count)
+
+  Inputs:
+
+    bufferPtr - A pointer to storage for the bytes.
+
+    count - The number of bytes to read.
+
+  Outputs:
+
+    bytesRead - The number of bytes that were read.  This is less than
+    count only at the end of the input.
+
+*****************************************************************************/
+uint32_t AsyncBlockIo::read(void *bufferPtr,uint32_t count)
+{
+  uint32_t bytesRead;
+  uint32_t available;
+  uint8_t *destinationPtr;
+  Slot *slotPtr;
+
+  destinationPtr = (uint8_t *)bufferPtr;
+  bytesRead = 0;
+
+  if (inputRing.descriptor < 0)
+  {
+    return (0);
+  } // if
+
+  while ((bytesRead < count) && !inputRing.ended)
+  {
+    slotPtr = &inputRing.slots[inputRing.currentIndex];
+
+    if (slotPtr->state != SLOT_READY)
+    {
+      issueTransfers(&inputRing);
+    } // if
+
+    // Wait for the buffer to be filled.
+    waitForSlot(&inputRing,inputRing.currentIndex);
+
+    // Copy what is available.
+    available = slotPtr->transferred - inputRing.position;
+
+    if (available > (count - bytesRead))
+    {
+      available = count - bytesRead;
+    } // if
+
+    memcpy(&destinationPtr[bytesRead],
+           &slotPtr->dataPtr[inputRing.position],
+           available);
+
+    bytesRead += available;
+    inputRing.position += available;
+
+    if (inputRing.position == slotPtr->transferred)
+    {
+      if (slotPtr->endOfStream)
+      {
+        // There is nothing more to read.
+        inputRing.ended = true;
+      } // if
+      else
+      {
+        // Read the next block into this buffer.
+        setSlotState(slotPtr,SLOT_IDLE);
+
+        inputRing.currentIndex = (inputRing.currentIndex + 1) % queueDepth;
+        inputRing.position = 0;
+
+        issueTransfers(&inputRing);
+      } // else
+    } // if
+  } // while
+
+  return (bytesRead);
+
+} // read
+
+/*****************************************************************************
+
+  Name: write
+
+  Purpose: The purpose of this function is to write bytes to the output.
+  Bytes are copied into the current buffer, and each buffer is handed off
+  to be written as soon as it is full.  The call only waits when every
+  buffer is still being written.
+
+  Calling Sequence: bytesWritten = write(bufferPtr,count)
+
+  Inputs:
+
+    bufferPtr - A pointer to the bytes.
+
+    count - The number of bytes to write.
+
+  Outputs:
+
+    bytesWritten - The number of bytes that were accepted.  Errors are
+    reported later by hasFailed().
+
+*****************************************************************************/
+uint32_t AsyncBlockIo::write(const void *bufferPtr,uint32_t count)
+{
+  uint32_t bytesWritten;
+  uint32_t room;
+  const uint8_t *sourcePtr;
+  Slot *slotPtr;
+
+  sourcePtr = (const uint8_t *)bufferPtr;
+  bytesWritten = 0;
+
+  if (outputRing.descriptor < 0)
+  {
+    return (0);
+  } // if
+
+  while (bytesWritten < count)
+  {
+    slotPtr = &outputRing.slots[outputRing.currentIndex];
+
+    // Wait for the buffer to be written.
+    waitForSlot(&outputRing,outputRing.currentIndex);
+
+    // Copy what fits.
+    room = blockSize - outputRing.position;
+
+    if (room > (count - bytesWritten))
+    {
+      room = count - bytesWritten;
+    } // if
+
+    memcpy(&slotPtr->dataPtr[outputRing.position],
+           &sourcePtr[bytesWritten],
+           room);
+
+    bytesWritten += room;
+    outputRing.position += room;
+
+    if (outputRing.position == blockSize)
+    {
+      queueSlot(&outputRing,blockSize);
+    } // if
+  } // while
+
+  return (bytesWritten);
+
+} // write
+
+/*****************************************************************************
+
+  Name: flush
+
+  Purpose: The purpose of this function is to write any partial buffer,
+  and to wait until all of the output has been written.
+
+  Calling Sequence: flush()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void AsyncBlockIo::flush(void)
+{
+  int i;
+
+  if (outputRing.descriptor < 0)
+  {
+    return;
+  } // if
+
+  if (outputRing.position > 0)
+  {
+    queueSlot(&outputRing,outputRing.position);
+  } // if
+
+  for (i = 0; i < queueDepth; i++)
+  {
+    waitForSlot(&outputRing,i);
+  } // for
+
+  return;
+
+} // flush
+
+/*****************************************************************************
+
+  Name: writeAt
+
+  Purpose: The purpose of this function is to write bytes at a given
+  offset of a seekable output, for example, to patch a header once the
+  size of the data is known.  Pending output is written first.
+
+  Calling Sequence: success = writeAt(offset,bufferPtr,count)
+
+  Inputs:
+
+    offset - The offset in the output.
+
+    bufferPtr - A pointer to the bytes.
+
+    count - The number of bytes to write.
+
+  Outputs:
+
+    success - A flag that indicates whether the bytes were written.
+
+*****************************************************************************/
+bool AsyncBlockIo::writeAt(uint64_t offset,
+                           const void *bufferPtr,
+                           uint32_t count)
+{
+  ssize_t result;
+  uint32_t written;
+
+  if (!outputRing.seekable)
+  {
+    return (false);
+  } // if
+
+  flush();
+
+  written = 0;
+
+  while (written < count)
+  {
+    result = pwrite(outputRing.descriptor,
+                    (const uint8_t *)bufferPtr + written,
+                    count - written,
+                    offset + written);
+
+    if (result <= 0)
+    {
+      if ((result < 0) && (errno == EINTR))
+      {
+        continue;
+      } // if
+
+      failed = true;
+      return (false);
+    } // if
+
+    written += result;
+  } // while
+
+  return (true);
+
+} // writeAt
+
+/*****************************************************************************
+
+  Name: isUsingUring
+
+  Purpose: The purpose of this function is to indicate whether io_uring
+  is performing the transfers.
+
+  Calling Sequence: usingUring = isUsingUring()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    usingUring - A flag that indicates whether io_uring is used.  A value
+    of false indicates that the transfer threads are used.
+
+*****************************************************************************/
+bool AsyncBlockIo::isUsingUring(void)
+{
+
+  return (uringDescriptor >= 0);
+
+} // isUsingUring
+
+/*****************************************************************************
+
+  Name: isOutputSeekable
+
+  Purpose: The purpose of this function is to indicate whether the output
+  can be seeked, so that writeAt() can be used.
+
+  Calling Sequence: seekable = isOutputSeekable()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    seekable - A flag that indicates whether the output can be seeked.
+
+*****************************************************************************/
+bool AsyncBlockIo::isOutputSeekable(void)
+{
+
+  return (outputRing.seekable);
+
+} // isOutputSeekable
+
+/*****************************************************************************
+
+  Name: hasFailed
+
+  Purpose: The purpose of this function is to indicate whether an I/O
+  error has occurred.
+
+  Calling Sequence: failed = hasFailed()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    failed - A flag that indicates whether an error has occurred.
+
+*****************************************************************************/
+bool AsyncBlockIo::hasFailed(void)
+{
+
+  return (failed);
+
+} // hasFailed
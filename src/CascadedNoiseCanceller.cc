@@ -0,0 +1,862 @@
+//************************************************************************
+// file name: CascadedNoiseCanceller.cc
+//************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "CascadedNoiseCanceller.h"
+#include "SampleConverter.h"
+
+using namespace std;
+
+/*****************************************************************************
+
+  Name: CascadedNoiseCanceller
+
+  Purpose: The purpose of this function is to serve as the constructor for
+  an instance of a CascadedNoiseCanceller.  The stages are run by the
+  caller until setNumberOfThreads() is called.
+
+  Calling Sequence: CascadedNoiseCanceller(numberOfStages,
+                                           filterLengthsPtr,
+                                           referenceDelaysPtr,
+                                           betasPtr)
+
+  Inputs:
+
+    numberOfStages - The number of stages.
+
+    filterLengthsPtr - A pointer to the number of taps of each stage.
+
+    referenceDelaysPtr - A pointer to the reference delay of each stage.
+
+    betasPtr - A pointer to the normalized step-size of each stage.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+CascadedNoiseCanceller::CascadedNoiseCanceller(int numberOfStages,
+                                               int *filterLengthsPtr,
+                                               int *referenceDelaysPtr,
+                                               float *betasPtr)
+{
+  int s;
+
+  if (numberOfStages < 1)
+  {
+    numberOfStages = 1;
+  } // if
+
+  // Save for later use.
+  this->numberOfStages = numberOfStages;
+
+  stagePtrs = new NlmsNoiseCanceller *[numberOfStages];
+  stageOutputPtrs = new float *[numberOfStages];
+
+  // The output of each stage is an estimate of its delayed input, so the
+  // delays of the stages add up.
+  latency = 0;
+
+  for (s = 0; s < numberOfStages; s++)
+  {
+    stagePtrs[s] = new NlmsNoiseCanceller(filterLengthsPtr[s],
+                                          referenceDelaysPtr[s],
+                                          betasPtr[s]);
+
+    latency += referenceDelaysPtr[s];
+
+    // The last stage writes to the caller's buffer.
+    stageOutputPtrs[s] = NULL;
+
+    if (s < (numberOfStages - 1))
+    {
+      stageOutputPtrs[s] = (float *)SampleConverter::allocateAligned(
+        CHUNK_SIZE * sizeof(float));
+    } // if
+  } // for
+
+  // Default to running every stage on the caller's thread.
+  numberOfThreads = 1;
+  firstStagePtr = NULL;
+  threadsPtr = NULL;
+  workersPtr = NULL;
+  done = false;
+
+  assignStages();
+
+  return;
+
+} // CascadedNoiseCanceller
+
+/*****************************************************************************
+
+  Name: ~CascadedNoiseCanceller
+
+  Purpose: The purpose of this function is to serve as the destructor for
+  an instance of a CascadedNoiseCanceller.
+
+  Calling Sequence: ~CascadedNoiseCanceller()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+CascadedNoiseCanceller::~CascadedNoiseCanceller(void)
+{
+  int s;
+
+  stopThreads();
+
+  // Release resources.
+  for (s = 0; s < numberOfStages; s++)
+  {
+    delete stagePtrs[s];
+
+    if (stageOutputPtrs[s] != NULL)
+    {
+      SampleConverter::releaseAligned(stageOutputPtrs[s]);
+    } // if
+  } // for
+
+  delete[] stagePtrs;
+  delete[] stageOutputPtrs;
+  delete[] firstStagePtr;
+
+  return;
+
+} // ~CascadedNoiseCanceller
+
+/*****************************************************************************
+
+  Name: setNumberOfThreads
+
+  Purpose: The purpose of this function is to set the number of threads
+  that the stages are pipelined across.  The calling thread is one of
+  them, so a value of 1 runs every stage on the calling thread.  There
+  are never more threads than stages.
+
+  Calling Sequence: setNumberOfThreads(numberOfThreads)
+
+  Inputs:
+
+    numberOfThreads - The number of threads.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void CascadedNoiseCanceller::setNumberOfThreads(int numberOfThreads)
+{
+
+  if (numberOfThreads > numberOfStages)
+  {
+    numberOfThreads = numberOfStages;
+  } // if
+
+  if (numberOfThreads < 1)
+  {
+    numberOfThreads = 1;
+  } // if
+
+  stopThreads();
+
+  this->numberOfThreads = numberOfThreads;
+
+  assignStages();
+  startThreads();
+
+  return;
+
+} // setNumberOfThreads
+
+/*****************************************************************************
+
+  Name: getNumberOfThreads
+
+  Purpose: The purpose of this function is to return the number of
+  threads that the stages are pipelined across.
+
+  Calling Sequence: numberOfThreads = getNumberOfThreads()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    numberOfThreads - The number of threads, including the caller.
+
+*****************************************************************************/
+int CascadedNoiseCanceller::getNumberOfThreads(void)
+{
+
+  return (numberOfThreads);
+
+} // getNumberOfThreads
+
+/*****************************************************************************
+
+  Name: getNumberOfStages
+
+  Purpose: The purpose of this function is to return the number of
+  stages of the cascade.
+
+  Calling Sequence: numberOfStages = getNumberOfStages()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    numberOfStages - The number of stages.
+
+*****************************************************************************/
+int CascadedNoiseCanceller::getNumberOfStages(void)
+{
+
+  return (numberOfStages);
+
+} // getNumberOfStages
+
+/*****************************************************************************
+
+  Name: getLatency
+
+  Purpose: The purpose of this function is to return the delay, in
+  samples, between a component of the input and the same component at
+  the output, which is the sum of the delays of the stages.
+
+  Calling Sequence: latency = getLatency()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    latency - The latency in samples.
+
+*****************************************************************************/
+int CascadedNoiseCanceller::getLatency(void)
+{
+
+  return (latency);
+
+} // getLatency
+
+/*****************************************************************************
+
+  Name: getStage
+
+  Purpose: The purpose of this function is to provide access to one of
+  the stages, so that its modes (such as the variable step-size policy)
+  can be set.  The modes should not be changed while the stages are
+  processing data.
+
+  Calling Sequence: cancellerPtr = getStage(stage)
+
+  Inputs:
+
+    stage - The index of the stage, where 0 is the first stage.
+
+  Outputs:
+
+    cancellerPtr - A pointer to the canceller of the stage, or NULL if
+    there is no such stage.
+
+*****************************************************************************/
+NlmsNoiseCanceller *CascadedNoiseCanceller::getStage(int stage)
+{
+
+  if ((stage < 0) || (stage >= numberOfStages))
+  {
+    return (NULL);
+  } // if
+
+  return (stagePtrs[stage]);
+
+} // getStage
+
+/*****************************************************************************
+
+  Name: writeState
+
+  Purpose: The purpose of this function is to write the adaptive state of
+  all of the stages to a stream, so that it can be restored by
+  readState().  No state is carried from one chunk to the next outside
+  of the stages, so the state of the stages is the whole state.
+
+  Calling Sequence: success = writeState(streamPtr)
+
+  Inputs:
+
+    streamPtr - The stream.
+
+  Outputs:
+
+    success - A flag that indicates whether the state was written.
+
+*****************************************************************************/
+bool CascadedNoiseCanceller::writeState(FILE *streamPtr)
+{
+  int i;
+
+  if (fwrite(&numberOfStages,sizeof(int),1,streamPtr) != 1)
+  {
+    return (false);
+  } // if
+
+  for (i = 0; i < numberOfStages; i++)
+  {
+    if (!stagePtrs[i]->writeState(streamPtr))
+    {
+      return (false);
+    } // if
+  } // for
+
+  return (true);
+
+} // writeState
+
+/*****************************************************************************
+
+  Name: readState
+
+  Purpose: The purpose of this function is to read the adaptive state
+  that was written by writeState().  The state is rejected if it was
+  written by a cascade with another number of stages, or by a stage
+  that is configured differently.
+
+  Calling Sequence: success = readState(streamPtr)
+
+  Inputs:
+
+    streamPtr - The stream.
+
+  Outputs:
+
+    success - A flag that indicates whether the state was read.
+
+*****************************************************************************/
+bool CascadedNoiseCanceller::readState(FILE *streamPtr)
+{
+  int i;
+  int count;
+
+  if (fread(&count,sizeof(int),1,streamPtr) != 1)
+  {
+    return (false);
+  } // if
+
+  if (count != numberOfStages)
+  {
+    return (false);
+  } // if
+
+  for (i = 0; i < numberOfStages; i++)
+  {
+    if (!stagePtrs[i]->readState(streamPtr))
+    {
+      return (false);
+    } // if
+  } // for
+
+  return (true);
+
+} // readState
+
+/*****************************************************************************
+
+  Name: assignStages
+
+  Purpose: The purpose of this function is to divide the stages among the
+  threads.  The cost of a stage is taken to be its number of taps, and
+  each thread receives a contiguous group of stages whose cost is about
+  the total cost divided by the number of threads.  Every thread
+  receives at least one stage.
+
+  Calling Sequence: assignStages()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void CascadedNoiseCanceller::assignStages(void)
+{
+  int s;
+  int t;
+  double cost;
+  double totalCost;
+
+  delete[] firstStagePtr;
+  firstStagePtr = new int[numberOfThreads + 1];
+
+  totalCost = 0;
+
+  for (s = 0; s < numberOfStages; s++)
+  {
+    totalCost += stagePtrs[s]->getFilterLength();
+  } // for
+
+  cost = 0;
+  t = 0;
+  firstStagePtr[0] = 0;
+
+  for (s = 0; s < numberOfStages; s++)
+  {
+    // Start the next group when this one has its share, or when only
+    // one stage is left for each of the remaining threads.
+    if ((t < (numberOfThreads - 1)) && (s > firstStagePtr[t]) &&
+        ((cost >= (((t + 1) * totalCost) / numberOfThreads)) ||
+         ((numberOfStages - s) == (numberOfThreads - 1 - t))))
+    {
+      t++;
+      firstStagePtr[t] = s;
+    } // if
+
+    cost += stagePtrs[s]->getFilterLength();
+  } // for
+
+  firstStagePtr[numberOfThreads] = numberOfStages;
+
+  return;
+
+} // assignStages
+
+/*****************************************************************************
+
+  Name: startThreads
+
+  Purpose: The purpose of this function is to start the pipeline
+  threads.  The calling thread acts as thread 0, so nothing is started
+  when there is one thread.
+
+  Calling Sequence: startThreads()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void CascadedNoiseCanceller::startThreads(void)
+{
+  int t;
+
+  if (numberOfThreads < 2)
+  {
+    return;
+  } // if
+
+  done = false;
+
+  pthread_barrier_init(&startBarrier,NULL,numberOfThreads);
+  pthread_barrier_init(&stepBarrier,NULL,numberOfThreads);
+
+  threadsPtr = new pthread_t[numberOfThreads];
+  workersPtr = new Worker[numberOfThreads];
+
+  for (t = 1; t < numberOfThreads; t++)
+  {
+    workersPtr[t].ownerPtr = this;
+    workersPtr[t].threadIndex = t;
+    pthread_create(&threadsPtr[t],NULL,stageWorker,&workersPtr[t]);
+  } // for
+
+  return;
+
+} // startThreads
+
+/*****************************************************************************
+
+  Name: stopThreads
+
+  Purpose: The purpose of this function is to stop the pipeline threads,
+  if they are running.
+
+  Calling Sequence: stopThreads()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void CascadedNoiseCanceller::stopThreads(void)
+{
+  int t;
+
+  if (threadsPtr == NULL)
+  {
+    return;
+  } // if
+
+  // Release the threads with nothing to do.
+  done = true;
+  pthread_barrier_wait(&startBarrier);
+
+  for (t = 1; t < numberOfThreads; t++)
+  {
+    pthread_join(threadsPtr[t],NULL);
+  } // for
+
+  pthread_barrier_destroy(&startBarrier);
+  pthread_barrier_destroy(&stepBarrier);
+
+  delete[] threadsPtr;
+  delete[] workersPtr;
+
+  threadsPtr = NULL;
+  workersPtr = NULL;
+
+  return;
+
+} // stopThreads
+
+/*****************************************************************************
+
+  Name: stageWorker
+
+  Purpose: The purpose of this function is to serve as the entry point of
+  a pipeline thread.  The thread waits for the caller to publish a
+  chunk, runs its stages in each step of the chunk, and waits for the
+  other threads at the end of each step.
+
+  Calling Sequence: stageWorker(argPtr)
+
+  Inputs:
+
+    argPtr - A pointer to the arguments of the thread.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void *CascadedNoiseCanceller::stageWorker(void *argPtr)
+{
+  int step;
+  bool finished;
+  Worker *workerPtr;
+  CascadedNoiseCanceller *ownerPtr;
+
+  workerPtr = (Worker *)argPtr;
+  ownerPtr = workerPtr->ownerPtr;
+
+  // Set up for loop entry.
+  finished = false;
+
+  while (!finished)
+  {
+    // Wait for the next chunk.
+    pthread_barrier_wait(&ownerPtr->startBarrier);
+
+    if (ownerPtr->done)
+    {
+      // We're done.
+      finished = true;
+    } // if
+    else
+    {
+      for (step = 0; step < ownerPtr->numberOfSteps; step++)
+      {
+        ownerPtr->processStep(workerPtr->threadIndex,step);
+
+        // The next group may now take the sub-block.
+        pthread_barrier_wait(&ownerPtr->stepBarrier);
+      } // for
+    } // else
+  } // while
+
+  return (NULL);
+
+} // stageWorker
+
+/*****************************************************************************
+
+  Name: processStep
+
+  Purpose: The purpose of this function is to run the stages of one
+  thread over the sub-block that the thread works on in one step of a
+  chunk.  In step n, thread t works on sub-block n - t, so it has
+  nothing to do while the pipeline fills and drains.
+
+  Calling Sequence: processStep(threadIndex,step)
+
+  Inputs:
+
+    threadIndex - The index of the thread.
+
+    step - The step of the chunk.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void CascadedNoiseCanceller::processStep(int threadIndex,int step)
+{
+  int s;
+  int subblock;
+  uint32_t offset;
+  uint32_t count;
+  float *inputPtr;
+  float *outputPtr;
+
+  subblock = step - threadIndex;
+  offset = subblock * SUBBLOCK_SIZE;
+
+  if ((subblock < 0) || (offset >= chunkCount))
+  {
+    return;
+  } // if
+
+  count = chunkCount - offset;
+
+  if (count > SUBBLOCK_SIZE)
+  {
+    count = SUBBLOCK_SIZE;
+  } // if
+
+  for (s = firstStagePtr[threadIndex]; s < firstStagePtr[threadIndex + 1]; s++)
+  {
+    // The first stage reads the caller's buffer.
+    if (s == 0)
+    {
+      inputPtr = &chunkInputPtr[offset];
+    } // if
+    else
+    {
+      inputPtr = &stageOutputPtrs[s - 1][offset];
+    } // else
+
+    // The last stage writes the caller's buffer.
+    if (s == (numberOfStages - 1))
+    {
+      outputPtr = &chunkOutputPtr[offset];
+    } // if
+    else
+    {
+      outputPtr = &stageOutputPtrs[s][offset];
+    } // else
+
+    stagePtrs[s]->acceptData(inputPtr,count,outputPtr);
+  } // for
+
+  return;
+
+} // processStep
+
+/*****************************************************************************
+
+  Name: processChunk
+
+  Purpose: The purpose of this function is to pass up to CHUNK_SIZE
+  samples through all of the stages.
+
+  Calling Sequence: processChunk(bufferPtr,count,outputBufferPtr)
+
+  Inputs:
+
+    bufferPtr - A pointer to the input samples.
+
+    count - The number of samples, which is no more than CHUNK_SIZE.
+
+    outputBufferPtr - A pointer to storage for the processed samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void CascadedNoiseCanceller::processChunk(float *bufferPtr,
+                                          uint32_t count,
+                                          float *outputBufferPtr)
+{
+  int step;
+
+  // Publish the chunk.
+  chunkInputPtr = bufferPtr;
+  chunkOutputPtr = outputBufferPtr;
+  chunkCount = count;
+
+  // The last sub-block leaves the last group numberOfThreads - 1 steps
+  // after it leaves the first.
+  numberOfSteps = ((count + SUBBLOCK_SIZE - 1) / SUBBLOCK_SIZE) +
+                  numberOfThreads - 1;
+
+  if (numberOfThreads > 1)
+  {
+    // Release the pipeline threads.
+    pthread_barrier_wait(&startBarrier);
+  } // if
+
+  for (step = 0; step < numberOfSteps; step++)
+  {
+    processStep(0,step);
+
+    if (numberOfThreads > 1)
+    {
+      pthread_barrier_wait(&stepBarrier);
+    } // if
+  } // for
+
+  return;
+
+} // processChunk
+
+/*****************************************************************************
+
+  Name: acceptData
+
+  Purpose: The purpose of this function is to present input samples to
+  be filtered and produce output samples to the calling function.
+
+  Calling Sequence: acceptData(bufferPtr,bufferLength,outputBufferPtr)
+
+  Inputs:
+
+    bufferPtr - A pointer to storage that provides the input samples.
+
+    bufferLength - The nmber of samples referenced by bufferPtr.  This
+    will also be the number of samples stored into memory referenced
+    by outputBufferPtr.
+
+    outputBufferPtr - A pointer to storage for the processed samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void CascadedNoiseCanceller::acceptData(int16_t *bufferPtr,
+                                        uint32_t bufferLength,
+                                        int16_t *outputBufferPtr)
+{
+
+  // Filter the block of data provided by the caller.
+  SampleConverter::filterInt16(filterBlock,
+                               this,
+                               bufferPtr,
+                               bufferLength,
+                               1,
+                               outputBufferPtr);
+
+  return;
+
+} // acceptData
+
+/*****************************************************************************
+
+  Name: filterBlock
+
+  Purpose: The purpose of this function is to pass a scratch block of
+  the 16-bit acceptData() to the float acceptData().
+
+  Calling Sequence: filterBlock(contextPtr,
+                                bufferPtr,
+                                bufferLength,
+                                outputBufferPtr)
+
+  Inputs:
+
+    contextPtr - A pointer to the canceller.
+
+    bufferPtr - A pointer to storage that provides the input samples.
+
+    bufferLength - The number of samples referenced by bufferPtr.
+
+    outputBufferPtr - A pointer to storage for the processed samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void CascadedNoiseCanceller::filterBlock(void *contextPtr,
+                                         float *bufferPtr,
+                                         uint32_t bufferLength,
+                                         float *outputBufferPtr)
+{
+  CascadedNoiseCanceller *thisPtr;
+
+  thisPtr = (CascadedNoiseCanceller *)contextPtr;
+
+  thisPtr->acceptData(bufferPtr,bufferLength,outputBufferPtr);
+
+  return;
+
+} // filterBlock
+
+/*****************************************************************************
+
+  Name: acceptData
+
+  Purpose: The purpose of this function is to present input samples to
+  be filtered and produce output samples to the calling function.  The
+  input and output buffers may be the same.
+
+  Calling Sequence: acceptData(bufferPtr,bufferLength,outputBufferPtr)
+
+  Inputs:
+
+    bufferPtr - A pointer to storage that provides the input samples.
+
+    bufferLength - The nmber of samples referenced by bufferPtr.  This
+    will also be the number of samples stored into memory referenced
+    by outputBufferPtr.
+
+    outputBufferPtr - A pointer to storage for the processed samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void CascadedNoiseCanceller::acceptData(float *bufferPtr,
+                                        uint32_t bufferLength,
+                                        float *outputBufferPtr)
+{
+  uint32_t i;
+  uint32_t count;
+
+  i = 0;
+
+  // Filter the block of data provided by the caller.
+  while (i < bufferLength)
+  {
+    count = bufferLength - i;
+
+    if (count > CHUNK_SIZE)
+    {
+      count = CHUNK_SIZE;
+    } // if
+
+    processChunk(&bufferPtr[i],count,&outputBufferPtr[i]);
+
+    i += count;
+  } // while
+
+  return;
+
+} // acceptData
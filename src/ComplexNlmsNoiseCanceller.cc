@@ -0,0 +1,530 @@
+//************************************************************************
+// file name: ComplexNlmsNoiseCanceller.cc
+//************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+#include "ComplexNlmsNoiseCanceller.h"
+#include "SampleConverter.h"
+
+using namespace std;
+
+/*****************************************************************************
+
+  Name: ComplexNlmsNoiseCanceller
+
+  Purpose: The purpose of this function is to serve as the constructor for
+  an instance of a ComplexNlmsNoiseCanceller.
+
+  Calling Sequence: ComplexNlmsNoiseCanceller(filterLength,referenceDelay,
+                                              beta)
+
+  Inputs:
+
+    filterLength - The number of complex taps for the filter.
+
+    referenceDelay - The number of samples to delay the input so that
+    the reference signal can be formed.
+
+    beta - The normalized step-size parameter.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+ComplexNlmsNoiseCanceller::ComplexNlmsNoiseCanceller(int filterLength,
+                                                     int referenceDelay,
+                                                     float beta)
+{
+  int i;
+  float *delayLineCoefficientsPtr;
+
+  // Save for later use.
+  this->filterLength = filterLength;
+
+  // Allocate storage for the coefficients.
+  coefficientsIPtr = new float[filterLength];
+  coefficientsQPtr = new float[filterLength];
+
+  // Allocate storage for the filter state.
+  filterStateIPtr = new float[filterLength];
+  filterStateQPtr = new float[filterLength];
+
+  // Start with zero-valued coefficients and an empty pipeline.
+  for (i = 0; i < filterLength; i++)
+  {
+    coefficientsIPtr[i] = 0;
+    coefficientsQPtr[i] = 0;
+    filterStateIPtr[i] = 0;
+    filterStateQPtr[i] = 0;
+  } // for
+
+  // Save this for display purposes.
+  this->referenceDelay = referenceDelay;
+
+  // Allocate delay line storage.
+  delayLineCoefficientsPtr = new float[referenceDelay + 1];
+
+  // Only the last tap of the delay line is nonzero.
+  for (i = 0; i < referenceDelay; i++)
+  {
+    delayLineCoefficientsPtr[i] = 0;
+  } // for
+
+  // Set delay line coefficient.
+  delayLineCoefficientsPtr[referenceDelay] = 1;
+
+  // Instantiate delay lines.
+  delayLineIPtr = new FirFilter(referenceDelay+1,delayLineCoefficientsPtr);
+  delayLineQPtr = new FirFilter(referenceDelay+1,delayLineCoefficientsPtr);
+
+  // We're done with this.
+  delete[] delayLineCoefficientsPtr;
+
+  // We'll use this for the update equation.
+  this->beta = beta;
+
+  return;
+
+} // ComplexNlmsNoiseCanceller
+
+/*****************************************************************************
+
+  Name: ~ComplexNlmsNoiseCanceller
+
+  Purpose: The purpose of this function is to serve as the destructor for
+  an instance of a ComplexNlmsNoiseCanceller.
+
+  Calling Sequence: ~ComplexNlmsNoiseCanceller()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+ComplexNlmsNoiseCanceller::~ComplexNlmsNoiseCanceller(void)
+{
+
+  // Release resources.
+  delete[] coefficientsIPtr;
+  delete[] coefficientsQPtr;
+  delete[] filterStateIPtr;
+  delete[] filterStateQPtr;
+  delete delayLineIPtr;
+  delete delayLineQPtr;
+
+  return;
+
+} // ~ComplexNlmsNoiseCanceller
+
+/*****************************************************************************
+
+  Name: acceptData
+
+  Purpose: The purpose of this function is to present complex input
+  samples, in cs16 format, to be filtered and produce output samples to
+  the calling function.
+
+  Calling Sequence: acceptData(bufferPtr,bufferLength,outputBufferPtr)
+
+  Inputs:
+
+    bufferPtr - A pointer to storage that provides the input samples as
+    interleaved I/Q pairs.
+
+    bufferLength - The number of complex samples referenced by
+    bufferPtr.  This will also be the number of complex samples stored
+    into memory referenced by outputBufferPtr.
+
+    outputBufferPtr - A pointer to storage for the processed samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void ComplexNlmsNoiseCanceller::acceptData(int16_t *bufferPtr,
+                                           uint32_t bufferLength,
+                                           int16_t *outputBufferPtr)
+{
+
+  // Filter the block of data provided by the caller.
+  SampleConverter::filterInt16(filterBlock,
+                               this,
+                               bufferPtr,
+                               bufferLength,
+                               2,
+                               outputBufferPtr);
+
+  return;
+
+} // acceptData
+
+/*****************************************************************************
+
+  Name: filterBlock
+
+  Purpose: The purpose of this function is to pass a scratch block of
+  the 16-bit acceptData() to the float acceptData().
+
+  Calling Sequence: filterBlock(contextPtr,
+                                bufferPtr,
+                                bufferLength,
+                                outputBufferPtr)
+
+  Inputs:
+
+    contextPtr - A pointer to the canceller.
+
+    bufferPtr - A pointer to storage that provides the input samples.
+
+    bufferLength - The number of complex samples referenced by bufferPtr.
+
+    outputBufferPtr - A pointer to storage for the processed samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void ComplexNlmsNoiseCanceller::filterBlock(void *contextPtr,
+                                            float *bufferPtr,
+                                            uint32_t bufferLength,
+                                            float *outputBufferPtr)
+{
+  ComplexNlmsNoiseCanceller *thisPtr;
+
+  thisPtr = (ComplexNlmsNoiseCanceller *)contextPtr;
+
+  thisPtr->acceptData(bufferPtr,bufferLength,outputBufferPtr);
+
+  return;
+
+} // filterBlock
+
+/*****************************************************************************
+
+  Name: acceptData
+
+  Purpose: The purpose of this function is to present complex input
+  samples, in cf32 format, to be filtered and produce output samples to
+  the calling function.
+
+  Calling Sequence: acceptData(bufferPtr,bufferLength,outputBufferPtr)
+
+  Inputs:
+
+    bufferPtr - A pointer to storage that provides the input samples as
+    interleaved I/Q pairs.
+
+    bufferLength - The number of complex samples referenced by
+    bufferPtr.  This will also be the number of complex samples stored
+    into memory referenced by outputBufferPtr.
+
+    outputBufferPtr - A pointer to storage for the processed samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void ComplexNlmsNoiseCanceller::acceptData(float *bufferPtr,
+                                           uint32_t bufferLength,
+                                           float *outputBufferPtr)
+{
+  uint32_t i;
+
+  // Filter the block of data provided by the caller.
+  for (i = 0; i < (2 * bufferLength); i += 2)
+  {
+    filterData(bufferPtr[i],bufferPtr[i+1],
+               &outputBufferPtr[i],&outputBufferPtr[i+1]);
+  } // for
+
+  return;
+
+} // acceptData
+
+/*****************************************************************************
+
+  Name: shiftSampleIntoPipeline
+
+  Purpose: The purpose of this function is to shift the next sample into
+  the filter state memory (the pipeline).  The structure of the
+  pipeline is the same as that of the NlmsNoiseCanceller class,
+
+  {x(n) x(n-1) x(n-2)...,x(n - N + 1)},
+
+  except that the real and imaginary parts are kept in separate arrays.
+
+  Calling Sequence: shiftSampleIntoPipeline(xI,xQ)
+
+  Inputs:
+
+    xI - The real part of the sample to shift into the pipeline.
+
+    xQ - The imaginary part of the sample to shift into the pipeline.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void ComplexNlmsNoiseCanceller::shiftSampleIntoPipeline(float xI,float xQ)
+{
+
+  // Make room for the new sample.
+  memmove(&filterStateIPtr[1],&filterStateIPtr[0],
+          (filterLength - 1) * sizeof(float));
+  memmove(&filterStateQPtr[1],&filterStateQPtr[0],
+          (filterLength - 1) * sizeof(float));
+
+  // Place the sample into the pipeline.
+  filterStateIPtr[0] = xI;
+  filterStateQPtr[0] = xQ;
+
+  return;
+
+} // shiftSampleIntoPipeline
+
+/*****************************************************************************
+
+  Name: dotProduct
+
+  Purpose: The purpose of this function is to compute the filter output,
+  y = w^H x, which is the sum of conj(w(k)) * x(k) over all taps, along
+  with the energy of the filter state, which is the sum of |x(k)|^2.
+  Both are computed in one pass over the taps.  When SSE is available,
+  four taps are processed at a time.
+
+  Calling Sequence: dotProduct(yIPtr,yQPtr,energyPtr)
+
+  Inputs:
+
+    yIPtr - A pointer to storage for the real part of the output.
+
+    yQPtr - A pointer to storage for the imaginary part of the output.
+
+    energyPtr - A pointer to storage for the energy of the filter state.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void ComplexNlmsNoiseCanceller::dotProduct(float *yIPtr,
+                                           float *yQPtr,
+                                           float *energyPtr)
+{
+  int i;
+  float yI, yQ, energy;
+  float *wI, *wQ, *xI, *xQ;
+
+  wI = coefficientsIPtr;
+  wQ = coefficientsQPtr;
+  xI = filterStateIPtr;
+  xQ = filterStateQPtr;
+
+  // Start out with zero sums.
+  yI = 0;
+  yQ = 0;
+  energy = 0;
+  i = 0;
+
+#ifdef __SSE__
+  __m128 wIv, wQv, xIv, xQv;
+  __m128 yIv, yQv, energyv;
+  float lanes[4];
+
+  yIv = _mm_setzero_ps();
+  yQv = _mm_setzero_ps();
+  energyv = _mm_setzero_ps();
+
+  for (; i <= (filterLength - 4); i += 4)
+  {
+    wIv = _mm_loadu_ps(&wI[i]);
+    wQv = _mm_loadu_ps(&wQ[i]);
+    xIv = _mm_loadu_ps(&xI[i]);
+    xQv = _mm_loadu_ps(&xQ[i]);
+
+    // Re{conj(w) * x} = wI*xI + wQ*xQ.
+    yIv = _mm_add_ps(yIv,_mm_add_ps(_mm_mul_ps(wIv,xIv),
+                                    _mm_mul_ps(wQv,xQv)));
+
+    // Im{conj(w) * x} = wI*xQ - wQ*xI.
+    yQv = _mm_add_ps(yQv,_mm_sub_ps(_mm_mul_ps(wIv,xQv),
+                                    _mm_mul_ps(wQv,xIv)));
+
+    // |x|^2 = xI*xI + xQ*xQ.
+    energyv = _mm_add_ps(energyv,_mm_add_ps(_mm_mul_ps(xIv,xIv),
+                                            _mm_mul_ps(xQv,xQv)));
+  } // for
+
+  // Reduce the lanes.
+  _mm_storeu_ps(lanes,yIv);
+  yI = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+  _mm_storeu_ps(lanes,yQv);
+  yQ = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+  _mm_storeu_ps(lanes,energyv);
+  energy = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+
+  // Process the remaining taps.
+  for (; i < filterLength; i++)
+  {
+    yI = yI + (wI[i] * xI[i]) + (wQ[i] * xQ[i]);
+    yQ = yQ + (wI[i] * xQ[i]) - (wQ[i] * xI[i]);
+    energy = energy + (xI[i] * xI[i]) + (xQ[i] * xQ[i]);
+  } // for
+
+  *yIPtr = yI;
+  *yQPtr = yQ;
+  *energyPtr = energy;
+
+  return;
+
+} // dotProduct
+
+/*****************************************************************************
+
+  Name: updateCoefficients
+
+  Purpose: The purpose of this function is to perform the complex NLMS
+  coefficient update, w(k) = w(k) + mu * x(k) * conj(e).  When SSE is
+  available, four taps are processed at a time.
+
+  Calling Sequence: updateCoefficients(mu,eI,eQ)
+
+  Inputs:
+
+    mu - The normalized step size, beta / energy.
+
+    eI - The real part of the error.
+
+    eQ - The imaginary part of the error.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void ComplexNlmsNoiseCanceller::updateCoefficients(float mu,float eI,float eQ)
+{
+  int i;
+  float *wI, *wQ, *xI, *xQ;
+  float muI, muQ;
+
+  wI = coefficientsIPtr;
+  wQ = coefficientsQPtr;
+  xI = filterStateIPtr;
+  xQ = filterStateQPtr;
+
+  // Fold the step size into the conjugated error.
+  muI = mu * eI;
+  muQ = mu * eQ;
+
+  i = 0;
+
+#ifdef __SSE__
+  __m128 muIv, muQv, xIv, xQv;
+
+  muIv = _mm_set1_ps(muI);
+  muQv = _mm_set1_ps(muQ);
+
+  for (; i <= (filterLength - 4); i += 4)
+  {
+    xIv = _mm_loadu_ps(&xI[i]);
+    xQv = _mm_loadu_ps(&xQ[i]);
+
+    // Re{x * conj(e)} = xI*eI + xQ*eQ.
+    _mm_storeu_ps(&wI[i],
+                  _mm_add_ps(_mm_loadu_ps(&wI[i]),
+                             _mm_add_ps(_mm_mul_ps(xIv,muIv),
+                                        _mm_mul_ps(xQv,muQv))));
+
+    // Im{x * conj(e)} = xQ*eI - xI*eQ.
+    _mm_storeu_ps(&wQ[i],
+                  _mm_add_ps(_mm_loadu_ps(&wQ[i]),
+                             _mm_sub_ps(_mm_mul_ps(xQv,muIv),
+                                        _mm_mul_ps(xIv,muQv))));
+  } // for
+#endif
+
+  // Process the remaining taps.
+  for (; i < filterLength; i++)
+  {
+    wI[i] = wI[i] + (xI[i] * muI) + (xQ[i] * muQ);
+    wQ[i] = wQ[i] + (xQ[i] * muI) - (xI[i] * muQ);
+  } // for
+
+  return;
+
+} // updateCoefficients
+
+/*****************************************************************************
+
+  Name: filterData
+
+  Purpose: The purpose of this function is to filter one complex sample
+  of data for the purpose of removing noise from a signal.  This works
+  in the same way as NlmsNoiseCanceller::filterData(), except that all
+  quantities are complex.  The reference signal, d(n) = x(n - n0), is
+  estimated by dHat(n) = w^H x(n), the error is e(n) = d(n) - dHat(n),
+  and the coefficients are updated by w = w + (beta / |x|^2) x conj(e).
+
+  Calling Sequence: filterData(xI,xQ,dHatIPtr,dHatQPtr)
+
+  Inputs:
+
+    xI - The real part of the data sample to filter.
+
+    xQ - The imaginary part of the data sample to filter.
+
+    dHatIPtr - A pointer to storage for the real part of the output.
+
+    dHatQPtr - A pointer to storage for the imaginary part of the output.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void ComplexNlmsNoiseCanceller::filterData(float xI,
+                                           float xQ,
+                                           float *dHatIPtr,
+                                           float *dHatQPtr)
+{
+  float dI, dQ;
+  float dHatI, dHatQ;
+  float den;
+
+  // Place the sample into the state memory.
+  shiftSampleIntoPipeline(xI,xQ);
+
+  // Compute reference sample.
+  dI = delayLineIPtr->filterData(xI);
+  dQ = delayLineQPtr->filterData(xQ);
+
+  // Compute noise-reduced sample and the normalizing denominator.
+  dotProduct(&dHatI,&dHatQ,&den);
+  den += 0.0001;
+
+  // Update the filter coefficients using the error.
+  updateCoefficients(beta / den,dI - dHatI,dQ - dHatQ);
+
+  *dHatIPtr = dHatI;
+  *dHatQPtr = dHatQ;
+
+  return;
+
+} // filterData
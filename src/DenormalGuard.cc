@@ -0,0 +1,102 @@
+//************************************************************************
+// file name: DenormalGuard.cc
+//************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+#include "DenormalGuard.h"
+
+using namespace std;
+
+#ifdef __SSE__
+// MXCSR bits for flush-to-zero and denormals-are-zero.
+#define MXCSR_FTZ (0x8000)
+#define MXCSR_DAZ (0x0040)
+#endif
+
+#ifdef __aarch64__
+// FPCR bit for flush-to-zero, which covers both inputs and outputs.
+#define FPCR_FZ (1 << 24)
+#endif
+
+/*****************************************************************************
+
+  Name: DenormalGuard
+
+  Purpose: The purpose of this function is to serve as the constructor for
+  an instance of a DenormalGuard.  If enabled, the floating point control
+  state is saved, and FTZ and DAZ are enabled.  On processors for which
+  no support is provided, the guard does nothing.
+
+  Calling Sequence: DenormalGuard(enable)
+
+  Inputs:
+
+    enable - A flag that indicates whether the guard should take effect.
+    A value of false makes the guard do nothing, which lets callers
+    create a guard unconditionally.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+DenormalGuard::DenormalGuard(bool enable)
+{
+
+  enabled = enable;
+  savedControlWord = 0;
+
+  if (enabled)
+  {
+#if defined(__SSE__)
+    savedControlWord = _mm_getcsr();
+    _mm_setcsr((unsigned int)savedControlWord | MXCSR_FTZ | MXCSR_DAZ);
+#elif defined(__aarch64__)
+    __asm__ __volatile__("mrs %0, fpcr" : "=r"(savedControlWord));
+    __asm__ __volatile__("msr fpcr, %0" : : "r"(savedControlWord | FPCR_FZ));
+#endif
+  } // if
+
+  return;
+
+} // DenormalGuard
+
+/*****************************************************************************
+
+  Name: ~DenormalGuard
+
+  Purpose: The purpose of this function is to serve as the destructor for
+  an instance of a DenormalGuard.  The saved floating point control
+  state is restored.
+
+  Calling Sequence: ~DenormalGuard()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+DenormalGuard::~DenormalGuard(void)
+{
+
+  if (enabled)
+  {
+#if defined(__SSE__)
+    _mm_setcsr((unsigned int)savedControlWord);
+#elif defined(__aarch64__)
+    __asm__ __volatile__("msr fpcr, %0" : : "r"(savedControlWord));
+#endif
+  } // if
+
+  return;
+
+} // ~DenormalGuard
@@ -22,7 +22,9 @@ using namespace std;
 
     filterLength - The number of taps for the filter.
 
-    coefficientPtr - A pointer to the filter coefficients.
+    coefficientPtr - A pointer to the filter coefficients.  A value of
+    NULL indicates that all coefficients are zero; they can be set
+    later with setCoefficient().
 
   Outputs:
 
@@ -32,30 +34,112 @@ using namespace std;
 FirFilter::FirFilter(int filterLength,
                      float *coefficientsPtr)
 {
-  int i;
 
-  // Save for later use.
-  this->filterLength = filterLength;
+  // Use the heap for storage.
+  initialize(filterLength,coefficientsPtr,NULL);
 
-  // Allocate storage for the coefficients.
-  coefficientStoragePtr = new float[filterLength];
+  return;
 
-  // Save the coefficients.
-  for (i = 0; i < filterLength; i++)
-  {
-    coefficientStoragePtr[i] = coefficientsPtr[i];
-  } // for
+} // FirFilter
 
-  // Allocate storage for the filter state.
-  filterStatePtr = new float[filterLength];
+/*****************************************************************************
 
-  // Set the filter state to an initial value.
-  resetFilterState();
+  Name: FirFilter
+
+  Purpose: The purpose of this function is to serve as the constructor for
+  an instance of an FirFilter whose storage is taken from an arena.
+
+  Calling Sequence: FirFilter(filterLength,coefficientsPtr,arenaPtr)
+
+  Inputs:
+
+    filterLength - The number of taps for the filter.
+
+    coefficientPtr - A pointer to the filter coefficients.  A value of
+    NULL indicates that all coefficients are zero.
+
+    arenaPtr - A pointer to the arena that provides the storage for the
+    coefficients and the filter state.  If it is NULL, or it does not
+    have getStorageRequirement() bytes left, the heap is used instead.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+FirFilter::FirFilter(int filterLength,
+                     float *coefficientsPtr,
+                     MemoryArena *arenaPtr)
+{
+
+  initialize(filterLength,coefficientsPtr,arenaPtr);
+
+  return;
+
+} // FirFilter
+
+/*****************************************************************************
+
+  Name: FirFilter
+
+  Purpose: The purpose of this function is to serve as the move
+  constructor for an instance of an FirFilter.  The storage of the other
+  instance is taken over without being copied, and the other instance
+  is left empty.
+
+  Calling Sequence: FirFilter(other)
+
+  Inputs:
+
+    other - The instance whose storage is taken.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+FirFilter::FirFilter(FirFilter &&other)
+{
+
+  takeStorage(other);
 
   return;
 
 } // FirFilter
 
+/*****************************************************************************
+
+  Name: operator=
+
+  Purpose: The purpose of this function is to serve as the move
+  assignment operator for an instance of an FirFilter.  The storage of
+  this instance is released, and the storage of the other instance is
+  taken over.
+
+  Calling Sequence: filter = std::move(other)
+
+  Inputs:
+
+    other - The instance whose storage is taken.
+
+  Outputs:
+
+    filter - A reference to this instance.
+
+*****************************************************************************/
+FirFilter &FirFilter::operator=(FirFilter &&other)
+{
+
+  if (this != &other)
+  {
+    releaseStorage();
+    takeStorage(other);
+  } // if
+
+  return (*this);
+
+} // operator=
+
 /*****************************************************************************
 
   Name: ~FirFilter
@@ -78,13 +162,319 @@ FirFilter::~FirFilter(void)
 {
 
   // Release resources.
-  delete[] coefficientStoragePtr;
-  delete[] filterStatePtr;
+  releaseStorage();
 
   return;
 
 } // ~FirFilter
 
+/*****************************************************************************
+
+  Name: takeStorage
+
+  Purpose: The purpose of this function is to take over the storage and
+  the state of another instance.  The other instance is left with no
+  storage, so that its destruction releases nothing.
+
+  Calling Sequence: takeStorage(other)
+
+  Inputs:
+
+    other - The instance whose storage is taken.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void FirFilter::takeStorage(FirFilter &other)
+{
+
+  filterLength = other.filterLength;
+  filterCapacity = other.filterCapacity;
+  coefficientStoragePtr = other.coefficientStoragePtr;
+  filterStatePtr = other.filterStatePtr;
+  ringBufferIndex = other.ringBufferIndex;
+  ownsStorage = other.ownsStorage;
+
+  // Leave the other instance empty.
+  other.filterLength = 0;
+  other.filterCapacity = 0;
+  other.coefficientStoragePtr = NULL;
+  other.filterStatePtr = NULL;
+  other.ringBufferIndex = 0;
+  other.ownsStorage = false;
+
+  return;
+
+} // takeStorage
+
+/*****************************************************************************
+
+  Name: releaseStorage
+
+  Purpose: The purpose of this function is to release the storage of
+  the instance if it was allocated from the heap.  Storage in an arena
+  belongs to the arena.
+
+  Calling Sequence: releaseStorage()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void FirFilter::releaseStorage(void)
+{
+
+  if (ownsStorage)
+  {
+    delete[] coefficientStoragePtr;
+    delete[] filterStatePtr;
+  } // if
+
+  coefficientStoragePtr = NULL;
+  filterStatePtr = NULL;
+  ownsStorage = false;
+
+  return;
+
+} // releaseStorage
+
+/*****************************************************************************
+
+  Name: reconfigure
+
+  Purpose: The purpose of this function is to change the length and the
+  coefficients of the filter without allocating memory.  The filter
+  state is reset.
+
+  Calling Sequence: success = reconfigure(filterLength,coefficientsPtr)
+
+  Inputs:
+
+    filterLength - The new number of taps for the filter.
+
+    coefficientPtr - A pointer to the filter coefficients.  A value of
+    NULL indicates that all coefficients are zero.
+
+  Outputs:
+
+    success - A flag that indicates whether the filter was reconfigured.
+    A value of false indicates that filterLength exceeds the capacity
+    of the storage, in which case the filter is unchanged.
+
+*****************************************************************************/
+bool FirFilter::reconfigure(int filterLength,float *coefficientsPtr)
+{
+  int i;
+
+  if ((filterLength < 1) || (filterLength > filterCapacity))
+  {
+    // It won't fit.
+    return (false);
+  } // if
+
+  this->filterLength = filterLength;
+
+  // Save the coefficients.
+  for (i = 0; i < filterLength; i++)
+  {
+    if (coefficientsPtr != NULL)
+    {
+      coefficientStoragePtr[i] = coefficientsPtr[i];
+    } // if
+    else
+    {
+      coefficientStoragePtr[i] = 0;
+    } // else
+  } // for
+
+  // Set the filter state to an initial value.
+  resetFilterState();
+
+  return (true);
+
+} // reconfigure
+
+/*****************************************************************************
+
+  Name: getCapacity
+
+  Purpose: The purpose of this function is to return the largest filter
+  length that reconfigure() can accept.
+
+  Calling Sequence: capacity = getCapacity()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    capacity - The number of taps that the storage can hold.
+
+*****************************************************************************/
+int FirFilter::getCapacity(void)
+{
+
+  return (filterCapacity);
+
+} // getCapacity
+
+/*****************************************************************************
+
+  Name: initialize
+
+  Purpose: The purpose of this function is to allocate the storage for
+  the coefficients and the filter state, and to set them to their
+  initial values.
+
+  Calling Sequence: initialize(filterLength,coefficientsPtr,arenaPtr)
+
+  Inputs:
+
+    filterLength - The number of taps for the filter.  A value less
+    than 1 is taken as 1.
+
+    coefficientPtr - A pointer to the filter coefficients, or NULL for
+    zero-valued coefficients.
+
+    arenaPtr - A pointer to the arena that provides the storage, or NULL
+    to use the heap.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void FirFilter::initialize(int filterLength,
+                           float *coefficientsPtr,
+                           MemoryArena *arenaPtr)
+{
+  int i;
+  size_t bytesNeeded;
+
+  // Guard against nonsensical values.
+  if (filterLength < 1)
+  {
+    filterLength = 1;
+  } // if
+
+  // Save for later use.
+  this->filterLength = filterLength;
+  filterCapacity = filterLength;
+
+  // Default to the heap.
+  ownsStorage = true;
+
+  if (arenaPtr != NULL)
+  {
+    bytesNeeded = getStorageRequirement(filterLength);
+
+    if ((arenaPtr->getCapacity() - arenaPtr->getBytesUsed()) >= bytesNeeded)
+    {
+      // The arena has room for everything.
+      ownsStorage = false;
+    } // if
+  } // if
+
+  if (ownsStorage)
+  {
+    // Allocate storage for the coefficients and the filter state.
+    coefficientStoragePtr = new float[filterLength];
+    filterStatePtr = new float[filterLength];
+  } // if
+  else
+  {
+    // Place the coefficients and the filter state in the arena.
+    coefficientStoragePtr = arenaPtr->allocateFloats(filterLength);
+    filterStatePtr = arenaPtr->allocateFloats(filterLength);
+  } // else
+
+  // Save the coefficients.
+  for (i = 0; i < filterLength; i++)
+  {
+    if (coefficientsPtr != NULL)
+    {
+      coefficientStoragePtr[i] = coefficientsPtr[i];
+    } // if
+    else
+    {
+      coefficientStoragePtr[i] = 0;
+    } // else
+  } // for
+
+  // Set the filter state to an initial value.
+  resetFilterState();
+
+  return;
+
+} // initialize
+
+/*****************************************************************************
+
+  Name: setCoefficient
+
+  Purpose: The purpose of this function is to set the value of one
+  filter coefficient.
+
+  Calling Sequence: setCoefficient(index,value)
+
+  Inputs:
+
+    index - The index of the coefficient.  Out of range values are
+    ignored.
+
+    value - The value of the coefficient.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void FirFilter::setCoefficient(int index,float value)
+{
+
+  if ((index >= 0) && (index < filterLength))
+  {
+    coefficientStoragePtr[index] = value;
+  } // if
+
+  return;
+
+} // setCoefficient
+
+/*****************************************************************************
+
+  Name: getStorageRequirement
+
+  Purpose: The purpose of this function is to compute the number of
+  bytes of arena storage that a filter needs for its coefficients and
+  its filter state.  The filter object itself is not included.
+
+  Calling Sequence: bytesNeeded = getStorageRequirement(filterLength)
+
+  Inputs:
+
+    filterLength - The number of taps for the filter.
+
+  Outputs:
+
+    bytesNeeded - The number of bytes of arena storage.
+
+*****************************************************************************/
+size_t FirFilter::getStorageRequirement(int filterLength)
+{
+
+  return (2 * MemoryArena::roundUp(filterLength * sizeof(float)));
+
+} // getStorageRequirement
+
 /*****************************************************************************
 
   Name: resetFilterState
@@ -122,6 +512,87 @@ void FirFilter::resetFilterState(void)
 
 } // resetFilterState
 
+/*****************************************************************************
+
+  Name: writeState
+
+  Purpose: The purpose of this function is to write the filter state to
+  a stream, so that it can be restored by readState().  The filter
+  length is written first, so that the state can be checked against the
+  filter that reads it.  The coefficients are not written.
+
+  Calling Sequence: success = writeState(streamPtr)
+
+  Inputs:
+
+    streamPtr - The stream.
+
+  Outputs:
+
+    success - A flag that indicates whether the state was written.
+
+*****************************************************************************/
+bool FirFilter::writeState(FILE *streamPtr)
+{
+  bool success;
+
+  success = (fwrite(&filterLength,sizeof(filterLength),1,streamPtr) == 1) &&
+    (fwrite(&ringBufferIndex,sizeof(ringBufferIndex),1,streamPtr) == 1) &&
+    (fwrite(filterStatePtr,sizeof(float),filterLength,streamPtr) ==
+     (size_t)filterLength);
+
+  return (success);
+
+} // writeState
+
+/*****************************************************************************
+
+  Name: readState
+
+  Purpose: The purpose of this function is to read the filter state that
+  was written by writeState().  The state is rejected if it was written
+  by a filter of another length.
+
+  Calling Sequence: success = readState(streamPtr)
+
+  Inputs:
+
+    streamPtr - The stream.
+
+  Outputs:
+
+    success - A flag that indicates whether the state was read.
+
+*****************************************************************************/
+bool FirFilter::readState(FILE *streamPtr)
+{
+  int length;
+  int index;
+
+  if ((fread(&length,sizeof(length),1,streamPtr) != 1) ||
+      (fread(&index,sizeof(index),1,streamPtr) != 1))
+  {
+    return (false);
+  } // if
+
+  if ((length != filterLength) || (index < 0) || (index >= filterLength))
+  {
+    // The state belongs to another filter.
+    return (false);
+  } // if
+
+  if (fread(filterStatePtr,sizeof(float),filterLength,streamPtr) !=
+      (size_t)filterLength)
+  {
+    return (false);
+  } // if
+
+  ringBufferIndex = index;
+
+  return (true);
+
+} // readState
+
 /*****************************************************************************
 
   Name: filterData
@@ -184,3 +655,73 @@ float FirFilter::filterData(float x)
 
 } // filterData
 
+
+/*****************************************************************************
+
+  Name: shiftData
+
+  Purpose: The purpose of this function is to shift one sample of data
+  into the filter state without computing an output.  A decimator uses
+  this for the samples whose outputs would be discarded, so that only
+  the outputs that are kept cost a convolution.
+
+  Calling Sequence: shiftData(x)
+
+  Inputs:
+
+    x - The data sample.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void FirFilter::shiftData(float x)
+{
+
+  // Store sample value.
+  filterStatePtr[ringBufferIndex] = x;
+
+  // Increment the index in a modulo fashion.
+  ringBufferIndex++;
+  if (ringBufferIndex == filterLength)
+  {
+    // Wrap the index.
+    ringBufferIndex = 0;
+  } // if
+
+  return;
+
+} // shiftData
+
+/*****************************************************************************
+
+  Name: delayData
+
+  Purpose: The purpose of this function is to use the filter as a pure
+  delay line.  The sample is shifted into the filter state, and the
+  sample that is filterLength - 1 samples older is returned without
+  computing a convolution.  For a filter whose only nonzero tap is the
+  last one, with a value of 1, this gives the same result as
+  filterData() at a fraction of the cost.
+
+  Calling Sequence: y = delayData(x)
+
+  Inputs:
+
+    x - The data sample.
+
+  Outputs:
+
+    y - The sample that was shifted in filterLength - 1 samples ago.
+
+*****************************************************************************/
+float FirFilter::delayData(float x)
+{
+
+  shiftData(x);
+
+  // The slot that will be written next holds the oldest sample.
+  return (filterStatePtr[ringBufferIndex]);
+
+} // delayData
@@ -0,0 +1,398 @@
+//************************************************************************
+// file name: LatencyHistogram.cc
+//************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "LatencyHistogram.h"
+
+using namespace std;
+
+/*****************************************************************************
+
+  Name: LatencyHistogram
+
+  Purpose: The purpose of this function is to serve as the constructor for
+  an instance of a LatencyHistogram.
+
+  Calling Sequence: LatencyHistogram()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+LatencyHistogram::LatencyHistogram(void)
+{
+
+  reset();
+
+  return;
+
+} // LatencyHistogram
+
+/*****************************************************************************
+
+  Name: ~LatencyHistogram
+
+  Purpose: The purpose of this function is to serve as the destructor for
+  an instance of a LatencyHistogram.
+
+  Calling Sequence: ~LatencyHistogram()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+LatencyHistogram::~LatencyHistogram(void)
+{
+
+  return;
+
+} // ~LatencyHistogram
+
+/*****************************************************************************
+
+  Name: reset
+
+  Purpose: The purpose of this function is to discard all of the
+  recorded intervals.
+
+  Calling Sequence: reset()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void LatencyHistogram::reset(void)
+{
+  int i;
+
+  for (i = 0; i < NUMBER_OF_BINS; i++)
+  {
+    bins[i] = 0;
+  } // for
+
+  count = 0;
+  minimum = UINT64_MAX;
+  maximum = 0;
+  total = 0;
+
+  return;
+
+} // reset
+
+/*****************************************************************************
+
+  Name: record
+
+  Purpose: The purpose of this function is to add an interval to the
+  histogram.
+
+  Calling Sequence: record(interval)
+
+  Inputs:
+
+    interval - The interval in nanoseconds.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void LatencyHistogram::record(uint64_t interval)
+{
+
+  bins[getBinIndex(interval)]++;
+
+  count++;
+  total += interval;
+
+  if (interval < minimum)
+  {
+    minimum = interval;
+  } // if
+
+  if (interval > maximum)
+  {
+    maximum = interval;
+  } // if
+
+  return;
+
+} // record
+
+/*****************************************************************************
+
+  Name: getCount
+
+  Purpose: The purpose of this function is to return the number of
+  intervals that have been recorded.
+
+  Calling Sequence: count = getCount()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    count - The number of intervals.
+
+*****************************************************************************/
+uint64_t LatencyHistogram::getCount(void)
+{
+
+  return (count);
+
+} // getCount
+
+/*****************************************************************************
+
+  Name: getMinimum
+
+  Purpose: The purpose of this function is to return the smallest
+  interval that has been recorded.
+
+  Calling Sequence: minimum = getMinimum()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    minimum - The smallest interval in nanoseconds, or 0 if nothing has
+    been recorded.
+
+*****************************************************************************/
+uint64_t LatencyHistogram::getMinimum(void)
+{
+
+  if (count == 0)
+  {
+    return (0);
+  } // if
+
+  return (minimum);
+
+} // getMinimum
+
+/*****************************************************************************
+
+  Name: getMaximum
+
+  Purpose: The purpose of this function is to return the largest
+  interval that has been recorded.
+
+  Calling Sequence: maximum = getMaximum()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    maximum - The largest interval in nanoseconds.
+
+*****************************************************************************/
+uint64_t LatencyHistogram::getMaximum(void)
+{
+
+  return (maximum);
+
+} // getMaximum
+
+/*****************************************************************************
+
+  Name: getMean
+
+  Purpose: The purpose of this function is to return the average of the
+  intervals that have been recorded.
+
+  Calling Sequence: mean = getMean()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    mean - The average interval in nanoseconds.
+
+*****************************************************************************/
+double LatencyHistogram::getMean(void)
+{
+
+  if (count == 0)
+  {
+    return (0);
+  } // if
+
+  return (total / count);
+
+} // getMean
+
+/*****************************************************************************
+
+  Name: getPercentile
+
+  Purpose: The purpose of this function is to return the interval that
+  a given percentage of the recorded intervals do not exceed.
+
+  Calling Sequence: interval = getPercentile(percentile)
+
+  Inputs:
+
+    percentile - The percentage, such as 50 or 99.9.
+
+  Outputs:
+
+    interval - The upper edge of the bin that contains the percentile,
+    in nanoseconds, limited to the largest recorded interval.
+
+*****************************************************************************/
+uint64_t LatencyHistogram::getPercentile(double percentile)
+{
+  int i;
+  uint64_t rank;
+  uint64_t cumulativeCount;
+  uint64_t interval;
+
+  if (count == 0)
+  {
+    return (0);
+  } // if
+
+  // The number of intervals that must be at or below the result.
+  rank = (uint64_t)ceil((percentile / 100) * count);
+
+  if (rank < 1)
+  {
+    rank = 1;
+  } // if
+
+  if (rank > count)
+  {
+    rank = count;
+  } // if
+
+  cumulativeCount = 0;
+  interval = maximum;
+
+  for (i = 0; i < NUMBER_OF_BINS; i++)
+  {
+    cumulativeCount += bins[i];
+
+    if (cumulativeCount >= rank)
+    {
+      interval = getBinUpperEdge(i);
+      break;
+    } // if
+  } // for
+
+  if (interval > maximum)
+  {
+    interval = maximum;
+  } // if
+
+  return (interval);
+
+} // getPercentile
+
+/*****************************************************************************
+
+  Name: getBinIndex
+
+  Purpose: The purpose of this function is to find the bin of an
+  interval.  Intervals below LINEAR_BINS map to themselves.  Above that,
+  the octave of the interval selects a group of BINS_PER_OCTAVE bins,
+  and the five bits below the leading one bit select the bin within the
+  group.
+
+  Calling Sequence: index = getBinIndex(interval)
+
+  Inputs:
+
+    interval - The interval in nanoseconds.
+
+  Outputs:
+
+    index - The index of the bin.
+
+*****************************************************************************/
+int LatencyHistogram::getBinIndex(uint64_t interval)
+{
+  int octave;
+  int shift;
+  int index;
+
+  if (interval < LINEAR_BINS)
+  {
+    return ((int)interval);
+  } // if
+
+  // The position of the leading one bit, which is at least 6.
+  octave = 63 - __builtin_clzll(interval);
+  shift = octave - 5;
+
+  index = LINEAR_BINS + ((octave - 6) * BINS_PER_OCTAVE) +
+          (int)((interval >> shift) - BINS_PER_OCTAVE);
+
+  return (index);
+
+} // getBinIndex
+
+/*****************************************************************************
+
+  Name: getBinUpperEdge
+
+  Purpose: The purpose of this function is to return the largest
+  interval that falls in a bin.
+
+  Calling Sequence: interval = getBinUpperEdge(index)
+
+  Inputs:
+
+    index - The index of the bin.
+
+  Outputs:
+
+    interval - The upper edge of the bin in nanoseconds.
+
+*****************************************************************************/
+uint64_t LatencyHistogram::getBinUpperEdge(int index)
+{
+  int octave;
+  int shift;
+  uint64_t lowerEdge;
+
+  if (index < LINEAR_BINS)
+  {
+    return ((uint64_t)index);
+  } // if
+
+  octave = 6 + ((index - LINEAR_BINS) / BINS_PER_OCTAVE);
+  shift = octave - 5;
+
+  lowerEdge = (uint64_t)(BINS_PER_OCTAVE +
+                         ((index - LINEAR_BINS) % BINS_PER_OCTAVE)) << shift;
+
+  return (lowerEdge + ((uint64_t)1 << shift) - 1);
+
+} // getBinUpperEdge
@@ -0,0 +1,280 @@
+//************************************************************************
+// file name: MemoryArena.cc
+//************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "MemoryArena.h"
+
+using namespace std;
+
+/*****************************************************************************
+
+  Name: MemoryArena
+
+  Purpose: The purpose of this function is to serve as the constructor for
+  an instance of a MemoryArena.  The block of memory is allocated on a
+  cache line boundary.
+
+  Calling Sequence: MemoryArena(capacity)
+
+  Inputs:
+
+    capacity - The number of bytes that can be allocated from the arena.
+    It is rounded up to a multiple of the alignment.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+MemoryArena::MemoryArena(size_t capacity)
+{
+  void *bufferPtr;
+
+  // Keep the end of the block on a cache line boundary too.
+  this->capacity = roundUp(capacity);
+
+  // Start at the beginning of the block.
+  offset = 0;
+
+  if (posix_memalign(&bufferPtr,ALIGNMENT,this->capacity) != 0)
+  {
+    // Indicate that nothing can be allocated.
+    bufferPtr = NULL;
+    this->capacity = 0;
+  } // if
+
+  storagePtr = (uint8_t *)bufferPtr;
+
+  return;
+
+} // MemoryArena
+
+/*****************************************************************************
+
+  Name: ~MemoryArena
+
+  Purpose: The purpose of this function is to serve as the destructor for
+  an instance of a MemoryArena.  All memory that was allocated from the
+  arena is released.
+
+  Calling Sequence: ~MemoryArena()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+MemoryArena::~MemoryArena(void)
+{
+
+  // Release resources.
+  free(storagePtr);
+
+  return;
+
+} // ~MemoryArena
+
+/*****************************************************************************
+
+  Name: allocate
+
+  Purpose: The purpose of this function is to allocate a zero-filled
+  buffer from the arena.  The buffer starts on a cache line boundary.
+
+  Calling Sequence: bufferPtr = allocate(size)
+
+  Inputs:
+
+    size - The size of the buffer in bytes.
+
+  Outputs:
+
+    bufferPtr - A pointer to the buffer, or NULL if the arena does not
+    have enough room left.
+
+*****************************************************************************/
+void *MemoryArena::allocate(size_t size)
+{
+  uint8_t *bufferPtr;
+
+  // Every buffer occupies whole cache lines.
+  size = roundUp(size);
+
+  if ((size > capacity) || (offset > (capacity - size)))
+  {
+    // Not enough room.
+    return (NULL);
+  } // if
+
+  bufferPtr = storagePtr + offset;
+  offset += size;
+
+  // Callers expect cleared storage, just like a fresh filter state.
+  memset(bufferPtr,0,size);
+
+  return (bufferPtr);
+
+} // allocate
+
+/*****************************************************************************
+
+  Name: allocateFloats
+
+  Purpose: The purpose of this function is to allocate a zero-filled
+  array of floats from the arena.
+
+  Calling Sequence: arrayPtr = allocateFloats(count)
+
+  Inputs:
+
+    count - The number of floats.
+
+  Outputs:
+
+    arrayPtr - A pointer to the array, or NULL if the arena does not
+    have enough room left.
+
+*****************************************************************************/
+float *MemoryArena::allocateFloats(int count)
+{
+
+  return ((float *)allocate(count * sizeof(float)));
+
+} // allocateFloats
+
+/*****************************************************************************
+
+  Name: reset
+
+  Purpose: The purpose of this function is to release all allocations at
+  once, so that the arena can be reused.  Any objects that were using
+  the storage must no longer be in use.
+
+  Calling Sequence: reset()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void MemoryArena::reset(void)
+{
+
+  offset = 0;
+
+  return;
+
+} // reset
+
+/*****************************************************************************
+
+  Name: isValid
+
+  Purpose: The purpose of this function is to indicate whether the block
+  of memory of the arena was successfully allocated.
+
+  Calling Sequence: valid = isValid()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    valid - A flag that indicates whether the arena is usable.
+
+*****************************************************************************/
+bool MemoryArena::isValid(void)
+{
+
+  return (storagePtr != NULL);
+
+} // isValid
+
+/*****************************************************************************
+
+  Name: getCapacity
+
+  Purpose: The purpose of this function is to return the size of the
+  block of memory of the arena.
+
+  Calling Sequence: capacity = getCapacity()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    capacity - The size of the block in bytes.
+
+*****************************************************************************/
+size_t MemoryArena::getCapacity(void)
+{
+
+  return (capacity);
+
+} // getCapacity
+
+/*****************************************************************************
+
+  Name: getBytesUsed
+
+  Purpose: The purpose of this function is to return the number of bytes
+  that have been allocated from the arena, including the padding that
+  keeps each allocation aligned.
+
+  Calling Sequence: bytesUsed = getBytesUsed()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    bytesUsed - The number of bytes that have been allocated.
+
+*****************************************************************************/
+size_t MemoryArena::getBytesUsed(void)
+{
+
+  return (offset);
+
+} // getBytesUsed
+
+/*****************************************************************************
+
+  Name: roundUp
+
+  Purpose: The purpose of this function is to round a size up to a
+  multiple of the alignment.  Callers use this to compute how much
+  arena storage their buffers need.
+
+  Calling Sequence: roundedSize = roundUp(size)
+
+  Inputs:
+
+    size - The size in bytes.
+
+  Outputs:
+
+    roundedSize - The size rounded up to a multiple of ALIGNMENT.
+
+*****************************************************************************/
+size_t MemoryArena::roundUp(size_t size)
+{
+
+  return ((size + ALIGNMENT - 1) & ~(ALIGNMENT - 1));
+
+} // roundUp
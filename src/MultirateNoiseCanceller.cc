@@ -0,0 +1,602 @@
+//************************************************************************
+// file name: MultirateNoiseCanceller.cc
+//************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "MultirateNoiseCanceller.h"
+#include "SampleConverter.h"
+
+using namespace std;
+
+/*****************************************************************************
+
+  Name: MultirateNoiseCanceller
+
+  Purpose: The purpose of this function is to serve as the constructor for
+  an instance of a MultirateNoiseCanceller.
+
+  Calling Sequence: MultirateNoiseCanceller(decimationFactor,filterLength,
+                                            referenceDelay,beta)
+
+  Inputs:
+
+    decimationFactor - The ratio of the input sample rate to the rate
+    at which the canceller runs.  A value of 1 runs the canceller at
+    the input rate with no filtering.
+
+    filterLength - The number of taps of the canceller at the reduced
+    rate.
+
+    referenceDelay - The reference delay of the canceller, in samples
+    at the reduced rate.
+
+    beta - The normalized step-size of the canceller.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+MultirateNoiseCanceller::MultirateNoiseCanceller(int decimationFactor,
+                                                 int filterLength,
+                                                 int referenceDelay,
+                                                 float beta)
+{
+  int i;
+  int p;
+  float *lowpassPtr;
+  float *branchPtr;
+
+  if (decimationFactor < 1)
+  {
+    decimationFactor = 1;
+  } // if
+
+  // Save for later use.
+  this->decimationFactor = decimationFactor;
+  this->referenceDelay = referenceDelay;
+
+  // The canceller runs at the reduced rate.
+  cancellerPtr = new NlmsNoiseCanceller(filterLength,referenceDelay,beta);
+
+  // Start at the beginning of a group of input samples.
+  phase = 0;
+
+  decimatorPtr = NULL;
+  interpolatorPtrs = NULL;
+  pendingOutputPtr = NULL;
+  lowpassLength = 0;
+
+  if (decimationFactor > 1)
+  {
+    // Use an odd length so that the delay is a whole number of samples.
+    lowpassLength = (TAPS_PER_PHASE * decimationFactor) - 1;
+
+    // Leave room for one zero tap so that the branches are equal.
+    lowpassPtr = new float[TAPS_PER_PHASE * decimationFactor];
+    branchPtr = new float[TAPS_PER_PHASE];
+
+    designLowpassFilter(lowpassPtr,lowpassLength);
+    lowpassPtr[lowpassLength] = 0;
+
+    // Instantiate the anti-alias filter.
+    decimatorPtr = new FirFilter(lowpassLength,lowpassPtr);
+
+    // Branch p produces output phase p from taps p, p + M, p + 2M, ...
+    // The gain of M makes up for the zeros that upsampling inserts.
+    interpolatorPtrs = new FirFilter *[decimationFactor];
+
+    for (p = 0; p < decimationFactor; p++)
+    {
+      for (i = 0; i < TAPS_PER_PHASE; i++)
+      {
+        branchPtr[i] = decimationFactor *
+                       lowpassPtr[p + (i * decimationFactor)];
+      } // for
+
+      interpolatorPtrs[p] = new FirFilter(TAPS_PER_PHASE,branchPtr);
+    } // for
+
+    // We're done with these.
+    delete[] lowpassPtr;
+    delete[] branchPtr;
+
+    // Nothing has been interpolated yet.
+    pendingOutputPtr = new float[decimationFactor];
+
+    for (p = 0; p < decimationFactor; p++)
+    {
+      pendingOutputPtr[p] = 0;
+    } // for
+  } // if
+
+  return;
+
+} // MultirateNoiseCanceller
+
+/*****************************************************************************
+
+  Name: ~MultirateNoiseCanceller
+
+  Purpose: The purpose of this function is to serve as the destructor for
+  an instance of a MultirateNoiseCanceller.
+
+  Calling Sequence: ~MultirateNoiseCanceller()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+MultirateNoiseCanceller::~MultirateNoiseCanceller(void)
+{
+  int p;
+
+  // Release resources.
+  delete cancellerPtr;
+
+  if (decimatorPtr != NULL)
+  {
+    delete decimatorPtr;
+
+    for (p = 0; p < decimationFactor; p++)
+    {
+      delete interpolatorPtrs[p];
+    } // for
+
+    delete[] interpolatorPtrs;
+    delete[] pendingOutputPtr;
+  } // if
+
+  return;
+
+} // ~MultirateNoiseCanceller
+
+/*****************************************************************************
+
+  Name: designLowpassFilter
+
+  Purpose: The purpose of this function is to design the lowpass filter
+  that is shared by the decimator and the interpolator.  A sinc function
+  with a cutoff at the Nyquist frequency of the reduced rate is shaped
+  by a Blackman window, and the coefficients are scaled for unity gain
+  at DC.
+
+  Calling Sequence: designLowpassFilter(coefficientsPtr,length)
+
+  Inputs:
+
+    coefficientsPtr - A pointer to storage for the coefficients.
+
+    length - The number of coefficients.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void MultirateNoiseCanceller::designLowpassFilter(float *coefficientsPtr,
+                                                  int length)
+{
+  int n;
+  double cutoff;
+  double t;
+  double window;
+  double sum;
+  double *hPtr;
+
+  hPtr = new double[length];
+
+  // The cutoff in cycles per input sample.
+  cutoff = 0.5 / decimationFactor;
+
+  sum = 0;
+
+  for (n = 0; n < length; n++)
+  {
+    // Time relative to the center of the filter.
+    t = n - ((length - 1) / 2.0);
+
+    if (t == 0)
+    {
+      hPtr[n] = 2 * cutoff;
+    } // if
+    else
+    {
+      hPtr[n] = sin(2 * M_PI * cutoff * t) / (M_PI * t);
+    } // else
+
+    window = 0.42 - (0.5 * cos((2 * M_PI * n) / (length - 1))) +
+             (0.08 * cos((4 * M_PI * n) / (length - 1)));
+
+    hPtr[n] *= window;
+    sum += hPtr[n];
+  } // for
+
+  // Normalize for unity gain at DC.
+  for (n = 0; n < length; n++)
+  {
+    coefficientsPtr[n] = (float)(hPtr[n] / sum);
+  } // for
+
+  delete[] hPtr;
+
+  return;
+
+} // designLowpassFilter
+
+/*****************************************************************************
+
+  Name: getDecimationFactor
+
+  Purpose: The purpose of this function is to return the ratio of the
+  input sample rate to the rate at which the canceller runs.
+
+  Calling Sequence: decimationFactor = getDecimationFactor()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    decimationFactor - The decimation factor.
+
+*****************************************************************************/
+int MultirateNoiseCanceller::getDecimationFactor(void)
+{
+
+  return (decimationFactor);
+
+} // getDecimationFactor
+
+/*****************************************************************************
+
+  Name: getLatency
+
+  Purpose: The purpose of this function is to return the delay, in input
+  samples, between a component of the input and the same component at
+  the output.  The decimator and the interpolator each contribute half
+  of the length of the lowpass filter, and the canceller contributes
+  its reference delay (its output is an estimate of the delayed input)
+  at the reduced rate.
+
+  Calling Sequence: latency = getLatency()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    latency - The latency in samples at the input rate.
+
+*****************************************************************************/
+int MultirateNoiseCanceller::getLatency(void)
+{
+  int latency;
+
+  // The canceller's own delay.
+  latency = referenceDelay * decimationFactor;
+
+  if (decimationFactor > 1)
+  {
+    // Add the delays of the decimator and the interpolator.
+    latency += lowpassLength - 1;
+  } // if
+
+  return (latency);
+
+} // getLatency
+
+/*****************************************************************************
+
+  Name: getCanceller
+
+  Purpose: The purpose of this function is to provide access to the
+  canceller that runs at the reduced rate, so that its modes (such as
+  the accumulation mode or the variable step-size policy) can be set.
+
+  Calling Sequence: cancellerPtr = getCanceller()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    cancellerPtr - A pointer to the canceller.
+
+*****************************************************************************/
+NlmsNoiseCanceller *MultirateNoiseCanceller::getCanceller(void)
+{
+
+  return (cancellerPtr);
+
+} // getCanceller
+
+/*****************************************************************************
+
+  Name: acceptData
+
+  Purpose: The purpose of this function is to present input samples to
+  be filtered and produce output samples to the calling function.
+
+  Calling Sequence: acceptData(bufferPtr,bufferLength,outputBufferPtr)
+
+  Inputs:
+
+    bufferPtr - A pointer to storage that provides the input samples.
+
+    bufferLength - The nmber of samples referenced by bufferPtr.  This
+    will also be the number of samples stored into memory referenced
+    by outputBufferPtr.
+
+    outputBufferPtr - A pointer to storage for the processed samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void MultirateNoiseCanceller::acceptData(int16_t *bufferPtr,
+                                         uint32_t bufferLength,
+                                         int16_t *outputBufferPtr)
+{
+
+  // Filter the block of data provided by the caller.
+  SampleConverter::filterInt16(filterBlock,
+                               this,
+                               bufferPtr,
+                               bufferLength,
+                               1,
+                               outputBufferPtr);
+
+  return;
+
+} // acceptData
+
+/*****************************************************************************
+
+  Name: filterBlock
+
+  Purpose: The purpose of this function is to pass a scratch block of
+  the 16-bit acceptData() to the float acceptData().
+
+  Calling Sequence: filterBlock(contextPtr,
+                                bufferPtr,
+                                bufferLength,
+                                outputBufferPtr)
+
+  Inputs:
+
+    contextPtr - A pointer to the canceller.
+
+    bufferPtr - A pointer to storage that provides the input samples.
+
+    bufferLength - The number of samples referenced by bufferPtr.
+
+    outputBufferPtr - A pointer to storage for the processed samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void MultirateNoiseCanceller::filterBlock(void *contextPtr,
+                                          float *bufferPtr,
+                                          uint32_t bufferLength,
+                                          float *outputBufferPtr)
+{
+  MultirateNoiseCanceller *thisPtr;
+
+  thisPtr = (MultirateNoiseCanceller *)contextPtr;
+
+  thisPtr->acceptData(bufferPtr,bufferLength,outputBufferPtr);
+
+  return;
+
+} // filterBlock
+
+/*****************************************************************************
+
+  Name: acceptData
+
+  Purpose: The purpose of this function is to present input samples to
+  be filtered and produce output samples to the calling function.  The
+  samples are taken in blocks: each block is decimated into scratch
+  storage, the canceller runs once over the decimated block, and the
+  output of the block is interpolated from the result.
+
+  Calling Sequence: acceptData(bufferPtr,bufferLength,outputBufferPtr)
+
+  Inputs:
+
+    bufferPtr - A pointer to storage that provides the input samples.
+
+    bufferLength - The nmber of samples referenced by bufferPtr.  This
+    will also be the number of samples stored into memory referenced
+    by outputBufferPtr.
+
+    outputBufferPtr - A pointer to storage for the processed samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void MultirateNoiseCanceller::acceptData(float *bufferPtr,
+                                         uint32_t bufferLength,
+                                         float *outputBufferPtr)
+{
+  uint32_t i;
+  uint32_t count;
+  uint32_t decimatedCount;
+  alignas(SampleConverter::ALIGNMENT)
+    float decimatedBlock[SampleConverter::SCRATCH_BLOCK_SIZE];
+
+  if (decimationFactor == 1)
+  {
+    // There's nothing to resample.
+    cancellerPtr->acceptData(bufferPtr,bufferLength,outputBufferPtr);
+    return;
+  } // if
+
+  i = 0;
+
+  // Filter the block of data provided by the caller.
+  while (i < bufferLength)
+  {
+    count = bufferLength - i;
+
+    if (count > SampleConverter::SCRATCH_BLOCK_SIZE)
+    {
+      count = SampleConverter::SCRATCH_BLOCK_SIZE;
+    } // if
+
+    decimatedCount = decimateBlock(&bufferPtr[i],count,decimatedBlock);
+
+    // Remove the noise of all of the decimated samples at once.
+    cancellerPtr->acceptData(decimatedBlock,decimatedCount,decimatedBlock);
+
+    interpolateBlock(decimatedBlock,count,&outputBufferPtr[i]);
+
+    i += count;
+  } // while
+
+  return;
+
+} // acceptData
+
+/*****************************************************************************
+
+  Name: decimateBlock
+
+  Purpose: The purpose of this function is to pass a block of input
+  samples through the anti-alias filter and to compute a decimated
+  sample for every Mth input sample.  The other outputs of the filter
+  would be discarded, so their samples are only shifted in.  The phase
+  is not advanced, since interpolateBlock() follows the same samples.
+
+  Calling Sequence: decimatedCount = decimateBlock(bufferPtr,
+                                                   bufferLength,
+                                                   decimatedPtr)
+
+  Inputs:
+
+    bufferPtr - A pointer to the input samples.
+
+    bufferLength - The number of input samples.
+
+    decimatedPtr - A pointer to storage for the decimated samples.  It
+    must have room for bufferLength samples.
+
+  Outputs:
+
+    decimatedCount - The number of decimated samples.
+
+*****************************************************************************/
+uint32_t MultirateNoiseCanceller::decimateBlock(float *bufferPtr,
+                                                uint32_t bufferLength,
+                                                float *decimatedPtr)
+{
+  uint32_t i;
+  uint32_t decimatedCount;
+  int groupPhase;
+
+  decimatedCount = 0;
+  groupPhase = phase;
+
+  for (i = 0; i < bufferLength; i++)
+  {
+    if (groupPhase < (decimationFactor - 1))
+    {
+      // This output of the anti-alias filter would be discarded.
+      decimatorPtr->shiftData(bufferPtr[i]);
+    } // if
+    else
+    {
+      decimatedPtr[decimatedCount] = decimatorPtr->filterData(bufferPtr[i]);
+      decimatedCount++;
+    } // else
+
+    // Advance to the next input sample of the group.
+    groupPhase++;
+    if (groupPhase == decimationFactor)
+    {
+      groupPhase = 0;
+    } // if
+  } // for
+
+  return (decimatedCount);
+
+} // decimateBlock
+
+/*****************************************************************************
+
+  Name: interpolateBlock
+
+  Purpose: The purpose of this function is to produce a block of output
+  samples from the processed decimated samples.  At the end of each
+  group of M input samples, the M polyphase branches compute the next M
+  output samples from a processed sample.  One pending output sample
+  is produced per input sample.
+
+  Calling Sequence: interpolateBlock(processedPtr,
+                                     bufferLength,
+                                     outputBufferPtr)
+
+  Inputs:
+
+    processedPtr - A pointer to the processed decimated samples, as
+    many as decimateBlock() produced for the same input samples.
+
+    bufferLength - The number of input samples.
+
+    outputBufferPtr - A pointer to storage for the output samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void MultirateNoiseCanceller::interpolateBlock(float *processedPtr,
+                                               uint32_t bufferLength,
+                                               float *outputBufferPtr)
+{
+  uint32_t i;
+  int p;
+
+  for (i = 0; i < bufferLength; i++)
+  {
+    if (phase == (decimationFactor - 1))
+    {
+      // Interpolate the next group of output samples.
+      for (p = 0; p < decimationFactor; p++)
+      {
+        pendingOutputPtr[p] = interpolatorPtrs[p]->filterData(*processedPtr);
+      } // for
+
+      processedPtr++;
+    } // if
+
+    // Advance to the next input sample of the group.
+    phase++;
+    if (phase == decimationFactor)
+    {
+      phase = 0;
+    } // if
+
+    // The output trails the group that was interpolated most recently.
+    outputBufferPtr[i] = pendingOutputPtr[phase];
+  } // for
+
+  return;
+
+} // interpolateBlock
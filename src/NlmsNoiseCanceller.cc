@@ -4,8 +4,17 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <math.h>
+#include <string.h>
+#include <new>
+
+#ifdef __F16C__
+#include <immintrin.h>
+#endif
 
 #include "NlmsNoiseCanceller.h"
+#include "DenormalGuard.h"
+#include "SampleConverter.h"
 
 using namespace std;
 
@@ -14,15 +23,19 @@ using namespace std;
   Name: NlmsNoiseCanceller
 
   Purpose: The purpose of this function is to serve as the constructor for
-  an instance of an NlmsNoiseCanceller.
+  an instance of an NlmsNoiseCanceller.  The instance creates a private
+  arena for its storage.
 
-  Calling Sequence: NlmsNoiseCanceller(filterLength,coefficientsPtr)
+  Calling Sequence: NlmsNoiseCanceller(filterLength,referenceDelay,beta)
 
   Inputs:
 
     filterLength - The number of taps for the filter.
 
-    coefficientPtr - A pointer to the filter coefficients.
+    referenceDelay - The number of samples to delay the input data
+    so that the reference signal can be formed.
+
+    beta - The normalized step-size of the update equation.
 
   Outputs:
 
@@ -33,46 +46,117 @@ NlmsNoiseCanceller::NlmsNoiseCanceller(int filterLength,
                                        int referenceDelay,
                                        float beta)
 {
-  int i;
-  float *delayLineCoefficientsPtr;
 
-  // Save for later use.
-  this->filterLength = filterLength;
+  initialize(filterLength,referenceDelay,beta,NULL);
 
-  // Allocate storage for the coefficients.
-  coefficientStoragePtr = new float[filterLength];
+  return;
 
-  // Start with zero-valued coefficients.
-  for (i = 0; i < filterLength; i++)
-  {
-    coefficientStoragePtr[i] = 0;
-  } // for
+} // NlmsNoiseCanceller
 
-  // Allocate storage for the filter state.
-  filterStatePtr = new float[filterLength];
+/*****************************************************************************
 
-  // Save this for display purposes.
-  this->referenceDelay = referenceDelay;
+  Name: NlmsNoiseCanceller
+
+  Purpose: The purpose of this function is to serve as the constructor for
+  an instance of an NlmsNoiseCanceller whose storage is taken from an
+  arena that is supplied by the caller.  The arena must outlive the
+  instance.
 
-  // Allocate delay line storage.
-  delayLineCoefficientsPtr = new float[referenceDelay + 1];
+  Calling Sequence: NlmsNoiseCanceller(filterLength,referenceDelay,beta,
+                                       arenaPtr)
 
-  // Set delay line coefficient.
-  delayLineCoefficientsPtr[referenceDelay] = 1;
+  Inputs:
 
-  // Instantiate delay line.
-  delayLinePtr = new FirFilter(referenceDelay+1,delayLineCoefficientsPtr);
+    filterLength - The number of taps for the filter.
 
-  // We're done with this.
-  delete[] delayLineCoefficientsPtr;
+    referenceDelay - The number of samples to delay the input data
+    so that the reference signal can be formed.
 
-  // We'll use this for the update equation.
-  this->beta = beta;
+    beta - The normalized step-size of the update equation.
+
+    arenaPtr - A pointer to the arena.  If it is NULL, or it does not
+    have getStorageRequirement() bytes left, a private arena is created.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+NlmsNoiseCanceller::NlmsNoiseCanceller(int filterLength,
+                                       int referenceDelay,
+                                       float beta,
+                                       MemoryArena *arenaPtr)
+{
+
+  initialize(filterLength,referenceDelay,beta,arenaPtr);
+
+  return;
+
+} // NlmsNoiseCanceller
+
+/*****************************************************************************
+
+  Name: NlmsNoiseCanceller
+
+  Purpose: The purpose of this function is to serve as the move
+  constructor for an instance of an NlmsNoiseCanceller.  The storage and
+  the adaptive state of the other instance are taken over without being
+  copied, and the other instance is left empty.  An empty instance may
+  only be destroyed or assigned to.
+
+  Calling Sequence: NlmsNoiseCanceller(other)
+
+  Inputs:
+
+    other - The instance whose storage is taken.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+NlmsNoiseCanceller::NlmsNoiseCanceller(NlmsNoiseCanceller &&other)
+{
+
+  takeStorage(other);
 
   return;
 
 } // NlmsNoiseCanceller
 
+/*****************************************************************************
+
+  Name: operator=
+
+  Purpose: The purpose of this function is to serve as the move
+  assignment operator for an instance of an NlmsNoiseCanceller.  The
+  storage of this instance is released, and the storage of the other
+  instance is taken over.
+
+  Calling Sequence: canceller = std::move(other)
+
+  Inputs:
+
+    other - The instance whose storage is taken.
+
+  Outputs:
+
+    canceller - A reference to this instance.
+
+*****************************************************************************/
+NlmsNoiseCanceller &NlmsNoiseCanceller::operator=(NlmsNoiseCanceller &&other)
+{
+
+  if (this != &other)
+  {
+    releaseStorage();
+    takeStorage(other);
+  } // if
+
+  return (*this);
+
+} // operator=
+
 /*****************************************************************************
 
   Name: ~NlmsNoiseCanceller
@@ -95,9 +179,7 @@ NlmsNoiseCanceller::~NlmsNoiseCanceller(void)
 {
 
   // Release resources.
-  delete[] coefficientStoragePtr;
-  delete[] filterStatePtr;
-  delete delayLinePtr;
+  releaseStorage();
 
   return;
 
@@ -105,223 +187,3757 @@ NlmsNoiseCanceller::~NlmsNoiseCanceller(void)
 
 /*****************************************************************************
 
-  Name: acceptData
+  Name: initialize
 
-  Purpose: The purpose of this function is to present input samples to
-  be filtered and produce output samples to the calling function.
+  Purpose: The purpose of this function is to set the initial values of
+  the attributes, to allocate the storage of the instance, and to
+  configure the filter.
 
-  Calling Sequence: acceptData(bufferPtr,bufferLength,outputBufferPtr)
+  Calling Sequence: initialize(filterLength,referenceDelay,beta,arenaPtr)
 
   Inputs:
 
-    bufferPtr - A pointer to storage that provides the input samples.
+    filterLength - The number of taps for the filter.  A value less
+    than 1 is taken as 1.
 
-    bufferLength - The nmber of samples referenced by bufferPtr.  This
-    will also be the number of samples stored into memory referenced
-    by outputBufferPtr.
+    referenceDelay - The number of samples to delay the input data
+    so that the reference signal can be formed.  A negative value is
+    taken as 0.
 
-    outputBufferPtr - A pointer to storage for the processed samples.
+    beta - The normalized step-size of the update equation.
+
+    arenaPtr - A pointer to the arena, or NULL to create a private one.
 
   Outputs:
 
     None.
 
 *****************************************************************************/
-void NlmsNoiseCanceller::acceptData(int16_t *bufferPtr,
-                                    uint32_t bufferLength,
-                                    int16_t *outputBufferPtr)
+void NlmsNoiseCanceller::initialize(int filterLength,
+                                    int referenceDelay,
+                                    float beta,
+                                    MemoryArena *arenaPtr)
 {
-  int i;
 
-  // Filter the block of data provided by the caller.
-  for (i = 0; i < bufferLength; i++)
+  // Default to plain float accumulation.
+  accumulationMode = ACCUMULATE_FLOAT;
+
+  // Default to no denormal protection and no dither.
+  denormalProtection = false;
+  ditherLevel = 0;
+  ditherState = 1;
+
+  // Default to the NLMS update with no active-tap mask.
+  proportionateUpdate = false;
+  alpha = 0;
+  activeTapThreshold = 0;
+  maskCounter = 0;
+  probeCounter = 0;
+
+  // Default to a fixed step size.
+  variableStepSize = false;
+  betaMin = 0;
+
+  // Default to always adapting.
+  frozen = false;
+  automaticFreeze = false;
+  freezeTolerance = 0;
+
+  // There is no storage yet.
+  filterCapacity = 0;
+  delayCapacity = 0;
+  coefficientStoragePtr = NULL;
+  filterStatePtr = NULL;
+  delayLinePtr = NULL;
+  compensationPtr = NULL;
+  compensationOnHeap = false;
+  segmentNormPtr = NULL;
+  segmentActivePtr = NULL;
+  segmentsOnHeap = false;
+  frozenHistoryPtr = NULL;
+  frozenHistoryOnHeap = false;
+  this->arenaPtr = NULL;
+  privateArenaPtr = NULL;
+
+  // Default to separate arrays of float taps.
+  tapLayout = TAPS_SEPARATE;
+  weightFormat = WEIGHTS_FLOAT32;
+  tapGroupPtr = NULL;
+  tapGroupsOnHeap = false;
+
+  // Guard against nonsensical values.
+  if (filterLength < 1)
   {
-    outputBufferPtr[i] = (int16_t)filterData((float)bufferPtr[i]);
-  } // for
+    filterLength = 1;
+  } // if
+
+  if (referenceDelay < 0)
+  {
+    referenceDelay = 0;
+  } // if
+
+  allocateStorage(filterLength,referenceDelay,arenaPtr);
+
+  reconfigure(filterLength,referenceDelay,beta);
 
   return;
 
-} // acceptData
+} // initialize
 
 /*****************************************************************************
 
-  Name: acceptData
+  Name: allocateStorage
 
-  Purpose: The purpose of this function is to present input samples to
-  be filtered and produce output samples to the calling function.
+  Purpose: The purpose of this function is to allocate the storage of
+  the instance from an arena.  The storage is laid out as the
+  coefficients, the filter state, the delay line object, and the delay
+  line storage, each of which starts on a cache line boundary.  Any
+  prior storage must already have been released.
 
-  Calling Sequence: acceptData(bufferPtr,bufferLength,outputBufferPtr)
+  Calling Sequence: allocateStorage(filterCapacity,delayCapacity,arenaPtr)
 
   Inputs:
 
-    bufferPtr - A pointer to storage that provides the input samples.
+    filterCapacity - The largest number of taps to provide for.  A
+    value less than 1 is taken as 1.
 
-    bufferLength - The nmber of samples referenced by bufferPtr.  This
-    will also be the number of samples stored into memory referenced
-    by outputBufferPtr.
+    delayCapacity - The largest reference delay to provide for.  A
+    negative value is taken as 0.
 
-    outputBufferPtr - A pointer to storage for the processed samples.
+    arenaPtr - A pointer to the arena.  If it is NULL, or it does not
+    have getStorageRequirement() bytes left, a private arena is created.
 
   Outputs:
 
     None.
 
 *****************************************************************************/
-void NlmsNoiseCanceller::acceptData(float *bufferPtr,
-                                    uint32_t bufferLength,
-                                    float *outputBufferPtr)
+void NlmsNoiseCanceller::allocateStorage(int filterCapacity,
+                                         int delayCapacity,
+                                         MemoryArena *arenaPtr)
 {
-  int i;
+  size_t bytesNeeded;
+  int numberOfSegments;
+  int numberOfGroups;
+  void *delayLineStoragePtr;
 
-  // Filter the block of data provided by the caller.
-  for (i = 0; i < bufferLength; i++)
+  // Never carve out an empty or negative block.
+  if (filterCapacity < 1)
   {
-    outputBufferPtr[i] = filterData(bufferPtr[i]);
-  } // for
+    filterCapacity = 1;
+  } // if
+
+  if (delayCapacity < 0)
+  {
+    delayCapacity = 0;
+  } // if
+
+  bytesNeeded = getStorageRequirement(filterCapacity,delayCapacity);
+
+  if (arenaPtr != NULL)
+  {
+    if ((arenaPtr->getCapacity() - arenaPtr->getBytesUsed()) < bytesNeeded)
+    {
+      // There isn't enough room, so don't use it.
+      arenaPtr = NULL;
+    } // if
+  } // if
+
+  if (arenaPtr == NULL)
+  {
+    // Create an arena that also has room for the Kahan compensation,
+    // the segment storage, the frozen history, and the tap groups, so
+    // that they stay with the rest of the storage if they are needed.
+    numberOfSegments = (filterCapacity + SEGMENT_SIZE - 1) / SEGMENT_SIZE;
+    numberOfGroups = (filterCapacity + TAP_GROUP_SIZE - 1) / TAP_GROUP_SIZE;
+
+    privateArenaPtr =
+      new MemoryArena(bytesNeeded +
+                      MemoryArena::roundUp(filterCapacity * sizeof(float)) +
+                      MemoryArena::roundUp(numberOfSegments * sizeof(float) +
+                                           numberOfSegments) +
+                      MemoryArena::roundUp((filterCapacity +
+                                            FROZEN_BLOCK_SIZE) *
+                                           sizeof(float)) +
+                      MemoryArena::roundUp(numberOfGroups * 2 *
+                                           TAP_GROUP_SIZE * sizeof(float)));
+    arenaPtr = privateArenaPtr;
+  } // if
+
+  // Save these for reconfiguration and the lazy allocations.
+  this->filterCapacity = filterCapacity;
+  this->delayCapacity = delayCapacity;
+  this->arenaPtr = arenaPtr;
+
+  // Allocate zero-valued coefficients and filter state.
+  coefficientStoragePtr = arenaPtr->allocateFloats(filterCapacity);
+  filterStatePtr = arenaPtr->allocateFloats(filterCapacity);
+
+  // Instantiate the delay line in the arena.
+  delayLineStoragePtr = arenaPtr->allocate(sizeof(FirFilter));
+  delayLinePtr = new (delayLineStoragePtr) FirFilter(delayCapacity + 1,
+                                                     NULL,
+                                                     arenaPtr);
+
+  if (accumulationMode == ACCUMULATE_KAHAN)
+  {
+    allocateCompensation();
+  } // if
+
+  if (proportionateUpdate)
+  {
+    allocateSegments();
+  } // if
+
+  if (automaticFreeze || frozen)
+  {
+    allocateFrozenHistory();
+  } // if
+
+  if (tapLayout == TAPS_INTERLEAVED)
+  {
+    allocateTapGroups();
+  } // if
 
   return;
 
-} // acceptData
+} // allocateStorage
 
 /*****************************************************************************
 
-  Name: shiftSampleIntoPipeline
-
-  Purpose: The purpose of this function is to shift the next sample into
-  the filter state memory (the pipeline).  For now, a linear buffer will
-  be used.  This was chosen because the pipeline is used in the update
-  equation for the the filter coefficients.  The structure of the
-  pipeline is,
+  Name: allocateAuxiliary
 
-  {x(n) x(n-1) x(n-2)...,x(n - N + 1)}.
+  Purpose: The purpose of this function is to allocate zero-filled
+  storage that is only needed by some modes.  It is taken from the
+  arena if there is room, and from the heap otherwise.
 
-  Calling Sequence: shiftSampleIntoPipeline(x)
+  Calling Sequence: bufferPtr = allocateAuxiliary(size,onHeapPtr)
 
   Inputs:
 
-    x - The sample to shift into the pipeline.
+    size - The size of the storage in bytes.
+
+    onHeapPtr - A pointer to storage for a flag that indicates whether
+    the storage came from the heap, in which case it must be released
+    with delete[] as an array of uint8_t.
 
   Outputs:
 
-    None.
+    bufferPtr - A pointer to the storage.
 
 *****************************************************************************/
-void NlmsNoiseCanceller::shiftSampleIntoPipeline(float x)
+void *NlmsNoiseCanceller::allocateAuxiliary(size_t size,bool *onHeapPtr)
 {
-  int i;
+  uint8_t *bufferPtr;
+  size_t i;
 
-  // Shift the existing samples.
-  for (i = filterLength-1; i > 0; i--)
+  bufferPtr = (uint8_t *)arenaPtr->allocate(size);
+  *onHeapPtr = false;
+
+  if (bufferPtr == NULL)
   {
-    // Make room for the new sample.
-    filterStatePtr[i] = filterStatePtr[i-1];
-  } // for
+    // The arena is full, so fall back to the heap.
+    bufferPtr = new uint8_t[size];
+    *onHeapPtr = true;
 
-  // Place the sample into the pipeline.
-  filterStatePtr[0] = x;
+    for (i = 0; i < size; i++)
+    {
+      bufferPtr[i] = 0;
+    } // for
+  } // if
 
-  return;
+  return (bufferPtr);
 
-} // shiftSampleIntoPipeline
+} // allocateAuxiliary
 
 /*****************************************************************************
 
-  Name: dotProduct
+  Name: allocateCompensation
 
-  Purpose: The purpose of this function is to compute the dot product
-  between two vectors
+  Purpose: The purpose of this function is to allocate the storage for
+  the Kahan compensation of the coefficient update.
 
-  Calling Sequence: dotProduct(aPtr,bPtr,n)
+  Calling Sequence: allocateCompensation()
 
   Inputs:
 
-    a - A pointer to the first vector for which a dot product is to be
-    computed.
+    None.
 
-    b - A pointer to he second vector for which a dot product is to be
-    computed.
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::allocateCompensation(void)
+{
+
+  // Allocate storage for the coefficient update compensation.
+  compensationPtr =
+    (float *)allocateAuxiliary(filterCapacity * sizeof(float),
+                               &compensationOnHeap);
+
+  return;
+
+} // allocateCompensation
+
+/*****************************************************************************
+
+  Name: allocateSegments
+
+  Purpose: The purpose of this function is to allocate the storage for
+  the segment norms and the active-tap mask of the proportionate
+  update.  The flags are placed right after the norms.
+
+  Calling Sequence: allocateSegments()
+
+  Inputs:
+
+    None.
 
   Outputs:
 
-    c - The dot product of the two input vectors.
+    None.
 
 *****************************************************************************/
-float NlmsNoiseCanceller::dotProduct(float *aPtr,float *bPtr,int n)
+void NlmsNoiseCanceller::allocateSegments(void)
 {
-  float result;
-  int i;
+  int numberOfSegments;
 
-  // Start out with a zero sum.
-  result = 0;
+  numberOfSegments = (filterCapacity + SEGMENT_SIZE - 1) / SEGMENT_SIZE;
 
-  for (i = 0; i < n; i++)
-  {
-    result = result + (aPtr[i] * bPtr[i]);
-  } // for
+  segmentNormPtr =
+    (float *)allocateAuxiliary(numberOfSegments * sizeof(float) +
+                               numberOfSegments,
+                               &segmentsOnHeap);
 
-  return (result);
+  segmentActivePtr = (uint8_t *)&segmentNormPtr[numberOfSegments];
 
-} // dotProduct
+  resetSegments();
+
+  return;
+
+} // allocateSegments
 
 /*****************************************************************************
 
-  Name: filterData
+  Name: allocateFrozenHistory
 
-  Purpose: The purpose of this function is to filter one sample of data
-  for the purpose of removing noise from a signal.  Here's how it works.
-  A reference signal is formed by delaying the input signal by a specified
-  number of samples.  The idea here is that the noise portion of the
-  delayed signal is uncorrelated with the nondelayed input signal.  This
-  way, the adaptive filter of the noise canceller will provide an
-  estimate of the desired signal as its output.
+  Purpose: The purpose of this function is to allocate the storage for
+  the input history of the frozen path.
 
-  Calling Sequence: dHat = filterData(x)
+  Calling Sequence: allocateFrozenHistory()
 
   Inputs:
 
-    x - The data sample to filter.
+    None.
 
   Outputs:
 
-    dHat - The output value of the filter.  This is an estimate of a
-    noise-reduced sample.
+    None.
 
 *****************************************************************************/
-float NlmsNoiseCanceller::filterData(float x)
+void NlmsNoiseCanceller::allocateFrozenHistory(void)
 {
-  int i;
-  float dHat;
-  float *w;
-  float d;
-  float den;
-  float e;
 
-  // Reference filter coefficients.
-  w = coefficientStoragePtr;
+  frozenHistoryPtr =
+    (float *)allocateAuxiliary((filterCapacity + FROZEN_BLOCK_SIZE) *
+                               sizeof(float),
+                               &frozenHistoryOnHeap);
 
-  // Place the sample into the state memory.
-  shiftSampleIntoPipeline(x);
+  return;
 
-  // Compute reference sample.
-  d = delayLinePtr->filterData(x);
+} // allocateFrozenHistory
 
-  // Compute noise-reduced sample.
-  dHat = dotProduct(w,filterStatePtr,filterLength);
+/*****************************************************************************
 
-  // Compute the error.
-  e = d - dHat;
+  Name: allocateTapGroups
 
-  // Compute the normalizing denominator.
-  den = dotProduct(filterStatePtr,filterStatePtr,filterLength);
-  den += 0.0001;
+  Purpose: The purpose of this function is to allocate the storage for
+  the groups of the interleaved layout.  There is room for float
+  weights, so that the weight format can be changed without allocating.
 
-  // Update the filter coefficients.
-  for (i = 0; i < filterLength; i++)
-  {
-    w[i] = w[i] + ((beta / den) * e * filterStatePtr[i]);
-  } // for
- 
-  return (dHat);
+  Calling Sequence: allocateTapGroups()
 
-} // filterData
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::allocateTapGroups(void)
+{
+  int numberOfGroups;
+
+  numberOfGroups = (filterCapacity + TAP_GROUP_SIZE - 1) / TAP_GROUP_SIZE;
+
+  tapGroupPtr =
+    (uint8_t *)allocateAuxiliary(numberOfGroups * 2 * TAP_GROUP_SIZE *
+                                 sizeof(float),
+                                 &tapGroupsOnHeap);
+
+  return;
+
+} // allocateTapGroups
+
+/*****************************************************************************
+
+  Name: resetSegments
+
+  Purpose: The purpose of this function is to recompute the norm of each
+  segment from the current coefficients, and to mark all segments as
+  active.
+
+  Calling Sequence: resetSegments()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::resetSegments(void)
+{
+  int i;
+  int segment;
+  int numberOfSegments;
+
+  numberOfSegments = (filterLength + SEGMENT_SIZE - 1) / SEGMENT_SIZE;
+
+  for (segment = 0; segment < numberOfSegments; segment++)
+  {
+    segmentNormPtr[segment] = 0;
+    segmentActivePtr[segment] = 1;
+  } // for
+
+  for (i = 0; i < filterLength; i++)
+  {
+    segmentNormPtr[i / SEGMENT_SIZE] += fabsf(coefficientStoragePtr[i]);
+  } // for
+
+  // Start the counters over.
+  maskCounter = 0;
+  probeCounter = 0;
+
+  return;
+
+} // resetSegments
+
+/*****************************************************************************
+
+  Name: releaseStorage
+
+  Purpose: The purpose of this function is to release the storage of
+  the instance.  Storage in a caller's arena belongs to the caller, and
+  it is not reclaimed until the caller resets or destroys the arena.
+
+  Calling Sequence: releaseStorage()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::releaseStorage(void)
+{
+
+  if (delayLinePtr != NULL)
+  {
+    // The delay line was constructed in place, so only destroy it.
+    delayLinePtr->~FirFilter();
+  } // if
+
+  if (compensationOnHeap)
+  {
+    delete[] (uint8_t *)compensationPtr;
+  } // if
+
+  if (segmentsOnHeap)
+  {
+    delete[] (uint8_t *)segmentNormPtr;
+  } // if
+
+  if (frozenHistoryOnHeap)
+  {
+    delete[] (uint8_t *)frozenHistoryPtr;
+  } // if
+
+  if (tapGroupsOnHeap)
+  {
+    delete[] tapGroupPtr;
+  } // if
+
+  if (privateArenaPtr != NULL)
+  {
+    delete privateArenaPtr;
+  } // if
+
+  filterCapacity = 0;
+  delayCapacity = 0;
+  coefficientStoragePtr = NULL;
+  filterStatePtr = NULL;
+  delayLinePtr = NULL;
+  compensationPtr = NULL;
+  compensationOnHeap = false;
+  segmentNormPtr = NULL;
+  segmentActivePtr = NULL;
+  segmentsOnHeap = false;
+  frozenHistoryPtr = NULL;
+  frozenHistoryOnHeap = false;
+  tapGroupPtr = NULL;
+  tapGroupsOnHeap = false;
+  arenaPtr = NULL;
+  privateArenaPtr = NULL;
+
+  return;
+
+} // releaseStorage
+
+/*****************************************************************************
+
+  Name: takeStorage
+
+  Purpose: The purpose of this function is to take over the storage and
+  the state of another instance.  The other instance is left with no
+  storage, so that its destruction releases nothing.
+
+  Calling Sequence: takeStorage(other)
+
+  Inputs:
+
+    other - The instance whose storage is taken.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::takeStorage(NlmsNoiseCanceller &other)
+{
+
+  filterLength = other.filterLength;
+  referenceDelay = other.referenceDelay;
+  beta = other.beta;
+  stepSize = other.stepSize;
+  filterCapacity = other.filterCapacity;
+  delayCapacity = other.delayCapacity;
+  coefficientStoragePtr = other.coefficientStoragePtr;
+  filterStatePtr = other.filterStatePtr;
+  delayLinePtr = other.delayLinePtr;
+  arenaPtr = other.arenaPtr;
+  privateArenaPtr = other.privateArenaPtr;
+  accumulationMode = other.accumulationMode;
+  compensationPtr = other.compensationPtr;
+  compensationOnHeap = other.compensationOnHeap;
+  denormalProtection = other.denormalProtection;
+  ditherLevel = other.ditherLevel;
+  ditherState = other.ditherState;
+  proportionateUpdate = other.proportionateUpdate;
+  alpha = other.alpha;
+  segmentNormPtr = other.segmentNormPtr;
+  segmentActivePtr = other.segmentActivePtr;
+  segmentsOnHeap = other.segmentsOnHeap;
+  activeTapThreshold = other.activeTapThreshold;
+  maskCounter = other.maskCounter;
+  probeCounter = other.probeCounter;
+  variableStepSize = other.variableStepSize;
+  betaMin = other.betaMin;
+  errorCorrelation = other.errorCorrelation;
+  errorPower = other.errorPower;
+  previousError = other.previousError;
+  frozen = other.frozen;
+  automaticFreeze = other.automaticFreeze;
+  freezeTolerance = other.freezeTolerance;
+  windowEnergy = other.windowEnergy;
+  windowCounter = other.windowCounter;
+  stableWindows = other.stableWindows;
+  previousWindowPower = other.previousWindowPower;
+  frozenPower = other.frozenPower;
+  frozenHistoryPtr = other.frozenHistoryPtr;
+  frozenHistoryOnHeap = other.frozenHistoryOnHeap;
+  tapLayout = other.tapLayout;
+  weightFormat = other.weightFormat;
+  tapGroupPtr = other.tapGroupPtr;
+  tapGroupsOnHeap = other.tapGroupsOnHeap;
+
+  // Leave the other instance empty.
+  other.filterLength = 0;
+  other.referenceDelay = 0;
+  other.filterCapacity = 0;
+  other.delayCapacity = 0;
+  other.coefficientStoragePtr = NULL;
+  other.filterStatePtr = NULL;
+  other.delayLinePtr = NULL;
+  other.arenaPtr = NULL;
+  other.privateArenaPtr = NULL;
+  other.compensationPtr = NULL;
+  other.compensationOnHeap = false;
+  other.segmentNormPtr = NULL;
+  other.segmentActivePtr = NULL;
+  other.segmentsOnHeap = false;
+  other.frozenHistoryPtr = NULL;
+  other.frozenHistoryOnHeap = false;
+  other.tapGroupPtr = NULL;
+  other.tapGroupsOnHeap = false;
+  other.frozen = false;
+
+  return;
+
+} // takeStorage
+
+/*****************************************************************************
+
+  Name: reconfigure
+
+  Purpose: The purpose of this function is to change the filter order,
+  the reference delay, and the convergence factor.  The adaptive state
+  (coefficients, filter state, and delay line) is reset, as it would be
+  for a new instance.  When the new order and delay fit in the storage
+  that the instance already has, no memory is allocated, so channels
+  can be rebalanced on the processing path.  Otherwise, new storage is
+  allocated: from the caller's arena if it has room (the old storage
+  there is not reclaimed), and from a new private arena otherwise.
+
+  Calling Sequence: success = reconfigure(filterLength,referenceDelay,beta)
+
+  Inputs:
+
+    filterLength - The number of taps for the filter.  This must be at
+    least 1.
+
+    referenceDelay - The number of samples to delay the input data
+    so that the reference signal can be formed.  This must not be
+    negative.
+
+    beta - The normalized step-size of the update equation.
+
+  Outputs:
+
+    success - A flag that indicates whether the canceller was
+    reconfigured.  A value of false indicates that filterLength or
+    referenceDelay is out of range, in which case the canceller is
+    unchanged.
+
+*****************************************************************************/
+bool NlmsNoiseCanceller::reconfigure(int filterLength,
+                                     int referenceDelay,
+                                     float beta)
+{
+  int i;
+
+  if ((filterLength < 1) || (referenceDelay < 0))
+  {
+    // Leave the current configuration alone.
+    return (false);
+  } // if
+
+  if ((filterLength > filterCapacity) || (referenceDelay > delayCapacity))
+  {
+    reserve(filterLength,referenceDelay);
+  } // if
+
+  // Save for later use.
+  this->filterLength = filterLength;
+  this->referenceDelay = referenceDelay;
+  this->beta = beta;
+
+  // Start out with the largest step, with no error history.
+  stepSize = beta;
+  errorCorrelation = 0;
+  errorPower = 0;
+  previousError = 0;
+
+  // The new filter has to converge before it can be frozen.
+  frozen = false;
+  windowEnergy = 0;
+  windowCounter = 0;
+  stableWindows = 0;
+  previousWindowPower = 0;
+  frozenPower = 0;
+
+  // Start with zero-valued coefficients and filter state.
+  for (i = 0; i < filterLength; i++)
+  {
+    coefficientStoragePtr[i] = 0;
+    filterStatePtr[i] = 0;
+  } // for
+
+  if (compensationPtr != NULL)
+  {
+    for (i = 0; i < filterLength; i++)
+    {
+      compensationPtr[i] = 0;
+    } // for
+  } // if
+
+  if (segmentNormPtr != NULL)
+  {
+    resetSegments();
+  } // if
+
+  if (tapGroupPtr != NULL)
+  {
+    packTaps();
+  } // if
+
+  // Only the last tap of the delay line is nonzero.
+  delayLinePtr->reconfigure(referenceDelay + 1,NULL);
+  delayLinePtr->setCoefficient(referenceDelay,1);
+
+  return (true);
+
+} // reconfigure
+
+/*****************************************************************************
+
+  Name: reserve
+
+  Purpose: The purpose of this function is to make sure that the storage
+  of the instance can hold a filter order and a reference delay, so
+  that later calls to reconfigure() with values up to these will not
+  allocate memory.  If new storage is needed, the adaptive state is
+  reset, otherwise nothing changes.
+
+  Calling Sequence: reserve(maxFilterLength,maxReferenceDelay)
+
+  Inputs:
+
+    maxFilterLength - The largest number of taps to provide for.
+
+    maxReferenceDelay - The largest reference delay to provide for.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::reserve(int maxFilterLength,int maxReferenceDelay)
+{
+  MemoryArena *callerArenaPtr;
+  int currentFilterLength;
+  int currentReferenceDelay;
+
+  if ((maxFilterLength <= filterCapacity) &&
+      (maxReferenceDelay <= delayCapacity))
+  {
+    // There's already enough room.
+    return;
+  } // if
+
+  // Never shrink.
+  if (maxFilterLength < filterCapacity)
+  {
+    maxFilterLength = filterCapacity;
+  } // if
+
+  if (maxReferenceDelay < delayCapacity)
+  {
+    maxReferenceDelay = delayCapacity;
+  } // if
+
+  // Remember whose arena was in use.
+  callerArenaPtr = NULL;
+  if (arenaPtr != privateArenaPtr)
+  {
+    callerArenaPtr = arenaPtr;
+  } // if
+
+  currentFilterLength = filterLength;
+  currentReferenceDelay = referenceDelay;
+
+  releaseStorage();
+  allocateStorage(maxFilterLength,maxReferenceDelay,callerArenaPtr);
+
+  // The new storage has to be configured.
+  if ((currentFilterLength <= filterCapacity) &&
+      (currentReferenceDelay <= delayCapacity))
+  {
+    reconfigure(currentFilterLength,currentReferenceDelay,beta);
+  } // if
+
+  return;
+
+} // reserve
+
+/*****************************************************************************
+
+  Name: getStorageRequirement
+
+  Purpose: The purpose of this function is to compute the number of
+  bytes of arena storage that an instance needs.  A caller that creates
+  many instances can size one arena with the sum of their requirements.
+  Storage for Kahan accumulation, the proportionate update, and freezing
+  is not included; it is taken from the arena if there is room left when
+  one of those modes is selected, and from the heap otherwise.
+
+  Calling Sequence: bytesNeeded = getStorageRequirement(filterLength,
+                                                        referenceDelay)
+
+  Inputs:
+
+    filterLength - The number of taps for the filter.
+
+    referenceDelay - The number of samples to delay the input data.
+
+  Outputs:
+
+    bytesNeeded - The number of bytes of arena storage.
+
+*****************************************************************************/
+size_t NlmsNoiseCanceller::getStorageRequirement(int filterLength,
+                                                 int referenceDelay)
+{
+  size_t bytesNeeded;
+
+  // Coefficients and filter state.
+  bytesNeeded = 2 * MemoryArena::roundUp(filterLength * sizeof(float));
+
+  // The delay line object and its storage.
+  bytesNeeded += MemoryArena::roundUp(sizeof(FirFilter));
+  bytesNeeded += FirFilter::getStorageRequirement(referenceDelay + 1);
+
+  return (bytesNeeded);
+
+} // getStorageRequirement
+
+/*****************************************************************************
+
+  Name: setAccumulationMode
+
+  Purpose: The purpose of this function is to select how the sums of the
+  dot products and the coefficient update are accumulated.  Float
+  accumulation is the fastest, but over multi-hour runs with high filter
+  orders, its rounding error causes the coefficients to drift.  See the
+  description of AccumulationMode in NlmsNoiseCanceller.h.
+
+  Calling Sequence: setAccumulationMode(mode)
+
+  Inputs:
+
+    mode - The accumulation mode.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::setAccumulationMode(AccumulationMode mode)
+{
+
+  accumulationMode = mode;
+
+  if ((mode == ACCUMULATE_KAHAN) && (compensationPtr == NULL))
+  {
+    allocateCompensation();
+  } // if
+
+  return;
+
+} // setAccumulationMode
+
+/*****************************************************************************
+
+  Name: setDenormalProtection
+
+  Purpose: The purpose of this function is to enable or disable the
+  flushing of subnormal values to zero while a block is processed.
+  When the input decays into silence, the filter state and the
+  coefficients decay into subnormal values, and arithmetic on them can
+  be 10 to 100 times slower.  When enabled, a DenormalGuard is active
+  for the duration of each call to acceptData().
+
+  Calling Sequence: setDenormalProtection(enable)
+
+  Inputs:
+
+    enable - A flag that indicates whether FTZ/DAZ should be enabled.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::setDenormalProtection(bool enable)
+{
+
+  denormalProtection = enable;
+
+  return;
+
+} // setDenormalProtection
+
+/*****************************************************************************
+
+  Name: setDitherLevel
+
+  Purpose: The purpose of this function is to set the amplitude of a
+  tiny uniform noise that is added to each input sample.  This keeps
+  the filter state away from subnormal values on processors (or
+  builds) where FTZ/DAZ is not available.  The level should be far
+  below the quantization step of the signal, but far above the
+  smallest normal float (about 1.2e-38).  For 16-bit scaled samples, a
+  level of 1e-3 is inaudible.
+
+  Calling Sequence: setDitherLevel(level)
+
+  Inputs:
+
+    level - The peak amplitude of the dither.  A value of 0 disables
+    dither.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::setDitherLevel(float level)
+{
+
+  ditherLevel = level;
+
+  return;
+
+} // setDitherLevel
+
+/*****************************************************************************
+
+  Name: setProportionateUpdate
+
+  Purpose: The purpose of this function is to select the improved
+  proportionate NLMS (IPNLMS) update.  The gain of tap k is,
+
+    g(k) = (1 - alpha) / 2N + (1 + alpha) |w(k)| / (2 ||w||1 + eps),
+
+  and the update is w(k) = w(k) + beta * e * g(k) * x(n - k) / den,
+  where den is the sum of g(k) * x(n - k)^2.  Since the tap magnitudes
+  are used, the update is performed in float regardless of the
+  accumulation mode; the accumulation mode still applies to the output
+  of the filter.
+
+  Calling Sequence: setProportionateUpdate(enable,alpha)
+
+  Inputs:
+
+    enable - A flag that indicates whether the IPNLMS update is used.
+
+    alpha - The mixing parameter in the range of [-1,1).  A value of -1
+    is equivalent to NLMS, and values of 0 or -0.5 are typical.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::setProportionateUpdate(bool enable,float alpha)
+{
+
+  proportionateUpdate = enable;
+  this->alpha = alpha;
+
+  if (enable)
+  {
+    if (segmentNormPtr == NULL)
+    {
+      allocateSegments();
+    } // if
+    else
+    {
+      // The coefficients may have changed since the norms were valid.
+      resetSegments();
+    } // else
+  } // if
+
+  return;
+
+} // setProportionateUpdate
+
+/*****************************************************************************
+
+  Name: setActiveTapThreshold
+
+  Purpose: The purpose of this function is to set the threshold of the
+  active-tap mask of the proportionate update.  Every MASK_INTERVAL
+  samples, a segment of SEGMENT_SIZE taps is marked inactive if its
+  largest tap magnitude is less than the threshold times the largest
+  tap magnitude of the filter, and its taps are set to zero.  Inactive
+  segments are updated only once every PROBE_PERIOD samples.
+
+  Calling Sequence: setActiveTapThreshold(threshold)
+
+  Inputs:
+
+    threshold - The relative threshold, such as 0.001 for -60dB.  A
+    value of 0 disables the mask.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::setActiveTapThreshold(float threshold)
+{
+
+  activeTapThreshold = threshold;
+
+  if (segmentNormPtr != NULL)
+  {
+    // Start over with all segments active.
+    resetSegments();
+  } // if
+
+  return;
+
+} // setActiveTapThreshold
+
+/*****************************************************************************
+
+  Name: getActiveTapCount
+
+  Purpose: The purpose of this function is to return the number of taps
+  that are in active segments of the active-tap mask.
+
+  Calling Sequence: count = getActiveTapCount()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    count - The number of active taps.  This is the filter length when
+    the proportionate update is not used.
+
+*****************************************************************************/
+int NlmsNoiseCanceller::getActiveTapCount(void)
+{
+  int count;
+  int segment;
+  int numberOfSegments;
+
+  if (!proportionateUpdate)
+  {
+    return (filterLength);
+  } // if
+
+  numberOfSegments = (filterLength + SEGMENT_SIZE - 1) / SEGMENT_SIZE;
+
+  count = 0;
+
+  for (segment = 0; segment < numberOfSegments; segment++)
+  {
+    if (segmentActivePtr[segment])
+    {
+      count += SEGMENT_SIZE;
+    } // if
+  } // for
+
+  if (count > filterLength)
+  {
+    count = filterLength;
+  } // if
+
+  return (count);
+
+} // getActiveTapCount
+
+/*****************************************************************************
+
+  Name: setVariableStepSize
+
+  Purpose: The purpose of this function is to enable or disable the
+  variable step-size policy.  The policy follows Aboulnasr and Mayyas:
+  the correlation of successive errors, p(n), is tracked rather than the
+  error power, so that uncorrelated noise at the output does not keep
+  the step large.  To make the policy independent of the signal level,
+  the correlation is normalized by the error power, which gives the
+  squared correlation coefficient, r(n), in the range of [0,1].  The
+  step size then tracks betaMin + (beta - betaMin) * r(n).
+
+  Calling Sequence: setVariableStepSize(enable,betaMin)
+
+  Inputs:
+
+    enable - A flag that indicates whether the policy is used.
+
+    betaMin - The smallest step size.  The largest step size is the
+    beta that was given to the constructor or to reconfigure().
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::setVariableStepSize(bool enable,float betaMin)
+{
+
+  variableStepSize = enable;
+  this->betaMin = betaMin;
+
+  // Start out with the largest step, with no error history.
+  stepSize = beta;
+  errorCorrelation = 0;
+  errorPower = 0;
+  previousError = 0;
+
+  return;
+
+} // setVariableStepSize
+
+/*****************************************************************************
+
+  Name: getStepSize
+
+  Purpose: The purpose of this function is to return the step size that
+  the coefficient update is currently using.
+
+  Calling Sequence: stepSize = getStepSize()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    stepSize - The current step size.
+
+*****************************************************************************/
+float NlmsNoiseCanceller::getStepSize(void)
+{
+
+  return (stepSize);
+
+} // getStepSize
+
+/*****************************************************************************
+
+  Name: setFrozen
+
+  Purpose: The purpose of this function is to freeze or unfreeze the
+  coefficients of the adaptive filter.  While the coefficients are
+  frozen, the canceller runs as a fixed FIR filter: no coefficient
+  update is performed, and blocks of samples are filtered with a block
+  convolution.  When automatic freezing is enabled, a frozen canceller
+  still resumes adaptation by itself if the error power rises.
+
+  Calling Sequence: setFrozen(frozen)
+
+  Inputs:
+
+    frozen - A flag that indicates whether the coefficients are frozen.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::setFrozen(bool frozen)
+{
+
+  if (frozenHistoryPtr == NULL)
+  {
+    allocateFrozenHistory();
+  } // if
+
+  if (frozen && !this->frozen)
+  {
+    enterFrozenState();
+
+    // Measure the error power of the frozen filter in the next window.
+    frozenPower = 0;
+  } // if
+  else
+  {
+    if (!frozen && this->frozen)
+    {
+      leaveFrozenState();
+    } // if
+  } // else
+
+  return;
+
+} // setFrozen
+
+/*****************************************************************************
+
+  Name: setAutomaticFreeze
+
+  Purpose: The purpose of this function is to enable or disable
+  automatic freezing.  The error power is measured over windows of
+  FREEZE_WINDOW samples.  Once it has changed by no more than the
+  tolerance (a fraction of its value) for STABLE_WINDOWS successive
+  windows, the coefficients are frozen.  If the error power of a later
+  window exceeds RESUME_RATIO times the error power at the time of
+  freezing, the noise is taken to have changed, and adaptation resumes.
+
+  Calling Sequence: setAutomaticFreeze(enable,tolerance)
+
+  Inputs:
+
+    enable - A flag that indicates whether freezing is automatic.
+
+    tolerance - The largest relative change of the error power between
+    windows that is still considered stable, for example, 0.05.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::setAutomaticFreeze(bool enable,float tolerance)
+{
+
+  if (enable && (frozenHistoryPtr == NULL))
+  {
+    allocateFrozenHistory();
+  } // if
+
+  automaticFreeze = enable;
+  freezeTolerance = tolerance;
+
+  // Start a new measurement.
+  windowEnergy = 0;
+  windowCounter = 0;
+  stableWindows = 0;
+  previousWindowPower = 0;
+
+  return;
+
+} // setAutomaticFreeze
+
+/*****************************************************************************
+
+  Name: isFrozen
+
+  Purpose: The purpose of this function is to indicate whether the
+  coefficients of the adaptive filter are currently frozen.
+
+  Calling Sequence: frozen = isFrozen()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    frozen - A flag that indicates whether the coefficients are frozen.
+
+*****************************************************************************/
+bool NlmsNoiseCanceller::isFrozen(void)
+{
+
+  return (frozen);
+
+} // isFrozen
+
+/*****************************************************************************
+
+  Name: setTapLayout
+
+  Purpose: The purpose of this function is to select how the taps are
+  stored.  In the interleaved layout, the state and the weights of each
+  group of TAP_GROUP_SIZE taps are stored together, and the weights may
+  be stored in a compact format.  The current taps are converted, so
+  the layout may be changed at any time, but weights that are converted
+  to a compact format are rounded.  The interleaved layout always uses
+  the NLMS update with float accumulation, so the proportionate update
+  and the accumulation mode take effect only in the separate layout.
+
+  Calling Sequence: setTapLayout(layout,format)
+
+  Inputs:
+
+    layout - The tap layout.
+
+    format - The storage format of the weights of the interleaved
+    layout.  It is ignored by the separate layout.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::setTapLayout(TapLayout layout,WeightFormat format)
+{
+
+  // Bring the taps back to the separate arrays.
+  if (tapLayout == TAPS_INTERLEAVED)
+  {
+    unpackTaps();
+  } // if
+
+  tapLayout = layout;
+  weightFormat = format;
+
+  if (tapLayout == TAPS_INTERLEAVED)
+  {
+    if (tapGroupPtr == NULL)
+    {
+      allocateTapGroups();
+    } // if
+
+    packTaps();
+  } // if
+
+  return;
+
+} // setTapLayout
+
+/*****************************************************************************
+
+  Name: getFilterLength
+
+  Purpose: The purpose of this function is to return the number of taps
+  of the adaptive filter.
+
+  Calling Sequence: filterLength = getFilterLength()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    filterLength - The number of taps.
+
+*****************************************************************************/
+int NlmsNoiseCanceller::getFilterLength(void)
+{
+
+  return (filterLength);
+
+} // getFilterLength
+
+/*****************************************************************************
+
+  Name: getCoefficients
+
+  Purpose: The purpose of this function is to retrieve the current
+  coefficients of the adaptive filter.
+
+  Calling Sequence: getCoefficients(coefficientsPtr)
+
+  Inputs:
+
+    coefficientsPtr - A pointer to storage for the coefficients.  It
+    must be able to hold getFilterLength() values.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::getCoefficients(float *coefficientsPtr)
+{
+  int i;
+
+  if (tapLayout == TAPS_INTERLEAVED)
+  {
+    unpackTaps();
+  } // if
+
+  for (i = 0; i < filterLength; i++)
+  {
+    coefficientsPtr[i] = coefficientStoragePtr[i];
+  } // for
+
+  return;
+
+} // getCoefficients
+
+/*****************************************************************************
+
+  Name: writeState
+
+  Purpose: The purpose of this function is to write the adaptive state of
+  the canceller to a stream, so that it can be restored by readState().
+  This includes the taps, the delay line, the dither generator, and the
+  state of the update policies.  The modes themselves are not written;
+  a flag is written for each optional array, so that readState() can
+  check that the modes match.
+
+  Calling Sequence: success = writeState(streamPtr)
+
+  Inputs:
+
+    streamPtr - The stream.
+
+  Outputs:
+
+    success - A flag that indicates whether the state was written.
+
+*****************************************************************************/
+bool NlmsNoiseCanceller::writeState(FILE *streamPtr)
+{
+  bool success;
+  int numberOfSegments;
+  int numberOfGroups;
+  int format;
+  uint8_t *groupsPtr;
+
+  numberOfSegments = (filterLength + SEGMENT_SIZE - 1) / SEGMENT_SIZE;
+  numberOfGroups = (filterLength + TAP_GROUP_SIZE - 1) / TAP_GROUP_SIZE;
+
+  // The groups are the only up to date copy of interleaved taps.
+  groupsPtr = NULL;
+  format = weightFormat;
+
+  if (tapLayout == TAPS_INTERLEAVED)
+  {
+    groupsPtr = tapGroupPtr;
+  } // if
+
+  success = writeValues(streamPtr,&filterLength,sizeof(int),1) &&
+    writeValues(streamPtr,&referenceDelay,sizeof(int),1) &&
+    writeValues(streamPtr,&format,sizeof(int),1) &&
+    writeValues(streamPtr,&stepSize,sizeof(float),1) &&
+    writeValues(streamPtr,&ditherState,sizeof(uint32_t),1) &&
+    writeValues(streamPtr,coefficientStoragePtr,sizeof(float),filterLength) &&
+    writeValues(streamPtr,filterStatePtr,sizeof(float),filterLength) &&
+    writeValues(streamPtr,&maskCounter,sizeof(int),1) &&
+    writeValues(streamPtr,&probeCounter,sizeof(int),1) &&
+    writeValues(streamPtr,&errorCorrelation,sizeof(float),1) &&
+    writeValues(streamPtr,&errorPower,sizeof(float),1) &&
+    writeValues(streamPtr,&previousError,sizeof(float),1) &&
+    writeValues(streamPtr,&frozen,sizeof(bool),1) &&
+    writeValues(streamPtr,&windowEnergy,sizeof(float),1) &&
+    writeValues(streamPtr,&windowCounter,sizeof(int),1) &&
+    writeValues(streamPtr,&stableWindows,sizeof(int),1) &&
+    writeValues(streamPtr,&previousWindowPower,sizeof(float),1) &&
+    writeValues(streamPtr,&frozenPower,sizeof(float),1) &&
+    writeOptionalValues(streamPtr,
+                        compensationPtr,
+                        sizeof(float),
+                        filterLength) &&
+    writeOptionalValues(streamPtr,
+                        segmentNormPtr,
+                        sizeof(float),
+                        numberOfSegments) &&
+    writeOptionalValues(streamPtr,
+                        segmentActivePtr,
+                        sizeof(uint8_t),
+                        numberOfSegments) &&
+    writeOptionalValues(streamPtr,
+                        frozenHistoryPtr,
+                        sizeof(float),
+                        filterLength) &&
+    writeOptionalValues(streamPtr,
+                        groupsPtr,
+                        getTapGroupStride(),
+                        numberOfGroups) &&
+    delayLinePtr->writeState(streamPtr);
+
+  return (success);
+
+} // writeState
+
+/*****************************************************************************
+
+  Name: readState
+
+  Purpose: The purpose of this function is to read the adaptive state
+  that was written by writeState().  The state is rejected if it was
+  written by a canceller with another filter order or reference delay,
+  or with other modes.  If the state is rejected part way through, the
+  canceller is left in an undefined state, and it should be reset with
+  reconfigure() or discarded.
+
+  Calling Sequence: success = readState(streamPtr)
+
+  Inputs:
+
+    streamPtr - The stream.
+
+  Outputs:
+
+    success - A flag that indicates whether the state was read.
+
+*****************************************************************************/
+bool NlmsNoiseCanceller::readState(FILE *streamPtr)
+{
+  bool success;
+  int length;
+  int delay;
+  int format;
+  int numberOfSegments;
+  int numberOfGroups;
+  uint8_t *groupsPtr;
+
+  if ((!readValues(streamPtr,&length,sizeof(int),1)) ||
+      (!readValues(streamPtr,&delay,sizeof(int),1)) ||
+      (!readValues(streamPtr,&format,sizeof(int),1)))
+  {
+    return (false);
+  } // if
+
+  if ((length != filterLength) || (delay != referenceDelay) ||
+      (format != weightFormat))
+  {
+    // The state belongs to another canceller.
+    return (false);
+  } // if
+
+  numberOfSegments = (filterLength + SEGMENT_SIZE - 1) / SEGMENT_SIZE;
+  numberOfGroups = (filterLength + TAP_GROUP_SIZE - 1) / TAP_GROUP_SIZE;
+
+  groupsPtr = NULL;
+
+  if (tapLayout == TAPS_INTERLEAVED)
+  {
+    groupsPtr = tapGroupPtr;
+  } // if
+
+  success = readValues(streamPtr,&stepSize,sizeof(float),1) &&
+    readValues(streamPtr,&ditherState,sizeof(uint32_t),1) &&
+    readValues(streamPtr,coefficientStoragePtr,sizeof(float),filterLength) &&
+    readValues(streamPtr,filterStatePtr,sizeof(float),filterLength) &&
+    readValues(streamPtr,&maskCounter,sizeof(int),1) &&
+    readValues(streamPtr,&probeCounter,sizeof(int),1) &&
+    readValues(streamPtr,&errorCorrelation,sizeof(float),1) &&
+    readValues(streamPtr,&errorPower,sizeof(float),1) &&
+    readValues(streamPtr,&previousError,sizeof(float),1) &&
+    readValues(streamPtr,&frozen,sizeof(bool),1) &&
+    readValues(streamPtr,&windowEnergy,sizeof(float),1) &&
+    readValues(streamPtr,&windowCounter,sizeof(int),1) &&
+    readValues(streamPtr,&stableWindows,sizeof(int),1) &&
+    readValues(streamPtr,&previousWindowPower,sizeof(float),1) &&
+    readValues(streamPtr,&frozenPower,sizeof(float),1) &&
+    readOptionalValues(streamPtr,
+                       compensationPtr,
+                       sizeof(float),
+                       filterLength) &&
+    readOptionalValues(streamPtr,
+                       segmentNormPtr,
+                       sizeof(float),
+                       numberOfSegments) &&
+    readOptionalValues(streamPtr,
+                       segmentActivePtr,
+                       sizeof(uint8_t),
+                       numberOfSegments) &&
+    readOptionalValues(streamPtr,
+                       frozenHistoryPtr,
+                       sizeof(float),
+                       filterLength) &&
+    readOptionalValues(streamPtr,
+                       groupsPtr,
+                       getTapGroupStride(),
+                       numberOfGroups) &&
+    delayLinePtr->readState(streamPtr);
+
+  return (success);
+
+} // readState
+
+/*****************************************************************************
+
+  Name: writeValues
+
+  Purpose: The purpose of this function is to write an array of values to
+  a stream.
+
+  Calling Sequence: success = writeValues(streamPtr,valuesPtr,size,count)
+
+  Inputs:
+
+    streamPtr - The stream.
+
+    valuesPtr - A pointer to the values.
+
+    size - The size of a value in bytes.
+
+    count - The number of values.
+
+  Outputs:
+
+    success - A flag that indicates whether the values were written.
+
+*****************************************************************************/
+bool NlmsNoiseCanceller::writeValues(FILE *streamPtr,
+                                     const void *valuesPtr,
+                                     size_t size,
+                                     size_t count)
+{
+
+  return (fwrite(valuesPtr,size,count,streamPtr) == count);
+
+} // writeValues
+
+/*****************************************************************************
+
+  Name: readValues
+
+  Purpose: The purpose of this function is to read an array of values
+  from a stream.
+
+  Calling Sequence: success = readValues(streamPtr,valuesPtr,size,count)
+
+  Inputs:
+
+    streamPtr - The stream.
+
+    valuesPtr - A pointer to storage for the values.
+
+    size - The size of a value in bytes.
+
+    count - The number of values.
+
+  Outputs:
+
+    success - A flag that indicates whether the values were read.
+
+*****************************************************************************/
+bool NlmsNoiseCanceller::readValues(FILE *streamPtr,
+                                    void *valuesPtr,
+                                    size_t size,
+                                    size_t count)
+{
+
+  return (fread(valuesPtr,size,count,streamPtr) == count);
+
+} // readValues
+
+/*****************************************************************************
+
+  Name: writeOptionalValues
+
+  Purpose: The purpose of this function is to write an array that is
+  only allocated in some modes.  A flag that indicates whether the array
+  is present is written, followed by the array if it is.
+
+  Calling Sequence: success = writeOptionalValues(streamPtr,valuesPtr,
+                                                  size,count)
+
+  Inputs:
+
+    streamPtr - The stream.
+
+    valuesPtr - A pointer to the values, or NULL if the array is not
+    allocated.
+
+    size - The size of a value in bytes.
+
+    count - The number of values.
+
+  Outputs:
+
+    success - A flag that indicates whether the array was written.
+
+*****************************************************************************/
+bool NlmsNoiseCanceller::writeOptionalValues(FILE *streamPtr,
+                                             const void *valuesPtr,
+                                             size_t size,
+                                             size_t count)
+{
+  uint8_t present;
+
+  present = (valuesPtr != NULL);
+
+  if (!writeValues(streamPtr,&present,sizeof(present),1))
+  {
+    return (false);
+  } // if
+
+  if (present)
+  {
+    return (writeValues(streamPtr,valuesPtr,size,count));
+  } // if
+
+  return (true);
+
+} // writeOptionalValues
+
+/*****************************************************************************
+
+  Name: readOptionalValues
+
+  Purpose: The purpose of this function is to read an array that was
+  written by writeOptionalValues().  The array must be present in the
+  stream exactly when it is allocated here.
+
+  Calling Sequence: success = readOptionalValues(streamPtr,valuesPtr,
+                                                 size,count)
+
+  Inputs:
+
+    streamPtr - The stream.
+
+    valuesPtr - A pointer to storage for the values, or NULL if the
+    array is not allocated.
+
+    size - The size of a value in bytes.
+
+    count - The number of values.
+
+  Outputs:
+
+    success - A flag that indicates whether the array was read.
+
+*****************************************************************************/
+bool NlmsNoiseCanceller::readOptionalValues(FILE *streamPtr,
+                                            void *valuesPtr,
+                                            size_t size,
+                                            size_t count)
+{
+  uint8_t present;
+
+  if (!readValues(streamPtr,&present,sizeof(present),1))
+  {
+    return (false);
+  } // if
+
+  if ((present != 0) != (valuesPtr != NULL))
+  {
+    // The modes don't match.
+    return (false);
+  } // if
+
+  if (present)
+  {
+    return (readValues(streamPtr,valuesPtr,size,count));
+  } // if
+
+  return (true);
+
+} // readOptionalValues
+
+/*****************************************************************************
+
+  Name: acceptData
+
+  Purpose: The purpose of this function is to present input samples to
+  be filtered and produce output samples to the calling function.  The
+  samples are converted to float a scratch block at a time, filtered
+  by the float version of this function, and rounded and saturated on
+  the way back to 16 bits.
+
+  Calling Sequence: acceptData(bufferPtr,bufferLength,outputBufferPtr)
+
+  Inputs:
+
+    bufferPtr - A pointer to storage that provides the input samples.
+
+    bufferLength - The nmber of samples referenced by bufferPtr.  This
+    will also be the number of samples stored into memory referenced
+    by outputBufferPtr.
+
+    outputBufferPtr - A pointer to storage for the processed samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::acceptData(int16_t *bufferPtr,
+                                    uint32_t bufferLength,
+                                    int16_t *outputBufferPtr)
+{
+  uint32_t i;
+  uint32_t count;
+  alignas(SampleConverter::ALIGNMENT)
+    float block[SampleConverter::SCRATCH_BLOCK_SIZE];
+
+  i = 0;
+
+  // Filter the block of data provided by the caller.
+  while (i < bufferLength)
+  {
+    count = bufferLength - i;
+
+    if (count > SampleConverter::SCRATCH_BLOCK_SIZE)
+    {
+      count = SampleConverter::SCRATCH_BLOCK_SIZE;
+    } // if
+
+    // The conversions are separate passes, so the adaptation sees only
+    // float samples, and the output saturates rather than wraps.
+    SampleConverter::int16ToFloat(&bufferPtr[i],count,1.0f,block);
+    acceptData(block,count,block);
+    SampleConverter::floatToInt16(block,count,1.0f,&outputBufferPtr[i]);
+
+    i += count;
+  } // while
+
+  return;
+
+} // acceptData
+
+/*****************************************************************************
+
+  Name: acceptData
+
+  Purpose: The purpose of this function is to present input samples to
+  be filtered and produce output samples to the calling function.
+
+  Calling Sequence: acceptData(bufferPtr,bufferLength,outputBufferPtr)
+
+  Inputs:
+
+    bufferPtr - A pointer to storage that provides the input samples.
+
+    bufferLength - The nmber of samples referenced by bufferPtr.  This
+    will also be the number of samples stored into memory referenced
+    by outputBufferPtr.
+
+    outputBufferPtr - A pointer to storage for the processed samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::acceptData(float *bufferPtr,
+                                    uint32_t bufferLength,
+                                    float *outputBufferPtr)
+{
+  uint32_t i;
+  uint32_t count;
+  DenormalGuard guard(denormalProtection);
+
+  i = 0;
+
+  // Filter the block of data provided by the caller.
+  while (i < bufferLength)
+  {
+    if (frozen)
+    {
+      count = getFrozenBlockCount(bufferLength - i);
+
+      filterBlockFrozen(&bufferPtr[i],NULL,count,&outputBufferPtr[i]);
+
+      i += count;
+    } // if
+    else
+    {
+      outputBufferPtr[i] = filterData(bufferPtr[i]);
+      i++;
+    } // else
+  } // while
+
+  return;
+
+} // acceptData
+
+/*****************************************************************************
+
+  Name: acceptData
+
+  Purpose: The purpose of this function is to present the samples of
+  a primary input and of a reference input to be filtered in
+  dual-input mode, and produce output samples to the calling function.
+  The primary input holds the signal plus the noise, and the reference
+  input holds noise from a second sensor.  The delay line is not used;
+  see filterDataDual() for a description.
+
+  Calling Sequence: acceptData(primaryPtr,referencePtr,bufferLength,
+                               outputBufferPtr)
+
+  Inputs:
+
+    primaryPtr - A pointer to storage that provides the primary samples.
+
+    referencePtr - A pointer to storage that provides the reference
+    samples.
+
+    bufferLength - The nmber of samples referenced by primaryPtr and by
+    referencePtr.  This will also be the number of samples stored into
+    memory referenced by outputBufferPtr.
+
+    outputBufferPtr - A pointer to storage for the processed samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::acceptData(int16_t *primaryPtr,
+                                    int16_t *referencePtr,
+                                    uint32_t bufferLength,
+                                    int16_t *outputBufferPtr)
+{
+  uint32_t i;
+  uint32_t count;
+  alignas(SampleConverter::ALIGNMENT)
+    float block[SampleConverter::SCRATCH_BLOCK_SIZE];
+  alignas(SampleConverter::ALIGNMENT)
+    float referenceBlock[SampleConverter::SCRATCH_BLOCK_SIZE];
+
+  i = 0;
+
+  // Filter the block of data provided by the caller.
+  while (i < bufferLength)
+  {
+    count = bufferLength - i;
+
+    if (count > SampleConverter::SCRATCH_BLOCK_SIZE)
+    {
+      count = SampleConverter::SCRATCH_BLOCK_SIZE;
+    } // if
+
+    // The conversions are separate passes, so the adaptation sees only
+    // float samples, and the output saturates rather than wraps.
+    SampleConverter::int16ToFloat(&primaryPtr[i],count,1.0f,block);
+    SampleConverter::int16ToFloat(&referencePtr[i],count,1.0f,
+                                  referenceBlock);
+    acceptData(block,referenceBlock,count,block);
+    SampleConverter::floatToInt16(block,count,1.0f,&outputBufferPtr[i]);
+
+    i += count;
+  } // while
+
+  return;
+
+} // acceptData
+
+/*****************************************************************************
+
+  Name: acceptData
+
+  Purpose: The purpose of this function is to present the samples of
+  a primary input and of a reference input to be filtered in
+  dual-input mode, and produce output samples to the calling function.
+  The primary input holds the signal plus the noise, and the reference
+  input holds noise from a second sensor.  The delay line is not used;
+  see filterDataDual() for a description.
+
+  Calling Sequence: acceptData(primaryPtr,referencePtr,bufferLength,
+                               outputBufferPtr)
+
+  Inputs:
+
+    primaryPtr - A pointer to storage that provides the primary samples.
+
+    referencePtr - A pointer to storage that provides the reference
+    samples.
+
+    bufferLength - The nmber of samples referenced by primaryPtr and by
+    referencePtr.  This will also be the number of samples stored into
+    memory referenced by outputBufferPtr.
+
+    outputBufferPtr - A pointer to storage for the processed samples.
+    It may be the same as primaryPtr.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::acceptData(float *primaryPtr,
+                                    float *referencePtr,
+                                    uint32_t bufferLength,
+                                    float *outputBufferPtr)
+{
+  uint32_t i;
+  uint32_t count;
+  DenormalGuard guard(denormalProtection);
+
+  i = 0;
+
+  // Filter the block of data provided by the caller.
+  while (i < bufferLength)
+  {
+    if (frozen)
+    {
+      count = getFrozenBlockCount(bufferLength - i);
+
+      filterBlockFrozen(&referencePtr[i],
+                        &primaryPtr[i],
+                        count,
+                        &outputBufferPtr[i]);
+
+      i += count;
+    } // if
+    else
+    {
+      outputBufferPtr[i] = filterDataDual(primaryPtr[i],referencePtr[i]);
+      i++;
+    } // else
+  } // while
+
+  return;
+
+} // acceptData
+
+/*****************************************************************************
+
+  Name: shiftSampleIntoPipeline
+
+  Purpose: The purpose of this function is to shift the next sample into
+  the filter state memory (the pipeline).  For now, a linear buffer will
+  be used.  This was chosen because the pipeline is used in the update
+  equation for the the filter coefficients.  The structure of the
+  pipeline is,
+
+  {x(n) x(n-1) x(n-2)...,x(n - N + 1)}.
+
+  Calling Sequence: shiftSampleIntoPipeline(x)
+
+  Inputs:
+
+    x - The sample to shift into the pipeline.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::shiftSampleIntoPipeline(float x)
+{
+  int i;
+
+  // Shift the existing samples.
+  for (i = filterLength-1; i > 0; i--)
+  {
+    // Make room for the new sample.
+    filterStatePtr[i] = filterStatePtr[i-1];
+  } // for
+
+  // Place the sample into the pipeline.
+  filterStatePtr[0] = x;
+
+  return;
+
+} // shiftSampleIntoPipeline
+
+/*****************************************************************************
+
+  Name: dotProduct
+
+  Purpose: The purpose of this function is to compute the dot product
+  between two vectors.  The sum is accumulated according to the
+  accumulation mode.
+
+  Calling Sequence: dotProduct(aPtr,bPtr,n)
+
+  Inputs:
+
+    a - A pointer to the first vector for which a dot product is to be
+    computed.
+
+    b - A pointer to he second vector for which a dot product is to be
+    computed.
+
+  Outputs:
+
+    c - The dot product of the two input vectors.
+
+*****************************************************************************/
+float NlmsNoiseCanceller::dotProduct(float *aPtr,float *bPtr,int n)
+{
+  float result;
+  int i;
+
+  switch (accumulationMode)
+  {
+    case ACCUMULATE_PAIRWISE:
+    {
+      result = pairwiseDotProduct(aPtr,bPtr,n);
+      break;
+    } // case
+
+    case ACCUMULATE_KAHAN:
+    {
+      result = kahanDotProduct(aPtr,bPtr,n);
+      break;
+    } // case
+
+    case ACCUMULATE_DOUBLE:
+    {
+      result = doubleDotProduct(aPtr,bPtr,n);
+      break;
+    } // case
+
+    default:
+    {
+      // Start out with a zero sum.
+      result = 0;
+
+      for (i = 0; i < n; i++)
+      {
+        result = result + (aPtr[i] * bPtr[i]);
+      } // for
+      break;
+    } // case
+  } // switch
+
+  return (result);
+
+} // dotProduct
+
+/*****************************************************************************
+
+  Name: pairwiseDotProduct
+
+  Purpose: The purpose of this function is to compute the dot product
+  between two vectors using pairwise summation.  The vectors are split
+  in half recursively, and the partial sums are added.  The leaves are
+  short enough that they are summed with four independent accumulators,
+  which also keeps the leaves friendly to SIMD.  The rounding error
+  grows with log(n) rather than with n.
+
+  Calling Sequence: c = pairwiseDotProduct(aPtr,bPtr,n)
+
+  Inputs:
+
+    a - A pointer to the first vector.
+
+    b - A pointer to the second vector.
+
+    n - The number of elements in each vector.
+
+  Outputs:
+
+    c - The dot product of the two input vectors.
+
+*****************************************************************************/
+float NlmsNoiseCanceller::pairwiseDotProduct(float *aPtr,float *bPtr,int n)
+{
+  int i;
+  int half;
+  float sum0, sum1, sum2, sum3;
+  float result;
+
+  if (n <= 32)
+  {
+    sum0 = 0;
+    sum1 = 0;
+    sum2 = 0;
+    sum3 = 0;
+
+    for (i = 0; i <= (n - 4); i += 4)
+    {
+      sum0 += aPtr[i] * bPtr[i];
+      sum1 += aPtr[i+1] * bPtr[i+1];
+      sum2 += aPtr[i+2] * bPtr[i+2];
+      sum3 += aPtr[i+3] * bPtr[i+3];
+    } // for
+
+    for (; i < n; i++)
+    {
+      sum0 += aPtr[i] * bPtr[i];
+    } // for
+
+    result = (sum0 + sum1) + (sum2 + sum3);
+  } // if
+  else
+  {
+    // Split on a multiple of 4 so that leaves have no remainders.
+    half = (n / 2) & ~3;
+
+    result = pairwiseDotProduct(aPtr,bPtr,half) +
+             pairwiseDotProduct(&aPtr[half],&bPtr[half],n - half);
+  } // else
+
+  return (result);
+
+} // pairwiseDotProduct
+
+/*****************************************************************************
+
+  Name: kahanDotProduct
+
+  Purpose: The purpose of this function is to compute the dot product
+  between two vectors using compensated (Kahan) summation.  The low
+  order bits that are lost in each addition are carried forward in a
+  compensation term.
+
+  Calling Sequence: c = kahanDotProduct(aPtr,bPtr,n)
+
+  Inputs:
+
+    a - A pointer to the first vector.
+
+    b - A pointer to the second vector.
+
+    n - The number of elements in each vector.
+
+  Outputs:
+
+    c - The dot product of the two input vectors.
+
+*****************************************************************************/
+float NlmsNoiseCanceller::kahanDotProduct(float *aPtr,float *bPtr,int n)
+{
+  int i;
+  float sum;
+  float compensation;
+  float y, t;
+
+  // Start out with a zero sum.
+  sum = 0;
+  compensation = 0;
+
+  for (i = 0; i < n; i++)
+  {
+    y = (aPtr[i] * bPtr[i]) - compensation;
+    t = sum + y;
+    compensation = (t - sum) - y;
+    sum = t;
+  } // for
+
+  return (sum);
+
+} // kahanDotProduct
+
+/*****************************************************************************
+
+  Name: doubleDotProduct
+
+  Purpose: The purpose of this function is to compute the dot product
+  between two float vectors with a double precision accumulator.
+
+  Calling Sequence: c = doubleDotProduct(aPtr,bPtr,n)
+
+  Inputs:
+
+    a - A pointer to the first vector.
+
+    b - A pointer to the second vector.
+
+    n - The number of elements in each vector.
+
+  Outputs:
+
+    c - The dot product of the two input vectors.
+
+*****************************************************************************/
+float NlmsNoiseCanceller::doubleDotProduct(float *aPtr,float *bPtr,int n)
+{
+  int i;
+  double result;
+
+  // Start out with a zero sum.
+  result = 0;
+
+  for (i = 0; i < n; i++)
+  {
+    result = result + ((double)aPtr[i] * (double)bPtr[i]);
+  } // for
+
+  return ((float)result);
+
+} // doubleDotProduct
+
+/*****************************************************************************
+
+  Name: updateCoefficients
+
+  Purpose: The purpose of this function is to perform the NLMS
+  coefficient update, w(k) = w(k) + (beta / den) * e * x(n - k).  In
+  Kahan mode, the part of each increment that is lost to rounding is
+  saved and applied with the next update.  In double mode, the step is
+  computed in double precision.
+
+  Calling Sequence: updateCoefficients(e,den)
+
+  Inputs:
+
+    e - The error.
+
+    den - The normalizing denominator.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::updateCoefficients(float e,float den)
+{
+  int i;
+  float *w;
+  float *c;
+  float step;
+  float y, t;
+
+  // Reference filter coefficients.
+  w = coefficientStoragePtr;
+
+  switch (accumulationMode)
+  {
+    case ACCUMULATE_KAHAN:
+    {
+      c = compensationPtr;
+      step = (stepSize / den) * e;
+
+      for (i = 0; i < filterLength; i++)
+      {
+        y = (step * filterStatePtr[i]) - c[i];
+        t = w[i] + y;
+        c[i] = (t - w[i]) - y;
+        w[i] = t;
+      } // for
+      break;
+    } // case
+
+    case ACCUMULATE_DOUBLE:
+    {
+      step = (float)(((double)stepSize / (double)den) * (double)e);
+
+      for (i = 0; i < filterLength; i++)
+      {
+        w[i] = w[i] + (step * filterStatePtr[i]);
+      } // for
+      break;
+    } // case
+
+    default:
+    {
+      for (i = 0; i < filterLength; i++)
+      {
+        w[i] = w[i] + ((stepSize / den) * e * filterStatePtr[i]);
+      } // for
+      break;
+    } // case
+  } // switch
+
+  return;
+
+} // updateCoefficients
+
+/*****************************************************************************
+
+  Name: filterData
+
+  Purpose: The purpose of this function is to filter one sample of data
+  for the purpose of removing noise from a signal.  Here's how it works.
+  A reference signal is formed by delaying the input signal by a specified
+  number of samples.  The idea here is that the noise portion of the
+  delayed signal is uncorrelated with the nondelayed input signal.  This
+  way, the adaptive filter of the noise canceller will provide an
+  estimate of the desired signal as its output.
+
+  Calling Sequence: dHat = filterData(x)
+
+  Inputs:
+
+    x - The data sample to filter.
+
+  Outputs:
+
+    dHat - The output value of the filter.  This is an estimate of a
+    noise-reduced sample.
+
+*****************************************************************************/
+float NlmsNoiseCanceller::filterData(float x)
+{
+  float dHat;
+  float d;
+
+  x = addDither(x);
+
+  if (tapLayout == TAPS_INTERLEAVED)
+  {
+    // Compute reference sample, and filter in the interleaved layout.
+    d = delayLinePtr->filterData(x);
+    dHat = filterDataInterleaved(x,d);
+
+    return (dHat);
+  } // if
+
+  // Place the sample into the state memory.
+  shiftSampleIntoPipeline(x);
+
+  // Compute reference sample.
+  d = delayLinePtr->filterData(x);
+
+  // Filter the state, and adapt the coefficients.
+  dHat = adaptSample(d);
+
+  return (dHat);
+
+} // filterData
+
+/*****************************************************************************
+
+  Name: filterDataDual
+
+  Purpose: The purpose of this function is to filter one sample of data
+  in dual-input mode.  The primary input, d, holds the signal plus the
+  noise, and the reference input, x, holds noise that is correlated
+  with the noise of the primary input but not with the signal.  The
+  reference is shifted into the filter state, the delay line is not
+  used, and the filter learns the path from the reference to the noise
+  of the primary input.  Since only the noise can be predicted from the
+  reference, the error, d - dHat, is the noise-reduced sample.
+
+  Calling Sequence: e = filterDataDual(d,x)
+
+  Inputs:
+
+    d - The primary sample.
+
+    x - The reference sample.
+
+  Outputs:
+
+    e - The primary sample with the estimate of its noise removed.
+
+*****************************************************************************/
+float NlmsNoiseCanceller::filterDataDual(float d,float x)
+{
+  float e;
+
+  x = addDither(x);
+
+  if (tapLayout == TAPS_INTERLEAVED)
+  {
+    e = d - filterDataInterleaved(x,d);
+
+    return (e);
+  } // if
+
+  // Place the reference sample into the state memory.
+  shiftSampleIntoPipeline(x);
+
+  // Remove the estimate of the noise from the primary sample.
+  e = d - adaptSample(d);
+
+  return (e);
+
+} // filterDataDual
+
+/*****************************************************************************
+
+  Name: adaptSample
+
+  Purpose: The purpose of this function is to filter the filter state
+  and to update the coefficients so that the output of the filter
+  approaches the desired sample.  The caller has already shifted the
+  current input sample into the filter state.
+
+  Calling Sequence: dHat = adaptSample(d)
+
+  Inputs:
+
+    d - The desired sample.
+
+  Outputs:
+
+    dHat - The output value of the filter.
+
+*****************************************************************************/
+float NlmsNoiseCanceller::adaptSample(float d)
+{
+  float dHat;
+  float *w;
+  float den;
+  float e;
+
+  // Reference filter coefficients.
+  w = coefficientStoragePtr;
+
+  if (proportionateUpdate)
+  {
+    return (filterDataProportionate(d));
+  } // if
+
+  // Compute noise-reduced sample.
+  dHat = dotProduct(w,filterStatePtr,filterLength);
+
+  // Compute the error.
+  e = d - dHat;
+
+  if (variableStepSize)
+  {
+    updateStepSize(e);
+  } // if
+
+  // Compute the normalizing denominator.
+  den = dotProduct(filterStatePtr,filterStatePtr,filterLength);
+  den += 0.0001;
+
+  // Update the filter coefficients.
+  updateCoefficients(e,den);
+
+  if (automaticFreeze)
+  {
+    trackErrorPower(e);
+  } // if
+
+  return (dHat);
+
+} // adaptSample
+
+/*****************************************************************************
+
+  Name: getTapGroupStride
+
+  Purpose: The purpose of this function is to compute the number of
+  bytes from one group of the interleaved layout to the next.  A group
+  holds TAP_GROUP_SIZE float state values followed by TAP_GROUP_SIZE
+  weights in the weight format.
+
+  Calling Sequence: stride = getTapGroupStride()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    stride - The size of a group in bytes.
+
+*****************************************************************************/
+int NlmsNoiseCanceller::getTapGroupStride(void)
+{
+  int stride;
+
+  stride = TAP_GROUP_SIZE * sizeof(float);
+
+  if (weightFormat == WEIGHTS_FLOAT32)
+  {
+    stride += TAP_GROUP_SIZE * sizeof(float);
+  } // if
+  else
+  {
+    stride += TAP_GROUP_SIZE * sizeof(uint16_t);
+  } // else
+
+  return (stride);
+
+} // getTapGroupStride
+
+/*****************************************************************************
+
+  Name: packTaps
+
+  Purpose: The purpose of this function is to copy the separate
+  coefficients and filter state into the groups of the interleaved
+  layout.  The taps of the last group that lie beyond the filter length
+  are set to zero, so that every loop can run over whole groups.
+
+  Calling Sequence: packTaps()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::packTaps(void)
+{
+  int g, i, k;
+  int stride;
+  int numberOfGroups;
+  float *statePtr;
+  float w[TAP_GROUP_SIZE];
+
+  stride = getTapGroupStride();
+  numberOfGroups = (filterLength + TAP_GROUP_SIZE - 1) / TAP_GROUP_SIZE;
+
+  for (g = 0; g < numberOfGroups; g++)
+  {
+    statePtr = (float *)&tapGroupPtr[g * stride];
+
+    for (i = 0; i < TAP_GROUP_SIZE; i++)
+    {
+      k = (g * TAP_GROUP_SIZE) + i;
+
+      statePtr[i] = 0;
+      w[i] = 0;
+
+      if (k < filterLength)
+      {
+        statePtr[i] = filterStatePtr[k];
+        w[i] = coefficientStoragePtr[k];
+      } // if
+    } // for
+
+    encodeWeights(w,(uint8_t *)&statePtr[TAP_GROUP_SIZE]);
+  } // for
+
+  return;
+
+} // packTaps
+
+/*****************************************************************************
+
+  Name: unpackTaps
+
+  Purpose: The purpose of this function is to copy the groups of the
+  interleaved layout back into the separate coefficients and filter
+  state.
+
+  Calling Sequence: unpackTaps()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::unpackTaps(void)
+{
+  int g, i, k;
+  int stride;
+  int numberOfGroups;
+  float *statePtr;
+  float w[TAP_GROUP_SIZE];
+
+  stride = getTapGroupStride();
+  numberOfGroups = (filterLength + TAP_GROUP_SIZE - 1) / TAP_GROUP_SIZE;
+
+  for (g = 0; g < numberOfGroups; g++)
+  {
+    statePtr = (float *)&tapGroupPtr[g * stride];
+
+    decodeWeights((uint8_t *)&statePtr[TAP_GROUP_SIZE],w);
+
+    for (i = 0; i < TAP_GROUP_SIZE; i++)
+    {
+      k = (g * TAP_GROUP_SIZE) + i;
+
+      if (k < filterLength)
+      {
+        filterStatePtr[k] = statePtr[i];
+        coefficientStoragePtr[k] = w[i];
+      } // if
+    } // for
+  } // for
+
+  return;
+
+} // unpackTaps
+
+/*****************************************************************************
+
+  Name: decodeWeights
+
+  Purpose: The purpose of this function is to convert the weights of one
+  group of the interleaved layout to float.
+
+  Calling Sequence: decodeWeights(weightsPtr,wPtr)
+
+  Inputs:
+
+    weightsPtr - A pointer to the weights of the group.
+
+    wPtr - A pointer to storage for TAP_GROUP_SIZE float weights.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::decodeWeights(uint8_t *weightsPtr,float *wPtr)
+{
+  int i;
+  uint16_t *compactPtr;
+
+  compactPtr = (uint16_t *)weightsPtr;
+
+  switch (weightFormat)
+  {
+    case WEIGHTS_BFLOAT16:
+    {
+      for (i = 0; i < TAP_GROUP_SIZE; i++)
+      {
+        wPtr[i] = decodeBfloat16(compactPtr[i]);
+      } // for
+      break;
+    } // case
+
+    case WEIGHTS_FLOAT16:
+    {
+#ifdef __F16C__
+      // The conversion instruction gives the same results.
+      for (i = 0; i < TAP_GROUP_SIZE; i += 4)
+      {
+        _mm_storeu_ps(&wPtr[i],
+                      _mm_cvtph_ps(_mm_loadl_epi64((__m128i *)
+                                                   &compactPtr[i])));
+      } // for
+#else
+      for (i = 0; i < TAP_GROUP_SIZE; i++)
+      {
+        wPtr[i] = decodeFloat16(compactPtr[i]);
+      } // for
+#endif
+      break;
+    } // case
+
+    default:
+    {
+      memcpy(wPtr,weightsPtr,TAP_GROUP_SIZE * sizeof(float));
+      break;
+    } // case
+  } // switch
+
+  return;
+
+} // decodeWeights
+
+/*****************************************************************************
+
+  Name: encodeWeights
+
+  Purpose: The purpose of this function is to store the float weights of
+  one group of the interleaved layout in the weight format.
+
+  Calling Sequence: encodeWeights(wPtr,weightsPtr)
+
+  Inputs:
+
+    wPtr - A pointer to TAP_GROUP_SIZE float weights.
+
+    weightsPtr - A pointer to the weights of the group.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::encodeWeights(float *wPtr,uint8_t *weightsPtr)
+{
+  int i;
+  uint16_t *compactPtr;
+
+  compactPtr = (uint16_t *)weightsPtr;
+
+  switch (weightFormat)
+  {
+    case WEIGHTS_BFLOAT16:
+    {
+      for (i = 0; i < TAP_GROUP_SIZE; i++)
+      {
+        compactPtr[i] = encodeBfloat16(wPtr[i]);
+      } // for
+      break;
+    } // case
+
+    case WEIGHTS_FLOAT16:
+    {
+#ifdef __F16C__
+      // The conversion instruction gives the same results.
+      for (i = 0; i < TAP_GROUP_SIZE; i += 4)
+      {
+        _mm_storel_epi64((__m128i *)&compactPtr[i],
+                         _mm_cvtps_ph(_mm_loadu_ps(&wPtr[i]),
+                                      _MM_FROUND_TO_NEAREST_INT));
+      } // for
+#else
+      for (i = 0; i < TAP_GROUP_SIZE; i++)
+      {
+        compactPtr[i] = encodeFloat16(wPtr[i]);
+      } // for
+#endif
+      break;
+    } // case
+
+    default:
+    {
+      memcpy(weightsPtr,wPtr,TAP_GROUP_SIZE * sizeof(float));
+      break;
+    } // case
+  } // switch
+
+  return;
+
+} // encodeWeights
+
+/*****************************************************************************
+
+  Name: filterDataInterleaved
+
+  Purpose: The purpose of this function is to filter one sample in the
+  interleaved layout, and to update the weights.  The groups are
+  visited from the oldest to the newest.  Each group is shifted by one
+  tap, taking in the oldest sample of the next newer group, which
+  hasn't been shifted yet, and its contribution to the output and to
+  the energy of the state is accumulated in one sum per lane, so the
+  lanes vectorize.  A second pass applies the update.  Since the sums
+  are formed in a different order, the results differ from those of
+  the separate layout by rounding.
+
+  Calling Sequence: dHat = filterDataInterleaved(x,d)
+
+  Inputs:
+
+    x - The input sample, which is shifted into the filter state.
+
+    d - The desired sample.
+
+  Outputs:
+
+    dHat - The output value of the filter.
+
+*****************************************************************************/
+float NlmsNoiseCanceller::filterDataInterleaved(float x,float d)
+{
+  int g, i;
+  int stride;
+  int numberOfGroups;
+  int tailLength;
+  float dHat;
+  float den;
+  float e;
+  float gain;
+  float carry;
+  float *statePtr;
+  float *wPtr;
+  float w[TAP_GROUP_SIZE];
+  float outputLanes[TAP_GROUP_SIZE];
+  float energyLanes[TAP_GROUP_SIZE];
+
+  stride = getTapGroupStride();
+  numberOfGroups = (filterLength + TAP_GROUP_SIZE - 1) / TAP_GROUP_SIZE;
+
+  // The number of taps of the last group that are in use.
+  tailLength = filterLength - ((numberOfGroups - 1) * TAP_GROUP_SIZE);
+
+  for (i = 0; i < TAP_GROUP_SIZE; i++)
+  {
+    outputLanes[i] = 0;
+    energyLanes[i] = 0;
+  } // for
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Shift, filter, and measure the energy in one pass.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  for (g = numberOfGroups - 1; g >= 0; g--)
+  {
+    statePtr = (float *)&tapGroupPtr[g * stride];
+
+    if (g > 0)
+    {
+      // The oldest sample of the next newer group moves into this one.
+      carry = ((float *)&tapGroupPtr[(g - 1) * stride])[TAP_GROUP_SIZE - 1];
+    } // if
+    else
+    {
+      carry = x;
+    } // else
+
+    memmove(&statePtr[1],&statePtr[0],(TAP_GROUP_SIZE - 1) * sizeof(float));
+    statePtr[0] = carry;
+
+    if (g == (numberOfGroups - 1))
+    {
+      // Taps beyond the filter length stay zero.
+      for (i = tailLength; i < TAP_GROUP_SIZE; i++)
+      {
+        statePtr[i] = 0;
+      } // for
+    } // if
+
+    if (weightFormat == WEIGHTS_FLOAT32)
+    {
+      wPtr = &statePtr[TAP_GROUP_SIZE];
+    } // if
+    else
+    {
+      decodeWeights((uint8_t *)&statePtr[TAP_GROUP_SIZE],w);
+      wPtr = w;
+    } // else
+
+    for (i = 0; i < TAP_GROUP_SIZE; i++)
+    {
+      outputLanes[i] += wPtr[i] * statePtr[i];
+      energyLanes[i] += statePtr[i] * statePtr[i];
+    } // for
+  } // for
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  // Reduce the lanes.
+  dHat = 0;
+  den = 0;
+
+  for (i = 0; i < TAP_GROUP_SIZE; i++)
+  {
+    dHat += outputLanes[i];
+    den += energyLanes[i];
+  } // for
+
+  // Compute the error.
+  e = d - dHat;
+
+  if (variableStepSize)
+  {
+    updateStepSize(e);
+  } // if
+
+  den += 0.0001;
+  gain = (stepSize / den) * e;
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Update the weights in a second pass.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  for (g = 0; g < numberOfGroups; g++)
+  {
+    statePtr = (float *)&tapGroupPtr[g * stride];
+
+    if (weightFormat == WEIGHTS_FLOAT32)
+    {
+      wPtr = &statePtr[TAP_GROUP_SIZE];
+
+      for (i = 0; i < TAP_GROUP_SIZE; i++)
+      {
+        wPtr[i] += gain * statePtr[i];
+      } // for
+    } // if
+    else
+    {
+      decodeWeights((uint8_t *)&statePtr[TAP_GROUP_SIZE],w);
+
+      for (i = 0; i < TAP_GROUP_SIZE; i++)
+      {
+        w[i] += gain * statePtr[i];
+      } // for
+
+      encodeWeights(w,(uint8_t *)&statePtr[TAP_GROUP_SIZE]);
+    } // else
+  } // for
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  if (automaticFreeze)
+  {
+    trackErrorPower(e);
+  } // if
+
+  return (dHat);
+
+} // filterDataInterleaved
+
+/*****************************************************************************
+
+  Name: encodeBfloat16
+
+  Purpose: The purpose of this function is to convert a float to a
+  bfloat16 value, which is the upper half of the float, rounded to the
+  nearest value (ties to even).
+
+  Calling Sequence: result = encodeBfloat16(value)
+
+  Inputs:
+
+    value - The value to convert.
+
+  Outputs:
+
+    result - The bfloat16 value.
+
+*****************************************************************************/
+uint16_t NlmsNoiseCanceller::encodeBfloat16(float value)
+{
+  uint32_t bits;
+
+  memcpy(&bits,&value,sizeof(bits));
+
+  // Round to nearest, ties to even.
+  bits += 0x7fff + ((bits >> 16) & 1);
+
+  return ((uint16_t)(bits >> 16));
+
+} // encodeBfloat16
+
+/*****************************************************************************
+
+  Name: decodeBfloat16
+
+  Purpose: The purpose of this function is to convert a bfloat16 value
+  to a float.
+
+  Calling Sequence: result = decodeBfloat16(value)
+
+  Inputs:
+
+    value - The bfloat16 value.
+
+  Outputs:
+
+    result - The float value.
+
+*****************************************************************************/
+float NlmsNoiseCanceller::decodeBfloat16(uint16_t value)
+{
+  uint32_t bits;
+  float result;
+
+  bits = (uint32_t)value << 16;
+  memcpy(&result,&bits,sizeof(result));
+
+  return (result);
+
+} // decodeBfloat16
+
+/*****************************************************************************
+
+  Name: encodeFloat16
+
+  Purpose: The purpose of this function is to convert a float to an IEEE
+  half precision value, rounded to the nearest value (ties to even).
+  Values beyond the range of a half become infinities, and small values
+  become subnormal halves.  Subnormal results are rounded by adding a
+  constant that aligns the binary point, so the floating point adder
+  does the rounding.
+
+  Calling Sequence: result = encodeFloat16(value)
+
+  Inputs:
+
+    value - The value to convert.
+
+  Outputs:
+
+    result - The half precision value.
+
+*****************************************************************************/
+uint16_t NlmsNoiseCanceller::encodeFloat16(float value)
+{
+  uint32_t bits;
+  uint32_t sign;
+  uint32_t result;
+  float alignment;
+  float sum;
+
+  memcpy(&bits,&value,sizeof(bits));
+
+  sign = (bits >> 16) & 0x8000;
+  bits &= 0x7fffffff;
+
+  if (bits >= 0x47800000)
+  {
+    // Too large for a half (or not a number).
+    result = (bits > 0x7f800000) ? 0x7e00 : 0x7c00;
+  } // if
+  else if (bits < 0x38800000)
+  {
+    // The result is subnormal (or zero).  Adding 0.5 leaves the half
+    // mantissa in the low bits of the sum, rounded to the nearest.
+    alignment = 0.5f;
+    memcpy(&sum,&bits,sizeof(sum));
+    sum += alignment;
+    memcpy(&result,&sum,sizeof(result));
+    result -= 0x3f000000;
+  } // else if
+  else
+  {
+    // Rebias the exponent, and round to nearest, ties to even.
+    result = bits + 0xc8000fff + ((bits >> 13) & 1);
+    result >>= 13;
+  } // else
+
+  return ((uint16_t)(result | sign));
+
+} // encodeFloat16
+
+/*****************************************************************************
+
+  Name: decodeFloat16
+
+  Purpose: The purpose of this function is to convert an IEEE half
+  precision value to a float.
+
+  Calling Sequence: result = decodeFloat16(value)
+
+  Inputs:
+
+    value - The half precision value.
+
+  Outputs:
+
+    result - The float value.
+
+*****************************************************************************/
+float NlmsNoiseCanceller::decodeFloat16(uint16_t value)
+{
+  uint32_t bits;
+  uint32_t exponent;
+  float result;
+
+  bits = (uint32_t)(value & 0x7fff) << 13;
+  exponent = bits & 0x0f800000;
+
+  // Rebias the exponent.
+  bits += 0x38000000;
+
+  if (exponent == 0x0f800000)
+  {
+    // Infinities and not a number keep the largest exponent.
+    bits += 0x38000000;
+    memcpy(&result,&bits,sizeof(result));
+  } // if
+  else if (exponent == 0)
+  {
+    // A subnormal half is normalized by the floating point unit.
+    bits += 0x00800000;
+    memcpy(&result,&bits,sizeof(result));
+    result -= 6.103515625e-05f;
+  } // else if
+  else
+  {
+    memcpy(&result,&bits,sizeof(result));
+  } // else
+
+  if (value & 0x8000)
+  {
+    result = -result;
+  } // if
+
+  return (result);
+
+} // decodeFloat16
+
+/*****************************************************************************
+
+  Name: addDither
+
+  Purpose: The purpose of this function is to add dither to an input
+  sample, if a dither level has been set.
+
+  Calling Sequence: y = addDither(x)
+
+  Inputs:
+
+    x - The input sample.
+
+  Outputs:
+
+    y - The input sample with dither added.
+
+*****************************************************************************/
+float NlmsNoiseCanceller::addDither(float x)
+{
+
+  if (ditherLevel != 0)
+  {
+    // Advance the dither generator (a linear congruential generator).
+    ditherState = (ditherState * 1664525) + 1013904223;
+
+    // Add uniform dither in the range of [-ditherLevel,ditherLevel).
+    x = x + ((float)(int32_t)ditherState * (ditherLevel / 2147483648.0f));
+  } // if
+
+  return (x);
+
+} // addDither
+
+/*****************************************************************************
+
+  Name: trackErrorPower
+
+  Purpose: The purpose of this function is to accumulate the error power
+  of the current window, and to evaluate it once the window is full.
+
+  Calling Sequence: trackErrorPower(e)
+
+  Inputs:
+
+    e - The error of the current sample.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::trackErrorPower(float e)
+{
+
+  windowEnergy += e * e;
+  windowCounter++;
+
+  if (windowCounter == FREEZE_WINDOW)
+  {
+    evaluateErrorPower();
+  } // if
+
+  return;
+
+} // trackErrorPower
+
+/*****************************************************************************
+
+  Name: evaluateErrorPower
+
+  Purpose: The purpose of this function is to decide, from the error
+  power of a full window, whether to freeze the coefficients or to
+  resume adaptation.  See setAutomaticFreeze() for a description of the
+  policy.  A new window is then started.
+
+  Calling Sequence: evaluateErrorPower()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::evaluateErrorPower(void)
+{
+  float power;
+
+  power = windowEnergy / FREEZE_WINDOW;
+
+  // Start a new window.
+  windowEnergy = 0;
+  windowCounter = 0;
+
+  if (frozen)
+  {
+    if (frozenPower == 0)
+    {
+      // This is the first window after a manual freeze.
+      frozenPower = power;
+    } // if
+    else
+    {
+      if (automaticFreeze && (power > (frozenPower * RESUME_RATIO)))
+      {
+        // The noise has changed, so adapt again.
+        leaveFrozenState();
+      } // if
+    } // else
+  } // if
+  else
+  {
+    if (fabsf(power - previousWindowPower) <=
+        (freezeTolerance * previousWindowPower))
+    {
+      stableWindows++;
+    } // if
+    else
+    {
+      stableWindows = 0;
+    } // else
+
+    previousWindowPower = power;
+
+    if (automaticFreeze && (stableWindows >= STABLE_WINDOWS))
+    {
+      enterFrozenState();
+      frozenPower = power;
+    } // if
+  } // else
+
+  return;
+
+} // evaluateErrorPower
+
+/*****************************************************************************
+
+  Name: enterFrozenState
+
+  Purpose: The purpose of this function is to freeze the coefficients.
+  The filter state is copied into the input history of the frozen path,
+  in time order.
+
+  Calling Sequence: enterFrozenState()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::enterFrozenState(void)
+{
+  int k;
+
+  // The frozen path uses the separate coefficients.
+  if (tapLayout == TAPS_INTERLEAVED)
+  {
+    unpackTaps();
+  } // if
+
+  for (k = 0; k < filterLength; k++)
+  {
+    frozenHistoryPtr[filterLength - 1 - k] = filterStatePtr[k];
+  } // for
+
+  frozen = true;
+
+  return;
+
+} // enterFrozenState
+
+/*****************************************************************************
+
+  Name: leaveFrozenState
+
+  Purpose: The purpose of this function is to resume adaptation.  The
+  input history of the frozen path is copied back into the filter
+  state, so the update continues from where the frozen path stopped.
+
+  Calling Sequence: leaveFrozenState()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::leaveFrozenState(void)
+{
+  int k;
+
+  for (k = 0; k < filterLength; k++)
+  {
+    filterStatePtr[k] = frozenHistoryPtr[filterLength - 1 - k];
+  } // for
+
+  if (tapLayout == TAPS_INTERLEAVED)
+  {
+    packTaps();
+  } // if
+
+  frozen = false;
+  stableWindows = 0;
+
+  return;
+
+} // leaveFrozenState
+
+/*****************************************************************************
+
+  Name: getFrozenBlockCount
+
+  Purpose: The purpose of this function is to compute the number of
+  samples that the frozen path may filter in one block.  A block never
+  crosses the end of an error power window, so a change of state takes
+  effect on the next sample.
+
+  Calling Sequence: count = getFrozenBlockCount(remaining)
+
+  Inputs:
+
+    remaining - The number of samples that are left to filter.
+
+  Outputs:
+
+    count - The number of samples of the next block.
+
+*****************************************************************************/
+uint32_t NlmsNoiseCanceller::getFrozenBlockCount(uint32_t remaining)
+{
+  uint32_t count;
+
+  count = FROZEN_BLOCK_SIZE;
+
+  if (remaining < count)
+  {
+    count = remaining;
+  } // if
+
+  if ((uint32_t)(FREEZE_WINDOW - windowCounter) < count)
+  {
+    count = FREEZE_WINDOW - windowCounter;
+  } // if
+
+  return (count);
+
+} // getFrozenBlockCount
+
+/*****************************************************************************
+
+  Name: filterBlockFrozen
+
+  Purpose: The purpose of this function is to filter a block of samples
+  with the frozen coefficients.  The input history holds the last
+  filterLength samples in time order, followed by the block, so the
+  output is a block convolution,
+
+    y(n + i) = sum over k of w(k) x(n + i - k),
+
+  that is computed one tap at a time across the whole block.  The inner
+  loop has no dependence from one sample to the next, so the compiler
+  can vectorize it, and each output is summed in the same order as
+  dotProduct().  The error power is still tracked, so that adaptation
+  can resume when the noise changes.  In dual-input mode, the block
+  holds reference samples, the desired samples are taken from the
+  primary input rather than from the delay line, and the output is the
+  error.  The input, primary, and output buffers may be the same.
+
+  Calling Sequence: filterBlockFrozen(bufferPtr,primaryPtr,count,
+                                      outputBufferPtr)
+
+  Inputs:
+
+    bufferPtr - A pointer to the input samples.
+
+    primaryPtr - A pointer to the primary samples in dual-input mode,
+    or NULL.
+
+    count - The number of samples, no more than FROZEN_BLOCK_SIZE.
+
+    outputBufferPtr - A pointer to storage for the processed samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::filterBlockFrozen(float *bufferPtr,
+                                           float *primaryPtr,
+                                           int count,
+                                           float *outputBufferPtr)
+{
+  int i, k;
+  float c;
+  float e;
+  float *h;
+  float *w;
+  float *xPtr;
+  float d[FROZEN_BLOCK_SIZE];
+
+  // Reference filter coefficients and input history.
+  w = coefficientStoragePtr;
+  h = frozenHistoryPtr;
+
+  // Append the block to the history, and form the reference samples.
+  for (i = 0; i < count; i++)
+  {
+    h[filterLength + i] = addDither(bufferPtr[i]);
+
+    if (primaryPtr != NULL)
+    {
+      d[i] = primaryPtr[i];
+    } // if
+    else
+    {
+      d[i] = delayLinePtr->delayData(h[filterLength + i]);
+    } // else
+  } // for
+
+  // Clear the accumulators.
+  for (i = 0; i < count; i++)
+  {
+    outputBufferPtr[i] = 0;
+  } // for
+
+  // Perform the block convolution, one tap at a time.
+  for (k = 0; k < filterLength; k++)
+  {
+    c = w[k];
+    xPtr = &h[filterLength - k];
+
+    for (i = 0; i < count; i++)
+    {
+      outputBufferPtr[i] = outputBufferPtr[i] + (c * xPtr[i]);
+    } // for
+  } // for
+
+  // Accumulate the error power of the block.
+  for (i = 0; i < count; i++)
+  {
+    e = d[i] - outputBufferPtr[i];
+    windowEnergy += e * e;
+
+    if (primaryPtr != NULL)
+    {
+      // The error is the output in dual-input mode.
+      outputBufferPtr[i] = e;
+    } // if
+  } // for
+
+  windowCounter += count;
+
+  if (windowCounter == FREEZE_WINDOW)
+  {
+    evaluateErrorPower();
+  } // if
+
+  // Keep the last filterLength samples for the next block.
+  memmove(h,&h[count],filterLength * sizeof(float));
+
+  return;
+
+} // filterBlockFrozen
+
+
+/*****************************************************************************
+
+  Name: updateStepSize
+
+  Purpose: The purpose of this function is to adapt the step size from
+  the error statistics.  See setVariableStepSize() for a description of
+  the policy.  Only scalars are involved, so the cost doesn't depend
+  on the filter length.
+
+  Calling Sequence: updateStepSize(e)
+
+  Inputs:
+
+    e - The error of the current sample.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::updateStepSize(float e)
+{
+  float r;
+
+  // Update the smoothed error correlation and error power.
+  errorCorrelation = (VSS_SMOOTHING * errorCorrelation) +
+                     ((1 - VSS_SMOOTHING) * e * previousError);
+  errorPower = (VSS_SMOOTHING * errorPower) +
+               ((1 - VSS_SMOOTHING) * e * e);
+
+  previousError = e;
+
+  // Compute the squared correlation coefficient.
+  r = 0;
+
+  if (errorPower > 0)
+  {
+    r = errorCorrelation / errorPower;
+    r = r * r;
+
+    if (r > 1)
+    {
+      r = 1;
+    } // if
+  } // if
+
+  // Move the step size toward its target.
+  stepSize = (VSS_SMOOTHING * stepSize) +
+             ((1 - VSS_SMOOTHING) * (betaMin + ((beta - betaMin) * r)));
+
+  return;
+
+} // updateStepSize
+
+/*****************************************************************************
+
+  Name: filterDataProportionate
+
+  Purpose: The purpose of this function is to perform the adaptive
+  filtering function with the IPNLMS update.  The sample has already
+  been shifted into the pipeline.  The gains are computed from the
+  coefficients before they are updated, and the norm of each segment
+  is refreshed as the segment is updated, so the L1 norm of the
+  filter costs only one addition per segment.
+
+  Calling Sequence: dHat = filterDataProportionate(d)
+
+  Inputs:
+
+    d - The reference sample.
+
+  Outputs:
+
+    dHat - The output value of the filter.
+
+*****************************************************************************/
+float NlmsNoiseCanceller::filterDataProportionate(float d)
+{
+  int i;
+  int segment;
+  int numberOfSegments;
+  int last;
+  bool probe;
+  float dHat;
+  float *w;
+  float *x;
+  float e;
+  float x2;
+  float energy;
+  float weightedEnergy;
+  float norm;
+  float a, b;
+  float den;
+  float step;
+  float magnitude;
+
+  // Reference filter coefficients and state.
+  w = coefficientStoragePtr;
+  x = filterStatePtr;
+
+  numberOfSegments = (filterLength + SEGMENT_SIZE - 1) / SEGMENT_SIZE;
+
+  // Compute noise-reduced sample.
+  dHat = dotProduct(w,x,filterLength);
+
+  // Compute the error.
+  e = d - dHat;
+
+  if (variableStepSize)
+  {
+    updateStepSize(e);
+  } // if
+
+  // Compute the energy and the energy weighted by the tap magnitudes.
+  energy = 0;
+  weightedEnergy = 0;
+
+  for (i = 0; i < filterLength; i++)
+  {
+    x2 = x[i] * x[i];
+    energy += x2;
+    weightedEnergy += fabsf(w[i]) * x2;
+  } // for
+
+  // Compute the L1 norm of the coefficients.
+  norm = 0;
+
+  for (segment = 0; segment < numberOfSegments; segment++)
+  {
+    norm += segmentNormPtr[segment];
+  } // for
+
+  // The gain of tap k is a + b|w(k)|.
+  a = (1 - alpha) / (2 * filterLength);
+  b = (1 + alpha) / ((2 * norm) + 1e-6f);
+
+  // Compute the normalizing denominator, sum of g(k) * x(n - k)^2.
+  den = (a * (energy + 0.0001f)) + (b * weightedEnergy);
+
+  step = (stepSize / den) * e;
+
+  // Inactive segments are updated on probe samples.
+  probe = (probeCounter == 0);
+
+  probeCounter++;
+  if (probeCounter == PROBE_PERIOD)
+  {
+    probeCounter = 0;
+  } // if
+
+  for (segment = 0; segment < numberOfSegments; segment++)
+  {
+    if (segmentActivePtr[segment] || probe)
+    {
+      last = (segment + 1) * SEGMENT_SIZE;
+      if (last > filterLength)
+      {
+        last = filterLength;
+      } // if
+
+      norm = 0;
+
+      for (i = segment * SEGMENT_SIZE; i < last; i++)
+      {
+        magnitude = fabsf(w[i]);
+        w[i] = w[i] + (step * (a + (b * magnitude)) * x[i]);
+        norm += fabsf(w[i]);
+      } // for
+
+      segmentNormPtr[segment] = norm;
+    } // if
+  } // for
+
+  if (activeTapThreshold != 0)
+  {
+    maskCounter++;
+    if (maskCounter == MASK_INTERVAL)
+    {
+      maskCounter = 0;
+      updateActiveTapMask();
+    } // if
+  } // if
+
+  if (automaticFreeze)
+  {
+    trackErrorPower(e);
+  } // if
+
+  return (dHat);
+
+} // filterDataProportionate
+
+/*****************************************************************************
+
+  Name: updateActiveTapMask
+
+  Purpose: The purpose of this function is to mark each segment of taps
+  as active or inactive.  A segment is active when its largest tap
+  magnitude is at least activeTapThreshold times the largest tap
+  magnitude of the filter.  The taps of inactive segments are set to
+  zero.
+
+  Calling Sequence: updateActiveTapMask()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NlmsNoiseCanceller::updateActiveTapMask(void)
+{
+  int i;
+  int segment;
+  int numberOfSegments;
+  int last;
+  float peak;
+  float segmentPeak;
+  float threshold;
+
+  numberOfSegments = (filterLength + SEGMENT_SIZE - 1) / SEGMENT_SIZE;
+
+  // Find the largest tap magnitude.
+  peak = 0;
+
+  for (i = 0; i < filterLength; i++)
+  {
+    if (fabsf(coefficientStoragePtr[i]) > peak)
+    {
+      peak = fabsf(coefficientStoragePtr[i]);
+    } // if
+  } // for
+
+  threshold = activeTapThreshold * peak;
+
+  for (segment = 0; segment < numberOfSegments; segment++)
+  {
+    last = (segment + 1) * SEGMENT_SIZE;
+    if (last > filterLength)
+    {
+      last = filterLength;
+    } // if
+
+    segmentPeak = 0;
+
+    for (i = segment * SEGMENT_SIZE; i < last; i++)
+    {
+      if (fabsf(coefficientStoragePtr[i]) > segmentPeak)
+      {
+        segmentPeak = fabsf(coefficientStoragePtr[i]);
+      } // if
+    } // for
+
+    // Until something has been learned, everything stays active.
+    segmentActivePtr[segment] = ((peak == 0) || (segmentPeak >= threshold));
+
+    if (!segmentActivePtr[segment])
+    {
+      // The taps have converged to zero, so drop what is left of the
+      // adaptation noise.  Probe updates can still bring them back.
+      for (i = segment * SEGMENT_SIZE; i < last; i++)
+      {
+        coefficientStoragePtr[i] = 0;
+      } // for
+
+      segmentNormPtr[segment] = 0;
+    } // if
+  } // for
+
+  return;
 
+} // updateActiveTapMask
@@ -0,0 +1,560 @@
+//************************************************************************
+// file name: PerformanceCounters.cc
+//************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "PerformanceCounters.h"
+
+using namespace std;
+
+static const char *eventNames[NUMBER_OF_EVENTS] =
+{
+  "cycles",
+  "instructions",
+  "L1D-misses",
+  "LLC-misses",
+  "branch-misses",
+  "task-clock-ns"
+};
+
+/*****************************************************************************
+
+  Name: PerformanceCounters
+
+  Purpose: The purpose of this function is to serve as the constructor for
+  an instance of a PerformanceCounters.  Each event is opened, and the
+  events that are supported form one group that counts continuously;
+  only the differences across each block are accumulated.
+
+  Calling Sequence: PerformanceCounters()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+PerformanceCounters::PerformanceCounters(void)
+{
+  int i;
+
+  leaderDescriptor = -1;
+  numberOfOpenEvents = 0;
+
+  for (i = 0; i < NUMBER_OF_EVENTS; i++)
+  {
+    descriptors[i] = -1;
+    groupIndex[i] = -1;
+  } // for
+
+  openEvent(EVENT_CYCLES,PERF_TYPE_HARDWARE,PERF_COUNT_HW_CPU_CYCLES);
+  openEvent(EVENT_INSTRUCTIONS,PERF_TYPE_HARDWARE,PERF_COUNT_HW_INSTRUCTIONS);
+
+  openEvent(EVENT_L1D_MISSES,
+            PERF_TYPE_HW_CACHE,
+            PERF_COUNT_HW_CACHE_L1D |
+            (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+
+  openEvent(EVENT_LLC_MISSES,PERF_TYPE_HARDWARE,PERF_COUNT_HW_CACHE_MISSES);
+  openEvent(EVENT_BRANCH_MISSES,
+            PERF_TYPE_HARDWARE,
+            PERF_COUNT_HW_BRANCH_MISSES);
+  openEvent(EVENT_TASK_CLOCK,PERF_TYPE_SOFTWARE,PERF_COUNT_SW_TASK_CLOCK);
+
+  if (leaderDescriptor != -1)
+  {
+    // Start the whole group at once.
+    ioctl(leaderDescriptor,PERF_EVENT_IOC_RESET,PERF_IOC_FLAG_GROUP);
+    ioctl(leaderDescriptor,PERF_EVENT_IOC_ENABLE,PERF_IOC_FLAG_GROUP);
+  } // if
+
+  reset();
+
+  return;
+
+} // PerformanceCounters
+
+/*****************************************************************************
+
+  Name: ~PerformanceCounters
+
+  Purpose: The purpose of this function is to serve as the destructor for
+  an instance of a PerformanceCounters.
+
+  Calling Sequence: ~PerformanceCounters()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+PerformanceCounters::~PerformanceCounters(void)
+{
+  int i;
+
+  // Close the members before the leader.
+  for (i = NUMBER_OF_EVENTS - 1; i >= 0; i--)
+  {
+    if (descriptors[i] != -1)
+    {
+      close(descriptors[i]);
+    } // if
+  } // for
+
+  return;
+
+} // ~PerformanceCounters
+
+/*****************************************************************************
+
+  Name: openEvent
+
+  Purpose: The purpose of this function is to open one event and add it
+  to the group.  The first event that opens becomes the leader.  The
+  group starts out disabled so that it can be started as a unit.  An
+  event that can't be opened is simply left out.
+
+  Calling Sequence: openEvent(event,type,config)
+
+  Inputs:
+
+    event - The event.
+
+    type - The perf_event type of the event.
+
+    config - The perf_event configuration of the event.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void PerformanceCounters::openEvent(PerformanceEvent event,
+                                    uint32_t type,
+                                    uint64_t config)
+{
+  int descriptor;
+  struct perf_event_attr attributes;
+
+  memset(&attributes,0,sizeof(attributes));
+  attributes.size = sizeof(attributes);
+  attributes.type = type;
+  attributes.config = config;
+  attributes.read_format = PERF_FORMAT_GROUP;
+
+  // Count only the user space work of this thread.
+  attributes.exclude_kernel = 1;
+  attributes.exclude_hv = 1;
+
+  if (leaderDescriptor == -1)
+  {
+    attributes.disabled = 1;
+  } // if
+
+  descriptor = syscall(__NR_perf_event_open,
+                       &attributes,
+                       0,
+                       -1,
+                       leaderDescriptor,
+                       0);
+
+  if (descriptor != -1)
+  {
+    if (leaderDescriptor == -1)
+    {
+      leaderDescriptor = descriptor;
+    } // if
+
+    descriptors[event] = descriptor;
+    groupIndex[event] = numberOfOpenEvents;
+    numberOfOpenEvents++;
+  } // if
+
+  return;
+
+} // openEvent
+
+/*****************************************************************************
+
+  Name: isAvailable
+
+  Purpose: The purpose of this function is to indicate whether any event
+  could be opened.
+
+  Calling Sequence: available = isAvailable()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    available - A flag that indicates whether events are counted.
+
+*****************************************************************************/
+bool PerformanceCounters::isAvailable(void)
+{
+
+  return (leaderDescriptor != -1);
+
+} // isAvailable
+
+/*****************************************************************************
+
+  Name: isSupported
+
+  Purpose: The purpose of this function is to indicate whether an event
+  is counted.
+
+  Calling Sequence: supported = isSupported(event)
+
+  Inputs:
+
+    event - The event.
+
+  Outputs:
+
+    supported - A flag that indicates whether the event is counted.
+
+*****************************************************************************/
+bool PerformanceCounters::isSupported(PerformanceEvent event)
+{
+
+  return (descriptors[event] != -1);
+
+} // isSupported
+
+/*****************************************************************************
+
+  Name: reset
+
+  Purpose: The purpose of this function is to discard the totals.
+
+  Calling Sequence: reset()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void PerformanceCounters::reset(void)
+{
+  int i;
+
+  for (i = 0; i < NUMBER_OF_EVENTS; i++)
+  {
+    startValues[i] = 0;
+    totals[i] = 0;
+  } // for
+
+  numberOfBlocks = 0;
+  numberOfSamples = 0;
+  started = false;
+
+  return;
+
+} // reset
+
+/*****************************************************************************
+
+  Name: readCounters
+
+  Purpose: The purpose of this function is to read the current values of
+  all of the events of the group with one system call.
+
+  Calling Sequence: success = readCounters(valuesPtr)
+
+  Inputs:
+
+    valuesPtr - A pointer to storage for NUMBER_OF_EVENTS values.  The
+    values of events that aren't supported are set to 0.
+
+  Outputs:
+
+    success - A flag that indicates whether the values were read.
+
+*****************************************************************************/
+bool PerformanceCounters::readCounters(uint64_t *valuesPtr)
+{
+  int i;
+  ssize_t bytesNeeded;
+  uint64_t buffer[NUMBER_OF_EVENTS + 1];
+
+  if (leaderDescriptor == -1)
+  {
+    return (false);
+  } // if
+
+  // A group read returns the number of events followed by the values.
+  bytesNeeded = (numberOfOpenEvents + 1) * sizeof(uint64_t);
+
+  if (read(leaderDescriptor,buffer,bytesNeeded) != bytesNeeded)
+  {
+    return (false);
+  } // if
+
+  for (i = 0; i < NUMBER_OF_EVENTS; i++)
+  {
+    valuesPtr[i] = 0;
+
+    if (groupIndex[i] != -1)
+    {
+      valuesPtr[i] = buffer[groupIndex[i] + 1];
+    } // if
+  } // for
+
+  return (true);
+
+} // readCounters
+
+/*****************************************************************************
+
+  Name: start
+
+  Purpose: The purpose of this function is to mark the start of a block.
+
+  Calling Sequence: start()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void PerformanceCounters::start(void)
+{
+
+  started = readCounters(startValues);
+
+  return;
+
+} // start
+
+/*****************************************************************************
+
+  Name: stop
+
+  Purpose: The purpose of this function is to mark the end of a block,
+  and to add the events of the block to the totals.
+
+  Calling Sequence: stop(count)
+
+  Inputs:
+
+    count - The number of samples in the block.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void PerformanceCounters::stop(uint64_t count)
+{
+  int i;
+  uint64_t values[NUMBER_OF_EVENTS];
+
+  if (started && readCounters(values))
+  {
+    for (i = 0; i < NUMBER_OF_EVENTS; i++)
+    {
+      totals[i] += values[i] - startValues[i];
+    } // for
+
+    numberOfBlocks++;
+    numberOfSamples += count;
+  } // if
+
+  started = false;
+
+  return;
+
+} // stop
+
+/*****************************************************************************
+
+  Name: getTotal
+
+  Purpose: The purpose of this function is to return the number of times
+  that an event occurred over all of the blocks.
+
+  Calling Sequence: total = getTotal(event)
+
+  Inputs:
+
+    event - The event.
+
+  Outputs:
+
+    total - The total count of the event.
+
+*****************************************************************************/
+uint64_t PerformanceCounters::getTotal(PerformanceEvent event)
+{
+
+  return (totals[event]);
+
+} // getTotal
+
+/*****************************************************************************
+
+  Name: getPerSample
+
+  Purpose: The purpose of this function is to return the average count
+  of an event per sample.
+
+  Calling Sequence: perSample = getPerSample(event)
+
+  Inputs:
+
+    event - The event.
+
+  Outputs:
+
+    perSample - The average count per sample, or 0 if no samples have
+    been counted.
+
+*****************************************************************************/
+double PerformanceCounters::getPerSample(PerformanceEvent event)
+{
+  double perSample;
+
+  perSample = 0;
+
+  if (numberOfSamples != 0)
+  {
+    perSample = (double)totals[event] / numberOfSamples;
+  } // if
+
+  return (perSample);
+
+} // getPerSample
+
+/*****************************************************************************
+
+  Name: getPerBlock
+
+  Purpose: The purpose of this function is to return the average count
+  of an event per block.
+
+  Calling Sequence: perBlock = getPerBlock(event)
+
+  Inputs:
+
+    event - The event.
+
+  Outputs:
+
+    perBlock - The average count per block, or 0 if no blocks have been
+    counted.
+
+*****************************************************************************/
+double PerformanceCounters::getPerBlock(PerformanceEvent event)
+{
+  double perBlock;
+
+  perBlock = 0;
+
+  if (numberOfBlocks != 0)
+  {
+    perBlock = (double)totals[event] / numberOfBlocks;
+  } // if
+
+  return (perBlock);
+
+} // getPerBlock
+
+/*****************************************************************************
+
+  Name: getNumberOfBlocks
+
+  Purpose: The purpose of this function is to return the number of
+  blocks that have been counted.
+
+  Calling Sequence: count = getNumberOfBlocks()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    count - The number of blocks.
+
+*****************************************************************************/
+uint64_t PerformanceCounters::getNumberOfBlocks(void)
+{
+
+  return (numberOfBlocks);
+
+} // getNumberOfBlocks
+
+/*****************************************************************************
+
+  Name: getNumberOfSamples
+
+  Purpose: The purpose of this function is to return the number of
+  samples that have been counted.
+
+  Calling Sequence: count = getNumberOfSamples()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    count - The number of samples.
+
+*****************************************************************************/
+uint64_t PerformanceCounters::getNumberOfSamples(void)
+{
+
+  return (numberOfSamples);
+
+} // getNumberOfSamples
+
+/*****************************************************************************
+
+  Name: getName
+
+  Purpose: The purpose of this function is to return the name of an
+  event for display.
+
+  Calling Sequence: namePtr = getName(event)
+
+  Inputs:
+
+    event - The event.
+
+  Outputs:
+
+    namePtr - The name of the event.
+
+*****************************************************************************/
+const char *PerformanceCounters::getName(PerformanceEvent event)
+{
+
+  return (eventNames[event]);
+
+} // getName
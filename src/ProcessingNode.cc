@@ -0,0 +1,273 @@
+//************************************************************************
+// file name: ProcessingNode.cc
+//************************************************************************
+#include <stdio.h>
+
+#include "ProcessingNode.h"
+
+using namespace std;
+
+/*****************************************************************************
+
+  Name: ProcessingNode
+
+  Purpose: The purpose of this function is to serve as the constructor for
+  an instance of a ProcessingNode.
+
+  Calling Sequence: ProcessingNode(namePtr,numberOfInputs,numberOfOutputs)
+
+  Inputs:
+
+    namePtr - The name of the node.  The string must outlive the node.
+
+    numberOfInputs - The number of input ports, up to MAX_PORTS.
+
+    numberOfOutputs - The number of output ports, up to MAX_PORTS.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+ProcessingNode::ProcessingNode(const char *namePtr,
+                               int numberOfInputs,
+                               int numberOfOutputs)
+{
+
+  this->namePtr = namePtr;
+
+  // Keep the port counts within bounds.
+  if (numberOfInputs > MAX_PORTS)
+  {
+    numberOfInputs = MAX_PORTS;
+  } // if
+
+  if (numberOfOutputs > MAX_PORTS)
+  {
+    numberOfOutputs = MAX_PORTS;
+  } // if
+
+  this->numberOfInputs = numberOfInputs;
+  this->numberOfOutputs = numberOfOutputs;
+
+  return;
+
+} // ProcessingNode
+
+/*****************************************************************************
+
+  Name: ~ProcessingNode
+
+  Purpose: The purpose of this function is to serve as the destructor for
+  an instance of a ProcessingNode.
+
+  Calling Sequence: ~ProcessingNode()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+ProcessingNode::~ProcessingNode(void)
+{
+
+  return;
+
+} // ~ProcessingNode
+
+/*****************************************************************************
+
+  Name: getName
+
+  Purpose: The purpose of this function is to return the name of the
+  node.
+
+  Calling Sequence: namePtr = getName()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    namePtr - The name of the node.
+
+*****************************************************************************/
+const char *ProcessingNode::getName(void)
+{
+
+  return (namePtr);
+
+} // getName
+
+/*****************************************************************************
+
+  Name: getNumberOfInputs
+
+  Purpose: The purpose of this function is to return the number of input
+  ports of the node.
+
+  Calling Sequence: numberOfInputs = getNumberOfInputs()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    numberOfInputs - The number of input ports.
+
+*****************************************************************************/
+int ProcessingNode::getNumberOfInputs(void)
+{
+
+  return (numberOfInputs);
+
+} // getNumberOfInputs
+
+/*****************************************************************************
+
+  Name: getNumberOfOutputs
+
+  Purpose: The purpose of this function is to return the number of output
+  ports of the node.
+
+  Calling Sequence: numberOfOutputs = getNumberOfOutputs()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    numberOfOutputs - The number of output ports.
+
+*****************************************************************************/
+int ProcessingNode::getNumberOfOutputs(void)
+{
+
+  return (numberOfOutputs);
+
+} // getNumberOfOutputs
+
+/*****************************************************************************
+
+  Name: getInputType
+
+  Purpose: The purpose of this function is to return the type of an input
+  port.  Unless a derived class says otherwise, ports are real.
+
+  Calling Sequence: type = getInputType(port)
+
+  Inputs:
+
+    port - The index of the input port.
+
+  Outputs:
+
+    type - The type of the port.
+
+*****************************************************************************/
+PortType ProcessingNode::getInputType(int)
+{
+
+  return (PORT_REAL);
+
+} // getInputType
+
+/*****************************************************************************
+
+  Name: getOutputType
+
+  Purpose: The purpose of this function is to return the type of an
+  output port.  Unless a derived class says otherwise, ports are real.
+
+  Calling Sequence: type = getOutputType(port)
+
+  Inputs:
+
+    port - The index of the output port.
+
+  Outputs:
+
+    type - The type of the port.
+
+*****************************************************************************/
+PortType ProcessingNode::getOutputType(int)
+{
+
+  return (PORT_REAL);
+
+} // getOutputType
+
+/*****************************************************************************
+
+  Name: canProcessInPlace
+
+  Purpose: The purpose of this function is to indicate whether output
+  port 0 may share its buffer with input port 0.  This is only true
+  when the node reads each input sample before it writes the output
+  sample with the same index, so it defaults to false.
+
+  Calling Sequence: inPlace = canProcessInPlace()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    inPlace - A flag that indicates that the buffer may be shared.
+
+*****************************************************************************/
+bool ProcessingNode::canProcessInPlace(void)
+{
+
+  return (false);
+
+} // canProcessInPlace
+
+/*****************************************************************************
+
+  Name: getPortWidth
+
+  Purpose: The purpose of this function is to return the number of floats
+  that one sample of a port occupies.
+
+  Calling Sequence: width = getPortWidth(type)
+
+  Inputs:
+
+    type - The type of the port.
+
+  Outputs:
+
+    width - The number of floats per sample.
+
+*****************************************************************************/
+int ProcessingNode::getPortWidth(PortType type)
+{
+  int width;
+
+  switch (type)
+  {
+    case PORT_COMPLEX:
+    {
+      width = 2;
+      break;
+    } // case
+
+    default:
+    {
+      width = 1;
+      break;
+    } // case
+  } // switch
+
+  return (width);
+
+} // getPortWidth
@@ -0,0 +1,746 @@
+//************************************************************************
+// file name: RlsNoiseCanceller.cc
+//************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "RlsNoiseCanceller.h"
+#include "DenormalGuard.h"
+#include "SampleConverter.h"
+
+using namespace std;
+
+/*****************************************************************************
+
+  Name: RlsNoiseCanceller
+
+  Purpose: The purpose of this function is to serve as the constructor for
+  an instance of an RlsNoiseCanceller.
+
+  Calling Sequence: RlsNoiseCanceller(filterLength,referenceDelay,lambda,
+                                      delta,algorithm)
+
+  Inputs:
+
+    filterLength - The number of taps for the filter.
+
+    referenceDelay - The number of samples to delay the input so that
+    the reference signal can be formed.
+
+    lambda - The forgetting factor, in the range of (0,1].  Values
+    between 0.99 and 0.9999 are typical.
+
+    delta - The regularization, which is the initial energy of the
+    least squares problem.  A value near the energy of one input sample
+    is a good starting point.
+
+    algorithm - The algorithm to use, RLS_TRANSVERSAL or RLS_LATTICE.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+RlsNoiseCanceller::RlsNoiseCanceller(int filterLength,
+                                     int referenceDelay,
+                                     float lambda,
+                                     float delta,
+                                     RlsAlgorithm algorithm)
+{
+  int i;
+  float *delayLineCoefficientsPtr;
+
+  // Save for later use.
+  this->filterLength = filterLength;
+  this->referenceDelay = referenceDelay;
+  this->lambda = lambda;
+  this->delta = delta;
+  this->algorithm = algorithm;
+
+  denormalProtection = false;
+
+  // Only the storage of the selected algorithm is allocated.
+  filterStatePtr = NULL;
+  coefficientsPtr = NULL;
+  inverseCorrelationPtr = NULL;
+  gainPtr = NULL;
+  forwardEnergyPtr = NULL;
+  backwardEnergyPtr = NULL;
+  forwardReflectionPtr = NULL;
+  backwardReflectionPtr = NULL;
+  regressionPtr = NULL;
+  previousBackwardErrorPtr = NULL;
+  previousConversionPtr = NULL;
+
+  if (algorithm == RLS_TRANSVERSAL)
+  {
+    filterStatePtr = new float[filterLength];
+    coefficientsPtr = new double[filterLength];
+    inverseCorrelationPtr = new double[filterLength * filterLength];
+    gainPtr = new double[filterLength];
+  } // if
+  else
+  {
+    forwardEnergyPtr = new float[filterLength];
+    backwardEnergyPtr = new float[filterLength];
+    forwardReflectionPtr = new float[filterLength];
+    backwardReflectionPtr = new float[filterLength];
+    regressionPtr = new float[filterLength];
+    previousBackwardErrorPtr = new float[filterLength];
+    previousConversionPtr = new float[filterLength];
+  } // else
+
+  // Allocate delay line storage.
+  delayLineCoefficientsPtr = new float[referenceDelay + 1];
+
+  // Only the last tap of the delay line is nonzero.
+  for (i = 0; i < referenceDelay; i++)
+  {
+    delayLineCoefficientsPtr[i] = 0;
+  } // for
+
+  // Set delay line coefficient.
+  delayLineCoefficientsPtr[referenceDelay] = 1;
+
+  // Instantiate delay line.
+  delayLinePtr = new FirFilter(referenceDelay+1,delayLineCoefficientsPtr);
+
+  // We're done with this.
+  delete[] delayLineCoefficientsPtr;
+
+  // Start from the regularized initial conditions.
+  reset();
+
+  return;
+
+} // RlsNoiseCanceller
+
+/*****************************************************************************
+
+  Name: ~RlsNoiseCanceller
+
+  Purpose: The purpose of this function is to serve as the destructor for
+  an instance of an RlsNoiseCanceller.
+
+  Calling Sequence: ~RlsNoiseCanceller()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+RlsNoiseCanceller::~RlsNoiseCanceller(void)
+{
+
+  // Release resources.
+  delete[] filterStatePtr;
+  delete[] coefficientsPtr;
+  delete[] inverseCorrelationPtr;
+  delete[] gainPtr;
+  delete[] forwardEnergyPtr;
+  delete[] backwardEnergyPtr;
+  delete[] forwardReflectionPtr;
+  delete[] backwardReflectionPtr;
+  delete[] regressionPtr;
+  delete[] previousBackwardErrorPtr;
+  delete[] previousConversionPtr;
+  delete delayLinePtr;
+
+  return;
+
+} // ~RlsNoiseCanceller
+
+/*****************************************************************************
+
+  Name: reset
+
+  Purpose: The purpose of this function is to return the adaptation to
+  its initial conditions, so that the canceller learns from scratch.
+  The contents of the delay line are kept.
+
+  Calling Sequence: reset()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void RlsNoiseCanceller::reset(void)
+{
+  int i, j;
+
+  if (algorithm == RLS_TRANSVERSAL)
+  {
+    // Start with zero-valued coefficients, an empty pipeline, and an
+    // inverse correlation matrix of I / delta.
+    for (i = 0; i < filterLength; i++)
+    {
+      filterStatePtr[i] = 0;
+      coefficientsPtr[i] = 0;
+
+      for (j = 0; j < filterLength; j++)
+      {
+        inverseCorrelationPtr[(i * filterLength) + j] = 0;
+      } // for
+
+      inverseCorrelationPtr[(i * filterLength) + i] = 1.0 / delta;
+    } // for
+
+    maxTrace = filterLength / (double)delta;
+  } // if
+  else
+  {
+    // Start with zero-valued coefficients and energies of delta.
+    for (i = 0; i < filterLength; i++)
+    {
+      forwardEnergyPtr[i] = delta;
+      backwardEnergyPtr[i] = delta;
+      forwardReflectionPtr[i] = 0;
+      backwardReflectionPtr[i] = 0;
+      regressionPtr[i] = 0;
+      previousBackwardErrorPtr[i] = 0;
+      previousConversionPtr[i] = 1;
+    } // for
+  } // else
+
+  return;
+
+} // reset
+
+/*****************************************************************************
+
+  Name: setDenormalProtection
+
+  Purpose: The purpose of this function is to enable or disable flushing
+  subnormal values to zero while samples are being processed.  This
+  should be enabled when the input contains long stretches of silence,
+  since the errors and the energies decay toward zero then.
+
+  Calling Sequence: setDenormalProtection(enable)
+
+  Inputs:
+
+    enable - A flag that indicates whether to flush subnormal values to
+    zero.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void RlsNoiseCanceller::setDenormalProtection(bool enable)
+{
+
+  denormalProtection = enable;
+
+  return;
+
+} // setDenormalProtection
+
+/*****************************************************************************
+
+  Name: getAlgorithm
+
+  Purpose: The purpose of this function is to retrieve the algorithm
+  that the canceller uses.
+
+  Calling Sequence: algorithm = getAlgorithm()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    algorithm - The algorithm, RLS_TRANSVERSAL or RLS_LATTICE.
+
+*****************************************************************************/
+RlsAlgorithm RlsNoiseCanceller::getAlgorithm(void)
+{
+
+  return (algorithm);
+
+} // getAlgorithm
+
+/*****************************************************************************
+
+  Name: getFilterLength
+
+  Purpose: The purpose of this function is to retrieve the number of
+  taps of the filter.
+
+  Calling Sequence: filterLength = getFilterLength()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    filterLength - The number of taps.
+
+*****************************************************************************/
+int RlsNoiseCanceller::getFilterLength(void)
+{
+
+  return (filterLength);
+
+} // getFilterLength
+
+/*****************************************************************************
+
+  Name: acceptData
+
+  Purpose: The purpose of this function is to present input samples to
+  be filtered and produce output samples to the calling function.
+
+  Calling Sequence: acceptData(bufferPtr,bufferLength,outputBufferPtr)
+
+  Inputs:
+
+    bufferPtr - A pointer to storage that provides the input samples.
+
+    bufferLength - The nmber of samples referenced by bufferPtr.  This
+    will also be the number of samples stored into memory referenced
+    by outputBufferPtr.
+
+    outputBufferPtr - A pointer to storage for the processed samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void RlsNoiseCanceller::acceptData(int16_t *bufferPtr,
+                                   uint32_t bufferLength,
+                                   int16_t *outputBufferPtr)
+{
+
+  // Filter the block of data provided by the caller.
+  SampleConverter::filterInt16(filterBlock,
+                               this,
+                               bufferPtr,
+                               bufferLength,
+                               1,
+                               outputBufferPtr);
+
+  return;
+
+} // acceptData
+
+/*****************************************************************************
+
+  Name: filterBlock
+
+  Purpose: The purpose of this function is to pass a scratch block of
+  the 16-bit acceptData() to the float acceptData().
+
+  Calling Sequence: filterBlock(contextPtr,
+                                bufferPtr,
+                                bufferLength,
+                                outputBufferPtr)
+
+  Inputs:
+
+    contextPtr - A pointer to the canceller.
+
+    bufferPtr - A pointer to storage that provides the input samples.
+
+    bufferLength - The number of samples referenced by bufferPtr.
+
+    outputBufferPtr - A pointer to storage for the processed samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void RlsNoiseCanceller::filterBlock(void *contextPtr,
+                                    float *bufferPtr,
+                                    uint32_t bufferLength,
+                                    float *outputBufferPtr)
+{
+  RlsNoiseCanceller *thisPtr;
+
+  thisPtr = (RlsNoiseCanceller *)contextPtr;
+
+  thisPtr->acceptData(bufferPtr,bufferLength,outputBufferPtr);
+
+  return;
+
+} // filterBlock
+
+/*****************************************************************************
+
+  Name: acceptData
+
+  Purpose: The purpose of this function is to present input samples to
+  be filtered and produce output samples to the calling function.
+
+  Calling Sequence: acceptData(bufferPtr,bufferLength,outputBufferPtr)
+
+  Inputs:
+
+    bufferPtr - A pointer to storage that provides the input samples.
+
+    bufferLength - The nmber of samples referenced by bufferPtr.  This
+    will also be the number of samples stored into memory referenced
+    by outputBufferPtr.
+
+    outputBufferPtr - A pointer to storage for the processed samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void RlsNoiseCanceller::acceptData(float *bufferPtr,
+                                   uint32_t bufferLength,
+                                   float *outputBufferPtr)
+{
+  uint32_t i;
+  DenormalGuard guard(denormalProtection);
+
+  // Filter the block of data provided by the caller.
+  for (i = 0; i < bufferLength; i++)
+  {
+    outputBufferPtr[i] = filterData(bufferPtr[i]);
+  } // for
+
+  return;
+
+} // acceptData
+
+/*****************************************************************************
+
+  Name: shiftSampleIntoPipeline
+
+  Purpose: The purpose of this function is to shift the next sample into
+  the filter state memory (the pipeline) of the transversal algorithm.
+  The structure of the pipeline is,
+
+  {x(n) x(n-1) x(n-2)...,x(n - N + 1)}.
+
+  Calling Sequence: shiftSampleIntoPipeline(x)
+
+  Inputs:
+
+    x - The sample to shift into the pipeline.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void RlsNoiseCanceller::shiftSampleIntoPipeline(float x)
+{
+  int i;
+
+  // Shift the existing samples.
+  for (i = filterLength-1; i > 0; i--)
+  {
+    // Make room for the new sample.
+    filterStatePtr[i] = filterStatePtr[i-1];
+  } // for
+
+  // Place the sample into the pipeline.
+  filterStatePtr[0] = x;
+
+  return;
+
+} // shiftSampleIntoPipeline
+
+/*****************************************************************************
+
+  Name: filterData
+
+  Purpose: The purpose of this function is to filter one sample of data
+  for the purpose of removing noise from a signal.  A reference signal is
+  formed by delaying the input signal, and the filter estimates the
+  reference from the most recent input samples, exactly as in the
+  NlmsNoiseCanceller class.
+
+  Calling Sequence: dHat = filterData(x)
+
+  Inputs:
+
+    x - The data sample to filter.
+
+  Outputs:
+
+    dHat - The output value of the filter.  This is an estimate of a
+    noise-reduced sample.
+
+*****************************************************************************/
+float RlsNoiseCanceller::filterData(float x)
+{
+  float d;
+  float dHat;
+
+  // Compute reference sample.
+  d = delayLinePtr->filterData(x);
+
+  if (algorithm == RLS_TRANSVERSAL)
+  {
+    // Place the sample into the state memory.
+    shiftSampleIntoPipeline(x);
+
+    dHat = filterDataTransversal(d);
+  } // if
+  else
+  {
+    dHat = filterDataLattice(x,d);
+  } // else
+
+  return (dHat);
+
+} // filterData
+
+/*****************************************************************************
+
+  Name: filterDataTransversal
+
+  Purpose: The purpose of this function is to perform one iteration of
+  the standard RLS algorithm.  With u(n) denoting the filter state and
+  P(n) the inverse correlation matrix, the iteration is,
+
+    pi(n) = P(n-1) u(n)
+    k(n) = pi(n) / (lambda + u(n)' pi(n))
+    e(n) = d(n) - w(n-1)' u(n)
+    w(n) = w(n-1) + k(n) e(n)
+    P(n) = (P(n-1) - k(n) pi(n)') / lambda.
+
+  Since P(n) is symmetric, only its upper triangle is computed, and it
+  is mirrored into the lower triangle, which keeps rounding from making
+  it asymmetric.  When the input is quiet, P(n) grows by 1 / lambda at
+  every sample; to keep it from overflowing, the division by lambda is
+  skipped whenever the trace would exceed that of P(0).
+
+  Calling Sequence: dHat = filterDataTransversal(d)
+
+  Inputs:
+
+    d - The reference sample.
+
+  Outputs:
+
+    dHat - The output value of the filter (the a priori estimate).
+
+*****************************************************************************/
+float RlsNoiseCanceller::filterDataTransversal(float d)
+{
+  int i, j;
+  double *p;
+  double *rowPtr;
+  double dHat;
+  double e;
+  double energy;
+  double den;
+  double trace;
+  double scale;
+
+  // Reference the inverse correlation matrix.
+  p = inverseCorrelationPtr;
+
+  // Compute pi(n), u(n)' pi(n), and the estimate.
+  energy = 0;
+  dHat = 0;
+
+  for (i = 0; i < filterLength; i++)
+  {
+    rowPtr = &p[i * filterLength];
+    gainPtr[i] = 0;
+
+    for (j = 0; j < filterLength; j++)
+    {
+      gainPtr[i] += rowPtr[j] * filterStatePtr[j];
+    } // for
+
+    energy += gainPtr[i] * filterStatePtr[i];
+    dHat += coefficientsPtr[i] * filterStatePtr[i];
+  } // for
+
+  den = lambda + energy;
+
+  // Compute the error.
+  e = d - dHat;
+
+  // Update the filter coefficients.
+  for (i = 0; i < filterLength; i++)
+  {
+    coefficientsPtr[i] += (gainPtr[i] / den) * e;
+  } // for
+
+  // Find the trace of P(n) before the division by lambda.
+  trace = 0;
+
+  for (i = 0; i < filterLength; i++)
+  {
+    trace += p[(i * filterLength) + i] - ((gainPtr[i] * gainPtr[i]) / den);
+  } // for
+
+  scale = 1.0 / lambda;
+
+  if ((trace * scale) > maxTrace)
+  {
+    // Don't let a quiet input inflate the matrix.
+    scale = 1;
+  } // if
+
+  // Update the upper triangle, and mirror it.
+  for (i = 0; i < filterLength; i++)
+  {
+    for (j = i; j < filterLength; j++)
+    {
+      p[(i * filterLength) + j] =
+        (p[(i * filterLength) + j] - ((gainPtr[i] * gainPtr[j]) / den)) *
+        scale;
+      p[(j * filterLength) + i] = p[(i * filterLength) + j];
+    } // for
+  } // for
+
+  return ((float)dHat);
+
+} // filterDataTransversal
+
+/*****************************************************************************
+
+  Name: filterDataLattice
+
+  Purpose: The purpose of this function is to perform one iteration of
+  the a priori RLS lattice with error feedback.  Stage m of the lattice
+  carries the a priori forward and backward prediction errors of order
+  m, eta(m) and beta(m), their energies, F(m) and B(m), and the
+  conversion factor, gamma(m), that turns an a priori error into an a
+  posteriori error.  At each sample, with eta(0) = beta(0) = x(n) and
+  gamma(0) = 1, the stages compute,
+
+    eta(m+1,n) = eta(m,n) + kf(m+1,n-1) beta(m,n-1)
+    beta(m+1,n) = beta(m,n-1) + kb(m+1,n-1) eta(m,n)
+    kf(m+1,n) = kf(m+1,n-1)
+                - gamma(m,n-1) beta(m,n-1) eta(m+1,n) / B(m,n-1)
+    kb(m+1,n) = kb(m+1,n-1) - gamma(m,n-1) eta(m,n) beta(m+1,n) / F(m,n)
+    F(m,n) = lambda F(m,n-1) + gamma(m,n-1) eta(m,n)^2
+    B(m,n) = lambda B(m,n-1) + gamma(m,n) beta(m,n)^2
+    gamma(m+1,n) = gamma(m,n) - (gamma(m,n) beta(m,n))^2 / B(m,n).
+
+  The backward prediction errors are orthogonal, so the reference is
+  estimated from them one stage at a time, starting with xi(0) = d(n),
+
+    xi(m+1,n) = xi(m,n) - h(m,n-1) beta(m,n)
+    h(m,n) = h(m,n-1) + gamma(m,n) beta(m,n) xi(m+1,n) / B(m,n),
+
+  and the estimate is d(n) - xi(N,n).  In exact arithmetic, this is the
+  same estimate that the transversal algorithm makes.
+
+  Calling Sequence: dHat = filterDataLattice(x,d)
+
+  Inputs:
+
+    x - The data sample.
+
+    d - The reference sample.
+
+  Outputs:
+
+    dHat - The output value of the filter (the a priori estimate).
+
+*****************************************************************************/
+float RlsNoiseCanceller::filterDataLattice(float x,float d)
+{
+  int m;
+  float forwardError;
+  float backwardError;
+  float nextForwardError;
+  float nextBackwardError;
+  float conversion;
+  float nextConversion;
+  float previousBackwardError;
+  float previousConversion;
+  float previousBackwardEnergy;
+  float backwardEnergy;
+  float xi;
+  float leakage;
+
+  // This keeps the energies from decaying below delta.
+  leakage = (1 - lambda) * delta;
+
+  // Stage 0 is the input itself.
+  forwardError = x;
+  backwardError = x;
+  conversion = 1;
+  xi = d;
+
+  forwardEnergyPtr[0] = (lambda * forwardEnergyPtr[0]) + (x * x) + leakage;
+
+  // The last stage has no order update.
+  nextForwardError = 0;
+  nextBackwardError = 0;
+  nextConversion = 0;
+
+  for (m = 0; m < filterLength; m++)
+  {
+    previousBackwardError = previousBackwardErrorPtr[m];
+    previousConversion = previousConversionPtr[m];
+    previousBackwardEnergy = backwardEnergyPtr[m];
+
+    backwardEnergy = (lambda * previousBackwardEnergy) +
+      (conversion * backwardError * backwardError) + leakage;
+
+    //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+    // Joint process estimation.
+    //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+    xi = xi - (regressionPtr[m] * backwardError);
+    regressionPtr[m] += ((conversion * backwardError) / backwardEnergy) * xi;
+    //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+    //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+    // Order update of the prediction errors.
+    //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+    if (m < (filterLength - 1))
+    {
+      nextForwardError = forwardError +
+        (forwardReflectionPtr[m] * previousBackwardError);
+      nextBackwardError = previousBackwardError +
+        (backwardReflectionPtr[m] * forwardError);
+
+      forwardReflectionPtr[m] -=
+        ((previousConversion * previousBackwardError) /
+         previousBackwardEnergy) * nextForwardError;
+      backwardReflectionPtr[m] -=
+        ((previousConversion * forwardError) / forwardEnergyPtr[m]) *
+        nextBackwardError;
+
+      forwardEnergyPtr[m + 1] = (lambda * forwardEnergyPtr[m + 1]) +
+        (previousConversionPtr[m + 1] * nextForwardError * nextForwardError) +
+        leakage;
+
+      nextConversion = conversion -
+        ((conversion * backwardError) * (conversion * backwardError)) /
+        backwardEnergy;
+    } // if
+    //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+    // Save the values of this sample for the next one.
+    previousBackwardErrorPtr[m] = backwardError;
+    previousConversionPtr[m] = conversion;
+    backwardEnergyPtr[m] = backwardEnergy;
+
+    // Move on to the next stage.
+    forwardError = nextForwardError;
+    backwardError = nextBackwardError;
+    conversion = nextConversion;
+  } // for
+
+  return (d - xi);
+
+} // filterDataLattice
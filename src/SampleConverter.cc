@@ -0,0 +1,828 @@
+//************************************************************************
+// file name: SampleConverter.cc
+//************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "SampleConverter.h"
+
+using namespace std;
+
+/*****************************************************************************
+
+  Name: getSampleSize
+
+  Purpose: The purpose of this function is to return the number of bytes
+  that are occupied by one sample of the specified format.
+
+  Calling Sequence: size = getSampleSize(format)
+
+  Inputs:
+
+    format - The sample format.
+
+  Outputs:
+
+    size - The size of one sample in bytes.
+
+*****************************************************************************/
+int SampleConverter::getSampleSize(SampleFormat format)
+{
+  int size;
+
+  switch (format)
+  {
+    case SAMPLE_FORMAT_S16:
+    {
+      size = sizeof(int16_t);
+      break;
+    } // case
+
+    case SAMPLE_FORMAT_S32:
+    {
+      size = sizeof(int32_t);
+      break;
+    } // case
+
+    default:
+    {
+      size = sizeof(float);
+      break;
+    } // case
+  } // switch
+
+  return (size);
+
+} // getSampleSize
+
+/*****************************************************************************
+
+  Name: parseFormat
+
+  Purpose: The purpose of this function is to map a format name, as
+  entered on a command line, to a sample format.  The names that are
+  recognized are s16, s32, and f32.
+
+  Calling Sequence: success = parseFormat(namePtr,formatPtr)
+
+  Inputs:
+
+    namePtr - The name of the format.
+
+    formatPtr - A pointer to storage for the sample format.
+
+  Outputs:
+
+    success - A flag that indicates whether or not the name was
+    recognized.  A value of true indicates that it was recognized, and a
+    value of false indicates that it was not.
+
+*****************************************************************************/
+bool SampleConverter::parseFormat(const char *namePtr,SampleFormat *formatPtr)
+{
+  bool success;
+
+  // Default to success.
+  success = true;
+
+  if (strcmp(namePtr,"s16") == 0)
+  {
+    *formatPtr = SAMPLE_FORMAT_S16;
+  } // if
+  else if (strcmp(namePtr,"s32") == 0)
+  {
+    *formatPtr = SAMPLE_FORMAT_S32;
+  } // else if
+  else if (strcmp(namePtr,"f32") == 0)
+  {
+    *formatPtr = SAMPLE_FORMAT_F32;
+  } // else if
+  else
+  {
+    success = false;
+  } // else
+
+  return (success);
+
+} // parseFormat
+
+/*****************************************************************************
+
+  Name: toFloat
+
+  Purpose: The purpose of this function is to convert a block of samples
+  of the specified format to float.  The fullScale parameter specifies
+  the float value to which a full scale sample maps.  For integer
+  formats, full scale is the magnitude of the most negative value, and
+  for the float format, full scale is 1.  For example, a fullScale value
+  of 32768 leaves 16-bit samples unchanged, and a value of 1 yields
+  normalized samples.
+
+  Calling Sequence: toFloat(inputPtr,format,numberOfSamples,fullScale,
+                            outputPtr)
+
+  Inputs:
+
+    inputPtr - A pointer to the samples to convert.
+
+    format - The format of the input samples.
+
+    numberOfSamples - The number of samples to convert.
+
+    fullScale - The float value of a full scale sample.
+
+    outputPtr - A pointer to storage for the converted samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SampleConverter::toFloat(const void *inputPtr,
+                              SampleFormat format,
+                              uint32_t numberOfSamples,
+                              float fullScale,
+                              float *outputPtr)
+{
+
+  switch (format)
+  {
+    case SAMPLE_FORMAT_S16:
+    {
+      int16ToFloat((const int16_t *)inputPtr,
+                   numberOfSamples,
+                   fullScale / 32768.0f,
+                   outputPtr);
+      break;
+    } // case
+
+    case SAMPLE_FORMAT_S32:
+    {
+      int32ToFloat((const int32_t *)inputPtr,
+                   numberOfSamples,
+                   fullScale / 2147483648.0f,
+                   outputPtr);
+      break;
+    } // case
+
+    default:
+    {
+      floatToFloat((const float *)inputPtr,
+                   numberOfSamples,
+                   fullScale,
+                   outputPtr);
+      break;
+    } // case
+  } // switch
+
+  return;
+
+} // toFloat
+
+/*****************************************************************************
+
+  Name: fromFloat
+
+  Purpose: The purpose of this function is to convert a block of float
+  samples to the specified format.  This is the inverse of toFloat().
+  Integer results are rounded to the nearest value and saturated.
+
+  Calling Sequence: fromFloat(inputPtr,numberOfSamples,fullScale,format,
+                              outputPtr)
+
+  Inputs:
+
+    inputPtr - A pointer to the samples to convert.
+
+    numberOfSamples - The number of samples to convert.
+
+    fullScale - The float value of a full scale sample.
+
+    format - The format of the output samples.
+
+    outputPtr - A pointer to storage for the converted samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SampleConverter::fromFloat(const float *inputPtr,
+                                uint32_t numberOfSamples,
+                                float fullScale,
+                                SampleFormat format,
+                                void *outputPtr)
+{
+
+  switch (format)
+  {
+    case SAMPLE_FORMAT_S16:
+    {
+      floatToInt16(inputPtr,
+                   numberOfSamples,
+                   32768.0f / fullScale,
+                   (int16_t *)outputPtr);
+      break;
+    } // case
+
+    case SAMPLE_FORMAT_S32:
+    {
+      floatToInt32(inputPtr,
+                   numberOfSamples,
+                   2147483648.0f / fullScale,
+                   (int32_t *)outputPtr);
+      break;
+    } // case
+
+    default:
+    {
+      floatToFloat(inputPtr,
+                   numberOfSamples,
+                   1.0f / fullScale,
+                   (float *)outputPtr);
+      break;
+    } // case
+  } // switch
+
+  return;
+
+} // fromFloat
+
+/*****************************************************************************
+
+  Name: int16ToFloat
+
+  Purpose: The purpose of this function is to convert a block of 16-bit
+  samples to float.  With SSE2, eight samples are sign extended,
+  converted, and scaled at a time.
+
+  Calling Sequence: int16ToFloat(inputPtr,numberOfSamples,scale,outputPtr)
+
+  Inputs:
+
+    inputPtr - A pointer to the samples to convert.
+
+    numberOfSamples - The number of samples to convert.
+
+    scale - The value by which each sample is multiplied.
+
+    outputPtr - A pointer to storage for the converted samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SampleConverter::int16ToFloat(const int16_t *inputPtr,
+                                   uint32_t numberOfSamples,
+                                   float scale,
+                                   float *outputPtr)
+{
+  uint32_t i;
+
+  i = 0;
+
+#ifdef __SSE2__
+  __m128i samples, low, high;
+  __m128 scalev;
+
+  scalev = _mm_set1_ps(scale);
+
+  for (; (i + 8) <= numberOfSamples; i += 8)
+  {
+    samples = _mm_loadu_si128((const __m128i *)&inputPtr[i]);
+
+    // Sign extend to 32 bits by placing each sample in the upper half
+    // of a lane and shifting it back down.
+    low = _mm_srai_epi32(_mm_unpacklo_epi16(samples,samples),16);
+    high = _mm_srai_epi32(_mm_unpackhi_epi16(samples,samples),16);
+
+    _mm_storeu_ps(&outputPtr[i],
+                  _mm_mul_ps(_mm_cvtepi32_ps(low),scalev));
+    _mm_storeu_ps(&outputPtr[i + 4],
+                  _mm_mul_ps(_mm_cvtepi32_ps(high),scalev));
+  } // for
+#endif
+
+  // Convert the remaining samples.
+  for (; i < numberOfSamples; i++)
+  {
+    outputPtr[i] = (float)inputPtr[i] * scale;
+  } // for
+
+  return;
+
+} // int16ToFloat
+
+/*****************************************************************************
+
+  Name: int32ToFloat
+
+  Purpose: The purpose of this function is to convert a block of 32-bit
+  samples to float.
+
+  Calling Sequence: int32ToFloat(inputPtr,numberOfSamples,scale,outputPtr)
+
+  Inputs:
+
+    inputPtr - A pointer to the samples to convert.
+
+    numberOfSamples - The number of samples to convert.
+
+    scale - The value by which each sample is multiplied.
+
+    outputPtr - A pointer to storage for the converted samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SampleConverter::int32ToFloat(const int32_t *inputPtr,
+                                   uint32_t numberOfSamples,
+                                   float scale,
+                                   float *outputPtr)
+{
+  uint32_t i;
+
+  for (i = 0; i < numberOfSamples; i++)
+  {
+    outputPtr[i] = (float)inputPtr[i] * scale;
+  } // for
+
+  return;
+
+} // int32ToFloat
+
+/*****************************************************************************
+
+  Name: floatToFloat
+
+  Purpose: The purpose of this function is to scale a block of float
+  samples.  The input and output may reference the same storage.
+
+  Calling Sequence: floatToFloat(inputPtr,numberOfSamples,scale,outputPtr)
+
+  Inputs:
+
+    inputPtr - A pointer to the samples to scale.
+
+    numberOfSamples - The number of samples to scale.
+
+    scale - The value by which each sample is multiplied.
+
+    outputPtr - A pointer to storage for the scaled samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SampleConverter::floatToFloat(const float *inputPtr,
+                                   uint32_t numberOfSamples,
+                                   float scale,
+                                   float *outputPtr)
+{
+  uint32_t i;
+
+  if (scale == 1.0f)
+  {
+    if (inputPtr != outputPtr)
+    {
+      memcpy(outputPtr,inputPtr,numberOfSamples * sizeof(float));
+    } // if
+  } // if
+  else
+  {
+    for (i = 0; i < numberOfSamples; i++)
+    {
+      outputPtr[i] = inputPtr[i] * scale;
+    } // for
+  } // else
+
+  return;
+
+} // floatToFloat
+
+/*****************************************************************************
+
+  Name: floatToInt16
+
+  Purpose: The purpose of this function is to convert a block of float
+  samples to 16-bit samples.  Each value is rounded to the nearest
+  integer and saturated to the range of a 16-bit value so that
+  overdriven samples clip rather than wrap.  With SSE2, eight samples
+  are converted at a time.  The values are clamped before they are
+  converted, since the conversion to 32 bits would wrap values beyond
+  its range, and the conversion rounds in the current rounding mode,
+  as lrintf() does, so both paths give the same results.  A NaN is
+  converted to 32767.
+
+  Calling Sequence: floatToInt16(inputPtr,numberOfSamples,scale,outputPtr)
+
+  Inputs:
+
+    inputPtr - A pointer to the samples to convert.
+
+    numberOfSamples - The number of samples to convert.
+
+    scale - The value by which each sample is multiplied.
+
+    outputPtr - A pointer to storage for the converted samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SampleConverter::floatToInt16(const float *inputPtr,
+                                   uint32_t numberOfSamples,
+                                   float scale,
+                                   int16_t *outputPtr)
+{
+  uint32_t i;
+  float value;
+
+  i = 0;
+
+#ifdef __SSE2__
+  __m128 scalev, maxv, minv;
+  __m128i low, high;
+
+  scalev = _mm_set1_ps(scale);
+  maxv = _mm_set1_ps(32767.0f);
+  minv = _mm_set1_ps(-32768.0f);
+
+  for (; (i + 8) <= numberOfSamples; i += 8)
+  {
+    // Scale, saturate, and round four samples at a time.
+    low = _mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(
+      _mm_mul_ps(_mm_loadu_ps(&inputPtr[i]),scalev),maxv),minv));
+    high = _mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(
+      _mm_mul_ps(_mm_loadu_ps(&inputPtr[i + 4]),scalev),maxv),minv));
+
+    // The values are in range, so the saturating pack just narrows them.
+    _mm_storeu_si128((__m128i *)&outputPtr[i],_mm_packs_epi32(low,high));
+  } // for
+#endif
+
+  // Convert the remaining samples.
+  for (; i < numberOfSamples; i++)
+  {
+    value = inputPtr[i] * scale;
+
+    // Saturate.  As with _mm_min_ps(), a NaN fails the comparison and
+    // is replaced by the limit, so it becomes 32767 on both paths.
+    value = (value < 32767.0f) ? value : 32767.0f;
+    value = (value > -32768.0f) ? value : -32768.0f;
+
+    outputPtr[i] = (int16_t)lrintf(value);
+  } // for
+
+  return;
+
+} // floatToInt16
+
+/*****************************************************************************
+
+  Name: floatToInt32
+
+  Purpose: The purpose of this function is to convert a block of float
+  samples to 32-bit samples.  Each value is rounded to the nearest
+  integer and saturated to the range of a 32-bit value.  Note that the
+  largest float that is less than 2^31 is 2147483520.
+
+  Calling Sequence: floatToInt32(inputPtr,numberOfSamples,scale,outputPtr)
+
+  Inputs:
+
+    inputPtr - A pointer to the samples to convert.
+
+    numberOfSamples - The number of samples to convert.
+
+    scale - The value by which each sample is multiplied.
+
+    outputPtr - A pointer to storage for the converted samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SampleConverter::floatToInt32(const float *inputPtr,
+                                   uint32_t numberOfSamples,
+                                   float scale,
+                                   int32_t *outputPtr)
+{
+  uint32_t i;
+  float value;
+
+  for (i = 0; i < numberOfSamples; i++)
+  {
+    value = inputPtr[i] * scale;
+
+    // Saturate.
+    value = (value > 2147483520.0f) ? 2147483520.0f : value;
+    value = (value < -2147483648.0f) ? -2147483648.0f : value;
+
+    outputPtr[i] = (int32_t)lrintf(value);
+  } // for
+
+  return;
+
+} // floatToInt32
+
+/*****************************************************************************
+
+  Name: deinterleave
+
+  Purpose: The purpose of this function is to split a block of
+  interleaved frames into one contiguous buffer per channel.  Rather
+  than scattering one sample at a time across all of the channel
+  buffers, the block is transposed in tiles of TRANSPOSE_TILE_SIZE
+  frames.  The input tile stays in the L1 cache while each channel's
+  run of the tile is written sequentially.
+
+  Calling Sequence: deinterleave(inputPtr,numberOfChannels,numberOfFrames,
+                                 outputPtrs)
+
+  Inputs:
+
+    inputPtr - A pointer to the interleaved frames.
+
+    numberOfChannels - The number of channels in each frame.
+
+    numberOfFrames - The number of frames to split.
+
+    outputPtrs - An array of pointers to storage for each channel.  Each
+    buffer must be able to hold numberOfFrames samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SampleConverter::deinterleave(const float *inputPtr,
+                                   int numberOfChannels,
+                                   uint32_t numberOfFrames,
+                                   float **outputPtrs)
+{
+  int c;
+  uint32_t i;
+  uint32_t tileStart;
+  uint32_t tileEnd;
+  const float *tilePtr;
+  float *channelPtr;
+
+  if (numberOfChannels == 1)
+  {
+    memcpy(outputPtrs[0],inputPtr,numberOfFrames * sizeof(float));
+    return;
+  } // if
+
+  for (tileStart = 0;
+       tileStart < numberOfFrames;
+       tileStart += TRANSPOSE_TILE_SIZE)
+  {
+    tileEnd = tileStart + TRANSPOSE_TILE_SIZE;
+    if (tileEnd > numberOfFrames)
+    {
+      tileEnd = numberOfFrames;
+    } // if
+
+    for (c = 0; c < numberOfChannels; c++)
+    {
+      tilePtr = &inputPtr[c];
+      channelPtr = outputPtrs[c];
+
+      for (i = tileStart; i < tileEnd; i++)
+      {
+        channelPtr[i] = tilePtr[i * numberOfChannels];
+      } // for
+    } // for
+  } // for
+
+  return;
+
+} // deinterleave
+
+/*****************************************************************************
+
+  Name: interleave
+
+  Purpose: The purpose of this function is to merge one buffer per
+  channel into a block of interleaved frames.  This is the inverse of
+  deinterleave(), and it is tiled in the same way.
+
+  Calling Sequence: interleave(inputPtrs,numberOfChannels,numberOfFrames,
+                               outputPtr)
+
+  Inputs:
+
+    inputPtrs - An array of pointers to the samples of each channel.
+
+    numberOfChannels - The number of channels in each frame.
+
+    numberOfFrames - The number of frames to merge.
+
+    outputPtr - A pointer to storage for the interleaved frames.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SampleConverter::interleave(float **inputPtrs,
+                                 int numberOfChannels,
+                                 uint32_t numberOfFrames,
+                                 float *outputPtr)
+{
+  int c;
+  uint32_t i;
+  uint32_t tileStart;
+  uint32_t tileEnd;
+  const float *channelPtr;
+  float *tilePtr;
+
+  if (numberOfChannels == 1)
+  {
+    memcpy(outputPtr,inputPtrs[0],numberOfFrames * sizeof(float));
+    return;
+  } // if
+
+  for (tileStart = 0;
+       tileStart < numberOfFrames;
+       tileStart += TRANSPOSE_TILE_SIZE)
+  {
+    tileEnd = tileStart + TRANSPOSE_TILE_SIZE;
+    if (tileEnd > numberOfFrames)
+    {
+      tileEnd = numberOfFrames;
+    } // if
+
+    for (c = 0; c < numberOfChannels; c++)
+    {
+      tilePtr = &outputPtr[c];
+      channelPtr = inputPtrs[c];
+
+      for (i = tileStart; i < tileEnd; i++)
+      {
+        tilePtr[i * numberOfChannels] = channelPtr[i];
+      } // for
+    } // for
+  } // for
+
+  return;
+
+} // interleave
+
+/*****************************************************************************
+
+  Name: filterInt16
+
+  Purpose: The purpose of this function is to pass 16-bit samples
+  through a float block filter.  The samples are converted, in chunks
+  of SCRATCH_BLOCK_SIZE samples, into a scratch block, filtered in
+  place, and converted back.  The conversions are done in separate
+  passes so that the output saturates.
+
+  Calling Sequence: filterInt16(filterPtr,
+                                contextPtr,
+                                inputPtr,
+                                numberOfFrames,
+                                samplesPerFrame,
+                                outputPtr)
+
+  Inputs:
+
+    filterPtr - A pointer to the float block filter.  It is passed
+    contextPtr, the scratch block, and the number of frames in the
+    scratch block.
+
+    contextPtr - A pointer to the object that owns the filter.
+
+    inputPtr - A pointer to the input samples.
+
+    numberOfFrames - The number of frames referenced by inputPtr.  This
+    will also be the number of frames stored into memory referenced by
+    outputPtr.
+
+    samplesPerFrame - The number of samples in a frame, for example, 2
+    for interleaved I/Q pairs.  It must be at most SCRATCH_BLOCK_SIZE.
+
+    outputPtr - A pointer to storage for the filtered samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SampleConverter::filterInt16(BlockFilter filterPtr,
+                                  void *contextPtr,
+                                  const int16_t *inputPtr,
+                                  uint32_t numberOfFrames,
+                                  uint32_t samplesPerFrame,
+                                  int16_t *outputPtr)
+{
+  uint32_t i;
+  uint32_t count;
+  uint32_t maximumCount;
+  alignas(ALIGNMENT) float block[SCRATCH_BLOCK_SIZE];
+
+  // Only whole frames fit in the scratch block.
+  maximumCount = SCRATCH_BLOCK_SIZE / samplesPerFrame;
+
+  i = 0;
+
+  while (i < numberOfFrames)
+  {
+    count = numberOfFrames - i;
+
+    if (count > maximumCount)
+    {
+      count = maximumCount;
+    } // if
+
+    int16ToFloat(&inputPtr[samplesPerFrame * i],
+                 samplesPerFrame * count,
+                 1.0f,
+                 block);
+
+    (*filterPtr)(contextPtr,block,count,block);
+
+    floatToInt16(block,
+                 samplesPerFrame * count,
+                 1.0f,
+                 &outputPtr[samplesPerFrame * i]);
+
+    i += count;
+  } // while
+
+  return;
+
+} // filterInt16
+
+/*****************************************************************************
+
+  Name: allocateAligned
+
+  Purpose: The purpose of this function is to allocate a buffer that
+  starts on a cache line boundary.
+
+  Calling Sequence: bufferPtr = allocateAligned(size)
+
+  Inputs:
+
+    size - The size of the buffer in bytes.
+
+  Outputs:
+
+    bufferPtr - A pointer to the buffer, or NULL if the allocation
+    failed.  The buffer must be released with releaseAligned().
+
+*****************************************************************************/
+void *SampleConverter::allocateAligned(size_t size)
+{
+  void *bufferPtr;
+
+  if (posix_memalign(&bufferPtr,ALIGNMENT,size) != 0)
+  {
+    bufferPtr = NULL;
+  } // if
+
+  return (bufferPtr);
+
+} // allocateAligned
+
+/*****************************************************************************
+
+  Name: releaseAligned
+
+  Purpose: The purpose of this function is to release a buffer that was
+  allocated by allocateAligned().
+
+  Calling Sequence: releaseAligned(bufferPtr)
+
+  Inputs:
+
+    bufferPtr - A pointer to the buffer.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SampleConverter::releaseAligned(void *bufferPtr)
+{
+
+  free(bufferPtr);
+
+  return;
+
+} // releaseAligned
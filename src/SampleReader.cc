@@ -0,0 +1,802 @@
+//************************************************************************
+// file name: SampleReader.cc
+//************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SampleReader.h"
+
+using namespace std;
+
+// The size of the staging buffer in bytes.
+#define STAGING_BUFFER_SIZE (256 * 1024)
+
+// WAVE format tags.
+#define WAVE_FORMAT_PCM (0x0001)
+#define WAVE_FORMAT_IEEE_FLOAT (0x0003)
+#define WAVE_FORMAT_EXTENSIBLE (0xfffe)
+
+/*****************************************************************************
+
+  Name: getLittleEndian16
+
+  Purpose: The purpose of this function is to extract a little endian
+  16-bit value from a byte buffer.
+
+  Calling Sequence: value = getLittleEndian16(bufferPtr)
+
+  Inputs:
+
+    bufferPtr - A pointer to the first byte of the value.
+
+  Outputs:
+
+    value - The extracted value.
+
+*****************************************************************************/
+static uint16_t getLittleEndian16(const uint8_t *bufferPtr)
+{
+
+  return ((uint16_t)(bufferPtr[0] | (bufferPtr[1] << 8)));
+
+} // getLittleEndian16
+
+/*****************************************************************************
+
+  Name: getLittleEndian32
+
+  Purpose: The purpose of this function is to extract a little endian
+  32-bit value from a byte buffer.
+
+  Calling Sequence: value = getLittleEndian32(bufferPtr)
+
+  Inputs:
+
+    bufferPtr - A pointer to the first byte of the value.
+
+  Outputs:
+
+    value - The extracted value.
+
+*****************************************************************************/
+static uint32_t getLittleEndian32(const uint8_t *bufferPtr)
+{
+
+  return ((uint32_t)getLittleEndian16(bufferPtr) |
+          ((uint32_t)getLittleEndian16(bufferPtr + 2) << 16));
+
+} // getLittleEndian32
+
+/*****************************************************************************
+
+  Name: getLittleEndian64
+
+  Purpose: The purpose of this function is to extract a little endian
+  64-bit value from a byte buffer.
+
+  Calling Sequence: value = getLittleEndian64(bufferPtr)
+
+  Inputs:
+
+    bufferPtr - A pointer to the first byte of the value.
+
+  Outputs:
+
+    value - The extracted value.
+
+*****************************************************************************/
+static uint64_t getLittleEndian64(const uint8_t *bufferPtr)
+{
+
+  return ((uint64_t)getLittleEndian32(bufferPtr) |
+          ((uint64_t)getLittleEndian32(bufferPtr + 4) << 32));
+
+} // getLittleEndian64
+
+/*****************************************************************************
+
+  Name: SampleReader
+
+  Purpose: The purpose of this function is to serve as the constructor for
+  an instance of a SampleReader.  The beginning of the stream is probed
+  for a WAV or RF64 header.  If one is found, the header determines the
+  sample format and the number of channels, otherwise the stream is
+  treated as raw data with the specified format and number of channels.
+
+  Calling Sequence: SampleReader(streamPtr,rawFormat,rawNumberOfChannels,
+                                 fullScale)
+
+  Inputs:
+
+    streamPtr - The stream from which samples are read.
+
+    rawFormat - The sample format of a raw stream.
+
+    rawNumberOfChannels - The number of interleaved channels of a raw
+    stream.
+
+    fullScale - The float value to which a full scale sample maps.  See
+    SampleConverter::toFloat() for details.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+SampleReader::SampleReader(FILE *streamPtr,
+                           SampleFormat rawFormat,
+                           int rawNumberOfChannels,
+                           float fullScale)
+{
+
+  // Save for later use.
+  this->streamPtr = streamPtr;
+  ioPtr = NULL;
+
+  initialize(rawFormat,rawNumberOfChannels,fullScale);
+
+  return;
+
+} // SampleReader
+
+/*****************************************************************************
+
+  Name: SampleReader
+
+  Purpose: The purpose of this function is to serve as the constructor for
+  an instance of a SampleReader that reads through an AsyncBlockIo, so
+  that the input is read ahead while the caller processes samples.  The
+  stream is probed for a header the same as with the FILE constructor.
+
+  Calling Sequence: SampleReader(ioPtr,rawFormat,rawNumberOfChannels,
+                                 fullScale)
+
+  Inputs:
+
+    ioPtr - The asynchronous I/O instance from which samples are read.
+
+    rawFormat - The sample format of a raw stream.
+
+    rawNumberOfChannels - The number of interleaved channels of a raw
+    stream.
+
+    fullScale - The float value to which a full scale sample maps.  See
+    SampleConverter::toFloat() for details.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+SampleReader::SampleReader(AsyncBlockIo *ioPtr,
+                           SampleFormat rawFormat,
+                           int rawNumberOfChannels,
+                           float fullScale)
+{
+
+  // Save for later use.
+  streamPtr = NULL;
+  this->ioPtr = ioPtr;
+
+  initialize(rawFormat,rawNumberOfChannels,fullScale);
+
+  return;
+
+} // SampleReader
+
+/*****************************************************************************
+
+  Name: initialize
+
+  Purpose: The purpose of this function is to perform the construction
+  that is common to both sources of samples.  The beginning of the
+  stream is probed for a WAV or RF64 header.
+
+  Calling Sequence: initialize(rawFormat,rawNumberOfChannels,fullScale)
+
+  Inputs:
+
+    rawFormat - The sample format of a raw stream.
+
+    rawNumberOfChannels - The number of interleaved channels of a raw
+    stream.
+
+    fullScale - The float value to which a full scale sample maps.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SampleReader::initialize(SampleFormat rawFormat,
+                              int rawNumberOfChannels,
+                              float fullScale)
+{
+
+  // Save for later use.
+  this->fullScale = fullScale;
+
+  // Default to raw data.
+  container = SAMPLE_CONTAINER_RAW;
+  format = rawFormat;
+  numberOfChannels = rawNumberOfChannels;
+  sampleRate = 0;
+  bytesRemaining = UINT64_MAX;
+  valid = true;
+
+  // Allocate the staging buffer.
+  stagingBufferSize = STAGING_BUFFER_SIZE;
+  stagingBufferPtr =
+    (uint8_t *)SampleConverter::allocateAligned(stagingBufferSize);
+
+  // Probe for a header.
+  probeIndex = 0;
+  probeLength = readStream(probeBuffer,sizeof(probeBuffer));
+
+  if (probeLength == sizeof(probeBuffer))
+  {
+    if ((memcmp(&probeBuffer[8],"WAVE",4) == 0) &&
+        ((memcmp(probeBuffer,"RIFF",4) == 0) ||
+         (memcmp(probeBuffer,"RF64",4) == 0)))
+    {
+      if (memcmp(probeBuffer,"RF64",4) == 0)
+      {
+        container = SAMPLE_CONTAINER_RF64;
+      } // if
+      else
+      {
+        container = SAMPLE_CONTAINER_WAV;
+      } // else
+
+      // The header is not sample data.
+      probeLength = 0;
+
+      valid = parseWaveHeader();
+    } // if
+  } // if
+
+  if (numberOfChannels < 1)
+  {
+    valid = false;
+  } // if
+
+  frameSize = SampleConverter::getSampleSize(format) * numberOfChannels;
+
+  return;
+
+} // initialize
+
+/*****************************************************************************
+
+  Name: ~SampleReader
+
+  Purpose: The purpose of this function is to serve as the destructor for
+  an instance of a SampleReader.  The stream is not closed.
+
+  Calling Sequence: ~SampleReader()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+SampleReader::~SampleReader(void)
+{
+
+  // Release resources.
+  SampleConverter::releaseAligned(stagingBufferPtr);
+
+  return;
+
+} // ~SampleReader
+
+/*****************************************************************************
+
+  Name: isValid
+
+  Purpose: The purpose of this function is to indicate whether or not the
+  stream can be decoded.
+
+  Calling Sequence: valid = isValid()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    valid - A flag that indicates whether the stream can be decoded.  A
+    value of true indicates that it can, and a value of false indicates
+    that the header is malformed or describes an unsupported format.
+
+*****************************************************************************/
+bool SampleReader::isValid(void)
+{
+
+  return (valid);
+
+} // isValid
+
+/*****************************************************************************
+
+  Name: getContainer
+
+  Purpose: The purpose of this function is to return the container
+  format of the stream.
+
+  Calling Sequence: container = getContainer()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    container - The container format.
+
+*****************************************************************************/
+SampleContainer SampleReader::getContainer(void)
+{
+
+  return (container);
+
+} // getContainer
+
+/*****************************************************************************
+
+  Name: getFormat
+
+  Purpose: The purpose of this function is to return the sample format
+  of the stream.
+
+  Calling Sequence: format = getFormat()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    format - The sample format.
+
+*****************************************************************************/
+SampleFormat SampleReader::getFormat(void)
+{
+
+  return (format);
+
+} // getFormat
+
+/*****************************************************************************
+
+  Name: getNumberOfChannels
+
+  Purpose: The purpose of this function is to return the number of
+  interleaved channels in the stream.
+
+  Calling Sequence: numberOfChannels = getNumberOfChannels()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    numberOfChannels - The number of channels.
+
+*****************************************************************************/
+int SampleReader::getNumberOfChannels(void)
+{
+
+  return (numberOfChannels);
+
+} // getNumberOfChannels
+
+/*****************************************************************************
+
+  Name: getSampleRate
+
+  Purpose: The purpose of this function is to return the sample rate
+  of the stream.
+
+  Calling Sequence: sampleRate = getSampleRate()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    sampleRate - The sample rate in S/s.  A value of 0 indicates that
+    the sample rate is unknown, as is the case for raw streams.
+
+*****************************************************************************/
+uint32_t SampleReader::getSampleRate(void)
+{
+
+  return (sampleRate);
+
+} // getSampleRate
+
+/*****************************************************************************
+
+  Name: readFrames
+
+  Purpose: The purpose of this function is to read a block of frames
+  from the stream and to convert them to float.  A frame contains one
+  sample of each channel, and the channels are interleaved in the
+  output.  Only as many bytes as are needed are requested from the
+  stream so that small reads don't stall waiting for data that has not
+  been produced yet.
+
+  Calling Sequence: count = readFrames(bufferPtr,maxFrames)
+
+  Inputs:
+
+    bufferPtr - A pointer to storage for the frames.  It must be able
+    to hold maxFrames * getNumberOfChannels() samples.
+
+    maxFrames - The maximum number of frames to read.
+
+  Outputs:
+
+    count - The number of frames that were read.  A value less than
+    maxFrames indicates that the end of the stream was reached.
+
+*****************************************************************************/
+uint32_t SampleReader::readFrames(float *bufferPtr,uint32_t maxFrames)
+{
+  bool done;
+  uint32_t count;
+  uint32_t framesToRead;
+  uint32_t bytesToRead;
+  uint32_t bytesRead;
+  uint32_t framesRead;
+
+  count = 0;
+
+  if (!valid)
+  {
+    return (0);
+  } // if
+
+  // Set up for loop entry.
+  done = false;
+
+  while ((!done) && (count < maxFrames))
+  {
+    framesToRead = maxFrames - count;
+
+    // Don't overrun the staging buffer.
+    if (framesToRead > (stagingBufferSize / frameSize))
+    {
+      framesToRead = stagingBufferSize / frameSize;
+    } // if
+
+    bytesToRead = framesToRead * frameSize;
+
+    // Don't read past the data chunk.
+    if (bytesToRead > bytesRemaining)
+    {
+      bytesToRead = (uint32_t)(bytesRemaining - (bytesRemaining % frameSize));
+    } // if
+
+    bytesRead = readBytes(stagingBufferPtr,bytesToRead);
+
+    if (bytesRemaining != UINT64_MAX)
+    {
+      bytesRemaining -= bytesRead;
+    } // if
+
+    // A trailing partial frame is discarded.
+    framesRead = bytesRead / frameSize;
+
+    SampleConverter::toFloat(stagingBufferPtr,
+                             format,
+                             framesRead * numberOfChannels,
+                             fullScale,
+                             &bufferPtr[count * numberOfChannels]);
+
+    count += framesRead;
+
+    if ((bytesRead < bytesToRead) || (bytesToRead == 0))
+    {
+      // We're done.
+      done = true;
+    } // if
+  } // while
+
+  return (count);
+
+} // readFrames
+
+/*****************************************************************************
+
+  Name: readBytes
+
+  Purpose: The purpose of this function is to read bytes from the stream.
+  Any bytes that were consumed while probing for a header are returned
+  first.
+
+  Calling Sequence: bytesRead = readBytes(bufferPtr,count)
+
+  Inputs:
+
+    bufferPtr - A pointer to storage for the bytes.
+
+    count - The number of bytes to read.
+
+  Outputs:
+
+    bytesRead - The number of bytes that were read.
+
+*****************************************************************************/
+uint32_t SampleReader::readBytes(void *bufferPtr,uint32_t count)
+{
+  uint32_t bytesRead;
+  uint8_t *destinationPtr;
+
+  destinationPtr = (uint8_t *)bufferPtr;
+  bytesRead = 0;
+
+  // Drain the probe buffer first.
+  while ((probeIndex < probeLength) && (bytesRead < count))
+  {
+    destinationPtr[bytesRead] = probeBuffer[probeIndex];
+    bytesRead++;
+    probeIndex++;
+  } // while
+
+  if (bytesRead < count)
+  {
+    bytesRead += readStream(&destinationPtr[bytesRead],count - bytesRead);
+  } // if
+
+  return (bytesRead);
+
+} // readBytes
+
+/*****************************************************************************
+
+  Name: readStream
+
+  Purpose: The purpose of this function is to read bytes from whichever
+  source the reader was constructed with.
+
+  Calling Sequence: bytesRead = readStream(bufferPtr,count)
+
+  Inputs:
+
+    bufferPtr - A pointer to storage for the bytes.
+
+    count - The number of bytes to read.
+
+  Outputs:
+
+    bytesRead - The number of bytes that were read.
+
+*****************************************************************************/
+uint32_t SampleReader::readStream(void *bufferPtr,uint32_t count)
+{
+  uint32_t bytesRead;
+
+  if (ioPtr != NULL)
+  {
+    bytesRead = ioPtr->read(bufferPtr,count);
+  } // if
+  else
+  {
+    bytesRead = fread(bufferPtr,1,count,streamPtr);
+  } // else
+
+  return (bytesRead);
+
+} // readStream
+
+/*****************************************************************************
+
+  Name: skipBytes
+
+  Purpose: The purpose of this function is to skip over bytes in the
+  stream.  The bytes are read rather than seeked over so that pipes are
+  supported.
+
+  Calling Sequence: success = skipBytes(count)
+
+  Inputs:
+
+    count - The number of bytes to skip.
+
+  Outputs:
+
+    success - A flag that indicates whether all of the bytes were
+    skipped.  A value of false indicates that the end of the stream was
+    reached.
+
+*****************************************************************************/
+bool SampleReader::skipBytes(uint64_t count)
+{
+  uint32_t chunkSize;
+
+  while (count > 0)
+  {
+    chunkSize = stagingBufferSize;
+
+    if (count < chunkSize)
+    {
+      chunkSize = (uint32_t)count;
+    } // if
+
+    if (readBytes(stagingBufferPtr,chunkSize) != chunkSize)
+    {
+      return (false);
+    } // if
+
+    count -= chunkSize;
+  } // while
+
+  return (true);
+
+} // skipBytes
+
+/*****************************************************************************
+
+  Name: parseWaveHeader
+
+  Purpose: The purpose of this function is to parse the chunks of a WAV
+  or RF64 file that precede the sample data.  When this function
+  returns successfully, the stream is positioned at the first sample.
+  For RF64 files, the 64-bit data size is taken from the ds64 chunk.
+  A data chunk size of 0 or 0xffffffff in a WAV file indicates a
+  streamed file whose size was not known when the header was written,
+  so such a file is read until end of file.
+
+  Calling Sequence: success = parseWaveHeader()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    success - A flag that indicates whether the header was parsed.  A
+    value of true indicates success, and a value of false indicates that
+    the header is malformed or describes an unsupported format.
+
+*****************************************************************************/
+bool SampleReader::parseWaveHeader(void)
+{
+  bool done;
+  bool formatFound;
+  uint8_t chunkHeader[8];
+  uint8_t chunkData[40];
+  uint32_t chunkSize;
+  uint32_t bytesToRead;
+  uint16_t formatTag;
+  uint16_t bitsPerSample;
+  uint64_t dataSize64;
+
+  formatFound = false;
+  dataSize64 = UINT64_MAX;
+
+  // Set up for loop entry.
+  done = false;
+
+  while (!done)
+  {
+    if (readBytes(chunkHeader,sizeof(chunkHeader)) != sizeof(chunkHeader))
+    {
+      // No data chunk was found.
+      return (false);
+    } // if
+
+    chunkSize = getLittleEndian32(&chunkHeader[4]);
+
+    if ((memcmp(chunkHeader,"fmt ",4) == 0) ||
+        (memcmp(chunkHeader,"ds64",4) == 0))
+    {
+      // Only the leading fields of these chunks are needed.
+      bytesToRead = chunkSize;
+      if (bytesToRead > sizeof(chunkData))
+      {
+        bytesToRead = sizeof(chunkData);
+      } // if
+
+      if (readBytes(chunkData,bytesToRead) != bytesToRead)
+      {
+        return (false);
+      } // if
+
+      if (!skipBytes(chunkSize - bytesToRead + (chunkSize & 1)))
+      {
+        return (false);
+      } // if
+
+      if (memcmp(chunkHeader,"ds64",4) == 0)
+      {
+        if (bytesToRead < 16)
+        {
+          return (false);
+        } // if
+
+        // Skip the RIFF size and retrieve the data size.
+        dataSize64 = getLittleEndian64(&chunkData[8]);
+      } // if
+      else
+      {
+        if (bytesToRead < 16)
+        {
+          return (false);
+        } // if
+
+        formatTag = getLittleEndian16(&chunkData[0]);
+        numberOfChannels = getLittleEndian16(&chunkData[2]);
+        sampleRate = getLittleEndian32(&chunkData[4]);
+        bitsPerSample = getLittleEndian16(&chunkData[14]);
+
+        if ((formatTag == WAVE_FORMAT_EXTENSIBLE) && (bytesToRead >= 26))
+        {
+          // The format tag is the start of the subformat GUID.
+          formatTag = getLittleEndian16(&chunkData[24]);
+        } // if
+
+        if ((formatTag == WAVE_FORMAT_PCM) && (bitsPerSample == 16))
+        {
+          format = SAMPLE_FORMAT_S16;
+        } // if
+        else if ((formatTag == WAVE_FORMAT_PCM) && (bitsPerSample == 32))
+        {
+          format = SAMPLE_FORMAT_S32;
+        } // else if
+        else if ((formatTag == WAVE_FORMAT_IEEE_FLOAT) &&
+                 (bitsPerSample == 32))
+        {
+          format = SAMPLE_FORMAT_F32;
+        } // else if
+        else
+        {
+          // Unsupported format.
+          return (false);
+        } // else
+
+        formatFound = true;
+      } // else
+    } // if
+    else if (memcmp(chunkHeader,"data",4) == 0)
+    {
+      if ((container == SAMPLE_CONTAINER_RF64) && (chunkSize == 0xffffffff))
+      {
+        // A zero size in the ds64 chunk indicates a streamed file.
+        bytesRemaining = (dataSize64 == 0) ? UINT64_MAX : dataSize64;
+      } // if
+      else if ((chunkSize == 0) || (chunkSize == 0xffffffff))
+      {
+        // Streamed file, so read until end of file.
+        bytesRemaining = UINT64_MAX;
+      } // else if
+      else
+      {
+        bytesRemaining = chunkSize;
+      } // else
+
+      // The samples follow.
+      done = true;
+    } // else if
+    else
+    {
+      // Skip over chunks that we don't care about.
+      if (!skipBytes((uint64_t)chunkSize + (chunkSize & 1)))
+      {
+        return (false);
+      } // if
+    } // else
+  } // while
+
+  return (formatFound);
+
+} // parseWaveHeader
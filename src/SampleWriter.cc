@@ -0,0 +1,633 @@
+//************************************************************************
+// file name: SampleWriter.cc
+//************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SampleWriter.h"
+
+using namespace std;
+
+// The size of the staging buffer in bytes.
+#define STAGING_BUFFER_SIZE (256 * 1024)
+
+// The size of the header that precedes the sample data.  It consists of
+// the RIFF header (12 bytes), a JUNK or ds64 chunk (36 bytes), a fmt
+// chunk (24 bytes), and the data chunk header (8 bytes).
+#define WAVE_HEADER_SIZE (80)
+
+// WAVE format tags.
+#define WAVE_FORMAT_PCM (0x0001)
+#define WAVE_FORMAT_IEEE_FLOAT (0x0003)
+
+/*****************************************************************************
+
+  Name: putLittleEndian16
+
+  Purpose: The purpose of this function is to store a 16-bit value into
+  a byte buffer in little endian order.
+
+  Calling Sequence: putLittleEndian16(bufferPtr,value)
+
+  Inputs:
+
+    bufferPtr - A pointer to storage for the value.
+
+    value - The value to store.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void putLittleEndian16(uint8_t *bufferPtr,uint16_t value)
+{
+
+  bufferPtr[0] = (uint8_t)value;
+  bufferPtr[1] = (uint8_t)(value >> 8);
+
+  return;
+
+} // putLittleEndian16
+
+/*****************************************************************************
+
+  Name: putLittleEndian32
+
+  Purpose: The purpose of this function is to store a 32-bit value into
+  a byte buffer in little endian order.
+
+  Calling Sequence: putLittleEndian32(bufferPtr,value)
+
+  Inputs:
+
+    bufferPtr - A pointer to storage for the value.
+
+    value - The value to store.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void putLittleEndian32(uint8_t *bufferPtr,uint32_t value)
+{
+
+  putLittleEndian16(bufferPtr,(uint16_t)value);
+  putLittleEndian16(bufferPtr + 2,(uint16_t)(value >> 16));
+
+  return;
+
+} // putLittleEndian32
+
+/*****************************************************************************
+
+  Name: putLittleEndian64
+
+  Purpose: The purpose of this function is to store a 64-bit value into
+  a byte buffer in little endian order.
+
+  Calling Sequence: putLittleEndian64(bufferPtr,value)
+
+  Inputs:
+
+    bufferPtr - A pointer to storage for the value.
+
+    value - The value to store.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void putLittleEndian64(uint8_t *bufferPtr,uint64_t value)
+{
+
+  putLittleEndian32(bufferPtr,(uint32_t)value);
+  putLittleEndian32(bufferPtr + 4,(uint32_t)(value >> 32));
+
+  return;
+
+} // putLittleEndian64
+
+/*****************************************************************************
+
+  Name: SampleWriter
+
+  Purpose: The purpose of this function is to serve as the constructor for
+  an instance of a SampleWriter.  For WAV and RF64 containers, a header
+  is written immediately.
+
+  Calling Sequence: SampleWriter(streamPtr,container,format,
+                                 numberOfChannels,sampleRate,fullScale)
+
+  Inputs:
+
+    streamPtr - The stream to which samples are written.
+
+    container - The container format.
+
+    format - The sample format.
+
+    numberOfChannels - The number of interleaved channels.
+
+    sampleRate - The sample rate in S/s.  This is only used for WAV and
+    RF64 containers.
+
+    fullScale - The float value that maps to a full scale sample.  See
+    SampleConverter::fromFloat() for details.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+SampleWriter::SampleWriter(FILE *streamPtr,
+                           SampleContainer container,
+                           SampleFormat format,
+                           int numberOfChannels,
+                           uint32_t sampleRate,
+                           float fullScale)
+{
+
+  // Save for later use.
+  this->streamPtr = streamPtr;
+  ioPtr = NULL;
+
+  // Pipes can't be seeked, so their headers can't be patched.
+  seekable = (fseeko(streamPtr,0,SEEK_CUR) == 0);
+
+  initialize(container,format,numberOfChannels,sampleRate,fullScale);
+
+  return;
+
+} // SampleWriter
+
+/*****************************************************************************
+
+  Name: SampleWriter
+
+  Purpose: The purpose of this function is to serve as the constructor for
+  an instance of a SampleWriter that writes through an AsyncBlockIo, so
+  that the output is written behind while the caller processes samples.
+  For WAV and RF64 containers, a header is written immediately.
+
+  Calling Sequence: SampleWriter(ioPtr,container,format,
+                                 numberOfChannels,sampleRate,fullScale)
+
+  Inputs:
+
+    ioPtr - The asynchronous I/O instance to which samples are written.
+
+    container - The container format.
+
+    format - The sample format.
+
+    numberOfChannels - The number of interleaved channels.
+
+    sampleRate - The sample rate in S/s.  This is only used for WAV and
+    RF64 containers.
+
+    fullScale - The float value that maps to a full scale sample.  See
+    SampleConverter::fromFloat() for details.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+SampleWriter::SampleWriter(AsyncBlockIo *ioPtr,
+                           SampleContainer container,
+                           SampleFormat format,
+                           int numberOfChannels,
+                           uint32_t sampleRate,
+                           float fullScale)
+{
+
+  // Save for later use.
+  streamPtr = NULL;
+  this->ioPtr = ioPtr;
+
+  seekable = ioPtr->isOutputSeekable();
+
+  initialize(container,format,numberOfChannels,sampleRate,fullScale);
+
+  return;
+
+} // SampleWriter
+
+/*****************************************************************************
+
+  Name: initialize
+
+  Purpose: The purpose of this function is to perform the construction
+  that is common to both destinations of samples.  For WAV and RF64
+  containers, a header is written immediately.
+
+  Calling Sequence: initialize(container,format,numberOfChannels,
+                               sampleRate,fullScale)
+
+  Inputs:
+
+    container - The container format.
+
+    format - The sample format.
+
+    numberOfChannels - The number of interleaved channels.
+
+    sampleRate - The sample rate in S/s.
+
+    fullScale - The float value that maps to a full scale sample.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SampleWriter::initialize(SampleContainer container,
+                              SampleFormat format,
+                              int numberOfChannels,
+                              uint32_t sampleRate,
+                              float fullScale)
+{
+
+  // Save for later use.
+  this->container = container;
+  this->format = format;
+  this->numberOfChannels = numberOfChannels;
+  this->sampleRate = sampleRate;
+  this->fullScale = fullScale;
+
+  frameSize = SampleConverter::getSampleSize(format) * numberOfChannels;
+  dataSize = 0;
+  closed = false;
+
+  // Allocate the staging buffer.
+  stagingBufferSize = STAGING_BUFFER_SIZE;
+  stagingBufferPtr =
+    (uint8_t *)SampleConverter::allocateAligned(stagingBufferSize);
+
+  if (container != SAMPLE_CONTAINER_RAW)
+  {
+    writeWaveHeader(false);
+  } // if
+
+  return;
+
+} // initialize
+
+/*****************************************************************************
+
+  Name: ~SampleWriter
+
+  Purpose: The purpose of this function is to serve as the destructor for
+  an instance of a SampleWriter.  The header is finalized if close()
+  was not called.  The stream is not closed.
+
+  Calling Sequence: ~SampleWriter()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+SampleWriter::~SampleWriter(void)
+{
+
+  close();
+
+  // Release resources.
+  SampleConverter::releaseAligned(stagingBufferPtr);
+
+  return;
+
+} // ~SampleWriter
+
+/*****************************************************************************
+
+  Name: writeFrames
+
+  Purpose: The purpose of this function is to convert a block of float
+  frames to the output format and to write them to the stream.
+
+  Calling Sequence: count = writeFrames(bufferPtr,numberOfFrames)
+
+  Inputs:
+
+    bufferPtr - A pointer to the interleaved frames.
+
+    numberOfFrames - The number of frames to write.
+
+  Outputs:
+
+    count - The number of frames that were written.
+
+*****************************************************************************/
+uint32_t SampleWriter::writeFrames(const float *bufferPtr,
+                                   uint32_t numberOfFrames)
+{
+  uint32_t count;
+  uint32_t framesToWrite;
+  uint32_t bytesWritten;
+
+  count = 0;
+
+  while (count < numberOfFrames)
+  {
+    framesToWrite = numberOfFrames - count;
+
+    // Don't overrun the staging buffer.
+    if (framesToWrite > (stagingBufferSize / frameSize))
+    {
+      framesToWrite = stagingBufferSize / frameSize;
+    } // if
+
+    SampleConverter::fromFloat(&bufferPtr[count * numberOfChannels],
+                               framesToWrite * numberOfChannels,
+                               fullScale,
+                               format,
+                               stagingBufferPtr);
+
+    bytesWritten = writeStream(stagingBufferPtr,framesToWrite * frameSize);
+
+    dataSize += bytesWritten;
+    count += bytesWritten / frameSize;
+
+    if (bytesWritten < (framesToWrite * frameSize))
+    {
+      // The stream is broken, so bail out.
+      break;
+    } // if
+  } // while
+
+  return (count);
+
+} // writeFrames
+
+/*****************************************************************************
+
+  Name: flush
+
+  Purpose: The purpose of this function is to push the samples that have
+  been written so far out to the stream, so that the output holds all
+  of them, for example before a checkpoint is taken.  The header is not
+  touched.
+
+  Calling Sequence: flush()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SampleWriter::flush(void)
+{
+
+  if (ioPtr != NULL)
+  {
+    ioPtr->flush();
+  } // if
+  else
+  {
+    fflush(streamPtr);
+  } // else
+
+  return;
+
+} // flush
+
+/*****************************************************************************
+
+  Name: close
+
+  Purpose: The purpose of this function is to finalize the output.  The
+  stream is flushed, and for seekable WAV and RF64 outputs, the header
+  is rewritten with the final sizes.  The stream is left positioned at
+  its end.
+
+  Calling Sequence: close()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SampleWriter::close(void)
+{
+  uint8_t padding;
+
+  if (closed)
+  {
+    return;
+  } // if
+
+  closed = true;
+
+  if ((container != SAMPLE_CONTAINER_RAW) && seekable)
+  {
+    // WAV data chunks must have an even size.
+    if (dataSize & 1)
+    {
+      padding = 0;
+      writeStream(&padding,1);
+    } // if
+
+    if (ioPtr != NULL)
+    {
+      // The header is written in place.
+      writeWaveHeader(true);
+    } // if
+    else if (fseeko(streamPtr,0,SEEK_SET) == 0)
+    {
+      writeWaveHeader(true);
+      fseeko(streamPtr,0,SEEK_END);
+    } // else if
+  } // if
+
+  if (ioPtr != NULL)
+  {
+    ioPtr->flush();
+  } // if
+  else
+  {
+    fflush(streamPtr);
+  } // else
+
+  return;
+
+} // close
+
+/*****************************************************************************
+
+  Name: writeWaveHeader
+
+  Purpose: The purpose of this function is to write the WAV or RF64
+  header at the current position of the stream (or, for a final header
+  written through an AsyncBlockIo, at the start of the output).  The
+  layout follows
+  EBU Tech 3306: a WAV file carries a JUNK chunk that is the same size
+  as a ds64 chunk so that it can be promoted to RF64 in place.  While
+  the final sizes are not known, the size fields are set to 0xffffffff.
+
+  Calling Sequence: writeWaveHeader(finalHeader)
+
+  Inputs:
+
+    finalHeader - A flag that indicates whether the final sizes are
+    known.  A value of true indicates that dataSize is the final size
+    of the sample data.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SampleWriter::writeWaveHeader(bool finalHeader)
+{
+  bool rf64;
+  uint8_t header[WAVE_HEADER_SIZE];
+  uint64_t riffSize;
+  uint16_t formatTag;
+  uint16_t bitsPerSample;
+
+  memset(header,0,sizeof(header));
+
+  riffSize = WAVE_HEADER_SIZE - 8 + dataSize + (dataSize & 1);
+
+  // Promote to RF64 when a WAV file can't describe the data.
+  rf64 = (container == SAMPLE_CONTAINER_RF64) ||
+         (finalHeader && (riffSize > 0xffffffffULL));
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // RIFF header.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  memcpy(&header[0],rf64 ? "RF64" : "RIFF",4);
+
+  if (finalHeader && (!rf64))
+  {
+    putLittleEndian32(&header[4],(uint32_t)riffSize);
+  } // if
+  else
+  {
+    putLittleEndian32(&header[4],0xffffffff);
+  } // else
+
+  memcpy(&header[8],"WAVE",4);
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // JUNK or ds64 chunk.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  memcpy(&header[12],rf64 ? "ds64" : "JUNK",4);
+  putLittleEndian32(&header[16],28);
+
+  if (rf64)
+  {
+    putLittleEndian64(&header[20],finalHeader ? riffSize : 0);
+    putLittleEndian64(&header[28],finalHeader ? dataSize : 0);
+    putLittleEndian64(&header[36],finalHeader ? (dataSize / frameSize) : 0);
+    putLittleEndian32(&header[44],0);
+  } // if
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // fmt chunk.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  bitsPerSample = SampleConverter::getSampleSize(format) * 8;
+
+  if (format == SAMPLE_FORMAT_F32)
+  {
+    formatTag = WAVE_FORMAT_IEEE_FLOAT;
+  } // if
+  else
+  {
+    formatTag = WAVE_FORMAT_PCM;
+  } // else
+
+  memcpy(&header[48],"fmt ",4);
+  putLittleEndian32(&header[52],16);
+  putLittleEndian16(&header[56],formatTag);
+  putLittleEndian16(&header[58],(uint16_t)numberOfChannels);
+  putLittleEndian32(&header[60],sampleRate);
+  putLittleEndian32(&header[64],sampleRate * frameSize);
+  putLittleEndian16(&header[68],(uint16_t)frameSize);
+  putLittleEndian16(&header[70],bitsPerSample);
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // data chunk header.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  memcpy(&header[72],"data",4);
+
+  if (finalHeader && (!rf64))
+  {
+    putLittleEndian32(&header[76],(uint32_t)dataSize);
+  } // if
+  else
+  {
+    putLittleEndian32(&header[76],0xffffffff);
+  } // else
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  if ((ioPtr != NULL) && finalHeader)
+  {
+    ioPtr->writeAt(0,header,sizeof(header));
+  } // if
+  else
+  {
+    writeStream(header,sizeof(header));
+  } // else
+
+  return;
+
+} // writeWaveHeader
+
+/*****************************************************************************
+
+  Name: writeStream
+
+  Purpose: The purpose of this function is to write bytes to whichever
+  destination the writer was constructed with.
+
+  Calling Sequence: bytesWritten = writeStream(bufferPtr,count)
+
+  Inputs:
+
+    bufferPtr - A pointer to the bytes.
+
+    count - The number of bytes to write.
+
+  Outputs:
+
+    bytesWritten - The number of bytes that were written.
+
+*****************************************************************************/
+uint32_t SampleWriter::writeStream(const void *bufferPtr,uint32_t count)
+{
+  uint32_t bytesWritten;
+
+  if (ioPtr != NULL)
+  {
+    bytesWritten = ioPtr->write(bufferPtr,count);
+  } // if
+  else
+  {
+    bytesWritten = fwrite(bufferPtr,1,count,streamPtr);
+  } // else
+
+  return (bytesWritten);
+
+} // writeStream
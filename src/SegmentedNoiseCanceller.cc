@@ -0,0 +1,617 @@
+//************************************************************************
+// file name: SegmentedNoiseCanceller.cc
+//************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SegmentedNoiseCanceller.h"
+#include "SampleConverter.h"
+
+using namespace std;
+
+/*****************************************************************************
+
+  Name: SegmentedNoiseCanceller
+
+  Purpose: The purpose of this function is to serve as the constructor for
+  an instance of a SegmentedNoiseCanceller.  Every segment gets its own
+  canceller with the same filter order, delay, and convergence factor,
+  but the cancellers are not created until the segments are processed.
+  The segments are processed by the caller until setNumberOfThreads()
+  is called, and there is no overlap until setOverlap() is called.
+
+  Calling Sequence: SegmentedNoiseCanceller(numberOfSegments,
+                                            filterLength,
+                                            referenceDelay,
+                                            beta)
+
+  Inputs:
+
+    numberOfSegments - The largest number of segments.  A value less
+    than 1 is taken as 1.
+
+    filterLength - The number of taps of each canceller.
+
+    referenceDelay - The reference delay of each canceller.
+
+    beta - The normalized step-size of each canceller.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+SegmentedNoiseCanceller::SegmentedNoiseCanceller(int numberOfSegments,
+                                                 int filterLength,
+                                                 int referenceDelay,
+                                                 float beta)
+{
+
+  if (numberOfSegments < 1)
+  {
+    numberOfSegments = 1;
+  } // if
+
+  // Save for later use.
+  requestedSegments = numberOfSegments;
+  this->numberOfSegments = numberOfSegments;
+  this->filterLength = filterLength;
+  this->referenceDelay = referenceDelay;
+  this->beta = beta;
+
+  // Default to the modes of a new canceller.
+  configurePtr = NULL;
+  configureArgPtr = NULL;
+
+  overlap = 0;
+  blockSize = DEFAULT_BLOCK_SIZE;
+  numberOfThreads = 1;
+
+  inputPtr = NULL;
+  outputPtr = NULL;
+  inputLength = 0;
+  nextSegment = 0;
+
+  pthread_mutex_init(&mutex,NULL);
+
+  return;
+
+} // SegmentedNoiseCanceller
+
+/*****************************************************************************
+
+  Name: ~SegmentedNoiseCanceller
+
+  Purpose: The purpose of this function is to serve as the destructor for
+  an instance of a SegmentedNoiseCanceller.
+
+  Calling Sequence: ~SegmentedNoiseCanceller()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+SegmentedNoiseCanceller::~SegmentedNoiseCanceller(void)
+{
+
+  // Release resources.
+  pthread_mutex_destroy(&mutex);
+
+  return;
+
+} // ~SegmentedNoiseCanceller
+
+/*****************************************************************************
+
+  Name: setConfigurator
+
+  Purpose: The purpose of this function is to set the function that
+  sets the modes of the canceller of each segment.  It is called by the
+  thread that takes a segment, right after the canceller is created, so
+  it may be called by several threads at once.
+
+  Calling Sequence: setConfigurator(configurePtr,argPtr)
+
+  Inputs:
+
+    configurePtr - A pointer to the function, or NULL to leave the modes
+    of a new canceller as they are.
+
+    argPtr - A pointer that is passed to the function.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SegmentedNoiseCanceller::setConfigurator(ConfigureFunction configurePtr,
+                                              void *argPtr)
+{
+
+  this->configurePtr = configurePtr;
+  configureArgPtr = argPtr;
+
+  return;
+
+} // setConfigurator
+
+/*****************************************************************************
+
+  Name: setOverlap
+
+  Purpose: The purpose of this function is to set the number of samples
+  that the canceller of each segment adapts over before its segment
+  starts.  The overlap is taken from the end of the previous segment
+  (or from further back, if that segment is shorter than the overlap),
+  and it is cut short at the start of the recording.
+
+  Calling Sequence: setOverlap(overlap)
+
+  Inputs:
+
+    overlap - The number of samples of the overlap.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SegmentedNoiseCanceller::setOverlap(uint32_t overlap)
+{
+
+  this->overlap = overlap;
+
+  return;
+
+} // setOverlap
+
+/*****************************************************************************
+
+  Name: getOverlap
+
+  Purpose: The purpose of this function is to return the number of
+  samples that the canceller of each segment adapts over before its
+  segment starts.
+
+  Calling Sequence: overlap = getOverlap()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    overlap - The number of samples of the overlap.
+
+*****************************************************************************/
+uint32_t SegmentedNoiseCanceller::getOverlap(void)
+{
+
+  return (overlap);
+
+} // getOverlap
+
+/*****************************************************************************
+
+  Name: setBlockSize
+
+  Purpose: The purpose of this function is to set the number of samples
+  that are presented to a canceller at a time.  This matters only to
+  the modes that work on blocks, such as the automatic freeze, and it
+  should match the block size of the serial run that the output is
+  compared with.
+
+  Calling Sequence: setBlockSize(blockSize)
+
+  Inputs:
+
+    blockSize - The number of samples per block.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SegmentedNoiseCanceller::setBlockSize(uint32_t blockSize)
+{
+
+  if (blockSize < 1)
+  {
+    blockSize = 1;
+  } // if
+
+  this->blockSize = blockSize;
+
+  return;
+
+} // setBlockSize
+
+/*****************************************************************************
+
+  Name: setNumberOfThreads
+
+  Purpose: The purpose of this function is to set the number of threads
+  that process segments, including the caller.  The threads are started
+  by each call to acceptData(), and they take segments in order as they
+  become free, so there is no need for the number of segments to be a
+  multiple of the number of threads.
+
+  Calling Sequence: setNumberOfThreads(numberOfThreads)
+
+  Inputs:
+
+    numberOfThreads - The number of threads.  This is limited to the
+    range of 1 to the largest number of segments.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SegmentedNoiseCanceller::setNumberOfThreads(int numberOfThreads)
+{
+
+  if (numberOfThreads > requestedSegments)
+  {
+    numberOfThreads = requestedSegments;
+  } // if
+
+  if (numberOfThreads < 1)
+  {
+    numberOfThreads = 1;
+  } // if
+
+  this->numberOfThreads = numberOfThreads;
+
+  return;
+
+} // setNumberOfThreads
+
+/*****************************************************************************
+
+  Name: getNumberOfThreads
+
+  Purpose: The purpose of this function is to return the number of
+  threads that process segments, including the caller.  An idle thread
+  isn't started, so after a call to acceptData(), this is no more than
+  the number of segments of that call.
+
+  Calling Sequence: threads = getNumberOfThreads()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    threads - The number of threads.
+
+*****************************************************************************/
+int SegmentedNoiseCanceller::getNumberOfThreads(void)
+{
+  int threads;
+
+  threads = numberOfThreads;
+
+  if (threads > numberOfSegments)
+  {
+    threads = numberOfSegments;
+  } // if
+
+  return (threads);
+
+} // getNumberOfThreads
+
+/*****************************************************************************
+
+  Name: getNumberOfSegments
+
+  Purpose: The purpose of this function is to return the number of
+  segments.  After a call to acceptData(), this is the number that the
+  recording was divided into, which may be less than the number that
+  was asked for.
+
+  Calling Sequence: numberOfSegments = getNumberOfSegments()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    numberOfSegments - The number of segments.
+
+*****************************************************************************/
+int SegmentedNoiseCanceller::getNumberOfSegments(void)
+{
+
+  return (numberOfSegments);
+
+} // getNumberOfSegments
+
+/*****************************************************************************
+
+  Name: getSegmentStart
+
+  Purpose: The purpose of this function is to return the index of the
+  first sample of a segment.  The recording is divided into segments
+  whose lengths differ by at most one sample.
+
+  Calling Sequence: start = getSegmentStart(segment,bufferLength)
+
+  Inputs:
+
+    segment - The index of the segment, where 0 is the first segment.
+    An index of numberOfSegments gives the end of the last segment.
+
+    bufferLength - The number of samples of the recording.
+
+  Outputs:
+
+    start - The index of the first sample of the segment.
+
+*****************************************************************************/
+uint64_t SegmentedNoiseCanceller::getSegmentStart(int segment,
+                                                  uint64_t bufferLength)
+{
+
+  return ((bufferLength * segment) / numberOfSegments);
+
+} // getSegmentStart
+
+/*****************************************************************************
+
+  Name: processSegment
+
+  Purpose: The purpose of this function is to process one segment.  A
+  canceller is created for the segment, and it first adapts over the
+  overlap, whose output is written to scratch storage and discarded.
+  It then processes the segment, whose output is kept, and it is
+  released.
+
+  Calling Sequence: processSegment(segment,scratchPtr)
+
+  Inputs:
+
+    segment - The index of the segment.
+
+    scratchPtr - A pointer to storage for blockSize samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SegmentedNoiseCanceller::processSegment(int segment,float *scratchPtr)
+{
+  uint64_t i;
+  uint64_t start;
+  uint64_t end;
+  uint64_t warmupStart;
+  uint32_t count;
+  NlmsNoiseCanceller *cancellerPtr;
+
+  cancellerPtr = new NlmsNoiseCanceller(filterLength,referenceDelay,beta);
+
+  if (configurePtr != NULL)
+  {
+    configurePtr(cancellerPtr,configureArgPtr);
+  } // if
+
+  start = getSegmentStart(segment,inputLength);
+  end = getSegmentStart(segment + 1,inputLength);
+
+  warmupStart = 0;
+
+  if (start > overlap)
+  {
+    warmupStart = start - overlap;
+  } // if
+
+  // Converge over the overlap.
+  for (i = warmupStart; i < start; i += count)
+  {
+    count = blockSize;
+
+    if ((start - i) < count)
+    {
+      count = start - i;
+    } // if
+
+    cancellerPtr->acceptData(&inputPtr[i],count,scratchPtr);
+  } // for
+
+  // Process the segment itself.
+  for (i = start; i < end; i += count)
+  {
+    count = blockSize;
+
+    if ((end - i) < count)
+    {
+      count = end - i;
+    } // if
+
+    cancellerPtr->acceptData(&inputPtr[i],count,&outputPtr[i]);
+  } // for
+
+  delete cancellerPtr;
+
+  return;
+
+} // processSegment
+
+/*****************************************************************************
+
+  Name: processSegments
+
+  Purpose: The purpose of this function is to take segments, one at a
+  time, and process them until there are none left.  Each thread that
+  calls this has its own scratch storage.
+
+  Calling Sequence: processSegments()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SegmentedNoiseCanceller::processSegments(void)
+{
+  int segment;
+  float *scratchPtr;
+
+  scratchPtr = (float *)SampleConverter::allocateAligned(
+    blockSize * sizeof(float));
+
+  while (true)
+  {
+    pthread_mutex_lock(&mutex);
+    segment = nextSegment;
+    nextSegment++;
+    pthread_mutex_unlock(&mutex);
+
+    if (segment >= numberOfSegments)
+    {
+      // We're done.
+      break;
+    } // if
+
+    processSegment(segment,scratchPtr);
+  } // while
+
+  SampleConverter::releaseAligned(scratchPtr);
+
+  return;
+
+} // processSegments
+
+/*****************************************************************************
+
+  Name: segmentWorker
+
+  Purpose: The purpose of this function is to serve as the entry point
+  of a worker thread.
+
+  Calling Sequence: segmentWorker(argPtr)
+
+  Inputs:
+
+    argPtr - A pointer to the instance.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void *SegmentedNoiseCanceller::segmentWorker(void *argPtr)
+{
+  SegmentedNoiseCanceller *ownerPtr;
+
+  ownerPtr = (SegmentedNoiseCanceller *)argPtr;
+
+  ownerPtr->processSegments();
+
+  return (NULL);
+
+} // segmentWorker
+
+/*****************************************************************************
+
+  Name: acceptData
+
+  Purpose: The purpose of this function is to process a whole recording.
+  The number of segments is limited so that each segment is at least
+  as long as the overlap.  The worker threads are started, the caller
+  joins them in taking segments, and the threads are stopped once
+  every segment has been processed.
+
+  Calling Sequence: acceptData(bufferPtr,bufferLength,outputBufferPtr)
+
+  Inputs:
+
+    bufferPtr - A pointer to the samples of the recording.
+
+    bufferLength - The number of samples of the recording.
+
+    outputBufferPtr - A pointer to storage for the output samples.  This
+    must not be bufferPtr, since the overlap of a segment is read from
+    the input of the segment before it, which may already have been
+    processed.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SegmentedNoiseCanceller::acceptData(float *bufferPtr,
+                                         uint64_t bufferLength,
+                                         float *outputBufferPtr)
+{
+  int t;
+  int threads;
+  uint64_t maxSegments;
+  pthread_t *threadsPtr;
+
+  inputPtr = bufferPtr;
+  outputPtr = outputBufferPtr;
+  inputLength = bufferLength;
+  nextSegment = 0;
+
+  // Don't divide the recording more finely than the overlap.
+  maxSegments = bufferLength;
+
+  if (overlap > 1)
+  {
+    maxSegments = bufferLength / overlap;
+  } // if
+
+  numberOfSegments = requestedSegments;
+
+  if ((uint64_t)numberOfSegments > maxSegments)
+  {
+    numberOfSegments = (int)maxSegments;
+  } // if
+
+  if (numberOfSegments < 1)
+  {
+    numberOfSegments = 1;
+  } // if
+
+  // An idle thread isn't worth starting.  The count is only for this
+  // call, so that a later, longer recording can use every thread.
+  threads = numberOfThreads;
+
+  if (threads > numberOfSegments)
+  {
+    threads = numberOfSegments;
+  } // if
+
+  threadsPtr = new pthread_t[threads];
+
+  for (t = 1; t < threads; t++)
+  {
+    pthread_create(&threadsPtr[t],NULL,segmentWorker,this);
+  } // for
+
+  // The caller acts as thread 0.
+  processSegments();
+
+  for (t = 1; t < threads; t++)
+  {
+    pthread_join(threadsPtr[t],NULL);
+  } // for
+
+  delete[] threadsPtr;
+
+  return;
+
+} // acceptData
@@ -0,0 +1,978 @@
+//************************************************************************
+// file name: SignalGraph.cc
+//************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SignalGraph.h"
+
+using namespace std;
+
+/*****************************************************************************
+
+  Name: SignalGraph
+
+  Purpose: The purpose of this function is to serve as the constructor for
+  an instance of a SignalGraph.
+
+  Calling Sequence: SignalGraph(blockSize)
+
+  Inputs:
+
+    blockSize - The largest number of samples that is processed by one
+    call to processBlock().  Every buffer holds this many samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+SignalGraph::SignalGraph(uint32_t blockSize)
+{
+
+  if (blockSize == 0)
+  {
+    blockSize = 1;
+  } // if
+
+  this->blockSize = blockSize;
+
+  numberOfNodes = 0;
+  numberOfLevels = 0;
+  numberOfBuffers = 0;
+  arenaPtr = NULL;
+  prepared = false;
+
+  // Run on the calling thread until told otherwise.
+  numberOfThreads = 1;
+  threadPtr = NULL;
+  workerContextPtr = NULL;
+  blockCount = 0;
+  stopRequested = false;
+
+  return;
+
+} // SignalGraph
+
+/*****************************************************************************
+
+  Name: ~SignalGraph
+
+  Purpose: The purpose of this function is to serve as the destructor for
+  an instance of a SignalGraph.  The worker threads are stopped, and the
+  nodes and the buffers are released.
+
+  Calling Sequence: ~SignalGraph()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+SignalGraph::~SignalGraph(void)
+{
+  int n;
+
+  stopWorkers();
+
+  // Release resources.
+  for (n = 0; n < numberOfNodes; n++)
+  {
+    delete nodePtrs[n];
+  } // for
+
+  if (arenaPtr != NULL)
+  {
+    delete arenaPtr;
+  } // if
+
+  return;
+
+} // ~SignalGraph
+
+/*****************************************************************************
+
+  Name: addNode
+
+  Purpose: The purpose of this function is to add a node to the graph.
+  The graph takes ownership of the node.  Nodes can't be added once the
+  graph has been prepared.
+
+  Calling Sequence: node = addNode(nodePtr)
+
+  Inputs:
+
+    nodePtr - A pointer to a node that was allocated with new.
+
+  Outputs:
+
+    node - The index of the node, which is used to connect its ports, or
+    -1 if the node could not be added.  In that case, the caller still
+    owns the node.
+
+*****************************************************************************/
+int SignalGraph::addNode(ProcessingNode *nodePtr)
+{
+  int node;
+  int p;
+
+  if ((nodePtr == NULL) || prepared || (numberOfNodes == MAX_NODES))
+  {
+    return (-1);
+  } // if
+
+  node = numberOfNodes;
+  nodePtrs[node] = nodePtr;
+
+  // Nothing is connected yet.
+  for (p = 0; p < ProcessingNode::MAX_PORTS; p++)
+  {
+    inputSources[node][p].node = -1;
+    inputSources[node][p].port = -1;
+    consumerCounts[node][p] = 0;
+    outputBuffers[node][p] = -1;
+    inputPtrs[node][p] = NULL;
+    outputPtrs[node][p] = NULL;
+  } // for
+
+  numberOfNodes++;
+
+  return (node);
+
+} // addNode
+
+/*****************************************************************************
+
+  Name: connect
+
+  Purpose: The purpose of this function is to connect an output port of
+  one node to an input port of another node.  An output port can drive
+  any number of input ports, but an input port can only be driven by one
+  output port, and the two ports must have the same type.
+
+  Calling Sequence: success = connect(sourceNode,sourcePort,
+                                      sinkNode,sinkPort)
+
+  Inputs:
+
+    sourceNode - The index of the node that produces the samples.
+
+    sourcePort - The output port of the source node.
+
+    sinkNode - The index of the node that consumes the samples.
+
+    sinkPort - The input port of the sink node.
+
+  Outputs:
+
+    success - A flag that indicates whether the ports were connected.
+
+*****************************************************************************/
+bool SignalGraph::connect(int sourceNode,
+                          int sourcePort,
+                          int sinkNode,
+                          int sinkPort)
+{
+  ProcessingNode *sourcePtr;
+  ProcessingNode *sinkPtr;
+
+  if (prepared)
+  {
+    return (false);
+  } // if
+
+  if ((sourceNode < 0) || (sourceNode >= numberOfNodes) ||
+      (sinkNode < 0) || (sinkNode >= numberOfNodes))
+  {
+    return (false);
+  } // if
+
+  sourcePtr = nodePtrs[sourceNode];
+  sinkPtr = nodePtrs[sinkNode];
+
+  if ((sourcePort < 0) || (sourcePort >= sourcePtr->getNumberOfOutputs()) ||
+      (sinkPort < 0) || (sinkPort >= sinkPtr->getNumberOfInputs()))
+  {
+    return (false);
+  } // if
+
+  if (sourcePtr->getOutputType(sourcePort) != sinkPtr->getInputType(sinkPort))
+  {
+    // The sample layouts differ.
+    return (false);
+  } // if
+
+  if (inputSources[sinkNode][sinkPort].node != -1)
+  {
+    // The input is already driven.
+    return (false);
+  } // if
+
+  inputSources[sinkNode][sinkPort].node = sourceNode;
+  inputSources[sinkNode][sinkPort].port = sourcePort;
+  consumerCounts[sourceNode][sourcePort]++;
+
+  return (true);
+
+} // connect
+
+/*****************************************************************************
+
+  Name: prepare
+
+  Purpose: The purpose of this function is to make the graph ready to
+  run.  The nodes are scheduled by level, the buffers are assigned and
+  allocated, and the worker threads are started.
+
+  Calling Sequence: success = prepare(numberOfThreads)
+
+  Inputs:
+
+    numberOfThreads - The number of threads, including the calling
+    thread, that run the nodes of each level.
+
+  Outputs:
+
+    success - A flag that indicates whether the graph can be run.  It is
+    false when an input port is not connected, when the graph has a
+    cycle, or when the buffers could not be allocated.
+
+*****************************************************************************/
+bool SignalGraph::prepare(int numberOfThreads)
+{
+
+  if (prepared)
+  {
+    return (true);
+  } // if
+
+  if (!scheduleNodes())
+  {
+    return (false);
+  } // if
+
+  if (!assignBuffers())
+  {
+    return (false);
+  } // if
+
+  startWorkers(numberOfThreads);
+
+  prepared = true;
+
+  return (true);
+
+} // prepare
+
+/*****************************************************************************
+
+  Name: scheduleNodes
+
+  Purpose: The purpose of this function is to compute the level of each
+  node and to sort the nodes by level.  The nodes are visited in
+  topological order, so each node is visited after all of the nodes that
+  feed it.
+
+  Calling Sequence: success = scheduleNodes()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    success - A flag that indicates that every input port is connected
+    and that the graph has no cycles.
+
+*****************************************************************************/
+bool SignalGraph::scheduleNodes(void)
+{
+  int i;
+  int n;
+  int p;
+  int source;
+  int level;
+  int head;
+  int tail;
+  int pendingInputs[MAX_NODES];
+  int order[MAX_NODES];
+
+  for (n = 0; n < numberOfNodes; n++)
+  {
+    pendingInputs[n] = nodePtrs[n]->getNumberOfInputs();
+
+    for (p = 0; p < nodePtrs[n]->getNumberOfInputs(); p++)
+    {
+      if (inputSources[n][p].node == -1)
+      {
+        // The node would have nothing to read.
+        return (false);
+      } // if
+    } // for
+  } // for
+
+  // Start with the sources.
+  tail = 0;
+
+  for (n = 0; n < numberOfNodes; n++)
+  {
+    if (pendingInputs[n] == 0)
+    {
+      order[tail] = n;
+      levels[n] = 0;
+      tail++;
+    } // if
+  } // for
+
+  // Release each node once all of its inputs have been visited.
+  for (head = 0; head < tail; head++)
+  {
+    source = order[head];
+
+    for (n = 0; n < numberOfNodes; n++)
+    {
+      for (p = 0; p < nodePtrs[n]->getNumberOfInputs(); p++)
+      {
+        if (inputSources[n][p].node == source)
+        {
+          pendingInputs[n]--;
+
+          if (pendingInputs[n] == 0)
+          {
+            order[tail] = n;
+            tail++;
+          } // if
+        } // if
+      } // for
+    } // for
+  } // for
+
+  if (tail != numberOfNodes)
+  {
+    // Some nodes are part of a cycle.
+    return (false);
+  } // if
+
+  numberOfLevels = 0;
+
+  for (i = 0; i < numberOfNodes; i++)
+  {
+    n = order[i];
+    level = 0;
+
+    for (p = 0; p < nodePtrs[n]->getNumberOfInputs(); p++)
+    {
+      if (levels[inputSources[n][p].node] >= level)
+      {
+        level = levels[inputSources[n][p].node] + 1;
+      } // if
+    } // for
+
+    levels[n] = level;
+
+    if (level >= numberOfLevels)
+    {
+      numberOfLevels = level + 1;
+    } // if
+  } // for
+
+  // Sort by level, keeping the order in which the nodes were added.
+  i = 0;
+
+  for (level = 0; level < numberOfLevels; level++)
+  {
+    levelStarts[level] = i;
+
+    for (n = 0; n < numberOfNodes; n++)
+    {
+      if (levels[n] == level)
+      {
+        schedule[i] = n;
+        i++;
+      } // if
+    } // for
+  } // for
+
+  levelStarts[numberOfLevels] = i;
+
+  return (true);
+
+} // scheduleNodes
+
+/*****************************************************************************
+
+  Name: assignBuffers
+
+  Purpose: The purpose of this function is to assign a buffer to each
+  output port and to allocate the buffers.  The nodes are visited in
+  schedule order.  A buffer is free once the level of its last reader
+  has passed, since nodes of the same level may run at the same time.
+  An output port uses, in order of preference, the buffer of input port
+  0 (when the node can process in place and is the only reader of that
+  buffer), a free buffer of the same width, or a new buffer.
+
+  Calling Sequence: success = assignBuffers()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    success - A flag that indicates that the buffers were allocated.
+
+*****************************************************************************/
+bool SignalGraph::assignBuffers(void)
+{
+  int i;
+  int b;
+  int n;
+  int p;
+  int q;
+  int level;
+  int width;
+  int lastUse;
+  int buffer;
+  size_t bufferSize;
+  size_t requirement;
+  Endpoint source;
+  ProcessingNode *nodePtr;
+  int bufferWidths[MAX_NODES * ProcessingNode::MAX_PORTS];
+  int bufferLastUses[MAX_NODES * ProcessingNode::MAX_PORTS];
+  float *bufferPtrs[MAX_NODES * ProcessingNode::MAX_PORTS];
+
+  numberOfBuffers = 0;
+
+  for (i = 0; i < numberOfNodes; i++)
+  {
+    n = schedule[i];
+    nodePtr = nodePtrs[n];
+    level = levels[n];
+
+    for (q = 0; q < nodePtr->getNumberOfOutputs(); q++)
+    {
+      width = ProcessingNode::getPortWidth(nodePtr->getOutputType(q));
+
+      // Find the level of the last reader of this port.
+      lastUse = level;
+
+      for (p = 0; p < numberOfNodes; p++)
+      {
+        for (b = 0; b < nodePtrs[p]->getNumberOfInputs(); b++)
+        {
+          if ((inputSources[p][b].node == n) &&
+              (inputSources[p][b].port == q) &&
+              (levels[p] > lastUse))
+          {
+            lastUse = levels[p];
+          } // if
+        } // for
+      } // for
+
+      buffer = -1;
+
+      if ((q == 0) && (nodePtr->getNumberOfInputs() > 0) &&
+          nodePtr->canProcessInPlace())
+      {
+        source = inputSources[n][0];
+        b = outputBuffers[source.node][source.port];
+
+        if ((consumerCounts[source.node][source.port] == 1) &&
+            (bufferWidths[b] == width))
+        {
+          // Write the output over the input.
+          buffer = b;
+        } // if
+      } // if
+
+      for (b = 0; (b < numberOfBuffers) && (buffer == -1); b++)
+      {
+        if ((bufferWidths[b] == width) && (bufferLastUses[b] < level))
+        {
+          // Nobody reads this buffer any more.
+          buffer = b;
+        } // if
+      } // for
+
+      if (buffer == -1)
+      {
+        buffer = numberOfBuffers;
+        bufferWidths[buffer] = width;
+        numberOfBuffers++;
+      } // if
+
+      bufferLastUses[buffer] = lastUse;
+      outputBuffers[n][q] = buffer;
+    } // for
+  } // for
+
+  // Place all of the buffers in one arena.
+  requirement = 0;
+
+  for (b = 0; b < numberOfBuffers; b++)
+  {
+    bufferSize = bufferWidths[b] * blockSize * sizeof(float);
+    requirement += MemoryArena::roundUp(bufferSize);
+  } // for
+
+  arenaPtr = new MemoryArena(requirement);
+
+  if (!arenaPtr->isValid())
+  {
+    delete arenaPtr;
+    arenaPtr = NULL;
+    return (false);
+  } // if
+
+  for (b = 0; b < numberOfBuffers; b++)
+  {
+    bufferPtrs[b] = arenaPtr->allocateFloats(bufferWidths[b] * blockSize);
+  } // for
+
+  // Resolve the pointers that are passed to each node.
+  for (n = 0; n < numberOfNodes; n++)
+  {
+    for (q = 0; q < nodePtrs[n]->getNumberOfOutputs(); q++)
+    {
+      outputPtrs[n][q] = bufferPtrs[outputBuffers[n][q]];
+    } // for
+
+    for (p = 0; p < nodePtrs[n]->getNumberOfInputs(); p++)
+    {
+      source = inputSources[n][p];
+      inputPtrs[n][p] = bufferPtrs[outputBuffers[source.node][source.port]];
+    } // for
+  } // for
+
+  return (true);
+
+} // assignBuffers
+
+/*****************************************************************************
+
+  Name: startWorkers
+
+  Purpose: The purpose of this function is to start the threads that
+  help the calling thread run the nodes of each level.
+
+  Calling Sequence: startWorkers(numberOfThreads)
+
+  Inputs:
+
+    numberOfThreads - The number of threads, including the calling
+    thread.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SignalGraph::startWorkers(int numberOfThreads)
+{
+  int t;
+
+  if (numberOfThreads < 1)
+  {
+    numberOfThreads = 1;
+  } // if
+
+  this->numberOfThreads = numberOfThreads;
+
+  if (numberOfThreads == 1)
+  {
+    // Everything runs on the calling thread.
+    return;
+  } // if
+
+  stopRequested = false;
+
+  pthread_barrier_init(&barrier,NULL,numberOfThreads);
+
+  threadPtr = new pthread_t[numberOfThreads];
+  workerContextPtr = new WorkerContext[numberOfThreads];
+
+  // The calling thread is thread 0.
+  for (t = 1; t < numberOfThreads; t++)
+  {
+    workerContextPtr[t].graphPtr = this;
+    workerContextPtr[t].threadIndex = t;
+    pthread_create(&threadPtr[t],NULL,workerThread,&workerContextPtr[t]);
+  } // for
+
+  return;
+
+} // startWorkers
+
+/*****************************************************************************
+
+  Name: stopWorkers
+
+  Purpose: The purpose of this function is to stop the worker threads and
+  wait for them to exit.
+
+  Calling Sequence: stopWorkers()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SignalGraph::stopWorkers(void)
+{
+  int t;
+
+  if (threadPtr == NULL)
+  {
+    return;
+  } // if
+
+  // Release the workers from their wait for the next block.
+  stopRequested = true;
+  pthread_barrier_wait(&barrier);
+
+  for (t = 1; t < numberOfThreads; t++)
+  {
+    pthread_join(threadPtr[t],NULL);
+  } // for
+
+  pthread_barrier_destroy(&barrier);
+
+  delete[] threadPtr;
+  delete[] workerContextPtr;
+  threadPtr = NULL;
+  workerContextPtr = NULL;
+
+  return;
+
+} // stopWorkers
+
+/*****************************************************************************
+
+  Name: workerThread
+
+  Purpose: The purpose of this function is to run one worker thread.
+  For each block, the worker waits for the calling thread to start the
+  block, and then it runs its share of each level, waiting at the
+  barrier after each level.
+
+  Calling Sequence: workerThread(argPtr)
+
+  Inputs:
+
+    argPtr - A pointer to the WorkerContext of the thread.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void *SignalGraph::workerThread(void *argPtr)
+{
+  int level;
+  WorkerContext *contextPtr;
+  SignalGraph *graphPtr;
+
+  contextPtr = (WorkerContext *)argPtr;
+  graphPtr = contextPtr->graphPtr;
+
+  while (1)
+  {
+    // Wait for the next block.
+    pthread_barrier_wait(&graphPtr->barrier);
+
+    if (graphPtr->stopRequested)
+    {
+      break;
+    } // if
+
+    for (level = 0; level < graphPtr->numberOfLevels; level++)
+    {
+      graphPtr->processLevel(level,contextPtr->threadIndex);
+      pthread_barrier_wait(&graphPtr->barrier);
+    } // for
+  } // while
+
+  return (NULL);
+
+} // workerThread
+
+/*****************************************************************************
+
+  Name: processLevel
+
+  Purpose: The purpose of this function is to run a thread's share of the
+  nodes of one level.  The nodes are dealt out to the threads in turn.
+
+  Calling Sequence: processLevel(level,threadIndex)
+
+  Inputs:
+
+    level - The level to run.
+
+    threadIndex - The index of the thread, where the calling thread is
+    thread 0.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SignalGraph::processLevel(int level,int threadIndex)
+{
+  int i;
+  int n;
+
+  for (i = levelStarts[level] + threadIndex;
+       i < levelStarts[level + 1];
+       i += numberOfThreads)
+  {
+    n = schedule[i];
+    nodePtrs[n]->process(inputPtrs[n],outputPtrs[n],blockCount);
+  } // for
+
+  return;
+
+} // processLevel
+
+/*****************************************************************************
+
+  Name: processBlock
+
+  Purpose: The purpose of this function is to run every node of the graph
+  once, on one block of samples.
+
+  Calling Sequence: processBlock(count)
+
+  Inputs:
+
+    count - The number of samples in the block.  It is limited to the
+    block size of the graph.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SignalGraph::processBlock(uint32_t count)
+{
+  int level;
+
+  if (!prepared)
+  {
+    return;
+  } // if
+
+  if (count > blockSize)
+  {
+    count = blockSize;
+  } // if
+
+  blockCount = count;
+
+  if (threadPtr == NULL)
+  {
+    for (level = 0; level < numberOfLevels; level++)
+    {
+      processLevel(level,0);
+    } // for
+  } // if
+  else
+  {
+    // Start the workers on this block.
+    pthread_barrier_wait(&barrier);
+
+    for (level = 0; level < numberOfLevels; level++)
+    {
+      processLevel(level,0);
+      pthread_barrier_wait(&barrier);
+    } // for
+  } // else
+
+  return;
+
+} // processBlock
+
+/*****************************************************************************
+
+  Name: run
+
+  Purpose: The purpose of this function is to run the graph over a number
+  of samples, one block at a time.  The last block may be short.
+
+  Calling Sequence: run(numberOfSamples)
+
+  Inputs:
+
+    numberOfSamples - The number of samples to process.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SignalGraph::run(uint64_t numberOfSamples)
+{
+  uint32_t count;
+
+  while (numberOfSamples > 0)
+  {
+    count = blockSize;
+
+    if (numberOfSamples < count)
+    {
+      count = (uint32_t)numberOfSamples;
+    } // if
+
+    processBlock(count);
+    numberOfSamples -= count;
+  } // while
+
+  return;
+
+} // run
+
+/*****************************************************************************
+
+  Name: getBlockSize
+
+  Purpose: The purpose of this function is to return the largest number
+  of samples per block.
+
+  Calling Sequence: blockSize = getBlockSize()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    blockSize - The block size.
+
+*****************************************************************************/
+uint32_t SignalGraph::getBlockSize(void)
+{
+
+  return (blockSize);
+
+} // getBlockSize
+
+/*****************************************************************************
+
+  Name: getNumberOfLevels
+
+  Purpose: The purpose of this function is to return the number of
+  levels of the graph.  It is valid once the graph has been prepared.
+
+  Calling Sequence: numberOfLevels = getNumberOfLevels()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    numberOfLevels - The number of levels.
+
+*****************************************************************************/
+int SignalGraph::getNumberOfLevels(void)
+{
+
+  return (numberOfLevels);
+
+} // getNumberOfLevels
+
+/*****************************************************************************
+
+  Name: getNumberOfBuffers
+
+  Purpose: The purpose of this function is to return the number of
+  buffers that the graph allocated.  It is valid once the graph has been
+  prepared.
+
+  Calling Sequence: numberOfBuffers = getNumberOfBuffers()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    numberOfBuffers - The number of buffers.
+
+*****************************************************************************/
+int SignalGraph::getNumberOfBuffers(void)
+{
+
+  return (numberOfBuffers);
+
+} // getNumberOfBuffers
+
+/*****************************************************************************
+
+  Name: describe
+
+  Purpose: The purpose of this function is to display the schedule of the
+  graph: the level of each node, the buffers that its ports use, and the
+  total size of the buffers.
+
+  Calling Sequence: describe(streamPtr)
+
+  Inputs:
+
+    streamPtr - The stream to write to.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void SignalGraph::describe(FILE *streamPtr)
+{
+  int i;
+  int n;
+  int p;
+  Endpoint source;
+
+  if (!prepared)
+  {
+    fprintf(streamPtr,"Graph is not prepared\n");
+    return;
+  } // if
+
+  for (i = 0; i < numberOfNodes; i++)
+  {
+    n = schedule[i];
+
+    fprintf(streamPtr,"level %d: %-12s",levels[n],nodePtrs[n]->getName());
+
+    for (p = 0; p < nodePtrs[n]->getNumberOfInputs(); p++)
+    {
+      source = inputSources[n][p];
+      fprintf(streamPtr," in%d=buf%d",
+              p,outputBuffers[source.node][source.port]);
+    } // for
+
+    for (p = 0; p < nodePtrs[n]->getNumberOfOutputs(); p++)
+    {
+      fprintf(streamPtr," out%d=buf%d",p,outputBuffers[n][p]);
+    } // for
+
+    fprintf(streamPtr,"\n");
+  } // for
+
+  fprintf(streamPtr,
+          "%d nodes, %d levels, %d buffers (%lu bytes), %d threads\n",
+          numberOfNodes,numberOfLevels,numberOfBuffers,
+          (unsigned long)arenaPtr->getBytesUsed(),numberOfThreads);
+
+  return;
+
+} // describe
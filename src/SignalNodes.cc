@@ -0,0 +1,1096 @@
+//************************************************************************
+// file name: SignalNodes.cc
+//************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "SignalNodes.h"
+
+using namespace std;
+
+/*****************************************************************************
+
+  Name: NcoNode
+
+  Purpose: The purpose of this function is to serve as the constructor for
+  an instance of an NcoNode.
+
+  Calling Sequence: NcoNode(sampleRate,frequency)
+
+  Inputs:
+
+    sampleRate - The sample rate in samples/second.
+
+    frequency - The frequency of the NCO in Hz.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+NcoNode::NcoNode(float sampleRate,float frequency)
+  : ProcessingNode("nco",0,2)
+{
+
+  ncoPtr = new Nco(sampleRate,frequency);
+
+  return;
+
+} // NcoNode
+
+/*****************************************************************************
+
+  Name: ~NcoNode
+
+  Purpose: The purpose of this function is to serve as the destructor for an
+  instance of an NcoNode.
+
+  Calling Sequence: ~NcoNode()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+NcoNode::~NcoNode(void)
+{
+
+  // Release resources.
+  delete ncoPtr;
+
+  return;
+
+} // ~NcoNode
+
+/*****************************************************************************
+
+  Name: process
+
+  Purpose: The purpose of this function is to generate a block of in-phase
+  and quadrature samples.
+
+  Calling Sequence: process(inputPtrs,outputPtrs,count)
+
+  Inputs:
+
+    inputPtrs - One buffer per input port.
+
+    outputPtrs - One buffer per output port.
+
+    count - The number of samples to process.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void NcoNode::process(float **,float **outputPtrs,uint32_t count)
+{
+  uint32_t i;
+
+  for (i = 0; i < count; i++)
+  {
+    ncoPtr->run(&outputPtrs[0][i],&outputPtrs[1][i]);
+  } // for
+
+  return;
+
+} // process
+
+/*****************************************************************************
+
+  Name: GaussianNoiseNode
+
+  Purpose: The purpose of this function is to serve as the constructor for
+  an instance of a GaussianNoiseNode.
+
+  Calling Sequence: GaussianNoiseNode(sigma)
+
+  Inputs:
+
+    sigma - The standard deviation of the noise.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+GaussianNoiseNode::GaussianNoiseNode(float sigma)
+  : ProcessingNode("gauss",0,1)
+{
+
+  this->sigma = sigma;
+
+  return;
+
+} // GaussianNoiseNode
+
+/*****************************************************************************
+
+  Name: ~GaussianNoiseNode
+
+  Purpose: The purpose of this function is to serve as the destructor for an
+  instance of a GaussianNoiseNode.
+
+  Calling Sequence: ~GaussianNoiseNode()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+GaussianNoiseNode::~GaussianNoiseNode(void)
+{
+
+  return;
+
+} // ~GaussianNoiseNode
+
+/*****************************************************************************
+
+  Name: process
+
+  Purpose: The purpose of this function is to generate a block of random
+  numbers that are weighted by a Gaussian density function.  The Box- Muller
+  method is used, with the random numbers taken from rand(), so the sequence
+  can be reproduced with srand().
+
+  Calling Sequence: process(inputPtrs,outputPtrs,count)
+
+  Inputs:
+
+    inputPtrs - One buffer per input port.
+
+    outputPtrs - One buffer per output port.
+
+    count - The number of samples to process.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void GaussianNoiseNode::process(float **,
+                                float **outputPtrs,
+                                uint32_t count)
+{
+  uint32_t i;
+  float x, b, r;
+
+  for (i = 0; i < count; i++)
+  {
+    // Get first random variable.
+    x = (float)rand();
+
+    // Scale the random variable.
+    x = x / RAND_MAX;
+
+    // Get second random variable.
+    b = (float)rand();
+
+    // Scale the random variable.
+    b = b / RAND_MAX;
+
+    // Generate the angle.
+    b = 2.0 * b * M_PI;
+
+    // Compute the magnitude.
+    r = sqrt(2.0 * sigma * sigma * log(1.0 / (1.0 - x)));
+
+    // Compute the real part of the random variable.
+    outputPtrs[0][i] = r * cos(b);
+  } // for
+
+  return;
+
+} // process
+
+/*****************************************************************************
+
+  Name: AdderNode
+
+  Purpose: The purpose of this function is to serve as the constructor for
+  an instance of an AdderNode.
+
+  Calling Sequence: AdderNode()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+AdderNode::AdderNode(void)
+  : ProcessingNode("adder",2,1)
+{
+
+  return;
+
+} // AdderNode
+
+/*****************************************************************************
+
+  Name: ~AdderNode
+
+  Purpose: The purpose of this function is to serve as the destructor for an
+  instance of an AdderNode.
+
+  Calling Sequence: ~AdderNode()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+AdderNode::~AdderNode(void)
+{
+
+  return;
+
+} // ~AdderNode
+
+/*****************************************************************************
+
+  Name: canProcessInPlace
+
+  Purpose: The purpose of this function is to indicate that output port 0
+  may share its buffer with input port 0.  Each sum only reads the samples
+  with the same index.
+
+  Calling Sequence: inPlace = canProcessInPlace()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    inPlace - A flag that indicates that the buffer may be shared.
+
+*****************************************************************************/
+bool AdderNode::canProcessInPlace(void)
+{
+
+  return (true);
+
+} // canProcessInPlace
+
+/*****************************************************************************
+
+  Name: process
+
+  Purpose: The purpose of this function is to add the samples of the two
+  input ports.
+
+  Calling Sequence: process(inputPtrs,outputPtrs,count)
+
+  Inputs:
+
+    inputPtrs - One buffer per input port.
+
+    outputPtrs - One buffer per output port.
+
+    count - The number of samples to process.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void AdderNode::process(float **inputPtrs,float **outputPtrs,uint32_t count)
+{
+  uint32_t i;
+
+  for (i = 0; i < count; i++)
+  {
+    outputPtrs[0][i] = inputPtrs[0][i] + inputPtrs[1][i];
+  } // for
+
+  return;
+
+} // process
+
+/*****************************************************************************
+
+  Name: FirFilterNode
+
+  Purpose: The purpose of this function is to serve as the constructor for
+  an instance of a FirFilterNode.
+
+  Calling Sequence: FirFilterNode(filterLength,coefficientsPtr)
+
+  Inputs:
+
+    filterLength - The number of taps of the filter.
+
+    coefficientsPtr - A pointer to the coefficients of the filter.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+FirFilterNode::FirFilterNode(int filterLength,float *coefficientsPtr)
+  : ProcessingNode("fir",1,1)
+{
+
+  filterPtr = new FirFilter(filterLength,coefficientsPtr);
+
+  return;
+
+} // FirFilterNode
+
+/*****************************************************************************
+
+  Name: ~FirFilterNode
+
+  Purpose: The purpose of this function is to serve as the destructor for an
+  instance of a FirFilterNode.
+
+  Calling Sequence: ~FirFilterNode()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+FirFilterNode::~FirFilterNode(void)
+{
+
+  // Release resources.
+  delete filterPtr;
+
+  return;
+
+} // ~FirFilterNode
+
+/*****************************************************************************
+
+  Name: getFilter
+
+  Purpose: The purpose of this function is to provide access to the filter,
+  so that its coefficients can be changed.
+
+  Calling Sequence: filterPtr = getFilter()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    filterPtr - A pointer to the filter.
+
+*****************************************************************************/
+FirFilter *FirFilterNode::getFilter(void)
+{
+
+  return (filterPtr);
+
+} // getFilter
+
+/*****************************************************************************
+
+  Name: canProcessInPlace
+
+  Purpose: The purpose of this function is to indicate that output port 0
+  may share its buffer with input port 0.  The filter keeps its own copy of
+  past samples, so each input sample is no longer needed once it has been
+  shifted in.
+
+  Calling Sequence: inPlace = canProcessInPlace()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    inPlace - A flag that indicates that the buffer may be shared.
+
+*****************************************************************************/
+bool FirFilterNode::canProcessInPlace(void)
+{
+
+  return (true);
+
+} // canProcessInPlace
+
+/*****************************************************************************
+
+  Name: process
+
+  Purpose: The purpose of this function is to filter a block of samples.
+
+  Calling Sequence: process(inputPtrs,outputPtrs,count)
+
+  Inputs:
+
+    inputPtrs - One buffer per input port.
+
+    outputPtrs - One buffer per output port.
+
+    count - The number of samples to process.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void FirFilterNode::process(float **inputPtrs,
+                            float **outputPtrs,
+                            uint32_t count)
+{
+  uint32_t i;
+
+  for (i = 0; i < count; i++)
+  {
+    outputPtrs[0][i] = filterPtr->filterData(inputPtrs[0][i]);
+  } // for
+
+  return;
+
+} // process
+
+/*****************************************************************************
+
+  Name: CancellerNode
+
+  Purpose: The purpose of this function is to serve as the constructor for
+  an instance of a CancellerNode.
+
+  Calling Sequence: CancellerNode(filterLength,referenceDelay,beta)
+
+  Inputs:
+
+    filterLength - The number of taps of the canceller.
+
+    referenceDelay - The reference delay of the canceller.
+
+    beta - The normalized step-size of the canceller.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+CancellerNode::CancellerNode(int filterLength,int referenceDelay,float beta)
+  : ProcessingNode("canceller",1,1)
+{
+
+  cancellerPtr = new NlmsNoiseCanceller(filterLength,referenceDelay,beta);
+
+  return;
+
+} // CancellerNode
+
+/*****************************************************************************
+
+  Name: ~CancellerNode
+
+  Purpose: The purpose of this function is to serve as the destructor for an
+  instance of a CancellerNode.
+
+  Calling Sequence: ~CancellerNode()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+CancellerNode::~CancellerNode(void)
+{
+
+  // Release resources.
+  delete cancellerPtr;
+
+  return;
+
+} // ~CancellerNode
+
+/*****************************************************************************
+
+  Name: getCanceller
+
+  Purpose: The purpose of this function is to provide access to the
+  canceller, so that its modes can be set.
+
+  Calling Sequence: cancellerPtr = getCanceller()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    cancellerPtr - A pointer to the canceller.
+
+*****************************************************************************/
+NlmsNoiseCanceller *CancellerNode::getCanceller(void)
+{
+
+  return (cancellerPtr);
+
+} // getCanceller
+
+/*****************************************************************************
+
+  Name: canProcessInPlace
+
+  Purpose: The purpose of this function is to indicate that output port 0
+  may share its buffer with input port 0.  The canceller keeps its own copy
+  of past samples.
+
+  Calling Sequence: inPlace = canProcessInPlace()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    inPlace - A flag that indicates that the buffer may be shared.
+
+*****************************************************************************/
+bool CancellerNode::canProcessInPlace(void)
+{
+
+  return (true);
+
+} // canProcessInPlace
+
+/*****************************************************************************
+
+  Name: process
+
+  Purpose: The purpose of this function is to remove the noise from a block
+  of samples.
+
+  Calling Sequence: process(inputPtrs,outputPtrs,count)
+
+  Inputs:
+
+    inputPtrs - One buffer per input port.
+
+    outputPtrs - One buffer per output port.
+
+    count - The number of samples to process.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void CancellerNode::process(float **inputPtrs,
+                            float **outputPtrs,
+                            uint32_t count)
+{
+
+  cancellerPtr->acceptData(inputPtrs[0],count,outputPtrs[0]);
+
+  return;
+
+} // process
+
+/*****************************************************************************
+
+  Name: MultirateCancellerNode
+
+  Purpose: The purpose of this function is to serve as the constructor for
+  an instance of a MultirateCancellerNode.
+
+  Calling Sequence: MultirateCancellerNode(decimationFactor,filterLength,
+                                           referenceDelay,beta)
+
+  Inputs:
+
+    decimationFactor - The ratio of the input sample rate to the rate
+    at which the canceller runs.
+
+    filterLength - The number of taps of the canceller at the reduced
+    rate.
+
+    referenceDelay - The reference delay of the canceller, in samples
+    at the reduced rate.
+
+    beta - The normalized step-size of the canceller.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+MultirateCancellerNode::MultirateCancellerNode(int decimationFactor,
+                                               int filterLength,
+                                               int referenceDelay,
+                                               float beta)
+  : ProcessingNode("multirate",1,1)
+{
+
+  cancellerPtr = new MultirateNoiseCanceller(decimationFactor,
+                                             filterLength,
+                                             referenceDelay,
+                                             beta);
+
+  return;
+
+} // MultirateCancellerNode
+
+/*****************************************************************************
+
+  Name: ~MultirateCancellerNode
+
+  Purpose: The purpose of this function is to serve as the destructor for an
+  instance of a MultirateCancellerNode.
+
+  Calling Sequence: ~MultirateCancellerNode()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+MultirateCancellerNode::~MultirateCancellerNode(void)
+{
+
+  // Release resources.
+  delete cancellerPtr;
+
+  return;
+
+} // ~MultirateCancellerNode
+
+/*****************************************************************************
+
+  Name: getCanceller
+
+  Purpose: The purpose of this function is to provide access to the reduced
+  rate stage, so that its latency can be queried and the modes of its
+  canceller can be set.
+
+  Calling Sequence: cancellerPtr = getCanceller()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    cancellerPtr - A pointer to the reduced rate stage.
+
+*****************************************************************************/
+MultirateNoiseCanceller *MultirateCancellerNode::getCanceller(void)
+{
+
+  return (cancellerPtr);
+
+} // getCanceller
+
+/*****************************************************************************
+
+  Name: canProcessInPlace
+
+  Purpose: The purpose of this function is to indicate that output port 0
+  may share its buffer with input port 0.  The resampling filters keep their
+  own copies of past samples.
+
+  Calling Sequence: inPlace = canProcessInPlace()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    inPlace - A flag that indicates that the buffer may be shared.
+
+*****************************************************************************/
+bool MultirateCancellerNode::canProcessInPlace(void)
+{
+
+  return (true);
+
+} // canProcessInPlace
+
+/*****************************************************************************
+
+  Name: process
+
+  Purpose: The purpose of this function is to remove the noise from a block
+  of samples.
+
+  Calling Sequence: process(inputPtrs,outputPtrs,count)
+
+  Inputs:
+
+    inputPtrs - One buffer per input port.
+
+    outputPtrs - One buffer per output port.
+
+    count - The number of samples to process.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void MultirateCancellerNode::process(float **inputPtrs,
+                                     float **outputPtrs,
+                                     uint32_t count)
+{
+
+  cancellerPtr->acceptData(inputPtrs[0],count,outputPtrs[0]);
+
+  return;
+
+} // process
+
+/*****************************************************************************
+
+  Name: ComplexCancellerNode
+
+  Purpose: The purpose of this function is to serve as the constructor for
+  an instance of a ComplexCancellerNode.
+
+  Calling Sequence: ComplexCancellerNode(filterLength,referenceDelay,beta)
+
+  Inputs:
+
+    filterLength - The number of taps of the canceller.
+
+    referenceDelay - The reference delay of the canceller.
+
+    beta - The normalized step-size of the canceller.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+ComplexCancellerNode::ComplexCancellerNode(int filterLength,
+                                           int referenceDelay,
+                                           float beta)
+  : ProcessingNode("complex",1,1)
+{
+
+  cancellerPtr = new ComplexNlmsNoiseCanceller(filterLength,
+                                               referenceDelay,
+                                               beta);
+
+  return;
+
+} // ComplexCancellerNode
+
+/*****************************************************************************
+
+  Name: ~ComplexCancellerNode
+
+  Purpose: The purpose of this function is to serve as the destructor for an
+  instance of a ComplexCancellerNode.
+
+  Calling Sequence: ~ComplexCancellerNode()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+ComplexCancellerNode::~ComplexCancellerNode(void)
+{
+
+  // Release resources.
+  delete cancellerPtr;
+
+  return;
+
+} // ~ComplexCancellerNode
+
+/*****************************************************************************
+
+  Name: getInputType
+
+  Purpose: The purpose of this function is to indicate that the input port
+  carries complex samples.
+
+  Calling Sequence: type = getInputType(port)
+
+  Inputs:
+
+    port - The index of the input port.
+
+  Outputs:
+
+    type - The type of the port.
+
+*****************************************************************************/
+PortType ComplexCancellerNode::getInputType(int)
+{
+
+  return (PORT_COMPLEX);
+
+} // getInputType
+
+/*****************************************************************************
+
+  Name: getOutputType
+
+  Purpose: The purpose of this function is to indicate that the output port
+  carries complex samples.
+
+  Calling Sequence: type = getOutputType(port)
+
+  Inputs:
+
+    port - The index of the output port.
+
+  Outputs:
+
+    type - The type of the port.
+
+*****************************************************************************/
+PortType ComplexCancellerNode::getOutputType(int)
+{
+
+  return (PORT_COMPLEX);
+
+} // getOutputType
+
+/*****************************************************************************
+
+  Name: canProcessInPlace
+
+  Purpose: The purpose of this function is to indicate that output port 0
+  may share its buffer with input port 0.  Both components of a sample are
+  read before either one is written.
+
+  Calling Sequence: inPlace = canProcessInPlace()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    inPlace - A flag that indicates that the buffer may be shared.
+
+*****************************************************************************/
+bool ComplexCancellerNode::canProcessInPlace(void)
+{
+
+  return (true);
+
+} // canProcessInPlace
+
+/*****************************************************************************
+
+  Name: process
+
+  Purpose: The purpose of this function is to remove the noise from a block
+  of complex samples.
+
+  Calling Sequence: process(inputPtrs,outputPtrs,count)
+
+  Inputs:
+
+    inputPtrs - One buffer per input port.
+
+    outputPtrs - One buffer per output port.
+
+    count - The number of samples to process.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void ComplexCancellerNode::process(float **inputPtrs,
+                                   float **outputPtrs,
+                                   uint32_t count)
+{
+
+  cancellerPtr->acceptData(inputPtrs[0],count,outputPtrs[0]);
+
+  return;
+
+} // process
+
+/*****************************************************************************
+
+  Name: FileSinkNode
+
+  Purpose: The purpose of this function is to serve as the constructor for
+  an instance of a FileSinkNode.  The file is created, or truncated if it
+  exists.
+
+  Calling Sequence: FileSinkNode(fileNamePtr,type)
+
+  Inputs:
+
+    fileNamePtr - The name of the output file.
+
+    type - The type of the samples that are written.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+FileSinkNode::FileSinkNode(const char *fileNamePtr,PortType type)
+  : ProcessingNode("file",1,0)
+{
+
+  this->type = type;
+
+  streamPtr = fopen(fileNamePtr,"w");
+
+  return;
+
+} // FileSinkNode
+
+/*****************************************************************************
+
+  Name: ~FileSinkNode
+
+  Purpose: The purpose of this function is to serve as the destructor for an
+  instance of a FileSinkNode.
+
+  Calling Sequence: ~FileSinkNode()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+FileSinkNode::~FileSinkNode(void)
+{
+
+  if (streamPtr != NULL)
+  {
+    fclose(streamPtr);
+  } // if
+
+  return;
+
+} // ~FileSinkNode
+
+/*****************************************************************************
+
+  Name: isOpen
+
+  Purpose: The purpose of this function is to indicate whether the output
+  file was opened.
+
+  Calling Sequence: open = isOpen()
+
+  Inputs:
+
+    None.
+
+  Outputs:
+
+    open - A flag that indicates that the file is open.
+
+*****************************************************************************/
+bool FileSinkNode::isOpen(void)
+{
+
+  return (streamPtr != NULL);
+
+} // isOpen
+
+/*****************************************************************************
+
+  Name: getInputType
+
+  Purpose: The purpose of this function is to return the type of the input
+  port, which is set by the constructor.
+
+  Calling Sequence: type = getInputType(port)
+
+  Inputs:
+
+    port - The index of the input port.
+
+  Outputs:
+
+    type - The type of the port.
+
+*****************************************************************************/
+PortType FileSinkNode::getInputType(int)
+{
+
+  return (type);
+
+} // getInputType
+
+/*****************************************************************************
+
+  Name: process
+
+  Purpose: The purpose of this function is to write a block of samples to
+  the file.
+
+  Calling Sequence: process(inputPtrs,outputPtrs,count)
+
+  Inputs:
+
+    inputPtrs - One buffer per input port.
+
+    outputPtrs - One buffer per output port.
+
+    count - The number of samples to process.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+void FileSinkNode::process(float **inputPtrs,
+                           float **,
+                           uint32_t count)
+{
+
+  if (streamPtr != NULL)
+  {
+    fwrite(inputPtrs[0],sizeof(float),count * getPortWidth(type),streamPtr);
+  } // if
+
+  return;
+
+} // process
@@ -0,0 +1,1584 @@
+//*************************************************************************
+// File name: batchCanceller.cc
+//*************************************************************************
+
+//*************************************************************************
+// This program is a long-running batch processor for captured files.
+// Rather than starting one noiseCanceller process per file, jobs are
+// dropped into a spool directory, and a pool of worker threads that
+// stay warm for the life of the program processes them.  Each worker
+// owns a canceller whose storage is allocated once, at startup, from
+// one arena, and the canceller is reconfigured for each job.  Output
+// blocks are handed to a pool of I/O threads, so the workers filter the
+// next block while the previous one is being written.
+//
+// A job is a text file whose name ends in ".job".  It holds one line
+// with the input file, the output file, and any of the options below,
+// in the same form as the noiseCanceller command line,
+//
+//     -o filterOrder -d delay -b beta -f format -S sampleRate
+//     -F freezeTolerance inputFileName outputFileName
+//
+// Relative file names are taken relative to the working directory of
+// this program.  The input is a single channel of raw samples (or a
+// single channel WAV file), and the output is raw samples of the same
+// format.  Jobs should be written under another name and renamed into
+// place, or simply closed; the directory is watched with inotify, and
+// it is also scanned once at startup.
+//
+// When a job is taken, its file is renamed to "<name>.active".  When it
+// is finished, that file is removed, and the statistics of the job
+// (the number of samples, the elapsed time, the filtering time, the
+// throughput, and the speed relative to real time) are written to
+// "<name>.done", or an error message is written to "<name>.failed".
+// The statistics are also written to stdout.  SIGINT or SIGTERM stops
+// the program once the queued jobs are finished.
+//
+// To run this program type,
+//
+//     ./batchCanceller -s spoolDirectory -t workers -i ioThreads
+//                      -m maxFilterOrder -M maxDelay -B blockSize
+//
+// where,
+//
+//    spoolDirectory - The directory that is watched for jobs.  The
+//    default is the current directory.
+//    workers - The number of worker threads.  It must be at least 1.
+//    The default is 1.
+//    ioThreads - The number of threads that write output.  It must be
+//    at least 1.  The default is 1.
+//    maxFilterOrder - The filter order that the cancellers of the pool
+//    are sized for.  It must be at least 1.  Larger jobs are still
+//    accepted, but the storage of the canceller then grows.  The
+//    default is 64.
+//    maxDelay - The reference delay that the cancellers of the pool are
+//    sized for.  It must not be negative.  The default is 64.
+//    blockSize - The number of samples that are read, processed, and
+//    written at a time.  It must be at least 1.  The default is 4000.
+//*************************************************************************
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <dirent.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/inotify.h>
+
+#include "NlmsNoiseCanceller.h"
+#include "MemoryArena.h"
+#include "SampleConverter.h"
+#include "SampleReader.h"
+
+// This structure is used to consolidate user parameters.
+struct MyParameters
+{
+  const char **spoolDirectoryPtr;
+  int *numberOfWorkersPtr;
+  int *numberOfIoThreadsPtr;
+  int *maxFilterOrderPtr;
+  int *maxDelayPtr;
+  int *blockSizePtr;
+  bool *argumentErrorPtr;
+};
+
+// The longest file name, including the terminator.
+#define PATH_LENGTH (1024)
+
+// The largest number of words on the line of a job.
+#define MAX_JOB_WORDS (32)
+
+// The number of output buffers of each worker.  This many blocks of a
+// job can be waiting to be written before the worker has to wait.
+#define BUFFERS_PER_WORKER (4)
+
+// The number of milliseconds between checks of the stop flag while the
+// spool directory is idle.
+#define POLL_INTERVAL (500)
+
+// Samples are presented to the canceller with 16-bit full scale values,
+// as they are by noiseCanceller.
+#define FULL_SCALE (32768.0f)
+
+// This describes one job.
+struct Job
+{
+  // The name of the job file without the ".job" suffix.
+  char name[PATH_LENGTH];
+
+  // The input and output files.
+  char inputPath[PATH_LENGTH];
+  char outputPath[PATH_LENGTH];
+
+  // The parameters of the canceller.
+  int filterOrder;
+  int delay;
+  float beta;
+  bool automaticFreeze;
+  float freezeTolerance;
+
+  // The format of raw input, and its sample rate.
+  SampleFormat format;
+  uint32_t sampleRate;
+
+  struct Job *nextPtr;
+};
+
+struct Worker;
+
+// This describes one block of output that is waiting to be written.
+struct OutputBuffer
+{
+  uint8_t *dataPtr;
+  uint32_t length;
+  int fileDescriptor;
+  off_t offset;
+
+  // The worker that the buffer belongs to.
+  struct Worker *ownerPtr;
+
+  struct OutputBuffer *nextPtr;
+};
+
+// This structure is shared by all of the threads.
+struct BatchContext
+{
+  // The spool directory, and the number of samples per block.
+  const char *spoolDirectoryPtr;
+  int blockSize;
+
+  // This protects everything below, and the free lists and write
+  // counts of the workers.
+  pthread_mutex_t mutex;
+
+  // The jobs that are waiting for a worker.
+  struct Job *jobHeadPtr;
+  struct Job *jobTailPtr;
+  pthread_cond_t jobAvailable;
+
+  // The blocks that are waiting to be written.
+  struct OutputBuffer *writeHeadPtr;
+  struct OutputBuffer *writeTailPtr;
+  pthread_cond_t writeAvailable;
+
+  // These tell the workers and the I/O threads to exit once their
+  // queues are empty.
+  bool workersStopping;
+  bool ioStopping;
+
+  // Totals over all jobs.
+  uint64_t totalJobs;
+  uint64_t failedJobs;
+  uint64_t totalSamples;
+};
+
+// This describes one worker thread and the resources that it owns.
+struct Worker
+{
+  struct BatchContext *contextPtr;
+  pthread_t thread;
+
+  // The canceller of the pool that belongs to this worker.
+  NlmsNoiseCanceller *cancellerPtr;
+
+  // The buffers of the current block.
+  float *inputBufferPtr;
+  float *outputBufferPtr;
+
+  // The output buffers, those that are free, and the number that are
+  // waiting to be written.
+  struct OutputBuffer buffers[BUFFERS_PER_WORKER];
+  struct OutputBuffer *freeListPtr;
+  int pendingWrites;
+  pthread_cond_t bufferFreed;
+
+  // This indicates that a write of the current job failed.
+  bool writeFailed;
+};
+
+// This is set by the signal handler.
+static volatile sig_atomic_t stopRequested = 0;
+
+/*****************************************************************************
+
+  Name: getUserArguments
+
+  Purpose: The purpose of this function is to retrieve the user arguments
+  that were passed to the program.  Any arguments that are specified are
+  set to reasonable default values.
+
+  Calling Sequence: exitProgram = getUserArguments(parameters)
+
+  Inputs:
+
+    parameters - A structure that contains pointers to the user parameters.
+
+  Outputs:
+
+    exitProgram - A flag that indicates whether or not the program should
+    be exited.  A value of true indicates to exit the program, and a value
+    of false indicates that the program should not be exited..  When
+    the program is exited because an argument is invalid, the flag that
+    parameters.argumentErrorPtr points to is set to true.
+
+*****************************************************************************/
+bool getUserArguments(int argc,char **argv,struct MyParameters parameters)
+{
+  bool exitProgram;
+  bool done;
+  int opt;
+
+  // Default not to exit program.
+  exitProgram = false;
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Default parameters.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Default to watching the current directory.
+  *parameters.spoolDirectoryPtr = ".";
+
+  // Default to one worker and one I/O thread.
+  *parameters.numberOfWorkersPtr = 1;
+  *parameters.numberOfIoThreadsPtr = 1;
+
+  // Default to a pool that fits the usual jobs.
+  *parameters.maxFilterOrderPtr = 64;
+  *parameters.maxDelayPtr = 64;
+
+  // Default to half a second at 8000S/s.
+  *parameters.blockSizePtr = 4000;
+
+  // Default to arguments that are valid.
+  *parameters.argumentErrorPtr = false;
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  // Set up for loop entry.
+  done = false;
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Retrieve the command line arguments.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  while (!done)
+  {
+    // Retrieve the next option.
+    opt = getopt(argc,argv,"s:t:i:m:M:B:h");
+
+    switch (opt)
+    {
+      case 's':
+      {
+        *parameters.spoolDirectoryPtr = optarg;
+        break;
+      } // case
+
+      case 't':
+      {
+        *parameters.numberOfWorkersPtr = atoi(optarg);
+
+        if (*parameters.numberOfWorkersPtr < 1)
+        {
+          fprintf(stderr,"Invalid number of workers %s.\n",optarg);
+          *parameters.argumentErrorPtr = true;
+          exitProgram = true;
+        } // if
+        break;
+      } // case
+
+      case 'i':
+      {
+        *parameters.numberOfIoThreadsPtr = atoi(optarg);
+
+        if (*parameters.numberOfIoThreadsPtr < 1)
+        {
+          fprintf(stderr,"Invalid number of I/O threads %s.\n",optarg);
+          *parameters.argumentErrorPtr = true;
+          exitProgram = true;
+        } // if
+        break;
+      } // case
+
+      case 'm':
+      {
+        *parameters.maxFilterOrderPtr = atoi(optarg);
+
+        if (*parameters.maxFilterOrderPtr < 1)
+        {
+          fprintf(stderr,"Invalid maximum filter order %s.\n",optarg);
+          *parameters.argumentErrorPtr = true;
+          exitProgram = true;
+        } // if
+        break;
+      } // case
+
+      case 'M':
+      {
+        *parameters.maxDelayPtr = atoi(optarg);
+
+        if (*parameters.maxDelayPtr < 0)
+        {
+          fprintf(stderr,"Invalid maximum delay %s.\n",optarg);
+          *parameters.argumentErrorPtr = true;
+          exitProgram = true;
+        } // if
+        break;
+      } // case
+
+      case 'B':
+      {
+        *parameters.blockSizePtr = atoi(optarg);
+
+        if (*parameters.blockSizePtr < 1)
+        {
+          fprintf(stderr,"Invalid block size %s.\n",optarg);
+          *parameters.argumentErrorPtr = true;
+          exitProgram = true;
+        } // if
+        break;
+      } // case
+
+      case 'h':
+      {
+        // Display usage.
+        fprintf(stderr,"./batchCanceller -s spoolDirectory -t workers"
+                " -i ioThreads\n"
+                "                 -m maxFilterOrder -M maxDelay"
+                " -B blockSize\n");
+
+        // Indicate that program must be exited.
+        exitProgram = true;
+        break;
+      } // case
+
+      case -1:
+      {
+        // All options consumed, so bail out.
+        done = true;
+      } // case
+    } // switch
+
+  } // while
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  return (exitProgram);
+
+} // getUserArguments
+
+/*****************************************************************************
+
+  Name: handleSignal
+
+  Purpose: The purpose of this function is to request that the program
+  stop once the queued jobs are finished.
+
+  Calling Sequence: handleSignal(signalNumber)
+
+  Inputs:
+
+    signalNumber - The number of the signal.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void handleSignal(int)
+{
+
+  stopRequested = 1;
+
+  return;
+
+} // handleSignal
+
+/*****************************************************************************
+
+  Name: getElapsedTime
+
+  Purpose: The purpose of this function is to compute the number of
+  seconds between two times.
+
+  Calling Sequence: seconds = getElapsedTime(startTime,endTime)
+
+  Inputs:
+
+    startTime - The earlier time.
+
+    endTime - The later time.
+
+  Outputs:
+
+    seconds - The number of seconds between the times.
+
+*****************************************************************************/
+static double getElapsedTime(struct timespec startTime,
+                             struct timespec endTime)
+{
+
+  return ((endTime.tv_sec - startTime.tv_sec) +
+          ((endTime.tv_nsec - startTime.tv_nsec) / 1e9));
+
+} // getElapsedTime
+
+/*****************************************************************************
+
+  Name: writeJobReport
+
+  Purpose: The purpose of this function is to finish a job in the spool
+  directory.  The active job file is removed, and a one line report is
+  written to "<name>.done" when the job succeeded, or to
+  "<name>.failed" when it didn't.  The report is also written to stdout.
+  A spool path that doesn't fit in a path buffer is left alone, rather
+  than acting on a truncated path.
+
+  Calling Sequence: writeJobReport(contextPtr,namePtr,succeeded,reportPtr)
+
+  Inputs:
+
+    contextPtr - A pointer to the shared context.
+
+    namePtr - The name of the job.
+
+    succeeded - A flag that indicates whether the job succeeded.
+
+    reportPtr - The text of the report.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void writeJobReport(struct BatchContext *contextPtr,
+                           const char *namePtr,
+                           bool succeeded,
+                           const char *reportPtr)
+{
+  int length;
+  char path[PATH_LENGTH * 2];
+  FILE *streamPtr;
+
+  length = snprintf(path,sizeof(path),"%s/%s.active",
+                    contextPtr->spoolDirectoryPtr,namePtr);
+
+  if (length < (int)sizeof(path))
+  {
+    unlink(path);
+  } // if
+
+  length = snprintf(path,sizeof(path),"%s/%s.%s",
+                    contextPtr->spoolDirectoryPtr,
+                    namePtr,
+                    succeeded ? "done" : "failed");
+
+  streamPtr = NULL;
+
+  if (length < (int)sizeof(path))
+  {
+    streamPtr = fopen(path,"w");
+  } // if
+
+  if (streamPtr != NULL)
+  {
+    fprintf(streamPtr,"%s\n",reportPtr);
+    fclose(streamPtr);
+  } // if
+
+  printf("%s: %s\n",namePtr,reportPtr);
+  fflush(stdout);
+
+  pthread_mutex_lock(&contextPtr->mutex);
+
+  contextPtr->totalJobs++;
+
+  if (!succeeded)
+  {
+    contextPtr->failedJobs++;
+  } // if
+
+  pthread_mutex_unlock(&contextPtr->mutex);
+
+  return;
+
+} // writeJobReport
+
+/*****************************************************************************
+
+  Name: parseJob
+
+  Purpose: The purpose of this function is to parse the line of a job
+  file.  The line is split into words, and the options are retrieved
+  with getopt() just as they are from a command line, so this must only
+  be called by the main thread.
+
+  Calling Sequence: valid = parseJob(linePtr,jobPtr,messagePtr,
+                                     messageLength)
+
+  Inputs:
+
+    linePtr - The line of the job file.  It is modified.
+
+    jobPtr - A pointer to the job, whose name is already set.
+
+    messagePtr - A pointer to storage for an error message.
+
+    messageLength - The size of the storage for the message.
+
+  Outputs:
+
+    valid - A flag that indicates whether the line was understood.
+
+*****************************************************************************/
+static bool parseJob(char *linePtr,
+                     struct Job *jobPtr,
+                     char *messagePtr,
+                     int messageLength)
+{
+  bool done;
+  int opt;
+  int argc;
+  char *argv[MAX_JOB_WORDS + 1];
+  char *wordPtr;
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Default parameters, as for noiseCanceller.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  jobPtr->filterOrder = 5;
+  jobPtr->delay = 5;
+  jobPtr->beta = 0.1;
+  jobPtr->automaticFreeze = false;
+  jobPtr->freezeTolerance = 0;
+  jobPtr->format = SAMPLE_FORMAT_S16;
+  jobPtr->sampleRate = 8000;
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  // Split the line into words, after a dummy program name.
+  argv[0] = (char *)"job";
+  argc = 1;
+
+  wordPtr = strtok(linePtr," \t\r\n");
+
+  while ((wordPtr != NULL) && (argc < MAX_JOB_WORDS))
+  {
+    argv[argc] = wordPtr;
+    argc++;
+
+    wordPtr = strtok(NULL," \t\r\n");
+  } // while
+
+  argv[argc] = NULL;
+
+  // Start getopt() over, and keep it quiet.
+  optind = 0;
+  opterr = 0;
+
+  // Set up for loop entry.
+  done = false;
+
+  while (!done)
+  {
+    // Retrieve the next option.
+    opt = getopt(argc,argv,"o:d:b:f:S:F:");
+
+    switch (opt)
+    {
+      case 'o':
+      {
+        jobPtr->filterOrder = atoi(optarg);
+        break;
+      } // case
+
+      case 'd':
+      {
+        jobPtr->delay = atoi(optarg);
+        break;
+      } // case
+
+      case 'b':
+      {
+        jobPtr->beta = atof(optarg);
+        break;
+      } // case
+
+      case 'f':
+      {
+        if (!SampleConverter::parseFormat(optarg,&jobPtr->format))
+        {
+          snprintf(messagePtr,messageLength,
+                   "unsupported format %s",optarg);
+          return (false);
+        } // if
+        break;
+      } // case
+
+      case 'S':
+      {
+        jobPtr->sampleRate = atoi(optarg);
+        break;
+      } // case
+
+      case 'F':
+      {
+        jobPtr->automaticFreeze = true;
+        jobPtr->freezeTolerance = atof(optarg);
+        break;
+      } // case
+
+      case -1:
+      {
+        // All options consumed, so bail out.
+        done = true;
+        break;
+      } // case
+
+      default:
+      {
+        snprintf(messagePtr,messageLength,"unrecognized option");
+        return (false);
+      } // case
+    } // switch
+  } // while
+
+  if ((argc - optind) != 2)
+  {
+    snprintf(messagePtr,messageLength,
+             "expected an input file and an output file");
+    return (false);
+  } // if
+
+  if ((jobPtr->filterOrder < 1) || (jobPtr->delay < 0))
+  {
+    snprintf(messagePtr,messageLength,"invalid filter order or delay");
+    return (false);
+  } // if
+
+  snprintf(jobPtr->inputPath,PATH_LENGTH,"%s",argv[optind]);
+  snprintf(jobPtr->outputPath,PATH_LENGTH,"%s",argv[optind + 1]);
+
+  if (jobPtr->sampleRate == 0)
+  {
+    jobPtr->sampleRate = 8000;
+  } // if
+
+  return (true);
+
+} // parseJob
+
+/*****************************************************************************
+
+  Name: submitJob
+
+  Purpose: The purpose of this function is to take a job file from the
+  spool directory, and to queue the job for the workers.  The job file
+  is renamed to "<name>.active" first, so a job is taken only once even
+  if it is seen by both the startup scan and inotify.  A job that can't
+  be parsed, or whose paths are too long, is finished immediately with
+  an error report.
+
+  Calling Sequence: submitJob(contextPtr,fileNamePtr)
+
+  Inputs:
+
+    contextPtr - A pointer to the shared context.
+
+    fileNamePtr - The name of the job file within the spool directory.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void submitJob(struct BatchContext *contextPtr,
+                      const char *fileNamePtr)
+{
+  int length;
+  int jobPathLength;
+  int activePathLength;
+  char jobPath[PATH_LENGTH * 2];
+  char activePath[PATH_LENGTH * 2];
+  char line[PATH_LENGTH * 3];
+  char message[PATH_LENGTH];
+  FILE *streamPtr;
+  struct Job *jobPtr;
+
+  length = strlen(fileNamePtr);
+
+  // Only files whose names end in ".job" are jobs.
+  if ((length <= 4) || (strcmp(&fileNamePtr[length - 4],".job") != 0))
+  {
+    return;
+  } // if
+
+  jobPtr = new struct Job;
+  jobPtr->nextPtr = NULL;
+  snprintf(jobPtr->name,PATH_LENGTH,"%.*s",length - 4,fileNamePtr);
+
+  jobPathLength = snprintf(jobPath,sizeof(jobPath),"%s/%s",
+                           contextPtr->spoolDirectoryPtr,fileNamePtr);
+  activePathLength = snprintf(activePath,sizeof(activePath),"%s/%s.active",
+                              contextPtr->spoolDirectoryPtr,jobPtr->name);
+
+  if ((jobPathLength >= (int)sizeof(jobPath)) ||
+      (activePathLength >= (int)sizeof(activePath)))
+  {
+    // Don't rename a truncated path.
+    writeJobReport(contextPtr,jobPtr->name,false,"job path is too long");
+    delete jobPtr;
+    return;
+  } // if
+
+  if (rename(jobPath,activePath) != 0)
+  {
+    // The job has already been taken.
+    delete jobPtr;
+    return;
+  } // if
+
+  line[0] = 0;
+
+  streamPtr = fopen(activePath,"r");
+
+  if (streamPtr != NULL)
+  {
+    if (fgets(line,sizeof(line),streamPtr) == NULL)
+    {
+      line[0] = 0;
+    } // if
+
+    fclose(streamPtr);
+  } // if
+
+  if (!parseJob(line,jobPtr,message,sizeof(message)))
+  {
+    writeJobReport(contextPtr,jobPtr->name,false,message);
+    delete jobPtr;
+    return;
+  } // if
+
+  // Queue the job.
+  pthread_mutex_lock(&contextPtr->mutex);
+
+  if (contextPtr->jobTailPtr == NULL)
+  {
+    contextPtr->jobHeadPtr = jobPtr;
+  } // if
+  else
+  {
+    contextPtr->jobTailPtr->nextPtr = jobPtr;
+  } // else
+
+  contextPtr->jobTailPtr = jobPtr;
+
+  pthread_cond_signal(&contextPtr->jobAvailable);
+  pthread_mutex_unlock(&contextPtr->mutex);
+
+  return;
+
+} // submitJob
+
+/*****************************************************************************
+
+  Name: scanSpoolDirectory
+
+  Purpose: The purpose of this function is to submit every job that is
+  already in the spool directory.
+
+  Calling Sequence: scanSpoolDirectory(contextPtr)
+
+  Inputs:
+
+    contextPtr - A pointer to the shared context.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void scanSpoolDirectory(struct BatchContext *contextPtr)
+{
+  DIR *directoryPtr;
+  struct dirent *entryPtr;
+
+  directoryPtr = opendir(contextPtr->spoolDirectoryPtr);
+
+  if (directoryPtr == NULL)
+  {
+    return;
+  } // if
+
+  entryPtr = readdir(directoryPtr);
+
+  while (entryPtr != NULL)
+  {
+    submitJob(contextPtr,entryPtr->d_name);
+    entryPtr = readdir(directoryPtr);
+  } // while
+
+  closedir(directoryPtr);
+
+  return;
+
+} // scanSpoolDirectory
+
+/*****************************************************************************
+
+  Name: getOutputBuffer
+
+  Purpose: The purpose of this function is to take a free output buffer
+  of a worker, waiting for one of its writes to complete if all of its
+  buffers are in use.
+
+  Calling Sequence: bufferPtr = getOutputBuffer(workerPtr)
+
+  Inputs:
+
+    workerPtr - A pointer to the worker.
+
+  Outputs:
+
+    bufferPtr - A pointer to the output buffer.
+
+*****************************************************************************/
+static struct OutputBuffer *getOutputBuffer(struct Worker *workerPtr)
+{
+  struct BatchContext *contextPtr;
+  struct OutputBuffer *bufferPtr;
+
+  contextPtr = workerPtr->contextPtr;
+
+  pthread_mutex_lock(&contextPtr->mutex);
+
+  while (workerPtr->freeListPtr == NULL)
+  {
+    pthread_cond_wait(&workerPtr->bufferFreed,&contextPtr->mutex);
+  } // while
+
+  bufferPtr = workerPtr->freeListPtr;
+  workerPtr->freeListPtr = bufferPtr->nextPtr;
+
+  pthread_mutex_unlock(&contextPtr->mutex);
+
+  return (bufferPtr);
+
+} // getOutputBuffer
+
+/*****************************************************************************
+
+  Name: queueWrite
+
+  Purpose: The purpose of this function is to hand a filled output buffer
+  to the I/O threads.
+
+  Calling Sequence: queueWrite(workerPtr,bufferPtr)
+
+  Inputs:
+
+    workerPtr - A pointer to the worker that owns the buffer.
+
+    bufferPtr - A pointer to the output buffer.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void queueWrite(struct Worker *workerPtr,
+                       struct OutputBuffer *bufferPtr)
+{
+  struct BatchContext *contextPtr;
+
+  contextPtr = workerPtr->contextPtr;
+
+  bufferPtr->nextPtr = NULL;
+
+  pthread_mutex_lock(&contextPtr->mutex);
+
+  if (contextPtr->writeTailPtr == NULL)
+  {
+    contextPtr->writeHeadPtr = bufferPtr;
+  } // if
+  else
+  {
+    contextPtr->writeTailPtr->nextPtr = bufferPtr;
+  } // else
+
+  contextPtr->writeTailPtr = bufferPtr;
+  workerPtr->pendingWrites++;
+
+  pthread_cond_signal(&contextPtr->writeAvailable);
+  pthread_mutex_unlock(&contextPtr->mutex);
+
+  return;
+
+} // queueWrite
+
+/*****************************************************************************
+
+  Name: waitForWrites
+
+  Purpose: The purpose of this function is to wait until every output
+  buffer of a worker has been written.
+
+  Calling Sequence: waitForWrites(workerPtr)
+
+  Inputs:
+
+    workerPtr - A pointer to the worker.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void waitForWrites(struct Worker *workerPtr)
+{
+  struct BatchContext *contextPtr;
+
+  contextPtr = workerPtr->contextPtr;
+
+  pthread_mutex_lock(&contextPtr->mutex);
+
+  while (workerPtr->pendingWrites > 0)
+  {
+    pthread_cond_wait(&workerPtr->bufferFreed,&contextPtr->mutex);
+  } // while
+
+  pthread_mutex_unlock(&contextPtr->mutex);
+
+  return;
+
+} // waitForWrites
+
+/*****************************************************************************
+
+  Name: ioThread
+
+  Purpose: The purpose of this function is to serve as the entry point of
+  an I/O thread.  The thread writes queued output buffers at their file
+  offsets, and returns each buffer to the worker that owns it, until it
+  is told to stop and the queue is empty.
+
+  Calling Sequence: ioThread(argPtr)
+
+  Inputs:
+
+    argPtr - A pointer to the shared context.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void *ioThread(void *argPtr)
+{
+  bool failed;
+  ssize_t result;
+  uint32_t written;
+  struct BatchContext *contextPtr;
+  struct OutputBuffer *bufferPtr;
+  struct Worker *workerPtr;
+
+  contextPtr = (struct BatchContext *)argPtr;
+
+  pthread_mutex_lock(&contextPtr->mutex);
+
+  while (true)
+  {
+    while ((contextPtr->writeHeadPtr == NULL) && !contextPtr->ioStopping)
+    {
+      pthread_cond_wait(&contextPtr->writeAvailable,&contextPtr->mutex);
+    } // while
+
+    if (contextPtr->writeHeadPtr == NULL)
+    {
+      // We're done.
+      break;
+    } // if
+
+    // Take the next buffer.
+    bufferPtr = contextPtr->writeHeadPtr;
+    contextPtr->writeHeadPtr = bufferPtr->nextPtr;
+
+    if (contextPtr->writeHeadPtr == NULL)
+    {
+      contextPtr->writeTailPtr = NULL;
+    } // if
+
+    pthread_mutex_unlock(&contextPtr->mutex);
+
+    // Write the whole buffer.
+    failed = false;
+    written = 0;
+
+    while ((written < bufferPtr->length) && !failed)
+    {
+      result = pwrite(bufferPtr->fileDescriptor,
+                      &bufferPtr->dataPtr[written],
+                      bufferPtr->length - written,
+                      bufferPtr->offset + written);
+
+      if (result > 0)
+      {
+        written += result;
+      } // if
+      else
+      {
+        if ((result < 0) && (errno == EINTR))
+        {
+          continue;
+        } // if
+
+        failed = true;
+      } // else
+    } // while
+
+    // Give the buffer back to its worker.
+    pthread_mutex_lock(&contextPtr->mutex);
+
+    workerPtr = bufferPtr->ownerPtr;
+
+    if (failed)
+    {
+      workerPtr->writeFailed = true;
+    } // if
+
+    bufferPtr->nextPtr = workerPtr->freeListPtr;
+    workerPtr->freeListPtr = bufferPtr;
+    workerPtr->pendingWrites--;
+
+    pthread_cond_signal(&workerPtr->bufferFreed);
+  } // while
+
+  pthread_mutex_unlock(&contextPtr->mutex);
+
+  return (NULL);
+
+} // ioThread
+
+/*****************************************************************************
+
+  Name: processJob
+
+  Purpose: The purpose of this function is to run one job on a worker.
+  The canceller of the worker is reconfigured for the job, and the input
+  is read, filtered, and handed to the I/O threads a block at a time.
+  The time that is spent in the canceller is measured separately from
+  the elapsed time of the job.
+
+  Calling Sequence: processJob(workerPtr,jobPtr)
+
+  Inputs:
+
+    workerPtr - A pointer to the worker.
+
+    jobPtr - A pointer to the job.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void processJob(struct Worker *workerPtr,struct Job *jobPtr)
+{
+  bool done;
+  int fileDescriptor;
+  int sampleSize;
+  uint32_t count;
+  uint32_t sampleRate;
+  uint64_t numberOfSamples;
+  off_t offset;
+  double elapsedTime;
+  double filterTime;
+  char report[PATH_LENGTH * 2];
+  struct timespec jobStartTime, startTime, endTime;
+  struct BatchContext *contextPtr;
+  struct OutputBuffer *bufferPtr;
+  NlmsNoiseCanceller *cancellerPtr;
+  SampleReader *readerPtr;
+  FILE *streamPtr;
+
+  contextPtr = workerPtr->contextPtr;
+  cancellerPtr = workerPtr->cancellerPtr;
+
+  clock_gettime(CLOCK_MONOTONIC,&jobStartTime);
+
+  streamPtr = fopen(jobPtr->inputPath,"rb");
+
+  if (streamPtr == NULL)
+  {
+    snprintf(report,sizeof(report),"can't open %s: %s",
+             jobPtr->inputPath,strerror(errno));
+    writeJobReport(contextPtr,jobPtr->name,false,report);
+    return;
+  } // if
+
+  readerPtr = new SampleReader(streamPtr,jobPtr->format,1,FULL_SCALE);
+
+  if (!readerPtr->isValid() || (readerPtr->getNumberOfChannels() != 1))
+  {
+    snprintf(report,sizeof(report),"%s is not a single channel stream",
+             jobPtr->inputPath);
+    writeJobReport(contextPtr,jobPtr->name,false,report);
+    delete readerPtr;
+    fclose(streamPtr);
+    return;
+  } // if
+
+  fileDescriptor = open(jobPtr->outputPath,O_WRONLY | O_CREAT | O_TRUNC,0644);
+
+  if (fileDescriptor < 0)
+  {
+    snprintf(report,sizeof(report),"can't create %s: %s",
+             jobPtr->outputPath,strerror(errno));
+    writeJobReport(contextPtr,jobPtr->name,false,report);
+    delete readerPtr;
+    fclose(streamPtr);
+    return;
+  } // if
+
+  // WAV files specify their own sample rate.
+  sampleRate = jobPtr->sampleRate;
+
+  if (readerPtr->getSampleRate() != 0)
+  {
+    sampleRate = readerPtr->getSampleRate();
+  } // if
+
+  sampleSize = SampleConverter::getSampleSize(readerPtr->getFormat());
+
+  // Reuse the storage of the pooled canceller.
+  if (!cancellerPtr->reconfigure(jobPtr->filterOrder,
+                                 jobPtr->delay,
+                                 jobPtr->beta))
+  {
+    snprintf(report,sizeof(report),"invalid filter order or delay");
+    writeJobReport(contextPtr,jobPtr->name,false,report);
+    close(fileDescriptor);
+    delete readerPtr;
+    fclose(streamPtr);
+    return;
+  } // if
+
+  cancellerPtr->setAutomaticFreeze(jobPtr->automaticFreeze,
+                                   jobPtr->freezeTolerance);
+
+  workerPtr->writeFailed = false;
+  numberOfSamples = 0;
+  offset = 0;
+  filterTime = 0;
+
+  // Set up for loop entry.
+  done = false;
+
+  while (!done)
+  {
+    count = readerPtr->readFrames(workerPtr->inputBufferPtr,
+                                  contextPtr->blockSize);
+
+    if (count == 0)
+    {
+      // We're done.
+      done = true;
+    } // if
+    else
+    {
+      clock_gettime(CLOCK_MONOTONIC,&startTime);
+
+      cancellerPtr->acceptData(workerPtr->inputBufferPtr,
+                               count,
+                               workerPtr->outputBufferPtr);
+
+      clock_gettime(CLOCK_MONOTONIC,&endTime);
+      filterTime += getElapsedTime(startTime,endTime);
+
+      // Encode the block, and let an I/O thread write it.
+      bufferPtr = getOutputBuffer(workerPtr);
+
+      SampleConverter::fromFloat(workerPtr->outputBufferPtr,
+                                 count,
+                                 FULL_SCALE,
+                                 readerPtr->getFormat(),
+                                 bufferPtr->dataPtr);
+
+      bufferPtr->length = count * sampleSize;
+      bufferPtr->fileDescriptor = fileDescriptor;
+      bufferPtr->offset = offset;
+
+      queueWrite(workerPtr,bufferPtr);
+
+      offset += bufferPtr->length;
+      numberOfSamples += count;
+    } // else
+  } // while
+
+  // The file can't be closed while its blocks are being written.
+  waitForWrites(workerPtr);
+
+  if ((close(fileDescriptor) != 0) || workerPtr->writeFailed)
+  {
+    snprintf(report,sizeof(report),"error writing %s",jobPtr->outputPath);
+    writeJobReport(contextPtr,jobPtr->name,false,report);
+  } // if
+  else
+  {
+    clock_gettime(CLOCK_MONOTONIC,&endTime);
+    elapsedTime = getElapsedTime(jobStartTime,endTime);
+
+    snprintf(report,sizeof(report),
+             "%llu samples, %.1f ms elapsed, %.1f ms filtering,"
+             " %.2f Msamples/s, %.1fx real time",
+             (unsigned long long)numberOfSamples,
+             elapsedTime * 1e3,
+             filterTime * 1e3,
+             (numberOfSamples / (elapsedTime + 1e-12)) / 1e6,
+             (numberOfSamples / (double)sampleRate) / (elapsedTime + 1e-12));
+
+    pthread_mutex_lock(&contextPtr->mutex);
+    contextPtr->totalSamples += numberOfSamples;
+    pthread_mutex_unlock(&contextPtr->mutex);
+
+    writeJobReport(contextPtr,jobPtr->name,true,report);
+  } // else
+
+  delete readerPtr;
+  fclose(streamPtr);
+
+  return;
+
+} // processJob
+
+/*****************************************************************************
+
+  Name: workerThread
+
+  Purpose: The purpose of this function is to serve as the entry point of
+  a worker thread.  The worker takes jobs from the queue and runs them
+  until it is told to stop and the queue is empty.
+
+  Calling Sequence: workerThread(argPtr)
+
+  Inputs:
+
+    argPtr - A pointer to the worker.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void *workerThread(void *argPtr)
+{
+  struct Worker *workerPtr;
+  struct BatchContext *contextPtr;
+  struct Job *jobPtr;
+
+  workerPtr = (struct Worker *)argPtr;
+  contextPtr = workerPtr->contextPtr;
+
+  while (true)
+  {
+    pthread_mutex_lock(&contextPtr->mutex);
+
+    while ((contextPtr->jobHeadPtr == NULL) && !contextPtr->workersStopping)
+    {
+      pthread_cond_wait(&contextPtr->jobAvailable,&contextPtr->mutex);
+    } // while
+
+    jobPtr = contextPtr->jobHeadPtr;
+
+    if (jobPtr != NULL)
+    {
+      contextPtr->jobHeadPtr = jobPtr->nextPtr;
+
+      if (contextPtr->jobHeadPtr == NULL)
+      {
+        contextPtr->jobTailPtr = NULL;
+      } // if
+    } // if
+
+    pthread_mutex_unlock(&contextPtr->mutex);
+
+    if (jobPtr == NULL)
+    {
+      // We're done.
+      break;
+    } // if
+
+    processJob(workerPtr,jobPtr);
+
+    delete jobPtr;
+  } // while
+
+  return (NULL);
+
+} // workerThread
+
+/*****************************************************************************
+
+  Name: watchSpoolDirectory
+
+  Purpose: The purpose of this function is to submit jobs as they appear
+  in the spool directory, until a stop is requested.
+
+  Calling Sequence: watchSpoolDirectory(contextPtr,notifyDescriptor)
+
+  Inputs:
+
+    contextPtr - A pointer to the shared context.
+
+    notifyDescriptor - The inotify descriptor that watches the spool
+    directory.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void watchSpoolDirectory(struct BatchContext *contextPtr,
+                                int notifyDescriptor)
+{
+  int result;
+  ssize_t length;
+  ssize_t i;
+  char events[4096]
+    __attribute__ ((aligned(__alignof__(struct inotify_event))));
+  struct inotify_event *eventPtr;
+  struct pollfd pollDescriptor;
+
+  pollDescriptor.fd = notifyDescriptor;
+  pollDescriptor.events = POLLIN;
+
+  while (!stopRequested)
+  {
+    result = poll(&pollDescriptor,1,POLL_INTERVAL);
+
+    if (result <= 0)
+    {
+      // Timeout or signal, so check the stop flag.
+      continue;
+    } // if
+
+    length = read(notifyDescriptor,events,sizeof(events));
+
+    for (i = 0; i < length; i += sizeof(struct inotify_event) + eventPtr->len)
+    {
+      eventPtr = (struct inotify_event *)&events[i];
+
+      if (eventPtr->len > 0)
+      {
+        submitJob(contextPtr,eventPtr->name);
+      } // if
+    } // for
+  } // while
+
+  return;
+
+} // watchSpoolDirectory
+
+//*************************************************************************
+// Mainline code.
+//*************************************************************************
+int main(int argc,char **argv)
+{
+  int i, j;
+  bool exitProgram;
+  bool argumentError;
+  const char *spoolDirectoryPtr;
+  int numberOfWorkers;
+  int numberOfIoThreads;
+  int maxFilterOrder;
+  int maxDelay;
+  int blockSize;
+  int notifyDescriptor;
+  struct sigaction action;
+  struct BatchContext context;
+  struct Worker *workersPtr;
+  pthread_t *ioThreadsPtr;
+  MemoryArena *arenaPtr;
+  struct MyParameters parameters;
+
+  // Set up for parameter transmission.
+  parameters.spoolDirectoryPtr = &spoolDirectoryPtr;
+  parameters.numberOfWorkersPtr = &numberOfWorkers;
+  parameters.numberOfIoThreadsPtr = &numberOfIoThreads;
+  parameters.maxFilterOrderPtr = &maxFilterOrder;
+  parameters.maxDelayPtr = &maxDelay;
+  parameters.blockSizePtr = &blockSize;
+  parameters.argumentErrorPtr = &argumentError;
+
+  // Retrieve the system parameters.
+  exitProgram = getUserArguments(argc,argv,parameters);
+
+  if (exitProgram)
+  {
+    if (argumentError)
+    {
+      // Let the caller know that the arguments were rejected.
+      return (1);
+    } // if
+
+    // Bail out.
+    return (0);
+  } // if
+
+  // Watch the spool directory before scanning it, so no job is missed.
+  notifyDescriptor = inotify_init1(IN_NONBLOCK);
+
+  if ((notifyDescriptor < 0) ||
+      (inotify_add_watch(notifyDescriptor,
+                         spoolDirectoryPtr,
+                         IN_CLOSE_WRITE | IN_MOVED_TO) < 0))
+  {
+    fprintf(stderr,"Can't watch %s.\n",spoolDirectoryPtr);
+    return (1);
+  } // if
+
+  // Stop cleanly on SIGINT and SIGTERM.
+  memset(&action,0,sizeof(action));
+  action.sa_handler = handleSignal;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT,&action,NULL);
+  sigaction(SIGTERM,&action,NULL);
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Set up the shared context.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  context.spoolDirectoryPtr = spoolDirectoryPtr;
+  context.blockSize = blockSize;
+  context.jobHeadPtr = NULL;
+  context.jobTailPtr = NULL;
+  context.writeHeadPtr = NULL;
+  context.writeTailPtr = NULL;
+  context.workersStopping = false;
+  context.ioStopping = false;
+  context.totalJobs = 0;
+  context.failedJobs = 0;
+  context.totalSamples = 0;
+
+  pthread_mutex_init(&context.mutex,NULL);
+  pthread_cond_init(&context.jobAvailable,NULL);
+  pthread_cond_init(&context.writeAvailable,NULL);
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Set up the workers.  All of the cancellers of the pool share one
+  // contiguous block of storage, and every buffer is allocated here,
+  // so running a job allocates nothing but its reader.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  arenaPtr = new MemoryArena(numberOfWorkers *
+    NlmsNoiseCanceller::getStorageRequirement(maxFilterOrder,maxDelay));
+
+  workersPtr = new struct Worker[numberOfWorkers];
+
+  for (i = 0; i < numberOfWorkers; i++)
+  {
+    workersPtr[i].contextPtr = &context;
+    workersPtr[i].cancellerPtr =
+      new NlmsNoiseCanceller(maxFilterOrder,maxDelay,0.1,arenaPtr);
+    workersPtr[i].inputBufferPtr = (float *)SampleConverter::allocateAligned(
+      blockSize * sizeof(float));
+    workersPtr[i].outputBufferPtr = (float *)SampleConverter::allocateAligned(
+      blockSize * sizeof(float));
+
+    workersPtr[i].freeListPtr = NULL;
+
+    for (j = 0; j < BUFFERS_PER_WORKER; j++)
+    {
+      // Room for the largest sample size.
+      workersPtr[i].buffers[j].dataPtr =
+        (uint8_t *)SampleConverter::allocateAligned(blockSize *
+                                                    sizeof(int32_t));
+      workersPtr[i].buffers[j].ownerPtr = &workersPtr[i];
+      workersPtr[i].buffers[j].nextPtr = workersPtr[i].freeListPtr;
+      workersPtr[i].freeListPtr = &workersPtr[i].buffers[j];
+    } // for
+
+    workersPtr[i].pendingWrites = 0;
+    workersPtr[i].writeFailed = false;
+    pthread_cond_init(&workersPtr[i].bufferFreed,NULL);
+  } // for
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Start the threads.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  ioThreadsPtr = new pthread_t[numberOfIoThreads];
+
+  for (i = 0; i < numberOfIoThreads; i++)
+  {
+    pthread_create(&ioThreadsPtr[i],NULL,ioThread,&context);
+  } // for
+
+  for (i = 0; i < numberOfWorkers; i++)
+  {
+    pthread_create(&workersPtr[i].thread,NULL,workerThread,&workersPtr[i]);
+  } // for
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  fprintf(stderr,"Watching %s with %d workers and %d I/O threads.\n",
+          spoolDirectoryPtr,numberOfWorkers,numberOfIoThreads);
+
+  // Take the jobs that are already waiting, and then the new ones.
+  scanSpoolDirectory(&context);
+  watchSpoolDirectory(&context,notifyDescriptor);
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Stop the threads once the queues are empty.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  pthread_mutex_lock(&context.mutex);
+  context.workersStopping = true;
+  pthread_cond_broadcast(&context.jobAvailable);
+  pthread_mutex_unlock(&context.mutex);
+
+  for (i = 0; i < numberOfWorkers; i++)
+  {
+    pthread_join(workersPtr[i].thread,NULL);
+  } // for
+
+  pthread_mutex_lock(&context.mutex);
+  context.ioStopping = true;
+  pthread_cond_broadcast(&context.writeAvailable);
+  pthread_mutex_unlock(&context.mutex);
+
+  for (i = 0; i < numberOfIoThreads; i++)
+  {
+    pthread_join(ioThreadsPtr[i],NULL);
+  } // for
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  fprintf(stderr,"%llu jobs (%llu failed), %llu samples.\n",
+          (unsigned long long)context.totalJobs,
+          (unsigned long long)context.failedJobs,
+          (unsigned long long)context.totalSamples);
+
+  // Release resources.
+  for (i = 0; i < numberOfWorkers; i++)
+  {
+    for (j = 0; j < BUFFERS_PER_WORKER; j++)
+    {
+      SampleConverter::releaseAligned(workersPtr[i].buffers[j].dataPtr);
+    } // for
+
+    SampleConverter::releaseAligned(workersPtr[i].inputBufferPtr);
+    SampleConverter::releaseAligned(workersPtr[i].outputBufferPtr);
+    pthread_cond_destroy(&workersPtr[i].bufferFreed);
+    delete workersPtr[i].cancellerPtr;
+  } // for
+
+  delete[] workersPtr;
+  delete[] ioThreadsPtr;
+  delete arenaPtr;
+
+  pthread_cond_destroy(&context.jobAvailable);
+  pthread_cond_destroy(&context.writeAvailable);
+  pthread_mutex_destroy(&context.mutex);
+
+  close(notifyDescriptor);
+
+  return (0);
+
+} // main
@@ -0,0 +1,537 @@
+//*************************************************************************
+// File name: denormalBenchmark.cc
+//*************************************************************************
+
+//*************************************************************************
+// This program demonstrates the effect of subnormal (denormal) floating
+// point values on the per-sample processing time of the NLMS noise
+// canceller, and the effect of the denormal protection options.  The
+// canceller is driven with normalized float samples in four phases:
+//
+//    signal - A noisy tone.
+//    decay - The same signal with an exponentially decaying envelope, so
+//    that the samples, the filter state, and the products pass through
+//    the subnormal range on their way to zero.
+//    silence - Exact zeros.
+//    return - The noisy tone again.
+//
+// The processing time of each block is measured, and for each
+// configuration (plain, FTZ/DAZ, dither, and both), the mean and the
+// maximum time per sample of each phase are displayed.  A flat profile
+// across the phases indicates that the configuration is immune to
+// subnormal slowdowns.  Hardware events can be counted too, which shows
+// whether a slow phase executes more instructions or just takes more
+// cycles for each of them, as subnormal arithmetic does.
+//
+// To run this program type,
+//
+//     ./denormalBenchmark -o filterOrder -d delay -b beta -B blockSize
+//                         -n ditherLevel -s phaseLength -P,
+//
+// where,
+//
+//    filterOrder - The order of the adaptive filter.
+//    delay - The delay that is used to generate the reference signal.
+//    beta - The convergence factor.
+//    blockSize - The number of samples per timed block.
+//    ditherLevel - The peak amplitude of the dither relative to full
+//    scale.  Its square must be a normal float, so it must exceed 1e-19.
+//    phaseLength - The number of samples in each phase.
+//    -P - Count cycles, instructions, cache misses, and branch misses
+//    over each block, and display the counts per sample of each phase
+//    of each configuration.
+//*************************************************************************
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+
+#include "Nco.h"
+#include "NlmsNoiseCanceller.h"
+#include "PerformanceCounters.h"
+
+// This structure is used to consolidate user parameters.
+struct MyParameters
+{
+  int *filterOrderPtr;
+  int *delayPtr;
+  float *betaPtr;
+  int *blockSizePtr;
+  float *ditherLevelPtr;
+  int *phaseLengthPtr;
+  bool *performanceCountersPtr;
+};
+
+// The number of phases of the test signal.
+#define NUMBER_OF_PHASES (4)
+
+// The number of configurations that are measured.
+#define NUMBER_OF_CONFIGURATIONS (4)
+
+static const char *phaseNames[NUMBER_OF_PHASES] =
+{
+  "signal",
+  "decay",
+  "silence",
+  "return"
+};
+
+static const char *configurationNames[NUMBER_OF_CONFIGURATIONS] =
+{
+  "plain",
+  "ftz/daz",
+  "dither",
+  "both"
+};
+
+/*****************************************************************************
+
+  Name: getUserArguments
+
+  Purpose: The purpose of this function is to retrieve the user arguments
+  that were passed to the program.  Any arguments that are specified are
+  set to reasonable default values.
+
+  Calling Sequence: exitProgram = getUserArguments(parameters)
+
+  Inputs:
+
+    parameters - A structure that contains pointers to the user parameters.
+
+  Outputs:
+
+    exitProgram - A flag that indicates whether or not the program should
+    be exited.  A value of true indicates to exit the program, and a value
+    of false indicates that the program should not be exited..
+
+*****************************************************************************/
+bool getUserArguments(int argc,char **argv,struct MyParameters parameters)
+{
+  bool exitProgram;
+  bool done;
+  int opt;
+
+  // Default not to exit program.
+  exitProgram = false;
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Default parameters.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Default a 64th order filter.
+  *parameters.filterOrderPtr = 64;
+
+  // Default to a delay of 64 samples.
+  *parameters.delayPtr = 64;
+
+  // Default to a convergence rate of something reasonable.
+  *parameters.betaPtr = 0.1;
+
+  // Default to 64 sample blocks.
+  *parameters.blockSizePtr = 64;
+
+  // Default to dither at about -180dB relative to full scale.
+  *parameters.ditherLevelPtr = 1e-9;
+
+  // Default to phases that are long enough for a complete decay.
+  *parameters.phaseLengthPtr = 32768;
+
+  // Default to timing only.
+  *parameters.performanceCountersPtr = false;
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  // Set up for loop entry.
+  done = false;
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Retrieve the command line arguments.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  while (!done)
+  {
+    // Retrieve the next option.
+    opt = getopt(argc,argv,"o:d:b:B:n:s:Ph");
+
+    switch (opt)
+    {
+      case 'o':
+      {
+        *parameters.filterOrderPtr = atoi(optarg);
+        break;
+      } // case
+
+      case 'd':
+      {
+        *parameters.delayPtr = atoi(optarg);
+        break;
+      } // case
+
+      case 'b':
+      {
+        *parameters.betaPtr = atof(optarg);
+        break;
+      } // case
+
+      case 'B':
+      {
+        *parameters.blockSizePtr = atoi(optarg);
+        break;
+      } // case
+
+      case 'n':
+      {
+        *parameters.ditherLevelPtr = atof(optarg);
+        break;
+      } // case
+
+      case 's':
+      {
+        *parameters.phaseLengthPtr = atoi(optarg);
+        break;
+      } // case
+
+      case 'P':
+      {
+        *parameters.performanceCountersPtr = true;
+        break;
+      } // case
+
+      case 'h':
+      {
+        // Display usage.
+        fprintf(stderr,"./denormalBenchmark -o filterOrder -d delay -b beta"
+                " -B blockSize -n ditherLevel -s phaseLength -P\n");
+
+        // Indicate that program must be exited.
+        exitProgram = true;
+        break;
+      } // case
+
+      case -1:
+      {
+        // All options consumed, so bail out.
+        done = true;
+      } // case
+    } // switch
+
+  } // while
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  if (*parameters.blockSizePtr < 1)
+  {
+    *parameters.blockSizePtr = 1;
+  } // if
+
+  return (exitProgram);
+
+} // getUserArguments
+
+/*****************************************************************************
+
+  Name: generateTestSignal
+
+  Purpose: The purpose of this function is to generate the four phases
+  of the test signal.  The decay rate is chosen so that the envelope
+  falls from 1 to below the smallest subnormal float (about 1.4e-45)
+  within the decay phase.
+
+  Calling Sequence: generateTestSignal(signalPtr,phaseLength)
+
+  Inputs:
+
+    signalPtr - A pointer to storage for 4 * phaseLength samples.
+
+    phaseLength - The number of samples in each phase.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void generateTestSignal(float *signalPtr,int phaseLength)
+{
+  int i;
+  int phase;
+  float iValue, qValue;
+  float noise;
+  double envelope;
+  double decayFactor;
+  Nco *myNcoPtr;
+
+  myNcoPtr = new Nco(8000,440);
+
+  // Reach 1e-46 about 3/4 of the way through the decay phase.
+  decayFactor = exp(log(1e-46) / (0.75 * phaseLength));
+
+  srand(1);
+  envelope = 1;
+
+  for (i = 0; i < (NUMBER_OF_PHASES * phaseLength); i++)
+  {
+    phase = i / phaseLength;
+
+    myNcoPtr->run(&iValue,&qValue);
+    noise = 0.05f * (((float)rand() / RAND_MAX) - 0.5f);
+
+    switch (phase)
+    {
+      case 1:
+      {
+        envelope *= decayFactor;
+        signalPtr[i] = (float)(envelope * (0.5f * iValue + noise));
+        break;
+      } // case
+
+      case 2:
+      {
+        signalPtr[i] = 0;
+        break;
+      } // case
+
+      default:
+      {
+        signalPtr[i] = 0.5f * iValue + noise;
+        break;
+      } // case
+    } // switch
+  } // for
+
+  delete myNcoPtr;
+
+  return;
+
+} // generateTestSignal
+
+//*************************************************************************
+// Mainline code.
+//*************************************************************************
+int main(int argc,char **argv)
+{
+  int i;
+  int configuration;
+  int phase;
+  bool exitProgram;
+  int filterOrder;
+  int delay;
+  float beta;
+  int blockSize;
+  float ditherLevel;
+  int phaseLength;
+  bool performanceCounters;
+  int event;
+  int numberOfSamples;
+  int count;
+  double perSample;
+  double phaseTotal[NUMBER_OF_PHASES];
+  double phaseMaximum[NUMBER_OF_PHASES];
+  int phaseBlocks[NUMBER_OF_PHASES];
+  double slowest, fastest;
+  double eventsPerSample[NUMBER_OF_CONFIGURATIONS][NUMBER_OF_PHASES]
+                        [NUMBER_OF_EVENTS];
+  PerformanceCounters *countersPtrs[NUMBER_OF_PHASES];
+  float *signalPtr;
+  float *outputPtr;
+  struct timespec startTime, endTime;
+  NlmsNoiseCanceller *cancellerPtr;
+  struct MyParameters parameters;
+
+  // Set up for parameter transmission.
+  parameters.filterOrderPtr = &filterOrder;
+  parameters.delayPtr = &delay;
+  parameters.betaPtr = &beta;
+  parameters.blockSizePtr = &blockSize;
+  parameters.ditherLevelPtr = &ditherLevel;
+  parameters.phaseLengthPtr = &phaseLength;
+  parameters.performanceCountersPtr = &performanceCounters;
+
+  // Retrieve the system parameters.
+  exitProgram = getUserArguments(argc,argv,parameters);
+
+  if (exitProgram)
+  {
+    // Bail out.
+    return (0);
+  } // if
+
+  numberOfSamples = NUMBER_OF_PHASES * phaseLength;
+
+  signalPtr = new float[numberOfSamples];
+  outputPtr = new float[blockSize];
+
+  generateTestSignal(signalPtr,phaseLength);
+
+  // Each phase gets its own counters.
+  for (phase = 0; phase < NUMBER_OF_PHASES; phase++)
+  {
+    countersPtrs[phase] = NULL;
+
+    if (performanceCounters)
+    {
+      countersPtrs[phase] = new PerformanceCounters();
+    } // if
+  } // for
+
+  if (performanceCounters && !countersPtrs[0]->isAvailable())
+  {
+    fprintf(stderr,"Performance counters are not available.\n");
+    performanceCounters = false;
+  } // if
+
+  printf("order %d, delay %d, beta %g, %d sample blocks, dither %g\n\n",
+         filterOrder,delay,beta,blockSize,ditherLevel);
+
+  printf("%10s","ns/sample");
+  for (phase = 0; phase < NUMBER_OF_PHASES; phase++)
+  {
+    printf(" %8s mean/max    ",phaseNames[phase]);
+  } // for
+  printf(" %10s\n","max/min");
+
+  for (configuration = 0;
+       configuration < NUMBER_OF_CONFIGURATIONS;
+       configuration++)
+  {
+    cancellerPtr = new NlmsNoiseCanceller(filterOrder,delay,beta);
+
+    // Configurations 1 and 3 use FTZ/DAZ.
+    cancellerPtr->setDenormalProtection((configuration & 1) != 0);
+
+    // Configurations 2 and 3 use dither.
+    if ((configuration & 2) != 0)
+    {
+      cancellerPtr->setDitherLevel(ditherLevel);
+    } // if
+
+    for (phase = 0; phase < NUMBER_OF_PHASES; phase++)
+    {
+      phaseTotal[phase] = 0;
+      phaseMaximum[phase] = 0;
+      phaseBlocks[phase] = 0;
+
+      if (performanceCounters)
+      {
+        countersPtrs[phase]->reset();
+      } // if
+    } // for
+
+    for (i = 0; i < numberOfSamples; i += count)
+    {
+      count = blockSize;
+      if ((i + count) > numberOfSamples)
+      {
+        count = numberOfSamples - i;
+      } // if
+
+      // Attribute the block to the phase of its first sample.
+      phase = i / phaseLength;
+
+      if (performanceCounters)
+      {
+        countersPtrs[phase]->start();
+      } // if
+
+      clock_gettime(CLOCK_MONOTONIC,&startTime);
+      cancellerPtr->acceptData(&signalPtr[i],count,outputPtr);
+      clock_gettime(CLOCK_MONOTONIC,&endTime);
+
+      if (performanceCounters)
+      {
+        countersPtrs[phase]->stop(count);
+      } // if
+
+      perSample = ((endTime.tv_sec - startTime.tv_sec) * 1e9 +
+                   (endTime.tv_nsec - startTime.tv_nsec)) / count;
+
+      phaseTotal[phase] += perSample;
+      phaseBlocks[phase]++;
+
+      if (perSample > phaseMaximum[phase])
+      {
+        phaseMaximum[phase] = perSample;
+      } // if
+    } // for
+
+    delete cancellerPtr;
+
+    printf("%10s",configurationNames[configuration]);
+
+    slowest = 0;
+    fastest = 1e30;
+
+    for (phase = 0; phase < NUMBER_OF_PHASES; phase++)
+    {
+      phaseTotal[phase] /= phaseBlocks[phase];
+
+      if (performanceCounters)
+      {
+        for (event = 0; event < NUMBER_OF_EVENTS; event++)
+        {
+          eventsPerSample[configuration][phase][event] =
+            countersPtrs[phase]->getPerSample((PerformanceEvent)event);
+        } // for
+      } // if
+
+      printf(" %9.1f / %9.1f",phaseTotal[phase],phaseMaximum[phase]);
+
+      if (phaseTotal[phase] > slowest)
+      {
+        slowest = phaseTotal[phase];
+      } // if
+
+      if (phaseTotal[phase] < fastest)
+      {
+        fastest = phaseTotal[phase];
+      } // if
+    } // for
+
+    printf(" %9.2fx\n",slowest / fastest);
+  } // for
+
+  if (performanceCounters)
+  {
+    printf("\n%-18s","events/sample");
+    for (event = 0; event < NUMBER_OF_EVENTS; event++)
+    {
+      printf(" %13s",PerformanceCounters::getName((PerformanceEvent)event));
+    } // for
+    printf("\n");
+
+    for (configuration = 0;
+         configuration < NUMBER_OF_CONFIGURATIONS;
+         configuration++)
+    {
+      for (phase = 0; phase < NUMBER_OF_PHASES; phase++)
+      {
+        printf("%8s %-9s",
+               configurationNames[configuration],
+               phaseNames[phase]);
+
+        for (event = 0; event < NUMBER_OF_EVENTS; event++)
+        {
+          if (countersPtrs[phase]->isSupported((PerformanceEvent)event))
+          {
+            printf(" %13.3f",eventsPerSample[configuration][phase][event]);
+          } // if
+          else
+          {
+            printf(" %13s","n/a");
+          } // else
+        } // for
+        printf("\n");
+      } // for
+    } // for
+  } // if
+
+  // Release resources.
+  for (phase = 0; phase < NUMBER_OF_PHASES; phase++)
+  {
+    delete countersPtrs[phase];
+  } // for
+
+  delete[] signalPtr;
+  delete[] outputPtr;
+
+  return (0);
+
+} // main
@@ -0,0 +1,624 @@
+//*************************************************************************
+// File name: driftBenchmark.cc
+//*************************************************************************
+
+//*************************************************************************
+// This program measures the cost and the benefit of each accumulation
+// mode of the NLMS noise canceller.  One canceller per mode is driven
+// with the same long stream of a noisy tone, along with a reference
+// canceller that is implemented entirely in double precision.  At each
+// report interval, the following are displayed for each mode:
+//
+//    outErr - The power of the difference between the output of the
+//    mode and the output of the reference, relative to the power of the
+//    reference output, in dB, over the interval.
+//    coefErr - The norm of the difference between the coefficients of
+//    the mode and those of the reference, relative to the norm of the
+//    reference coefficients, in dB, at the end of the interval.
+//
+// At the end of the run, the throughput of each mode is displayed along
+// with its cost relative to float accumulation.
+//
+// To run this program type,
+//
+//     ./driftBenchmark -o filterOrder -d delay -b beta -r sampleRate
+//                      -t duration -i interval -a amplitude
+//                      -v noiseVariance,
+//
+// where,
+//
+//    filterOrder - The order of the adaptive filters.
+//    delay - The delay that is used to generate the reference signal.
+//    beta - The convergence factor.
+//    sampleRate - The sample rate in samples/second.
+//    duration - The duration of the stream in seconds.
+//    interval - The report interval in seconds.
+//    amplitude - The amplitude of the tone.
+//    noiseVariance - The variance of the noise source.
+//*************************************************************************
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+
+#include "Nco.h"
+#include "NlmsNoiseCanceller.h"
+
+// This structure is used to consolidate user parameters.
+struct MyParameters
+{
+  int *filterOrderPtr;
+  int *delayPtr;
+  float *betaPtr;
+  float *sampleRatePtr;
+  float *durationPtr;
+  float *intervalPtr;
+  float *amplitudePtr;
+  float *noiseVariancePtr;
+};
+
+// The number of samples that are processed at a time.
+#define BLOCK_SIZE (1000)
+
+// The number of accumulation modes.
+#define NUMBER_OF_MODES (4)
+
+static const AccumulationMode modes[NUMBER_OF_MODES] =
+{
+  ACCUMULATE_FLOAT,
+  ACCUMULATE_PAIRWISE,
+  ACCUMULATE_KAHAN,
+  ACCUMULATE_DOUBLE
+};
+
+static const char *modeNames[NUMBER_OF_MODES] =
+{
+  "float",
+  "pairwise",
+  "kahan",
+  "double"
+};
+
+// This is a double precision model of the NLMS noise canceller.  It is
+// the yardstick against which the accumulation modes are measured.
+struct ReferenceCanceller
+{
+  int filterLength;
+  int referenceDelay;
+  double beta;
+  double *coefficientsPtr;
+  double *filterStatePtr;
+
+  // Ring buffer of past inputs for the reference delay.
+  double *historyPtr;
+  int historyIndex;
+};
+
+/*****************************************************************************
+
+  Name: getUserArguments
+
+  Purpose: The purpose of this function is to retrieve the user arguments
+  that were passed to the program.  Any arguments that are specified are
+  set to reasonable default values.
+
+  Calling Sequence: exitProgram = getUserArguments(parameters)
+
+  Inputs:
+
+    parameters - A structure that contains pointers to the user parameters.
+
+  Outputs:
+
+    exitProgram - A flag that indicates whether or not the program should
+    be exited.  A value of true indicates to exit the program, and a value
+    of false indicates that the program should not be exited..
+
+*****************************************************************************/
+bool getUserArguments(int argc,char **argv,struct MyParameters parameters)
+{
+  bool exitProgram;
+  bool done;
+  int opt;
+
+  // Default not to exit program.
+  exitProgram = false;
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Default parameters.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Default to a high order filter since that is where drift shows up.
+  *parameters.filterOrderPtr = 256;
+
+  // Default to a delay of 256 samples.
+  *parameters.delayPtr = 256;
+
+  // Default to a slow convergence rate.
+  *parameters.betaPtr = 0.01;
+
+  // Default to 8000 S/s.
+  *parameters.sampleRatePtr = 8000;
+
+  // Default to 10 minutes of data.
+  *parameters.durationPtr = 600;
+
+  // Default to a report every minute.
+  *parameters.intervalPtr = 60;
+
+  // Default to a tone at about 1/3 of 16-bit full scale.
+  *parameters.amplitudePtr = 10000;
+
+  // Default to a noise level similar to the tone.
+  *parameters.noiseVariancePtr = 5000;
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  // Set up for loop entry.
+  done = false;
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Retrieve the command line arguments.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  while (!done)
+  {
+    // Retrieve the next option.
+    opt = getopt(argc,argv,"o:d:b:r:t:i:a:v:h");
+
+    switch (opt)
+    {
+      case 'o':
+      {
+        *parameters.filterOrderPtr = atoi(optarg);
+        break;
+      } // case
+
+      case 'd':
+      {
+        *parameters.delayPtr = atoi(optarg);
+        break;
+      } // case
+
+      case 'b':
+      {
+        *parameters.betaPtr = atof(optarg);
+        break;
+      } // case
+
+      case 'r':
+      {
+        *parameters.sampleRatePtr = atof(optarg);
+        break;
+      } // case
+
+      case 't':
+      {
+        *parameters.durationPtr = atof(optarg);
+        break;
+      } // case
+
+      case 'i':
+      {
+        *parameters.intervalPtr = atof(optarg);
+        break;
+      } // case
+
+      case 'a':
+      {
+        *parameters.amplitudePtr = atof(optarg);
+        break;
+      } // case
+
+      case 'v':
+      {
+        *parameters.noiseVariancePtr = atof(optarg);
+        break;
+      } // case
+
+      case 'h':
+      {
+        // Display usage.
+        fprintf(stderr,"./driftBenchmark -o filterOrder -d delay -b beta"
+                " -r sampleRate -t duration -i interval\n"
+                "                 -a amplitude -v noiseVariance\n");
+
+        // Indicate that program must be exited.
+        exitProgram = true;
+        break;
+      } // case
+
+      case -1:
+      {
+        // All options consumed, so bail out.
+        done = true;
+      } // case
+    } // switch
+
+  } // while
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  return (exitProgram);
+
+} // getUserArguments
+
+/*****************************************************************************
+
+  Name: gauss
+
+  Purpose: The purpose of this function is to generate a random number
+  that is weighted by a Gaussian density function.
+
+  Calling Sequence: value = gauss(sigma)
+
+  Inputs:
+
+    sigma - The standard deviation of the random process.
+
+  Outputs:
+
+    value - The generated random number.
+
+*****************************************************************************/
+float gauss(float sigma)
+{
+  float x, b, r, value;
+
+  // Get first random variable.
+  x = (float)rand();
+
+  // Scale the random variable.
+  x = x / RAND_MAX;
+
+  // Get second random variable.
+  b = (float)rand();
+
+  // Scale the random variable.
+  b = b / RAND_MAX;
+
+  // Generate the angle.
+  b = 2.0 * b * M_PI;
+
+  // Compute the magnitude.
+  r = sqrt(2.0 * sigma * sigma * log(1.0 / (1.0 - x)));
+
+  // Compute the real part of the random variable.
+  value = r * cos(b);
+
+  return (value);
+
+} // gauss
+
+/*****************************************************************************
+
+  Name: runReference
+
+  Purpose: The purpose of this function is to run the double precision
+  reference canceller over one block of data.  The algorithm is the
+  same as that of NlmsNoiseCanceller::filterData().
+
+  Calling Sequence: runReference(referencePtr,inputPtr,n,outputPtr)
+
+  Inputs:
+
+    referencePtr - A pointer to the reference canceller.
+
+    inputPtr - A pointer to the input samples.
+
+    n - The number of samples to process.
+
+    outputPtr - A pointer to storage for the output samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void runReference(struct ReferenceCanceller *referencePtr,
+                         float *inputPtr,
+                         int n,
+                         double *outputPtr)
+{
+  int i, k;
+  int length;
+  double x, d, dHat, e, den, step;
+  double *w;
+  double *state;
+
+  length = referencePtr->filterLength;
+  w = referencePtr->coefficientsPtr;
+  state = referencePtr->filterStatePtr;
+
+  for (i = 0; i < n; i++)
+  {
+    x = inputPtr[i];
+
+    // Shift the sample into the pipeline.
+    for (k = length - 1; k > 0; k--)
+    {
+      state[k] = state[k-1];
+    } // for
+    state[0] = x;
+
+    // Form the reference, d(n) = x(n - delay).
+    referencePtr->historyPtr[referencePtr->historyIndex] = x;
+    referencePtr->historyIndex =
+      (referencePtr->historyIndex + 1) % (referencePtr->referenceDelay + 1);
+    d = referencePtr->historyPtr[referencePtr->historyIndex];
+
+    dHat = 0;
+    den = 0;
+
+    for (k = 0; k < length; k++)
+    {
+      dHat += w[k] * state[k];
+      den += state[k] * state[k];
+    } // for
+
+    den += 0.0001;
+    e = d - dHat;
+    step = (referencePtr->beta / den) * e;
+
+    for (k = 0; k < length; k++)
+    {
+      w[k] += step * state[k];
+    } // for
+
+    outputPtr[i] = dHat;
+  } // for
+
+  return;
+
+} // runReference
+
+/*****************************************************************************
+
+  Name: toDecibels
+
+  Purpose: The purpose of this function is to compute a power ratio in
+  decibels.
+
+  Calling Sequence: ratio = toDecibels(numerator,denominator)
+
+  Inputs:
+
+    numerator - The power of the error.
+
+    denominator - The power of the signal.
+
+  Outputs:
+
+    ratio - The ratio in dB.  An exact match is reported as -999 dB.
+
+*****************************************************************************/
+static double toDecibels(double numerator,double denominator)
+{
+  double ratio;
+
+  if (numerator <= 0)
+  {
+    ratio = -999;
+  } // if
+  else
+  {
+    ratio = 10 * log10(numerator / (denominator + 1e-30));
+  } // else
+
+  return (ratio);
+
+} // toDecibels
+
+//*************************************************************************
+// Mainline code.
+//*************************************************************************
+int main(int argc,char **argv)
+{
+  int i, k, m;
+  bool exitProgram;
+  int filterOrder;
+  int delay;
+  float beta;
+  float sampleRate;
+  float duration;
+  float interval;
+  float amplitude;
+  float noiseVariance;
+  float iValue, qValue;
+  long numberOfBlocks;
+  long blocksPerInterval;
+  long block;
+  double difference;
+  double referencePower;
+  double coefficientNorm;
+  double coefficientError;
+  double outputError[NUMBER_OF_MODES];
+  double elapsed[NUMBER_OF_MODES];
+  float inputBuffer[BLOCK_SIZE];
+  float outputBuffer[BLOCK_SIZE];
+  double referenceOutput[BLOCK_SIZE];
+  float *coefficientsPtr;
+  struct timespec startTime, endTime;
+  struct ReferenceCanceller reference;
+  NlmsNoiseCanceller *cancellerPtrs[NUMBER_OF_MODES];
+  Nco *myNcoPtr;
+  struct MyParameters parameters;
+
+  // Set up for parameter transmission.
+  parameters.filterOrderPtr = &filterOrder;
+  parameters.delayPtr = &delay;
+  parameters.betaPtr = &beta;
+  parameters.sampleRatePtr = &sampleRate;
+  parameters.durationPtr = &duration;
+  parameters.intervalPtr = &interval;
+  parameters.amplitudePtr = &amplitude;
+  parameters.noiseVariancePtr = &noiseVariance;
+
+  // Retrieve the system parameters.
+  exitProgram = getUserArguments(argc,argv,parameters);
+
+  if (exitProgram)
+  {
+    // Bail out.
+    return (0);
+  } // if
+
+  // We derive these.
+  numberOfBlocks = (long)((sampleRate * duration) / BLOCK_SIZE);
+  blocksPerInterval = (long)((sampleRate * interval) / BLOCK_SIZE);
+
+  if (blocksPerInterval < 1)
+  {
+    blocksPerInterval = 1;
+  } // if
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Set up the system.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  myNcoPtr = new Nco(sampleRate,440);
+
+  for (m = 0; m < NUMBER_OF_MODES; m++)
+  {
+    cancellerPtrs[m] = new NlmsNoiseCanceller(filterOrder,delay,beta);
+    cancellerPtrs[m]->setAccumulationMode(modes[m]);
+    elapsed[m] = 0;
+  } // for
+
+  reference.filterLength = filterOrder;
+  reference.referenceDelay = delay;
+  reference.beta = beta;
+  reference.coefficientsPtr = new double[filterOrder];
+  reference.filterStatePtr = new double[filterOrder];
+  reference.historyPtr = new double[delay + 1];
+  reference.historyIndex = 0;
+
+  for (k = 0; k < filterOrder; k++)
+  {
+    reference.coefficientsPtr[k] = 0;
+    reference.filterStatePtr[k] = 0;
+  } // for
+
+  for (k = 0; k <= delay; k++)
+  {
+    reference.historyPtr[k] = 0;
+  } // for
+
+  coefficientsPtr = new float[filterOrder];
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  printf("order %d, delay %d, beta %g, %.0f seconds at %.0f S/s\n\n",
+         filterOrder,delay,beta,duration,sampleRate);
+
+  printf("%8s","time(s)");
+  for (m = 0; m < NUMBER_OF_MODES; m++)
+  {
+    printf("  %8s outErr/coefErr(dB)",modeNames[m]);
+  } // for
+  printf("\n");
+
+  referencePower = 0;
+
+  for (m = 0; m < NUMBER_OF_MODES; m++)
+  {
+    outputError[m] = 0;
+  } // for
+
+  for (block = 1; block <= numberOfBlocks; block++)
+  {
+    // Generate the next block of the noisy tone.
+    for (i = 0; i < BLOCK_SIZE; i++)
+    {
+      myNcoPtr->run(&iValue,&qValue);
+      inputBuffer[i] = (amplitude * iValue) + gauss(noiseVariance);
+    } // for
+
+    runReference(&reference,inputBuffer,BLOCK_SIZE,referenceOutput);
+
+    for (i = 0; i < BLOCK_SIZE; i++)
+    {
+      referencePower += referenceOutput[i] * referenceOutput[i];
+    } // for
+
+    for (m = 0; m < NUMBER_OF_MODES; m++)
+    {
+      clock_gettime(CLOCK_MONOTONIC,&startTime);
+      cancellerPtrs[m]->acceptData(inputBuffer,BLOCK_SIZE,outputBuffer);
+      clock_gettime(CLOCK_MONOTONIC,&endTime);
+
+      elapsed[m] += (endTime.tv_sec - startTime.tv_sec) +
+                    ((endTime.tv_nsec - startTime.tv_nsec) / 1e9);
+
+      for (i = 0; i < BLOCK_SIZE; i++)
+      {
+        difference = outputBuffer[i] - referenceOutput[i];
+        outputError[m] += difference * difference;
+      } // for
+    } // for
+
+    if ((block % blocksPerInterval) == 0)
+    {
+      printf("%8.0f",(block * BLOCK_SIZE) / sampleRate);
+
+      coefficientNorm = 0;
+      for (k = 0; k < filterOrder; k++)
+      {
+        coefficientNorm +=
+          reference.coefficientsPtr[k] * reference.coefficientsPtr[k];
+      } // for
+
+      for (m = 0; m < NUMBER_OF_MODES; m++)
+      {
+        cancellerPtrs[m]->getCoefficients(coefficientsPtr);
+
+        coefficientError = 0;
+        for (k = 0; k < filterOrder; k++)
+        {
+          difference = coefficientsPtr[k] - reference.coefficientsPtr[k];
+          coefficientError += difference * difference;
+        } // for
+
+        printf("  %13.1f / %13.1f",
+               toDecibels(outputError[m],referencePower),
+               toDecibels(coefficientError,coefficientNorm));
+
+        outputError[m] = 0;
+      } // for
+
+      printf("\n");
+      fflush(stdout);
+
+      referencePower = 0;
+    } // if
+  } // for
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Display the throughput.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  printf("\n%10s %14s %10s\n","mode","samples/s","cost");
+
+  for (m = 0; m < NUMBER_OF_MODES; m++)
+  {
+    printf("%10s %14.0f %9.2fx\n",
+           modeNames[m],
+           (numberOfBlocks * BLOCK_SIZE) / (elapsed[m] + 1e-12),
+           elapsed[m] / (elapsed[0] + 1e-12));
+  } // for
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Release resources.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  for (m = 0; m < NUMBER_OF_MODES; m++)
+  {
+    delete cancellerPtrs[m];
+  } // for
+
+  delete myNcoPtr;
+  delete[] reference.coefficientsPtr;
+  delete[] reference.filterStatePtr;
+  delete[] reference.historyPtr;
+  delete[] coefficientsPtr;
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  return (0);
+
+} // main
@@ -0,0 +1,391 @@
+//*************************************************************************
+// File name: freezeBenchmark.cc
+//*************************************************************************
+
+//*************************************************************************
+// This program compares a canceller that always adapts with one whose
+// coefficients are frozen automatically once its error power is stable.
+// Both are driven with a tone in white noise.  Halfway through the run,
+// the frequency of the tone changes, so the frozen canceller has to
+// detect the change and resume adaptation.  The error of each output
+// relative to the clean tone (delayed by the reference delay) in dB,
+// the number of times that the second canceller resumed adaptation, and
+// its state are displayed at regular intervals, followed by the
+// processing time per sample of each canceller, and of the second
+// canceller while it is frozen.
+//
+// To run this program type,
+//
+//     ./freezeBenchmark -o filterOrder -d delay -b beta -t tolerance
+//                       -n numberOfSamples -i reportInterval,
+//
+// where,
+//
+//    filterOrder - The order of the adaptive filter.
+//    delay - The delay that is used to generate the reference signal.
+//    beta - The convergence factor.
+//    tolerance - The relative change of the error power between windows
+//    that is still considered stable.
+//    numberOfSamples - The number of samples to process.
+//    reportInterval - The number of samples between reports.
+//*************************************************************************
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+
+#include "NlmsNoiseCanceller.h"
+
+// This structure is used to consolidate user parameters.
+struct MyParameters
+{
+  int *filterOrderPtr;
+  int *delayPtr;
+  float *betaPtr;
+  float *tolerancePtr;
+  int *numberOfSamplesPtr;
+  int *reportIntervalPtr;
+};
+
+// The number of cancellers that are compared.
+#define NUMBER_OF_CONFIGURATIONS (2)
+
+// The number of samples per call to acceptData().
+#define BLOCK_SIZE (1000)
+
+// The frequencies of the tone, in cycles per sample, before and after
+// the change.
+#define FIRST_FREQUENCY (0.05)
+#define SECOND_FREQUENCY (0.11)
+
+static const char *configurationNames[NUMBER_OF_CONFIGURATIONS] =
+{
+  "adaptive",
+  "freeze"
+};
+
+/*****************************************************************************
+
+  Name: getUserArguments
+
+  Purpose: The purpose of this function is to retrieve the user arguments
+  that were passed to the program.  Any arguments that are specified are
+  set to reasonable default values.
+
+  Calling Sequence: exitProgram = getUserArguments(parameters)
+
+  Inputs:
+
+    parameters - A structure that contains pointers to the user parameters.
+
+  Outputs:
+
+    exitProgram - A flag that indicates whether or not the program should
+    be exited.  A value of true indicates to exit the program, and a value
+    of false indicates that the program should not be exited..
+
+*****************************************************************************/
+bool getUserArguments(int argc,char **argv,struct MyParameters parameters)
+{
+  bool exitProgram;
+  bool done;
+  int opt;
+
+  // Default not to exit program.
+  exitProgram = false;
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Default parameters.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Default a 32nd order filter.
+  *parameters.filterOrderPtr = 32;
+
+  // Default to a delay that is just past the end of the filter.
+  *parameters.delayPtr = 32;
+
+  // Default to a convergence rate of something reasonable.
+  *parameters.betaPtr = 0.01;
+
+  // Default to a 10 percent change between windows.
+  *parameters.tolerancePtr = 0.1;
+
+  // Default to 50 seconds at 8000S/s.
+  *parameters.numberOfSamplesPtr = 400000;
+
+  // Default to reporting every 2.5 seconds.
+  *parameters.reportIntervalPtr = 20000;
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  // Set up for loop entry.
+  done = false;
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Retrieve the command line arguments.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  while (!done)
+  {
+    // Retrieve the next option.
+    opt = getopt(argc,argv,"o:d:b:t:n:i:h");
+
+    switch (opt)
+    {
+      case 'o':
+      {
+        *parameters.filterOrderPtr = atoi(optarg);
+        break;
+      } // case
+
+      case 'd':
+      {
+        *parameters.delayPtr = atoi(optarg);
+        break;
+      } // case
+
+      case 'b':
+      {
+        *parameters.betaPtr = atof(optarg);
+        break;
+      } // case
+
+      case 't':
+      {
+        *parameters.tolerancePtr = atof(optarg);
+        break;
+      } // case
+
+      case 'n':
+      {
+        *parameters.numberOfSamplesPtr = atoi(optarg);
+        break;
+      } // case
+
+      case 'i':
+      {
+        *parameters.reportIntervalPtr = atoi(optarg);
+        break;
+      } // case
+
+      case 'h':
+      {
+        // Display usage.
+        fprintf(stderr,"./freezeBenchmark -o filterOrder -d delay -b beta"
+                " -t tolerance\n"
+                "                  -n numberOfSamples -i reportInterval\n");
+
+        // Indicate that program must be exited.
+        exitProgram = true;
+        break;
+      } // case
+
+      case -1:
+      {
+        // All options consumed, so bail out.
+        done = true;
+      } // case
+    } // switch
+
+  } // while
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  if (*parameters.reportIntervalPtr < BLOCK_SIZE)
+  {
+    *parameters.reportIntervalPtr = BLOCK_SIZE;
+  } // if
+
+  return (exitProgram);
+
+} // getUserArguments
+
+//*************************************************************************
+// Mainline code.
+//*************************************************************************
+int main(int argc,char **argv)
+{
+  int i, j;
+  int c;
+  bool exitProgram;
+  bool frozen;
+  int filterOrder;
+  int delay;
+  float beta;
+  float tolerance;
+  int numberOfSamples;
+  int reportInterval;
+  int count;
+  int frozenSamples;
+  int resumes;
+  double frequency;
+  double difference;
+  float *signalPtr;
+  float *tonePtr;
+  float *outputPtr;
+  double errorEnergy[NUMBER_OF_CONFIGURATIONS];
+  double elapsedTime[NUMBER_OF_CONFIGURATIONS];
+  double blockTime;
+  double frozenTime;
+  struct timespec startTime, endTime;
+  NlmsNoiseCanceller *cancellerPtrs[NUMBER_OF_CONFIGURATIONS];
+  struct MyParameters parameters;
+
+  // Set up for parameter transmission.
+  parameters.filterOrderPtr = &filterOrder;
+  parameters.delayPtr = &delay;
+  parameters.betaPtr = &beta;
+  parameters.tolerancePtr = &tolerance;
+  parameters.numberOfSamplesPtr = &numberOfSamples;
+  parameters.reportIntervalPtr = &reportInterval;
+
+  // Retrieve the system parameters.
+  exitProgram = getUserArguments(argc,argv,parameters);
+
+  if (exitProgram)
+  {
+    // Bail out.
+    return (0);
+  } // if
+
+  signalPtr = new float[numberOfSamples];
+  tonePtr = new float[numberOfSamples];
+  outputPtr = new float[BLOCK_SIZE];
+
+  // Generate a tone with a peak of 0.5 in white noise with a peak of
+  // 0.5.  The frequency changes halfway through.
+  srand(1);
+
+  for (i = 0; i < numberOfSamples; i++)
+  {
+    frequency = FIRST_FREQUENCY;
+
+    if (i >= (numberOfSamples / 2))
+    {
+      frequency = SECOND_FREQUENCY;
+    } // if
+
+    tonePtr[i] = 0.5 * cos(2 * M_PI * frequency * i);
+    signalPtr[i] = tonePtr[i] + ((float)rand() / RAND_MAX) - 0.5f;
+  } // for
+
+  for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+  {
+    cancellerPtrs[c] = new NlmsNoiseCanceller(filterOrder,delay,beta);
+    errorEnergy[c] = 0;
+    elapsedTime[c] = 0;
+  } // for
+
+  cancellerPtrs[1]->setAutomaticFreeze(true,tolerance);
+
+  frozenTime = 0;
+  frozenSamples = 0;
+  resumes = 0;
+
+  printf("order %d, delay %d, beta %g, tolerance %g\n\n",
+         filterOrder,delay,beta,tolerance);
+
+  printf("%10s","samples");
+  for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+  {
+    printf(" %10s(dB)",configurationNames[c]);
+  } // for
+  printf(" %8s %8s\n","resumes","state");
+
+  for (i = 0; i < numberOfSamples; i += count)
+  {
+    count = BLOCK_SIZE;
+    if ((i + count) > numberOfSamples)
+    {
+      count = numberOfSamples - i;
+    } // if
+
+    for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+    {
+      frozen = cancellerPtrs[c]->isFrozen();
+
+      clock_gettime(CLOCK_MONOTONIC,&startTime);
+      cancellerPtrs[c]->acceptData(&signalPtr[i],count,outputPtr);
+      clock_gettime(CLOCK_MONOTONIC,&endTime);
+
+      blockTime = (endTime.tv_sec - startTime.tv_sec) +
+                  ((endTime.tv_nsec - startTime.tv_nsec) / 1e9);
+
+      elapsedTime[c] += blockTime;
+
+      // Only count blocks that were frozen from start to end.
+      if (frozen && cancellerPtrs[c]->isFrozen())
+      {
+        frozenTime += blockTime;
+        frozenSamples += count;
+      } // if
+
+      if (frozen && !cancellerPtrs[c]->isFrozen())
+      {
+        resumes++;
+      } // if
+
+      // The output is an estimate of the delayed tone.
+      for (j = 0; j < count; j++)
+      {
+        difference = outputPtr[j];
+
+        if ((i + j) >= delay)
+        {
+          difference -= tonePtr[i + j - delay];
+        } // if
+
+        errorEnergy[c] += difference * difference;
+      } // for
+    } // for
+
+    if ((((i + count) % reportInterval) == 0) ||
+        ((i + count) == numberOfSamples))
+    {
+      printf("%10d",i + count);
+
+      for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+      {
+        // Display the error relative to the power of the tone.
+        printf(" %14.1f",
+               10 * log10((errorEnergy[c] / reportInterval) / 0.125 + 1e-30));
+        errorEnergy[c] = 0;
+      } // for
+
+      printf(" %8d %8s\n",
+             resumes,
+             cancellerPtrs[1]->isFrozen() ? "frozen" : "adapting");
+      resumes = 0;
+    } // if
+  } // for
+
+  printf("\n%10s %14s %10s\n","canceller","ns/sample","cost");
+
+  for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+  {
+    printf("%10s %14.1f %9.2fx\n",
+           configurationNames[c],
+           (elapsedTime[c] * 1e9) / numberOfSamples,
+           elapsedTime[c] / elapsedTime[0]);
+  } // for
+
+  if (frozenSamples > 0)
+  {
+    printf("%10s %14.1f %9.2fx\n",
+           "frozen",
+           (frozenTime * 1e9) / frozenSamples,
+           (frozenTime / frozenSamples) / (elapsedTime[0] / numberOfSamples));
+  } // if
+
+  // Release resources.
+  for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+  {
+    delete cancellerPtrs[c];
+  } // for
+
+  delete[] signalPtr;
+  delete[] tonePtr;
+  delete[] outputPtr;
+
+  return (0);
+
+} // main
@@ -5,25 +5,209 @@
 //*************************************************************************
 // This program tests both the NLMS noise canceller.  A noisy signal is
 // read from stdin, and the reduced-noise signal is written to stdout.
+// WAV and RF64 input is recognized by its header, and the output is
+// written in the same container and sample format as the input.
+// Anything else is treated as raw samples of the format given by -f.
+//
+// Multi-channel input is supported.  Each channel is processed by its
+// own canceller, and the channels are processed in parallel when more
+// than one thread is requested.  Interleaved blocks are transposed into
+// per-channel buffers before processing and transposed back afterward.
+//
+// In I/Q mode, the input is treated as a complex baseband signal whose
+// I and Q components are interleaved (cs16 or cf32), and a complex
+// canceller is used.
+//
+// For long filters on sparse noise paths, the proportionate (IPNLMS)
+// update can be selected, optionally with an active-tap mask that skips
+// most of the updates of taps that have converged to zero.  A variable
+// step-size policy can also be selected, in which case the convergence
+// factor given by -b is the largest step size.
+//
+// For oversampled input, the cancellers can run at a reduced sample
+// rate.  Each channel is decimated, processed, and interpolated back,
+// and the filter order and the delay are scaled down by the decimation
+// factor.
+//
+// For live monitoring, a low-latency mode reads and writes small blocks
+// through unbuffered streams, so that each block leaves the program as
+// soon as it has been processed.  The processing time of every block
+// can be recorded, and a histogram of the times is displayed at the end
+// along with the real-time deadline of a block.  Hardware events, such
+// as cycles, cache misses, and branch misses, can also be counted over
+// the processing of every block and reported per sample.
+//
+// Once a channel has converged on stationary noise, its coefficients
+// can be frozen automatically, which removes the cost of the coefficient
+// update until the noise changes.
+//
+// For throughput, the input can be read ahead and the output written
+// behind on a ring of buffers, so that processing overlaps the I/O.
+// io_uring is used when the kernel provides it, and a pair of I/O
+// threads otherwise.
+//
+// When a second sensor picks up the noise without the signal, the
+// canceller can run in dual-input mode.  The noise of the second sensor
+// is the reference, the delayed input is not used, and the output is the
+// signal of the first sensor with the noise removed.  The reference is
+// either read from a second file, or it is the second channel of stereo
+// input, in which case the output has one channel.
+//
+// To remove noise of several kinds, each channel can run a cascade of
+// cancellers with their own orders, delays, and convergence factors,
+// which replaces a pipe of noiseCanceller processes.  The stages of a
+// cascade can be pipelined across threads.
+//
+// A long run can be checkpointed.  Every so often, once a block has been
+// written, the number of frames consumed, the amount of output, and the
+// state of every canceller (its taps, its delay line, and the state of
+// its update policies) are saved to a file.  A run that is stopped can
+// then be resumed from the last checkpoint: the output is cut back to
+// the checkpoint, the input that was consumed is skipped, and the
+// output that follows is exactly what the uninterrupted run produces.
+//
+// A long recording can also be divided into segments that are processed
+// in parallel on all of the processors.  The canceller of each segment
+// adapts over an overlap that precedes the segment before its output is
+// kept, so the output is close to, but not exactly, that of a serial
+// run.  A report that compares the two can be displayed.
 //
 // To run this program type,
 // 
-//     ./noiseCanceller -o filterOrder -d delay -b beta < inputFileName
-//                      > outputFileName,
+//     ./noiseCanceller -o filterOrder -d delay -b beta -f format
+//                      -c channels -t threads -q -z -n ditherLevel
+//                      -p alpha -a activeTapThreshold -V betaMin
+//                      -D decimationFactor -B blockSize -l -H
+//                      -S sampleRate -F freezeTolerance
+//                      -A queueDepth -U -R referenceFileName -P
+//                      -C stages -T stageThreads -k checkpointFileName
+//                      -K checkpointInterval -r -s segments -w overlap -Q
+//                      < inputFileName > outputFileName,
 //
 // where,
 //
 //    filterOrder - The order of the adaptive filter used for noise reduction.
+//    It must be at least 1.
 //    delay - The delay that is used to generate the reference signal.
+//    It must not be negative.
+//    format - The format of raw input: s16 (signed 16-bit little endian,
+//    the default), s32 (signed 32-bit little endian), or f32 (32-bit
+//    float, where 1.0 is full scale).
+//    channels - The number of interleaved channels of raw input.  It
+//    must be at least 1.  The number of channels of WAV input is taken
+//    from its header.
+//    threads - The number of threads that process channels.  It must be
+//    at least 1.
+//    -q - Process the input as interleaved I/Q samples.
+//    -z - Flush subnormal values to zero (FTZ/DAZ) while processing.
+//    ditherLevel - The peak amplitude, in 16-bit units, of a tiny noise
+//    that is added to the input to keep the filter state away from
+//    subnormal values.  The default is 0 (no dither).
+//    alpha - Use the IPNLMS update with this mixing parameter in the
+//    range of [-1,1).  A value of -1 is equivalent to NLMS, and 0 is a
+//    good starting point.
+//    activeTapThreshold - With -p, update segments of 16 taps whose
+//    largest tap is below this fraction of the largest tap of the
+//    filter only every few samples.  The default is 0 (all taps are
+//    always updated).
+//    betaMin - Use the variable step-size policy, and let the step size
+//    range from this value up to beta.
+//    decimationFactor - Run the cancellers at the input sample rate
+//    divided by this factor.  The filter order and the delay are given
+//    at the input rate, and they are divided by this factor.  It must
+//    be at least 1.  The default is 1.
+//    blockSize - The number of frames that are read, processed, and
+//    written at a time.  It must be at least 1.  The default is 4000, or
+//    16 with -l.
+//    -l - Low-latency mode.  The input and output streams are
+//    unbuffered, and the block size is limited to 64 frames.
+//    -H - Display the percentiles of the processing time per block on
+//    stderr when the input is exhausted.
+//    sampleRate - The sample rate of raw input, which is used to compute
+//    the deadline of a block for -H.  WAV files specify their own.
+//    freezeTolerance - Freeze the coefficients of a channel once its
+//    error power changes by no more than this fraction (for example,
+//    0.05) over several successive windows, and resume adaptation if
+//    the error power rises.  A frozen channel runs as a plain FIR
+//    filter.  The default is to always adapt.
+//    queueDepth - Read and write asynchronously with this many buffers
+//    of one block each in flight per direction (1 to 32).  Without -A,
+//    the stdio streams are used.  This is ignored with -l.
+//    -U - With -A, use the I/O threads even if io_uring is available.
+//    referenceFileName - Run in dual-input mode, and read the reference
+//    from this file, which has one channel and the same format as the
+//    input.  The input then has one channel, the primary.  If this is
+//    -, the input has two channels: the primary in the first and the
+//    reference in the second.  The delay is not used in this mode.
+//    -P - Count cycles, instructions, L1 data cache misses, last level
+//    cache misses, and branch misses over the processing of each block,
+//    and display the totals and the counts per sample on stderr when the
+//    input is exhausted.  Only the main thread is counted, so this is
+//    most useful with one thread.  Events that the system doesn't
+//    provide are reported as such.
+//    stages - Run a cascade of cancellers on each channel, where the
+//    output of each stage is the input of the next.  The stages are
+//    separated by commas, and each one is given as
+//    filterOrder[:delay[:beta]] (for example, 8:8,32:1:0.05).  Values
+//    that are left out (as in :1) are taken from -o, -d, and -b.  Up to
+//    16 stages may be given.  This can't be used with -q, -D, or -R.
+//    stageThreads - With -C, pipeline the stages of each cascade across
+//    this many threads.  The output doesn't depend on the number of
+//    threads.  It must be at least 1.  The default is 1.
+//    checkpointFileName - Save a checkpoint to this file every
+//    checkpointInterval frames.  The file is replaced atomically, so it
+//    always holds a complete checkpoint.  This can't be used with -q or
+//    -D, or with WAV input.
+//    checkpointInterval - The number of frames between checkpoints.  A
+//    checkpoint is taken at the end of the first block that reaches the
+//    interval.  The default is 480000 (one minute at 8000S/s).
+//    -r - Resume from the checkpoint in checkpointFileName.  The input is
+//    the same as that of the interrupted run, and the output is its
+//    output file opened without truncation, as in 1<>outputFileName or
+//    >>outputFileName.  The output is cut back to the checkpoint, and
+//    the run continues from there.  If the output is a pipe, only the
+//    output that follows the checkpoint is written.  The other
+//    parameters, including the block size, must be the same as those of
+//    the interrupted run.
+//    segments - Read the whole input, divide it into this many segments
+//    of about equal length, and process the segments in parallel with
+//    one thread per processor.  There are never so many segments that
+//    one is shorter than the overlap.  The channels are processed one after
+//    another.  This can't be used with -q, -D, -R, -C, -k, -l, -H, or
+//    -P.  The default is 0, which processes the input as a stream.
+//    overlap - With -s, the number of frames before each segment that
+//    its canceller adapts over before its output is kept.  It must not
+//    be negative.  The default is 16000.
+//    -Q - With -s, also process the input serially, and display on
+//    stderr how far the output of each segment is from the serial
+//    output: the largest difference and the signal to difference ratio
+//    (in 16-bit units and dB), and the number of frames after the start
+//    of the segment until the difference stays within 1.  The times of
+//    both runs are displayed as well.
 //*************************************************************************
 
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/stat.h>
 
 #include "NlmsNoiseCanceller.h"
+#include "MemoryArena.h"
+#include "MultirateNoiseCanceller.h"
+#include "ComplexNlmsNoiseCanceller.h"
+#include "CascadedNoiseCanceller.h"
+#include "SegmentedNoiseCanceller.h"
+#include "DenormalGuard.h"
+#include "LatencyHistogram.h"
+#include "PerformanceCounters.h"
+#include "SampleReader.h"
+#include "SampleWriter.h"
+#include "AsyncBlockIo.h"
 
 // This structure is used to consolidate user parameters.
 struct MyParameters
@@ -31,10 +215,114 @@ struct MyParameters
   int *filterOrderPtr;
   int *delayPtr;
   float *betaPtr;
+  SampleFormat *rawFormatPtr;
+  int *numberOfChannelsPtr;
+  int *numberOfThreadsPtr;
+  bool *iqModePtr;
+  bool *denormalProtectionPtr;
+  float *ditherLevelPtr;
+  bool *proportionateUpdatePtr;
+  float *alphaPtr;
+  float *activeTapThresholdPtr;
+  bool *variableStepSizePtr;
+  float *betaMinPtr;
+  int *decimationFactorPtr;
+  int *blockSizePtr;
+  bool *lowLatencyPtr;
+  bool *latencyHistogramPtr;
+  uint32_t *sampleRatePtr;
+  bool *automaticFreezePtr;
+  float *freezeTolerancePtr;
+  int *queueDepthPtr;
+  bool *forceThreadsPtr;
+  char **referenceFileNamePtr;
+  bool *performanceCountersPtr;
+  char **cascadeSpecificationPtr;
+  int *stageThreadsPtr;
+  char **checkpointFileNamePtr;
+  uint64_t *checkpointIntervalPtr;
+  bool *resumePtr;
+  int *numberOfSegmentsPtr;
+  int *overlapPtr;
+  bool *qualityReportPtr;
+  bool *argumentErrorPtr;
+};
+
+// This structure is shared by the threads that process channels.
+struct ChannelContext
+{
+  // The number of channels and the number of threads.
+  int numberOfChannels;
+  int numberOfThreads;
+
+  // One canceller per channel.
+  NlmsNoiseCanceller **cancellerPtrs;
+
+  // One reduced rate stage per channel.  This is NULL when the
+  // cancellers run at the input rate; otherwise, each of the cancellers
+  // above belongs to one of these stages.
+  MultirateNoiseCanceller **multirateCancellerPtrs;
+
+  // One cascade per channel.  This is NULL when each channel has a
+  // single canceller; otherwise, the canceller of each channel above is
+  // the first stage of its cascade.
+  CascadedNoiseCanceller **cascadePtrs;
+
+  // Per-channel input and output buffers.
+  float **channelInputPtrs;
+  float **channelOutputPtrs;
+
+  // The number of frames in the current block.
+  uint32_t count;
+
+  // This tells the workers to exit.
+  bool done;
+
+  // These synchronize the start and the end of each block.
+  pthread_barrier_t startBarrier;
+  pthread_barrier_t doneBarrier;
+};
+
+// This structure is passed to each worker thread.
+struct WorkerArguments
+{
+  struct ChannelContext *contextPtr;
+  int threadIndex;
 };
 
-int16_t inputBuffer[16384];
-int16_t outputBuffer[16384];
+// The default number of frames that are processed at a time.
+#define BLOCK_SIZE (4000)
+
+// The default and the largest number of frames per block in low-latency
+// mode.  At 8000S/s, 16 frames is 2ms.
+#define LOW_LATENCY_BLOCK_SIZE (16)
+#define MAX_LOW_LATENCY_BLOCK_SIZE (64)
+
+// The smallest asynchronous I/O buffer in bytes.
+#define MIN_IO_BLOCK_SIZE (4096)
+
+// The largest number of stages of a cascade.
+#define MAX_CASCADE_STAGES (16)
+
+// The default number of frames between checkpoints.  At 8000S/s, this
+// is one minute.
+#define CHECKPOINT_INTERVAL (480000)
+
+// This identifies a checkpoint file and the version of its layout.
+#define CHECKPOINT_MAGIC "NCCHECK1"
+
+// The default number of frames that the canceller of a segment adapts
+// over before its output is kept.  At 8000S/s, this is 2 seconds.
+#define SEGMENT_OVERLAP (16000)
+
+// The number of frames that the buffer of the whole input starts out
+// with.  The buffer doubles as needed.
+#define INPUT_CAPACITY (1048576)
+
+// Samples are presented to the canceller with 16-bit full scale values
+// so that raw 16-bit input is processed exactly as it always has been.
+#define FULL_SCALE (32768.0f)
+
 
 /*****************************************************************************
 
@@ -54,7 +342,9 @@ int16_t outputBuffer[16384];
 
     exitProgram - A flag that indicates whether or not the program should
     be exited.  A value of true indicates to exit the program, and a value
-    of false indicates that the program should not be exited..
+    of false indicates that the program should not be exited..  When
+    the program is exited because an argument is invalid, the flag that
+    parameters.argumentErrorPtr points to is set to true.
 
 *****************************************************************************/
 bool getUserArguments(int argc,char **argv,struct MyParameters parameters)
@@ -77,6 +367,75 @@ bool getUserArguments(int argc,char **argv,struct MyParameters parameters)
 
   // Default to a convergence rate of something reasonable.
   *parameters.betaPtr = 0.1;
+
+  // Default to signed 16-bit raw samples.
+  *parameters.rawFormatPtr = SAMPLE_FORMAT_S16;
+
+  // Default to a single channel.
+  *parameters.numberOfChannelsPtr = 1;
+
+  // Default to a single thread.
+  *parameters.numberOfThreadsPtr = 1;
+
+  // Default to real samples.
+  *parameters.iqModePtr = false;
+
+  // Default to leaving subnormal handling alone.
+  *parameters.denormalProtectionPtr = false;
+  *parameters.ditherLevelPtr = 0;
+
+  // Default to the NLMS update.
+  *parameters.proportionateUpdatePtr = false;
+  *parameters.alphaPtr = 0;
+  *parameters.activeTapThresholdPtr = 0;
+
+  // Default to a fixed step size.
+  *parameters.variableStepSizePtr = false;
+  *parameters.betaMinPtr = 0;
+
+  // Default to running at the input sample rate.
+  *parameters.decimationFactorPtr = 1;
+
+  // Default to a block size that suits the mode (see below).
+  *parameters.blockSizePtr = 0;
+
+  // Default to buffered streams and no timing.
+  *parameters.lowLatencyPtr = false;
+  *parameters.latencyHistogramPtr = false;
+
+  // Default to an unknown sample rate for raw input.
+  *parameters.sampleRatePtr = 0;
+
+  // Default to always adapting.
+  *parameters.automaticFreezePtr = false;
+  *parameters.freezeTolerancePtr = 0;
+
+  // Default to the stdio streams.
+  *parameters.queueDepthPtr = 0;
+  *parameters.forceThreadsPtr = false;
+
+  // Default to deriving the reference from the input.
+  *parameters.referenceFileNamePtr = NULL;
+
+  // Default to no event counting.
+  *parameters.performanceCountersPtr = false;
+
+  // Default to one canceller per channel.
+  *parameters.cascadeSpecificationPtr = NULL;
+  *parameters.stageThreadsPtr = 1;
+
+  // Default to no checkpoints.
+  *parameters.checkpointFileNamePtr = NULL;
+  *parameters.checkpointIntervalPtr = CHECKPOINT_INTERVAL;
+  *parameters.resumePtr = false;
+
+  // Default to processing the input as a stream.
+  *parameters.numberOfSegmentsPtr = 0;
+  *parameters.overlapPtr = SEGMENT_OVERLAP;
+  *parameters.qualityReportPtr = false;
+
+  // Default to arguments that are valid.
+  *parameters.argumentErrorPtr = false;
   //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
 
   // Set up for loop entry.
@@ -88,19 +447,35 @@ bool getUserArguments(int argc,char **argv,struct MyParameters parameters)
   while (!done)
   {
     // Retrieve the next option.
-    opt = getopt(argc,argv,"o:d:b:h");
+    opt = getopt(argc,
+                 argv,
+                 "o:d:b:f:c:t:qzn:p:a:V:D:B:lHS:F:A:UR:PC:T:k:K:rs:w:Qh");
 
     switch (opt)
     {
       case 'o':
       {
         *parameters.filterOrderPtr = atoi(optarg);
+
+        if (*parameters.filterOrderPtr < 1)
+        {
+          fprintf(stderr,"Invalid filter order %s.\n",optarg);
+          *parameters.argumentErrorPtr = true;
+          exitProgram = true;
+        } // if
         break;
       } // case
 
       case 'd':
       {
         *parameters.delayPtr = atoi(optarg);
+
+        if (*parameters.delayPtr < 0)
+        {
+          fprintf(stderr,"Invalid delay %s.\n",optarg);
+          *parameters.argumentErrorPtr = true;
+          exitProgram = true;
+        } // if
         break;
       } // case
 
@@ -110,10 +485,249 @@ bool getUserArguments(int argc,char **argv,struct MyParameters parameters)
         break;
       } // case
 
+      case 'f':
+      {
+        if (!SampleConverter::parseFormat(optarg,parameters.rawFormatPtr))
+        {
+          fprintf(stderr,"Unknown format %s.\n",optarg);
+          *parameters.argumentErrorPtr = true;
+          exitProgram = true;
+        } // if
+        break;
+      } // case
+
+      case 'c':
+      {
+        *parameters.numberOfChannelsPtr = atoi(optarg);
+
+        if (*parameters.numberOfChannelsPtr < 1)
+        {
+          fprintf(stderr,"Invalid number of channels %s.\n",optarg);
+          *parameters.argumentErrorPtr = true;
+          exitProgram = true;
+        } // if
+        break;
+      } // case
+
+      case 't':
+      {
+        *parameters.numberOfThreadsPtr = atoi(optarg);
+
+        if (*parameters.numberOfThreadsPtr < 1)
+        {
+          fprintf(stderr,"Invalid number of threads %s.\n",optarg);
+          *parameters.argumentErrorPtr = true;
+          exitProgram = true;
+        } // if
+        break;
+      } // case
+
+      case 'q':
+      {
+        *parameters.iqModePtr = true;
+        break;
+      } // case
+
+      case 'z':
+      {
+        *parameters.denormalProtectionPtr = true;
+        break;
+      } // case
+
+      case 'n':
+      {
+        *parameters.ditherLevelPtr = atof(optarg);
+        break;
+      } // case
+
+      case 'p':
+      {
+        *parameters.proportionateUpdatePtr = true;
+        *parameters.alphaPtr = atof(optarg);
+        break;
+      } // case
+
+      case 'a':
+      {
+        *parameters.activeTapThresholdPtr = atof(optarg);
+        break;
+      } // case
+
+      case 'V':
+      {
+        *parameters.variableStepSizePtr = true;
+        *parameters.betaMinPtr = atof(optarg);
+        break;
+      } // case
+
+      case 'D':
+      {
+        *parameters.decimationFactorPtr = atoi(optarg);
+
+        if (*parameters.decimationFactorPtr < 1)
+        {
+          fprintf(stderr,"Invalid decimation factor %s.\n",optarg);
+          *parameters.argumentErrorPtr = true;
+          exitProgram = true;
+        } // if
+        break;
+      } // case
+
+      case 'B':
+      {
+        *parameters.blockSizePtr = atoi(optarg);
+
+        if (*parameters.blockSizePtr < 1)
+        {
+          fprintf(stderr,"Invalid block size %s.\n",optarg);
+          *parameters.argumentErrorPtr = true;
+          exitProgram = true;
+        } // if
+        break;
+      } // case
+
+      case 'l':
+      {
+        *parameters.lowLatencyPtr = true;
+        break;
+      } // case
+
+      case 'H':
+      {
+        *parameters.latencyHistogramPtr = true;
+        break;
+      } // case
+
+      case 'S':
+      {
+        *parameters.sampleRatePtr = atoi(optarg);
+        break;
+      } // case
+
+      case 'F':
+      {
+        *parameters.automaticFreezePtr = true;
+        *parameters.freezeTolerancePtr = atof(optarg);
+        break;
+      } // case
+
+      case 'A':
+      {
+        *parameters.queueDepthPtr = atoi(optarg);
+
+        if ((*parameters.queueDepthPtr < 1) ||
+            (*parameters.queueDepthPtr > AsyncBlockIo::MAX_QUEUE_DEPTH))
+        {
+          fprintf(stderr,"Invalid queue depth %s.\n",optarg);
+          *parameters.argumentErrorPtr = true;
+          exitProgram = true;
+        } // if
+        break;
+      } // case
+
+      case 'U':
+      {
+        *parameters.forceThreadsPtr = true;
+        break;
+      } // case
+
+      case 'R':
+      {
+        *parameters.referenceFileNamePtr = optarg;
+        break;
+      } // case
+
+      case 'P':
+      {
+        *parameters.performanceCountersPtr = true;
+        break;
+      } // case
+
+      case 'C':
+      {
+        *parameters.cascadeSpecificationPtr = optarg;
+        break;
+      } // case
+
+      case 'T':
+      {
+        *parameters.stageThreadsPtr = atoi(optarg);
+
+        if (*parameters.stageThreadsPtr < 1)
+        {
+          fprintf(stderr,"Invalid number of stage threads %s.\n",optarg);
+          *parameters.argumentErrorPtr = true;
+          exitProgram = true;
+        } // if
+        break;
+      } // case
+
+      case 'k':
+      {
+        *parameters.checkpointFileNamePtr = optarg;
+        break;
+      } // case
+
+      case 'K':
+      {
+        *parameters.checkpointIntervalPtr = strtoull(optarg,NULL,10);
+        break;
+      } // case
+
+      case 'r':
+      {
+        *parameters.resumePtr = true;
+        break;
+      } // case
+
+      case 's':
+      {
+        *parameters.numberOfSegmentsPtr = atoi(optarg);
+
+        if (*parameters.numberOfSegmentsPtr < 0)
+        {
+          fprintf(stderr,"Invalid number of segments %s.\n",optarg);
+          *parameters.argumentErrorPtr = true;
+          exitProgram = true;
+        } // if
+        break;
+      } // case
+
+      case 'w':
+      {
+        *parameters.overlapPtr = atoi(optarg);
+
+        if (*parameters.overlapPtr < 0)
+        {
+          fprintf(stderr,"Invalid overlap %s.\n",optarg);
+          *parameters.argumentErrorPtr = true;
+          exitProgram = true;
+        } // if
+        break;
+      } // case
+
+      case 'Q':
+      {
+        *parameters.qualityReportPtr = true;
+        break;
+      } // case
+
       case 'h':
       {
         // Display usage.
-        fprintf(stderr,"./noiseCanceller -o filterOrder -d delay -b beta\n");
+        fprintf(stderr,"./noiseCanceller -o filterOrder -d delay -b beta"
+                " -f s16|s32|f32 -c channels -t threads -q\n"
+                "                 -z -n ditherLevel -p alpha"
+                " -a activeTapThreshold -V betaMin\n"
+                "                 -D decimationFactor -B blockSize -l -H"
+                " -S sampleRate\n"
+                "                 -F freezeTolerance -A queueDepth -U"
+                " -R referenceFileName -P\n"
+                "                 -C order[:delay[:beta]],..."
+                " -T stageThreads\n"
+                "                 -k checkpointFileName"
+                " -K checkpointInterval -r\n"
+                "                 -s segments -w overlap -Q\n");
 
         // Indicate that program must be exited.
         exitProgram = true;
@@ -130,69 +744,2252 @@ bool getUserArguments(int argc,char **argv,struct MyParameters parameters)
   } // while
   //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
 
+  if (*parameters.blockSizePtr <= 0)
+  {
+    if (*parameters.lowLatencyPtr)
+    {
+      *parameters.blockSizePtr = LOW_LATENCY_BLOCK_SIZE;
+    } // if
+    else
+    {
+      *parameters.blockSizePtr = BLOCK_SIZE;
+    } // else
+  } // if
+
+  // Small blocks are the point of low-latency mode.
+  if (*parameters.lowLatencyPtr &&
+      (*parameters.blockSizePtr > MAX_LOW_LATENCY_BLOCK_SIZE))
+  {
+    *parameters.blockSizePtr = MAX_LOW_LATENCY_BLOCK_SIZE;
+  } // if
+
+  // Unbuffered streams already hand off each block.
+  if (*parameters.lowLatencyPtr)
+  {
+    *parameters.queueDepthPtr = 0;
+  } // if
+
+  if (*parameters.checkpointIntervalPtr == 0)
+  {
+    *parameters.checkpointIntervalPtr = CHECKPOINT_INTERVAL;
+  } // if
+
   return (exitProgram);
 
 } // getUserArguments
 
-//*************************************************************************
-// Mainline code.
-//*************************************************************************
-int main(int argc,char **argv)
-{
-  bool exitProgram;
-  bool done;
-  uint32_t count;
-  int filterOrder;
-  int delay;
-  float beta;
-  NlmsNoiseCanceller *cancellerPtr;
-  struct MyParameters parameters;
+/*****************************************************************************
 
-  // Set up for parameter transmission.
-  parameters.filterOrderPtr = &filterOrder;
-  parameters.delayPtr = &delay;
-  parameters.betaPtr = &beta;
+  Name: parseCascadeSpecification
 
-  // Retrieve the system parameters.
-  exitProgram = getUserArguments(argc,argv,parameters);
+  Purpose: The purpose of this function is to parse the stages of a
+  cascade.  The stages are separated by commas, and each one is given
+  as filterOrder[:delay[:beta]].  Values that are left out are taken
+  from the defaults.
 
-  if (exitProgram)
-  {
-    // Bail out.
-    return (0);
-  } // if
+  Calling Sequence: valid = parseCascadeSpecification(specificationPtr,
+                                                      filterOrder,
+                                                      delay,
+                                                      beta,
+                                                      numberOfStagesPtr,
+                                                      filterOrdersPtr,
+                                                      delaysPtr,
+                                                      betasPtr)
 
-  // Instantiate a noise canceller.
-  cancellerPtr = new NlmsNoiseCanceller(filterOrder,delay,beta);
+  Inputs:
 
-  // Set up for oop entry
-  done = false;
+    specificationPtr - A pointer to the specification.
 
-  while (!done)
+    filterOrder - The default filter order.
+
+    delay - The default delay.
+
+    beta - The default convergence factor.
+
+    numberOfStagesPtr - A pointer to storage for the number of stages.
+
+    filterOrdersPtr - A pointer to storage for MAX_CASCADE_STAGES filter
+    orders.
+
+    delaysPtr - A pointer to storage for MAX_CASCADE_STAGES delays.
+
+    betasPtr - A pointer to storage for MAX_CASCADE_STAGES convergence
+    factors.
+
+  Outputs:
+
+    valid - A flag that indicates whether the specification is valid.
+
+*****************************************************************************/
+static bool parseCascadeSpecification(char *specificationPtr,
+                                      int filterOrder,
+                                      int delay,
+                                      float beta,
+                                      int *numberOfStagesPtr,
+                                      int *filterOrdersPtr,
+                                      int *delaysPtr,
+                                      float *betasPtr)
+{
+  int n;
+  char *endPtr;
+
+  n = 0;
+
+  while (true)
   {
-    // Read a block of input samples.
-    count = fread(inputBuffer,sizeof(int16_t),4000,stdin);
+    if (n == MAX_CASCADE_STAGES)
+    {
+      return (false);
+    } // if
 
-    if (count == 0)
+    filterOrdersPtr[n] = filterOrder;
+    delaysPtr[n] = delay;
+    betasPtr[n] = beta;
+
+    // The filter order, unless it is left out.
+    if ((*specificationPtr != ':') && (*specificationPtr != ','))
     {
-      // We're done.
-      done = true;
+      filterOrdersPtr[n] = strtol(specificationPtr,&endPtr,10);
+
+      if ((endPtr == specificationPtr) || (filterOrdersPtr[n] < 1))
+      {
+        return (false);
+      } // if
+
+      specificationPtr = endPtr;
     } // if
-    else
+
+    // The optional delay.
+    if (*specificationPtr == ':')
     {
-      // Remove the noise from the signal.
-     cancellerPtr->acceptData(inputBuffer,count,outputBuffer);
+      specificationPtr++;
+      delaysPtr[n] = strtol(specificationPtr,&endPtr,10);
 
-      // Output the filtered data.
-      fwrite(outputBuffer,sizeof(int16_t),count,stdout);
-    } // else
-  } // while
+      if ((endPtr == specificationPtr) || (delaysPtr[n] < 0))
+      {
+        return (false);
+      } // if
 
-  // Release resources.
-  if (cancellerPtr != NULL)
-  {
-    delete cancellerPtr;
+      specificationPtr = endPtr;
+    } // if
+
+    // The optional convergence factor.
+    if (*specificationPtr == ':')
+    {
+      specificationPtr++;
+      betasPtr[n] = strtod(specificationPtr,&endPtr);
+
+      if (endPtr == specificationPtr)
+      {
+        return (false);
+      } // if
+
+      specificationPtr = endPtr;
+    } // if
+
+    n++;
+
+    if (*specificationPtr == 0)
+    {
+      // We're done.
+      *numberOfStagesPtr = n;
+      return (true);
+    } // if
+
+    if (*specificationPtr != ',')
+    {
+      return (false);
+    } // if
+
+    specificationPtr++;
+  } // while
+
+} // parseCascadeSpecification
+
+/*****************************************************************************
+
+  Name: configureCanceller
+
+  Purpose: The purpose of this function is to set the modes that the
+  user selected on a canceller.  Every canceller of a run, whether it
+  serves a channel, a stage of a cascade, a segment, or the dual-input
+  mode, gets the same modes.
+
+  Calling Sequence: configureCanceller(cancellerPtr,parameters)
+
+  Inputs:
+
+    cancellerPtr - A pointer to the canceller.
+
+    parameters - A structure that contains pointers to the user
+    parameters.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void configureCanceller(NlmsNoiseCanceller *cancellerPtr,
+                               struct MyParameters parameters)
+{
+
+  cancellerPtr->setDenormalProtection(*parameters.denormalProtectionPtr);
+  cancellerPtr->setDitherLevel(*parameters.ditherLevelPtr);
+
+  if (*parameters.proportionateUpdatePtr)
+  {
+    cancellerPtr->setProportionateUpdate(true,*parameters.alphaPtr);
+    cancellerPtr->setActiveTapThreshold(*parameters.activeTapThresholdPtr);
+  } // if
+
+  if (*parameters.variableStepSizePtr)
+  {
+    cancellerPtr->setVariableStepSize(true,*parameters.betaMinPtr);
+  } // if
+
+  if (*parameters.automaticFreezePtr)
+  {
+    cancellerPtr->setAutomaticFreeze(true,*parameters.freezeTolerancePtr);
+  } // if
+
+  return;
+
+} // configureCanceller
+
+/*****************************************************************************
+
+  Name: processChannels
+
+  Purpose: The purpose of this function is to run the cancellers of the
+  channels that are assigned to a thread over the current block.
+  Channels are assigned to threads in a round robin fashion.
+
+  Calling Sequence: processChannels(contextPtr,threadIndex)
+
+  Inputs:
+
+    contextPtr - A pointer to the shared channel context.
+
+    threadIndex - The index of the calling thread.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void processChannels(struct ChannelContext *contextPtr,int threadIndex)
+{
+  int c;
+
+  for (c = threadIndex;
+       c < contextPtr->numberOfChannels;
+       c += contextPtr->numberOfThreads)
+  {
+    if (contextPtr->cascadePtrs != NULL)
+    {
+      // Remove the noise in each stage of the cascade.
+      contextPtr->cascadePtrs[c]->acceptData(
+        contextPtr->channelInputPtrs[c],
+        contextPtr->count,
+        contextPtr->channelOutputPtrs[c]);
+    } // if
+    else if (contextPtr->multirateCancellerPtrs != NULL)
+    {
+      // Remove the noise at the reduced rate.
+      contextPtr->multirateCancellerPtrs[c]->acceptData(
+        contextPtr->channelInputPtrs[c],
+        contextPtr->count,
+        contextPtr->channelOutputPtrs[c]);
+    } // else if
+    else
+    {
+      // Remove the noise from the signal.
+      contextPtr->cancellerPtrs[c]->acceptData(
+        contextPtr->channelInputPtrs[c],
+        contextPtr->count,
+        contextPtr->channelOutputPtrs[c]);
+    } // else
+  } // for
+
+  return;
+
+} // processChannels
+
+/*****************************************************************************
+
+  Name: channelWorker
+
+  Purpose: The purpose of this function is to serve as the entry point of
+  a worker thread.  The worker waits for the main thread to publish a
+  block, processes its channels, and then waits for the other threads
+  to finish the block.
+
+  Calling Sequence: channelWorker(argPtr)
+
+  Inputs:
+
+    argPtr - A pointer to the arguments of the worker.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void *channelWorker(void *argPtr)
+{
+  bool done;
+  struct WorkerArguments *argumentsPtr;
+  struct ChannelContext *contextPtr;
+
+  argumentsPtr = (struct WorkerArguments *)argPtr;
+  contextPtr = argumentsPtr->contextPtr;
+
+  // Set up for loop entry.
+  done = false;
+
+  while (!done)
+  {
+    // Wait for the next block.
+    pthread_barrier_wait(&contextPtr->startBarrier);
+
+    if (contextPtr->done)
+    {
+      // We're done.
+      done = true;
+    } // if
+    else
+    {
+      processChannels(contextPtr,argumentsPtr->threadIndex);
+
+      // Let the main thread know that this thread is finished.
+      pthread_barrier_wait(&contextPtr->doneBarrier);
+    } // else
+  } // while
+
+  return (NULL);
+
+} // channelWorker
+
+/*****************************************************************************
+
+  Name: displayLatencyHistogram
+
+  Purpose: The purpose of this function is to display the percentiles of
+  the processing time per block on stderr.  When the sample rate is
+  known, the real-time deadline of a block (the time that it takes for
+  a block of samples to arrive) is displayed too, along with the number
+  of blocks that missed it.
+
+  Calling Sequence: displayLatencyHistogram(histogramPtr,blockSize,
+                                            sampleRate,lateBlocks)
+
+  Inputs:
+
+    histogramPtr - A pointer to the histogram of processing times.
+
+    blockSize - The number of frames per block.
+
+    sampleRate - The sample rate in samples/second, or 0 if it is not
+    known.
+
+    lateBlocks - The number of blocks that took longer than the deadline.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void displayLatencyHistogram(LatencyHistogram *histogramPtr,
+                                    int blockSize,
+                                    uint32_t sampleRate,
+                                    uint64_t lateBlocks)
+{
+
+  fprintf(stderr,"Processing time of %llu blocks of %d frames (us):\n",
+          (unsigned long long)histogramPtr->getCount(),blockSize);
+
+  fprintf(stderr,"%10s %10s %10s %10s %10s %10s\n",
+          "min","p50","p99","p99.9","max","mean");
+
+  fprintf(stderr,"%10.3f %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+          histogramPtr->getMinimum() / 1e3,
+          histogramPtr->getPercentile(50) / 1e3,
+          histogramPtr->getPercentile(99) / 1e3,
+          histogramPtr->getPercentile(99.9) / 1e3,
+          histogramPtr->getMaximum() / 1e3,
+          histogramPtr->getMean() / 1e3);
+
+  if (sampleRate != 0)
+  {
+    fprintf(stderr,"Deadline: %.3fus per block at %uS/s, %llu blocks late\n",
+            (blockSize * 1e6) / sampleRate,
+            sampleRate,
+            (unsigned long long)lateBlocks);
+  } // if
+  else
+  {
+    fprintf(stderr,"Deadline: unknown, use -S to give the sample rate\n");
+  } // else
+
+  return;
+
+} // displayLatencyHistogram
+
+/*****************************************************************************
+
+  Name: displayPerformanceCounters
+
+  Purpose: The purpose of this function is to display the events that
+  were counted over the processing of the blocks on stderr.  Each event
+  is displayed as a total, per sample, and per block, and the number
+  of instructions per cycle is displayed when both are counted.
+
+  Calling Sequence: displayPerformanceCounters(countersPtr)
+
+  Inputs:
+
+    countersPtr - A pointer to the event counters.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void displayPerformanceCounters(PerformanceCounters *countersPtr)
+{
+  int i;
+  PerformanceEvent event;
+
+  fprintf(stderr,"Events over %llu blocks, %llu samples:\n",
+          (unsigned long long)countersPtr->getNumberOfBlocks(),
+          (unsigned long long)countersPtr->getNumberOfSamples());
+
+  fprintf(stderr,"%-14s %16s %12s %14s\n",
+          "event","total","per sample","per block");
+
+  for (i = 0; i < NUMBER_OF_EVENTS; i++)
+  {
+    event = (PerformanceEvent)i;
+
+    if (countersPtr->isSupported(event))
+    {
+      fprintf(stderr,"%-14s %16llu %12.3f %14.1f\n",
+              PerformanceCounters::getName(event),
+              (unsigned long long)countersPtr->getTotal(event),
+              countersPtr->getPerSample(event),
+              countersPtr->getPerBlock(event));
+    } // if
+    else
+    {
+      fprintf(stderr,"%-14s %16s\n",
+              PerformanceCounters::getName(event),
+              "not supported");
+    } // else
+  } // for
+
+  if (countersPtr->isSupported(EVENT_CYCLES) &&
+      countersPtr->isSupported(EVENT_INSTRUCTIONS) &&
+      (countersPtr->getTotal(EVENT_CYCLES) != 0))
+  {
+    fprintf(stderr,"Instructions per cycle: %.2f\n",
+            (double)countersPtr->getTotal(EVENT_INSTRUCTIONS) /
+            countersPtr->getTotal(EVENT_CYCLES));
+  } // if
+
+  return;
+
+} // displayPerformanceCounters
+
+/*****************************************************************************
+
+  Name: writeCancellerStates
+
+  Purpose: The purpose of this function is to write the state of every
+  canceller to a stream.  The number of cancellers is written first.
+  In dual-input mode, there is one canceller; otherwise, there is one
+  canceller or cascade per channel.
+
+  Calling Sequence: success = writeCancellerStates(streamPtr,
+                                                   contextPtr,
+                                                   dualCancellerPtr)
+
+  Inputs:
+
+    streamPtr - The stream.
+
+    contextPtr - A pointer to the channel context.
+
+    dualCancellerPtr - A pointer to the dual-input canceller, or NULL if
+    the channels have their own cancellers.
+
+  Outputs:
+
+    success - A flag that indicates whether the states were written.
+
+*****************************************************************************/
+static bool writeCancellerStates(FILE *streamPtr,
+                                 struct ChannelContext *contextPtr,
+                                 NlmsNoiseCanceller *dualCancellerPtr)
+{
+  int c;
+  int numberOfCancellers;
+  bool success;
+
+  if (dualCancellerPtr != NULL)
+  {
+    numberOfCancellers = 1;
+
+    success = (fwrite(&numberOfCancellers,sizeof(int),1,streamPtr) == 1) &&
+      dualCancellerPtr->writeState(streamPtr);
+
+    return (success);
+  } // if
+
+  numberOfCancellers = contextPtr->numberOfChannels;
+
+  if (fwrite(&numberOfCancellers,sizeof(int),1,streamPtr) != 1)
+  {
+    return (false);
+  } // if
+
+  for (c = 0; c < numberOfCancellers; c++)
+  {
+    if (contextPtr->cascadePtrs != NULL)
+    {
+      success = contextPtr->cascadePtrs[c]->writeState(streamPtr);
+    } // if
+    else
+    {
+      success = contextPtr->cancellerPtrs[c]->writeState(streamPtr);
+    } // else
+
+    if (!success)
+    {
+      return (false);
+    } // if
+  } // for
+
+  return (true);
+
+} // writeCancellerStates
+
+/*****************************************************************************
+
+  Name: readCancellerStates
+
+  Purpose: The purpose of this function is to read the states that were
+  written by writeCancellerStates() into the cancellers.  The states are
+  rejected if they were written by a run with other parameters.
+
+  Calling Sequence: success = readCancellerStates(streamPtr,
+                                                  contextPtr,
+                                                  dualCancellerPtr)
+
+  Inputs:
+
+    streamPtr - The stream.
+
+    contextPtr - A pointer to the channel context.
+
+    dualCancellerPtr - A pointer to the dual-input canceller, or NULL if
+    the channels have their own cancellers.
+
+  Outputs:
+
+    success - A flag that indicates whether the states were read.
+
+*****************************************************************************/
+static bool readCancellerStates(FILE *streamPtr,
+                                struct ChannelContext *contextPtr,
+                                NlmsNoiseCanceller *dualCancellerPtr)
+{
+  int c;
+  int numberOfCancellers;
+  bool success;
+
+  if (fread(&numberOfCancellers,sizeof(int),1,streamPtr) != 1)
+  {
+    return (false);
+  } // if
+
+  if (dualCancellerPtr != NULL)
+  {
+    success = (numberOfCancellers == 1) &&
+      dualCancellerPtr->readState(streamPtr);
+
+    return (success);
+  } // if
+
+  if (numberOfCancellers != contextPtr->numberOfChannels)
+  {
+    return (false);
+  } // if
+
+  for (c = 0; c < numberOfCancellers; c++)
+  {
+    if (contextPtr->cascadePtrs != NULL)
+    {
+      success = contextPtr->cascadePtrs[c]->readState(streamPtr);
+    } // if
+    else
+    {
+      success = contextPtr->cancellerPtrs[c]->readState(streamPtr);
+    } // else
+
+    if (!success)
+    {
+      return (false);
+    } // if
+  } // for
+
+  return (true);
+
+} // readCancellerStates
+
+/*****************************************************************************
+
+  Name: saveCheckpoint
+
+  Purpose: The purpose of this function is to save a checkpoint.  The
+  output is flushed and synchronized first, so that the output that the
+  checkpoint accounts for is on disk before the checkpoint is.  The
+  checkpoint is written to a temporary file that is then renamed over
+  the checkpoint file, so that a crash at any point leaves a complete
+  checkpoint behind.
+
+  Calling Sequence: success = saveCheckpoint(fileNamePtr,
+                                             framesConsumed,
+                                             outputOffset,
+                                             writerPtr,
+                                             contextPtr,
+                                             dualCancellerPtr)
+
+  Inputs:
+
+    fileNamePtr - The name of the checkpoint file.
+
+    framesConsumed - The number of input frames that have been consumed.
+
+    outputOffset - The number of bytes of output that have been written.
+
+    writerPtr - A pointer to the output writer.
+
+    contextPtr - A pointer to the channel context.
+
+    dualCancellerPtr - A pointer to the dual-input canceller, or NULL if
+    the channels have their own cancellers.
+
+  Outputs:
+
+    success - A flag that indicates whether the checkpoint was saved.
+
+*****************************************************************************/
+static bool saveCheckpoint(char *fileNamePtr,
+                           uint64_t framesConsumed,
+                           uint64_t outputOffset,
+                           SampleWriter *writerPtr,
+                           struct ChannelContext *contextPtr,
+                           NlmsNoiseCanceller *dualCancellerPtr)
+{
+  bool success;
+  char *temporaryNamePtr;
+  FILE *streamPtr;
+
+  // Make sure that the output is durable.  A pipe can't be synchronized,
+  // which is fine.
+  writerPtr->flush();
+  fsync(fileno(stdout));
+
+  temporaryNamePtr = new char[strlen(fileNamePtr) + 5];
+  sprintf(temporaryNamePtr,"%s.tmp",fileNamePtr);
+
+  streamPtr = fopen(temporaryNamePtr,"wb");
+
+  if (streamPtr == NULL)
+  {
+    delete[] temporaryNamePtr;
+    return (false);
+  } // if
+
+  success = (fwrite(CHECKPOINT_MAGIC,8,1,streamPtr) == 1) &&
+    (fwrite(&framesConsumed,sizeof(uint64_t),1,streamPtr) == 1) &&
+    (fwrite(&outputOffset,sizeof(uint64_t),1,streamPtr) == 1) &&
+    writeCancellerStates(streamPtr,contextPtr,dualCancellerPtr);
+
+  // The data has to be on disk before the rename makes it visible.
+  success = success && (fflush(streamPtr) == 0) &&
+    (fsync(fileno(streamPtr)) == 0);
+
+  if (fclose(streamPtr) != 0)
+  {
+    success = false;
+  } // if
+
+  if (success)
+  {
+    success = (rename(temporaryNamePtr,fileNamePtr) == 0);
+  } // if
+  else
+  {
+    remove(temporaryNamePtr);
+  } // else
+
+  delete[] temporaryNamePtr;
+
+  return (success);
+
+} // saveCheckpoint
+
+/*****************************************************************************
+
+  Name: openCheckpoint
+
+  Purpose: The purpose of this function is to open a checkpoint file and
+  to read its header.  The stream is left positioned at the states of
+  the cancellers, which are read by readCancellerStates() once the
+  cancellers exist.
+
+  Calling Sequence: streamPtr = openCheckpoint(fileNamePtr,
+                                               framesConsumedPtr,
+                                               outputOffsetPtr)
+
+  Inputs:
+
+    fileNamePtr - The name of the checkpoint file.
+
+    framesConsumedPtr - A pointer to storage for the number of input
+    frames that had been consumed.
+
+    outputOffsetPtr - A pointer to storage for the number of bytes of
+    output that had been written.
+
+  Outputs:
+
+    streamPtr - The stream, or NULL if the file can't be opened or is
+    not a checkpoint.
+
+*****************************************************************************/
+static FILE *openCheckpoint(char *fileNamePtr,
+                            uint64_t *framesConsumedPtr,
+                            uint64_t *outputOffsetPtr)
+{
+  char magic[8];
+  FILE *streamPtr;
+
+  streamPtr = fopen(fileNamePtr,"rb");
+
+  if (streamPtr == NULL)
+  {
+    return (NULL);
+  } // if
+
+  if ((fread(magic,8,1,streamPtr) != 1) ||
+      (memcmp(magic,CHECKPOINT_MAGIC,8) != 0) ||
+      (fread(framesConsumedPtr,sizeof(uint64_t),1,streamPtr) != 1) ||
+      (fread(outputOffsetPtr,sizeof(uint64_t),1,streamPtr) != 1))
+  {
+    fclose(streamPtr);
+    return (NULL);
+  } // if
+
+  return (streamPtr);
+
+} // openCheckpoint
+
+/*****************************************************************************
+
+  Name: positionOutput
+
+  Purpose: The purpose of this function is to position the output of an
+  interrupted run at a checkpoint, so that the resumed run carries on
+  from there.  Nothing is discarded yet; truncateOutput() cuts off the
+  output that follows the checkpoint once the checkpoint has been
+  accepted.  When stdout is not a regular file (a pipe, for example),
+  it is left alone.
+
+  Calling Sequence: success = positionOutput(outputOffset)
+
+  Inputs:
+
+    outputOffset - The number of bytes of output at the checkpoint.
+
+  Outputs:
+
+    success - A flag that indicates whether the output is usable.  This
+    is false if the output is shorter than the checkpoint.
+
+*****************************************************************************/
+static bool positionOutput(uint64_t outputOffset)
+{
+  int descriptor;
+  struct stat status;
+
+  descriptor = fileno(stdout);
+
+  if ((fstat(descriptor,&status) != 0) || (!S_ISREG(status.st_mode)))
+  {
+    return (true);
+  } // if
+
+  if ((uint64_t)status.st_size < outputOffset)
+  {
+    // Output that the checkpoint accounts for is missing.
+    return (false);
+  } // if
+
+  return (lseek(descriptor,outputOffset,SEEK_SET) >= 0);
+
+} // positionOutput
+
+/*****************************************************************************
+
+  Name: truncateOutput
+
+  Purpose: The purpose of this function is to cut off the output that
+  an interrupted run wrote after its last checkpoint.  This works
+  whether stdout was opened for update or for appending.  When stdout
+  is not a regular file, it is left alone.
+
+  Calling Sequence: success = truncateOutput(outputOffset)
+
+  Inputs:
+
+    outputOffset - The number of bytes of output at the checkpoint.
+
+  Outputs:
+
+    success - A flag that indicates whether the output was truncated.
+
+*****************************************************************************/
+static bool truncateOutput(uint64_t outputOffset)
+{
+  int descriptor;
+  struct stat status;
+
+  descriptor = fileno(stdout);
+
+  if ((fstat(descriptor,&status) != 0) || (!S_ISREG(status.st_mode)))
+  {
+    return (true);
+  } // if
+
+  return (ftruncate(descriptor,outputOffset) == 0);
+
+} // truncateOutput
+
+/*****************************************************************************
+
+  Name: displaySegmentReport
+
+  Purpose: The purpose of this function is to display on stderr how far
+  the output of each segment is from the output of a serial run.  For
+  each segment, the largest difference, the ratio of the energy of the
+  serial output to the energy of the difference, and the number of
+  frames after the start of the segment until the difference stays
+  within 1 are displayed, over all of the channels.  The first segment
+  is always identical to the serial output.  The totals and the times
+  of both runs follow.
+
+  Calling Sequence: displaySegmentReport(segmentedPtr,
+                                         outputPtrs,
+                                         serialOutputPtrs,
+                                         numberOfChannels,
+                                         numberOfFrames,
+                                         segmentedTime,
+                                         serialTime)
+
+  Inputs:
+
+    segmentedPtr - A pointer to one of the segmented cancellers, which
+    provides the segment boundaries.
+
+    outputPtrs - A pointer to the segmented output of each channel.
+
+    serialOutputPtrs - A pointer to the serial output of each channel.
+
+    numberOfChannels - The number of channels.
+
+    numberOfFrames - The number of frames of each channel.
+
+    segmentedTime - The time of the segmented run in seconds.
+
+    serialTime - The time of the serial run in seconds.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void displaySegmentReport(SegmentedNoiseCanceller *segmentedPtr,
+                                 float **outputPtrs,
+                                 float **serialOutputPtrs,
+                                 int numberOfChannels,
+                                 uint64_t numberOfFrames,
+                                 double segmentedTime,
+                                 double serialTime)
+{
+  int c, s;
+  uint64_t i;
+  uint64_t start;
+  uint64_t end;
+  uint64_t settle;
+  float difference;
+  float maxDifference;
+  float totalMaxDifference;
+  double signalEnergy;
+  double differenceEnergy;
+  double totalSignalEnergy;
+  double totalDifferenceEnergy;
+
+  fprintf(stderr,"Segments: %d, overlap: %u frames, threads: %d\n",
+          segmentedPtr->getNumberOfSegments(),
+          segmentedPtr->getOverlap(),
+          segmentedPtr->getNumberOfThreads());
+
+  fprintf(stderr,"%8s %14s %12s %12s %10s %12s\n",
+          "segment","start","frames","max diff","SDR (dB)","settle");
+
+  totalMaxDifference = 0;
+  totalSignalEnergy = 0;
+  totalDifferenceEnergy = 0;
+
+  for (s = 0; s < segmentedPtr->getNumberOfSegments(); s++)
+  {
+    start = segmentedPtr->getSegmentStart(s,numberOfFrames);
+    end = segmentedPtr->getSegmentStart(s + 1,numberOfFrames);
+
+    maxDifference = 0;
+    signalEnergy = 0;
+    differenceEnergy = 0;
+    settle = 0;
+
+    for (c = 0; c < numberOfChannels; c++)
+    {
+      for (i = start; i < end; i++)
+      {
+        difference = fabsf(outputPtrs[c][i] - serialOutputPtrs[c][i]);
+
+        signalEnergy += (double)serialOutputPtrs[c][i] *
+                        serialOutputPtrs[c][i];
+        differenceEnergy += (double)difference * difference;
+
+        if (difference > maxDifference)
+        {
+          maxDifference = difference;
+        } // if
+
+        // The segment has settled after the last difference above 1.
+        if ((difference > 1) && ((i - start + 1) > settle))
+        {
+          settle = i - start + 1;
+        } // if
+      } // for
+    } // for
+
+    fprintf(stderr,"%8d %14llu %12llu %12.3f ",
+            s,
+            (unsigned long long)start,
+            (unsigned long long)(end - start),
+            maxDifference);
+
+    if (differenceEnergy == 0)
+    {
+      fprintf(stderr,"%10s",(signalEnergy == 0) ? "-" : "inf");
+    } // if
+    else
+    {
+      fprintf(stderr,"%10.1f",10 * log10(signalEnergy / differenceEnergy));
+    } // else
+
+    fprintf(stderr," %12llu\n",(unsigned long long)settle);
+
+    if (maxDifference > totalMaxDifference)
+    {
+      totalMaxDifference = maxDifference;
+    } // if
+
+    totalSignalEnergy += signalEnergy;
+    totalDifferenceEnergy += differenceEnergy;
+  } // for
+
+  fprintf(stderr,"Overall: max diff %.3f, SDR ",totalMaxDifference);
+
+  if (totalDifferenceEnergy == 0)
+  {
+    fprintf(stderr,"%s dB\n",(totalSignalEnergy == 0) ? "-" : "inf");
+  } // if
+  else
+  {
+    fprintf(stderr,"%.1f dB\n",
+            10 * log10(totalSignalEnergy / totalDifferenceEnergy));
+  } // else
+
+  fprintf(stderr,"Segmented: %.3fs, serial: %.3fs",segmentedTime,serialTime);
+
+  if (segmentedTime > 0)
+  {
+    fprintf(stderr,", speedup: %.2f",serialTime / segmentedTime);
+  } // if
+
+  fprintf(stderr,"\n");
+
+  return;
+
+} // displaySegmentReport
+
+/*****************************************************************************
+
+  Name: configureSegment
+
+  Purpose: The purpose of this function is to set the modes that the
+  user selected on the canceller of a segment.  It is called by a
+  segmented canceller as each segment's canceller is created.
+
+  Calling Sequence: configureSegment(cancellerPtr,argPtr)
+
+  Inputs:
+
+    cancellerPtr - A pointer to the canceller.
+
+    argPtr - A pointer to the structure that contains pointers to the
+    user parameters.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void configureSegment(NlmsNoiseCanceller *cancellerPtr,void *argPtr)
+{
+
+  configureCanceller(cancellerPtr,*(struct MyParameters *)argPtr);
+
+  return;
+
+} // configureSegment
+
+/*****************************************************************************
+
+  Name: processSegments
+
+  Purpose: The purpose of this function is to process the whole input
+  in segments that run in parallel.  The input is read into memory and
+  split into channels.  Each channel is processed by a segmented
+  canceller that uses one thread per processor, and the channels are
+  processed one after another.  If a report was requested, each channel
+  is also processed serially by a segmented canceller of one segment,
+  and the two are compared.  The output is then written.
+
+  Calling Sequence: processSegments(readerPtr,
+                                    writerPtr,
+                                    numberOfChannels,
+                                    parameters)
+
+  Inputs:
+
+    readerPtr - A pointer to the input reader.
+
+    writerPtr - A pointer to the output writer.
+
+    numberOfChannels - The number of channels.
+
+    parameters - A structure that contains pointers to the user
+    parameters.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void processSegments(SampleReader *readerPtr,
+                            SampleWriter *writerPtr,
+                            int numberOfChannels,
+                            struct MyParameters parameters)
+{
+  int c;
+  int numberOfThreads;
+  uint32_t blockSize;
+  uint32_t count;
+  uint64_t i;
+  uint64_t numberOfFrames;
+  uint64_t capacity;
+  double segmentedTime;
+  double serialTime;
+  struct timespec startTime, endTime;
+  float *inputPtr;
+  float *grownInputPtr;
+  float **channelInputPtrs;
+  float **channelOutputPtrs;
+  float **serialOutputPtrs;
+  float **framePtrs;
+  SegmentedNoiseCanceller **segmentedPtrs;
+  SegmentedNoiseCanceller *serialPtr;
+
+  blockSize = *parameters.blockSizePtr;
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Read the whole input.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  capacity = INPUT_CAPACITY;
+  numberOfFrames = 0;
+
+  inputPtr = (float *)SampleConverter::allocateAligned(
+    capacity * numberOfChannels * sizeof(float));
+
+  while (true)
+  {
+    if ((numberOfFrames + blockSize) > capacity)
+    {
+      // Make room by doubling the buffer.
+      capacity *= 2;
+
+      grownInputPtr = (float *)SampleConverter::allocateAligned(
+        capacity * numberOfChannels * sizeof(float));
+
+      memcpy(grownInputPtr,
+             inputPtr,
+             numberOfFrames * numberOfChannels * sizeof(float));
+
+      SampleConverter::releaseAligned(inputPtr);
+      inputPtr = grownInputPtr;
+    } // if
+
+    count = readerPtr->readFrames(&inputPtr[numberOfFrames *
+                                            numberOfChannels],
+                                  blockSize);
+
+    if (count == 0)
+    {
+      // We're done.
+      break;
+    } // if
+
+    numberOfFrames += count;
+  } // while
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Split the input into channels.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  channelInputPtrs = new float *[numberOfChannels];
+  channelOutputPtrs = new float *[numberOfChannels];
+  serialOutputPtrs = new float *[numberOfChannels];
+  framePtrs = new float *[numberOfChannels];
+
+  for (c = 0; c < numberOfChannels; c++)
+  {
+    // A single channel is processed in place.
+    channelInputPtrs[c] = inputPtr;
+
+    if (numberOfChannels > 1)
+    {
+      channelInputPtrs[c] = (float *)SampleConverter::allocateAligned(
+        numberOfFrames * sizeof(float));
+    } // if
+
+    channelOutputPtrs[c] = (float *)SampleConverter::allocateAligned(
+      numberOfFrames * sizeof(float));
+
+    serialOutputPtrs[c] = NULL;
+
+    if (*parameters.qualityReportPtr)
+    {
+      serialOutputPtrs[c] = (float *)SampleConverter::allocateAligned(
+        numberOfFrames * sizeof(float));
+    } // if
+  } // for
+
+  if (numberOfChannels > 1)
+  {
+    for (i = 0; i < numberOfFrames; i += count)
+    {
+      count = blockSize;
+
+      if ((numberOfFrames - i) < count)
+      {
+        count = numberOfFrames - i;
+      } // if
+
+      for (c = 0; c < numberOfChannels; c++)
+      {
+        framePtrs[c] = &channelInputPtrs[c][i];
+      } // for
+
+      SampleConverter::deinterleave(&inputPtr[i * numberOfChannels],
+                                    numberOfChannels,
+                                    count,
+                                    framePtrs);
+    } // for
+  } // if
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Process the segments.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  numberOfThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+  segmentedPtrs = new SegmentedNoiseCanceller *[numberOfChannels];
+
+  for (c = 0; c < numberOfChannels; c++)
+  {
+    segmentedPtrs[c] =
+      new SegmentedNoiseCanceller(*parameters.numberOfSegmentsPtr,
+                                  *parameters.filterOrderPtr,
+                                  *parameters.delayPtr,
+                                  *parameters.betaPtr);
+
+    segmentedPtrs[c]->setConfigurator(configureSegment,&parameters);
+    segmentedPtrs[c]->setOverlap(*parameters.overlapPtr);
+    segmentedPtrs[c]->setBlockSize(blockSize);
+    segmentedPtrs[c]->setNumberOfThreads(numberOfThreads);
+  } // for
+
+  clock_gettime(CLOCK_MONOTONIC,&startTime);
+
+  for (c = 0; c < numberOfChannels; c++)
+  {
+    segmentedPtrs[c]->acceptData(channelInputPtrs[c],
+                                 numberOfFrames,
+                                 channelOutputPtrs[c]);
+  } // for
+
+  clock_gettime(CLOCK_MONOTONIC,&endTime);
+
+  segmentedTime = (endTime.tv_sec - startTime.tv_sec) +
+                  ((endTime.tv_nsec - startTime.tv_nsec) / 1e9);
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  if (*parameters.qualityReportPtr)
+  {
+    clock_gettime(CLOCK_MONOTONIC,&startTime);
+
+    // A single segment is a serial run.
+    for (c = 0; c < numberOfChannels; c++)
+    {
+      serialPtr = new SegmentedNoiseCanceller(1,
+                                              *parameters.filterOrderPtr,
+                                              *parameters.delayPtr,
+                                              *parameters.betaPtr);
+
+      serialPtr->setConfigurator(configureSegment,&parameters);
+      serialPtr->setBlockSize(blockSize);
+
+      serialPtr->acceptData(channelInputPtrs[c],
+                            numberOfFrames,
+                            serialOutputPtrs[c]);
+
+      delete serialPtr;
+    } // for
+
+    clock_gettime(CLOCK_MONOTONIC,&endTime);
+
+    serialTime = (endTime.tv_sec - startTime.tv_sec) +
+                 ((endTime.tv_nsec - startTime.tv_nsec) / 1e9);
+
+    displaySegmentReport(segmentedPtrs[0],
+                         channelOutputPtrs,
+                         serialOutputPtrs,
+                         numberOfChannels,
+                         numberOfFrames,
+                         segmentedTime,
+                         serialTime);
+  } // if
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Write the output.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  for (i = 0; i < numberOfFrames; i += count)
+  {
+    count = blockSize;
+
+    if ((numberOfFrames - i) < count)
+    {
+      count = numberOfFrames - i;
+    } // if
+
+    if (numberOfChannels > 1)
+    {
+      // The input is no longer needed, so it holds the interleaved block.
+      for (c = 0; c < numberOfChannels; c++)
+      {
+        framePtrs[c] = &channelOutputPtrs[c][i];
+      } // for
+
+      SampleConverter::interleave(framePtrs,
+                                  numberOfChannels,
+                                  count,
+                                  inputPtr);
+
+      writerPtr->writeFrames(inputPtr,count);
+    } // if
+    else
+    {
+      writerPtr->writeFrames(&channelOutputPtrs[0][i],count);
+    } // else
+  } // for
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Release resources.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  for (c = 0; c < numberOfChannels; c++)
+  {
+    delete segmentedPtrs[c];
+
+    if (numberOfChannels > 1)
+    {
+      SampleConverter::releaseAligned(channelInputPtrs[c]);
+    } // if
+
+    SampleConverter::releaseAligned(channelOutputPtrs[c]);
+
+    if (serialOutputPtrs[c] != NULL)
+    {
+      SampleConverter::releaseAligned(serialOutputPtrs[c]);
+    } // if
+  } // for
+
+  delete[] segmentedPtrs;
+  delete[] channelInputPtrs;
+  delete[] channelOutputPtrs;
+  delete[] serialOutputPtrs;
+  delete[] framePtrs;
+
+  SampleConverter::releaseAligned(inputPtr);
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  return;
+
+} // processSegments
+
+//*************************************************************************
+// Mainline code.
+//*************************************************************************
+int main(int argc,char **argv)
+{
+  int c;
+  bool exitProgram;
+  bool argumentError;
+  bool done;
+  uint32_t count;
+  int filterOrder;
+  int delay;
+  float beta;
+  SampleFormat rawFormat;
+  int numberOfChannels;
+  int numberOfThreads;
+  bool iqMode;
+  bool denormalProtection;
+  float ditherLevel;
+  bool proportionateUpdate;
+  float alpha;
+  float activeTapThreshold;
+  bool variableStepSize;
+  float betaMin;
+  int decimationFactor;
+  int blockSize;
+  bool lowLatency;
+  bool latencyHistogram;
+  uint32_t sampleRate;
+  bool automaticFreeze;
+  float freezeTolerance;
+  int queueDepth;
+  bool forceThreads;
+  char *referenceFileName;
+  bool performanceCounters;
+  char *cascadeSpecification;
+  int stageThreads;
+  char *checkpointFileName;
+  uint64_t checkpointInterval;
+  bool resume;
+  uint64_t framesConsumed;
+  uint64_t outputOffset;
+  uint64_t nextCheckpoint;
+  uint64_t framesSkipped;
+  uint32_t outputFrameSize;
+  int numberOfSegments;
+  int overlap;
+  bool qualityReport;
+  int numberOfStages;
+  int filterOrders[MAX_CASCADE_STAGES];
+  int delays[MAX_CASCADE_STAGES];
+  float betas[MAX_CASCADE_STAGES];
+  int s;
+  bool stereoReference;
+  uint32_t ioBlockSize;
+  uint32_t i;
+  uint32_t referenceCount;
+  uint64_t deadline;
+  uint64_t elapsedTime;
+  uint64_t lateBlocks;
+  struct timespec startTime, endTime;
+  LatencyHistogram *histogramPtr;
+  PerformanceCounters *countersPtr;
+  float *inputBufferPtr;
+  float *outputBufferPtr;
+  float *primaryBufferPtr;
+  float *referenceBufferPtr;
+  float *dualInputPtrs[2];
+  pthread_t *threadsPtr;
+  struct WorkerArguments *workerArgumentsPtr;
+  struct ChannelContext context;
+  ComplexNlmsNoiseCanceller *iqCancellerPtr;
+  NlmsNoiseCanceller *dualCancellerPtr;
+  NlmsNoiseCanceller *stagePtr;
+  MemoryArena *arenaPtr;
+  FILE *referenceStreamPtr;
+  FILE *checkpointStreamPtr;
+  SampleReader *readerPtr;
+  SampleReader *referenceReaderPtr;
+  SampleWriter *writerPtr;
+  AsyncBlockIo *ioPtr;
+  struct MyParameters parameters;
+
+  // Set up for parameter transmission.
+  parameters.filterOrderPtr = &filterOrder;
+  parameters.delayPtr = &delay;
+  parameters.betaPtr = &beta;
+  parameters.rawFormatPtr = &rawFormat;
+  parameters.numberOfChannelsPtr = &numberOfChannels;
+  parameters.numberOfThreadsPtr = &numberOfThreads;
+  parameters.iqModePtr = &iqMode;
+  parameters.denormalProtectionPtr = &denormalProtection;
+  parameters.ditherLevelPtr = &ditherLevel;
+  parameters.proportionateUpdatePtr = &proportionateUpdate;
+  parameters.alphaPtr = &alpha;
+  parameters.activeTapThresholdPtr = &activeTapThreshold;
+  parameters.variableStepSizePtr = &variableStepSize;
+  parameters.betaMinPtr = &betaMin;
+  parameters.decimationFactorPtr = &decimationFactor;
+  parameters.blockSizePtr = &blockSize;
+  parameters.lowLatencyPtr = &lowLatency;
+  parameters.latencyHistogramPtr = &latencyHistogram;
+  parameters.sampleRatePtr = &sampleRate;
+  parameters.automaticFreezePtr = &automaticFreeze;
+  parameters.freezeTolerancePtr = &freezeTolerance;
+  parameters.queueDepthPtr = &queueDepth;
+  parameters.forceThreadsPtr = &forceThreads;
+  parameters.referenceFileNamePtr = &referenceFileName;
+  parameters.performanceCountersPtr = &performanceCounters;
+  parameters.cascadeSpecificationPtr = &cascadeSpecification;
+  parameters.stageThreadsPtr = &stageThreads;
+  parameters.checkpointFileNamePtr = &checkpointFileName;
+  parameters.checkpointIntervalPtr = &checkpointInterval;
+  parameters.resumePtr = &resume;
+  parameters.numberOfSegmentsPtr = &numberOfSegments;
+  parameters.overlapPtr = &overlap;
+  parameters.qualityReportPtr = &qualityReport;
+  parameters.argumentErrorPtr = &argumentError;
+
+  // Retrieve the system parameters.
+  exitProgram = getUserArguments(argc,argv,parameters);
+
+  if (exitProgram)
+  {
+    if (argumentError)
+    {
+      // Let the caller know that the arguments were rejected.
+      return (1);
+    } // if
+
+    // Bail out.
+    return (0);
+  } // if
+
+  if (iqMode)
+  {
+    // I and Q are carried as a pair of channels.
+    numberOfChannels = 2;
+  } // if
+
+  // A single canceller is a cascade of one stage.
+  numberOfStages = 1;
+
+  if (cascadeSpecification != NULL)
+  {
+    if (iqMode || (decimationFactor > 1) || (referenceFileName != NULL))
+    {
+      fprintf(stderr,"A cascade can't be used with -q, -D, or -R.\n");
+      return (1);
+    } // if
+
+    if (!parseCascadeSpecification(cascadeSpecification,
+                                   filterOrder,
+                                   delay,
+                                   beta,
+                                   &numberOfStages,
+                                   filterOrders,
+                                   delays,
+                                   betas))
+    {
+      fprintf(stderr,"Invalid cascade %s.\n",cascadeSpecification);
+      return (1);
+    } // if
+  } // if
+
+  if (numberOfSegments > 0)
+  {
+    if (iqMode || (decimationFactor > 1) || (referenceFileName != NULL) ||
+        (cascadeSpecification != NULL) || (checkpointFileName != NULL) ||
+        lowLatency || latencyHistogram || performanceCounters)
+    {
+      fprintf(stderr,"Segments can't be used with -q, -D, -R, -C, -k, -l,"
+              " -H, or -P.\n");
+      return (1);
+    } // if
+  } // if
+
+  stereoReference = false;
+
+  if (referenceFileName != NULL)
+  {
+    if (iqMode || (decimationFactor > 1))
+    {
+      fprintf(stderr,"Dual-input mode can't be used with -q or -D.\n");
+      return (1);
+    } // if
+
+    if (strcmp(referenceFileName,"-") == 0)
+    {
+      // The primary and the reference are carried as a pair of channels.
+      stereoReference = true;
+      numberOfChannels = 2;
+    } // if
+    else
+    {
+      numberOfChannels = 1;
+    } // else
+  } // if
+
+  framesConsumed = 0;
+  outputOffset = 0;
+  checkpointStreamPtr = NULL;
+
+  if (checkpointFileName != NULL)
+  {
+    if (iqMode || (decimationFactor > 1))
+    {
+      fprintf(stderr,"Checkpoints can't be used with -q or -D.\n");
+      return (1);
+    } // if
+
+    if (resume)
+    {
+      checkpointStreamPtr = openCheckpoint(checkpointFileName,
+                                           &framesConsumed,
+                                           &outputOffset);
+
+      if (checkpointStreamPtr == NULL)
+      {
+        fprintf(stderr,"Can't read checkpoint %s.\n",checkpointFileName);
+        return (1);
+      } // if
+
+      // The asynchronous I/O starts writing at the current position, so
+      // this must precede it.
+      if (!positionOutput(outputOffset))
+      {
+        fprintf(stderr,"The output doesn't reach the checkpoint.\n");
+        fclose(checkpointStreamPtr);
+        return (1);
+      } // if
+    } // if
+  } // if
+  else if (resume)
+  {
+    fprintf(stderr,"Resuming needs a checkpoint file (-k).\n");
+    return (1);
+  } // else if
+
+  if (lowLatency)
+  {
+    // Move each block as soon as it is available rather than waiting
+    // for the stdio buffers to fill.  This must precede any I/O.
+    setvbuf(stdin,NULL,_IONBF,0);
+    setvbuf(stdout,NULL,_IONBF,0);
+  } // if
+
+  ioPtr = NULL;
+
+  if (queueDepth > 0)
+  {
+    // Size the buffers for a block of the widest samples.
+    ioBlockSize = blockSize * numberOfChannels * sizeof(int32_t);
+
+    if (ioBlockSize < MIN_IO_BLOCK_SIZE)
+    {
+      ioBlockSize = MIN_IO_BLOCK_SIZE;
+    } // if
+
+    ioPtr = new AsyncBlockIo(fileno(stdin),
+                             fileno(stdout),
+                             ioBlockSize,
+                             queueDepth,
+                             !forceThreads);
+
+    if (ioPtr->hasFailed())
+    {
+      // Its buffers couldn't be allocated, and nothing has been read.
+      fprintf(stderr,"Asynchronous I/O is unavailable, so stdio is used.\n");
+      delete ioPtr;
+      ioPtr = NULL;
+    } // if
+  } // if
+
+  // Set up the input stream.
+  if (ioPtr != NULL)
+  {
+    readerPtr = new SampleReader(ioPtr,rawFormat,numberOfChannels,FULL_SCALE);
+  } // if
+  else
+  {
+    readerPtr = new SampleReader(stdin,rawFormat,numberOfChannels,FULL_SCALE);
+  } // else
+
+  if (!readerPtr->isValid())
+  {
+    fprintf(stderr,"Unsupported input stream.\n");
+    delete readerPtr;
+    delete ioPtr;
+    return (1);
+  } // if
+
+  if ((checkpointFileName != NULL) &&
+      (readerPtr->getContainer() != SAMPLE_CONTAINER_RAW))
+  {
+    fprintf(stderr,"Checkpoints can only be used with raw input.\n");
+    delete readerPtr;
+    delete ioPtr;
+    return (1);
+  } // if
+
+  // WAV files specify their own number of channels.
+  numberOfChannels = readerPtr->getNumberOfChannels();
+
+  if (iqMode && (numberOfChannels != 2))
+  {
+    fprintf(stderr,"I/Q input must have exactly two channels.\n");
+    delete readerPtr;
+    delete ioPtr;
+    return (1);
+  } // if
+
+  referenceStreamPtr = NULL;
+  referenceReaderPtr = NULL;
+
+  if (referenceFileName != NULL)
+  {
+    if (numberOfChannels != (stereoReference ? 2 : 1))
+    {
+      fprintf(stderr,"Dual-input mode needs one input channel, or two"
+              " with -R -.\n");
+      delete readerPtr;
+      delete ioPtr;
+      return (1);
+    } // if
+
+    if (!stereoReference)
+    {
+      referenceStreamPtr = fopen(referenceFileName,"rb");
+
+      if (referenceStreamPtr == NULL)
+      {
+        fprintf(stderr,"Can't open %s.\n",referenceFileName);
+        delete readerPtr;
+        delete ioPtr;
+        return (1);
+      } // if
+
+      referenceReaderPtr =
+        new SampleReader(referenceStreamPtr,rawFormat,1,FULL_SCALE);
+
+      if ((!referenceReaderPtr->isValid()) ||
+          (referenceReaderPtr->getNumberOfChannels() != 1))
+      {
+        fprintf(stderr,"Unsupported reference stream.\n");
+        delete referenceReaderPtr;
+        fclose(referenceStreamPtr);
+        delete readerPtr;
+        delete ioPtr;
+        return (1);
+      } // if
+    } // if
+
+    // Only the primary, with the noise removed, is output.
+    numberOfChannels = 1;
+  } // if
+
+  // WAV files specify their own sample rate.
+  if (readerPtr->getSampleRate() != 0)
+  {
+    sampleRate = readerPtr->getSampleRate();
+  } // if
+
+  histogramPtr = NULL;
+  deadline = 0;
+  lateBlocks = 0;
+
+  if (latencyHistogram)
+  {
+    histogramPtr = new LatencyHistogram();
+
+    if (sampleRate != 0)
+    {
+      // A block has to be processed before the next one arrives.
+      deadline = ((uint64_t)blockSize * 1000000000) / sampleRate;
+    } // if
+  } // if
+
+  countersPtr = NULL;
+
+  if (performanceCounters)
+  {
+    countersPtr = new PerformanceCounters();
+
+    if (!countersPtr->isAvailable())
+    {
+      fprintf(stderr,"Performance counters are not available.\n");
+      delete countersPtr;
+      countersPtr = NULL;
+    } // if
+  } // if
+
+  // The output has the same format as the input.
+  if (ioPtr != NULL)
+  {
+    writerPtr = new SampleWriter(ioPtr,
+                                 readerPtr->getContainer(),
+                                 readerPtr->getFormat(),
+                                 numberOfChannels,
+                                 readerPtr->getSampleRate(),
+                                 FULL_SCALE);
+  } // if
+  else
+  {
+    writerPtr = new SampleWriter(stdout,
+                                 readerPtr->getContainer(),
+                                 readerPtr->getFormat(),
+                                 numberOfChannels,
+                                 readerPtr->getSampleRate(),
+                                 FULL_SCALE);
+  } // else
+
+  // This is used to account for the output at each checkpoint.
+  outputFrameSize = numberOfChannels *
+    SampleConverter::getSampleSize(readerPtr->getFormat());
+
+  if (numberOfSegments > 0)
+  {
+    // The whole input is processed at once, so there is no stream loop.
+    processSegments(readerPtr,writerPtr,numberOfChannels,parameters);
+
+    writerPtr->close();
+
+    delete writerPtr;
+    delete readerPtr;
+
+    if (ioPtr != NULL)
+    {
+      if (ioPtr->hasFailed())
+      {
+        fprintf(stderr,"An I/O error occurred.\n");
+      } // if
+
+      delete ioPtr;
+    } // if
+
+    return (0);
+  } // if
+
+  // Interleaved I/Q pairs are processed directly by a complex canceller.
+  iqCancellerPtr = NULL;
+
+  if (iqMode)
+  {
+    iqCancellerPtr = new ComplexNlmsNoiseCanceller(filterOrder,delay,beta);
+
+    // The complex canceller replaces the per-channel cancellers.
+    numberOfChannels = 0;
+  } // if
+
+  // In dual-input mode, one canceller filters the reference.
+  dualCancellerPtr = NULL;
+  primaryBufferPtr = NULL;
+  referenceBufferPtr = NULL;
+
+  if (referenceFileName != NULL)
+  {
+    // The delay line is not used, so it is given no delay.
+    dualCancellerPtr = new NlmsNoiseCanceller(filterOrder,0,beta);
+
+    configureCanceller(dualCancellerPtr,parameters);
+
+    if (stereoReference)
+    {
+      primaryBufferPtr = (float *)SampleConverter::allocateAligned(
+        blockSize * sizeof(float));
+    } // if
+
+    referenceBufferPtr = (float *)SampleConverter::allocateAligned(
+      blockSize * sizeof(float));
+
+    dualInputPtrs[0] = primaryBufferPtr;
+    dualInputPtrs[1] = referenceBufferPtr;
+
+    // The dual-input canceller replaces the per-channel cancellers.
+    numberOfChannels = 0;
+  } // if
+
+  // Don't create threads that have nothing to do.
+  if (numberOfThreads > numberOfChannels)
+  {
+    numberOfThreads = numberOfChannels;
+  } // if
+
+  if (numberOfThreads < 1)
+  {
+    numberOfThreads = 1;
+  } // if
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Set up the channels.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  context.numberOfChannels = numberOfChannels;
+  context.numberOfThreads = numberOfThreads;
+  context.done = false;
+  context.cancellerPtrs = new NlmsNoiseCanceller *[numberOfChannels];
+  context.multirateCancellerPtrs = NULL;
+  context.cascadePtrs = NULL;
+  context.channelInputPtrs = new float *[numberOfChannels];
+  context.channelOutputPtrs = new float *[numberOfChannels];
+
+  // Interleaved block buffers.
+  inputBufferPtr = (float *)SampleConverter::allocateAligned(
+    blockSize * readerPtr->getNumberOfChannels() * sizeof(float));
+  outputBufferPtr = (float *)SampleConverter::allocateAligned(
+    blockSize * readerPtr->getNumberOfChannels() * sizeof(float));
+
+  if (decimationFactor > 1)
+  {
+    context.multirateCancellerPtrs =
+      new MultirateNoiseCanceller *[numberOfChannels];
+
+    // The order and the delay are given at the input rate.
+    filterOrder = filterOrder / decimationFactor;
+    delay = delay / decimationFactor;
+
+    if (filterOrder < 1)
+    {
+      filterOrder = 1;
+    } // if
+  } // if
+
+  if (cascadeSpecification != NULL)
+  {
+    context.cascadePtrs = new CascadedNoiseCanceller *[numberOfChannels];
+  } // if
+
+  // All of the cancellers share one contiguous block of storage.  The
+  // reduced rate stages and the cascades manage the storage of their own
+  // cancellers.
+  if ((context.multirateCancellerPtrs != NULL) ||
+      (context.cascadePtrs != NULL))
+  {
+    arenaPtr = new MemoryArena(0);
+  } // if
+  else
+  {
+    arenaPtr = new MemoryArena(numberOfChannels *
+      NlmsNoiseCanceller::getStorageRequirement(filterOrder,delay));
+  } // else
+
+  for (c = 0; c < numberOfChannels; c++)
+  {
+    if (context.cascadePtrs != NULL)
+    {
+      // Instantiate a cascade, and pipeline its stages.
+      context.cascadePtrs[c] = new CascadedNoiseCanceller(numberOfStages,
+                                                          filterOrders,
+                                                          delays,
+                                                          betas);
+      context.cascadePtrs[c]->setNumberOfThreads(stageThreads);
+      context.cancellerPtrs[c] = context.cascadePtrs[c]->getStage(0);
+    } // if
+    else if (context.multirateCancellerPtrs != NULL)
+    {
+      // Instantiate a reduced rate stage, and configure its canceller.
+      context.multirateCancellerPtrs[c] =
+        new MultirateNoiseCanceller(decimationFactor,filterOrder,delay,beta);
+      context.cancellerPtrs[c] =
+        context.multirateCancellerPtrs[c]->getCanceller();
+    } // else if
+    else
+    {
+      // Instantiate a noise canceller.
+      context.cancellerPtrs[c] =
+        new NlmsNoiseCanceller(filterOrder,delay,beta,arenaPtr);
+    } // else
+
+    // Every stage of a cascade gets the same modes.
+    for (s = 0; s < numberOfStages; s++)
+    {
+      stagePtr = context.cancellerPtrs[c];
+
+      if (context.cascadePtrs != NULL)
+      {
+        stagePtr = context.cascadePtrs[c]->getStage(s);
+      } // if
+
+      configureCanceller(stagePtr,parameters);
+    } // for
+
+    if (numberOfChannels == 1)
+    {
+      // No transpose is needed, so process the block buffers directly.
+      context.channelInputPtrs[c] = inputBufferPtr;
+      context.channelOutputPtrs[c] = outputBufferPtr;
+    } // if
+    else
+    {
+      context.channelInputPtrs[c] = (float *)SampleConverter::allocateAligned(
+        blockSize * sizeof(float));
+      context.channelOutputPtrs[c] = (float *)SampleConverter::allocateAligned(
+        blockSize * sizeof(float));
+    } // else
+  } // for
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  if (checkpointStreamPtr != NULL)
+  {
+    // Carry on from the checkpoint.
+    if (!readCancellerStates(checkpointStreamPtr,&context,dualCancellerPtr))
+    {
+      fprintf(stderr,"The checkpoint doesn't match the parameters.\n");
+      return (1);
+    } // if
+
+    fclose(checkpointStreamPtr);
+
+    // Discard the output that followed the checkpoint.
+    if (!truncateOutput(outputOffset))
+    {
+      fprintf(stderr,"Can't truncate the output.\n");
+      return (1);
+    } // if
+
+    // Skip the input that has already been processed.
+    for (framesSkipped = 0; framesSkipped < framesConsumed;
+         framesSkipped += count)
+    {
+      count = blockSize;
+
+      if ((framesConsumed - framesSkipped) < count)
+      {
+        count = framesConsumed - framesSkipped;
+      } // if
+
+      count = readerPtr->readFrames(inputBufferPtr,count);
+
+      if (count == 0)
+      {
+        fprintf(stderr,"The input ends before the checkpoint.\n");
+        return (1);
+      } // if
+
+      if (referenceReaderPtr != NULL)
+      {
+        referenceReaderPtr->readFrames(referenceBufferPtr,count);
+      } // if
+    } // for
+  } // if
+
+  nextCheckpoint = framesConsumed + checkpointInterval;
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Start the worker threads.  The main thread acts as thread 0.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  threadsPtr = NULL;
+  workerArgumentsPtr = NULL;
+
+  if (numberOfThreads > 1)
+  {
+    pthread_barrier_init(&context.startBarrier,NULL,numberOfThreads);
+    pthread_barrier_init(&context.doneBarrier,NULL,numberOfThreads);
+
+    threadsPtr = new pthread_t[numberOfThreads];
+    workerArgumentsPtr = new struct WorkerArguments[numberOfThreads];
+
+    for (c = 1; c < numberOfThreads; c++)
+    {
+      workerArgumentsPtr[c].contextPtr = &context;
+      workerArgumentsPtr[c].threadIndex = c;
+      pthread_create(&threadsPtr[c],NULL,channelWorker,&workerArgumentsPtr[c]);
+    } // for
+  } // if
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  // Set up for oop entry
+  done = false;
+
+  while (!done)
+  {
+    // Read a block of input samples.
+    count = readerPtr->readFrames(inputBufferPtr,blockSize);
+
+    if (count == 0)
+    {
+      // We're done.
+      done = true;
+    } // if
+    else
+    {
+      if (histogramPtr != NULL)
+      {
+        clock_gettime(CLOCK_MONOTONIC,&startTime);
+      } // if
+
+      // The events are counted inside the timed interval, so that they
+      // cover only the processing.
+      if (countersPtr != NULL)
+      {
+        countersPtr->start();
+      } // if
+
+      if (iqCancellerPtr != NULL)
+      {
+        DenormalGuard guard(denormalProtection);
+
+        // Remove the noise from the complex signal.
+        iqCancellerPtr->acceptData(inputBufferPtr,count,outputBufferPtr);
+      } // if
+      else if (dualCancellerPtr != NULL)
+      {
+        if (stereoReference)
+        {
+          // Split the primary from the reference.
+          SampleConverter::deinterleave(inputBufferPtr,
+                                        2,
+                                        count,
+                                        dualInputPtrs);
+        } // if
+        else
+        {
+          // The input is the primary.  A reference that ends early is
+          // treated as silence.
+          referenceCount =
+            referenceReaderPtr->readFrames(referenceBufferPtr,count);
+
+          for (i = referenceCount; i < count; i++)
+          {
+            referenceBufferPtr[i] = 0;
+          } // for
+
+          primaryBufferPtr = inputBufferPtr;
+        } // else
+
+        // Remove the noise that is correlated with the reference.
+        dualCancellerPtr->acceptData(primaryBufferPtr,
+                                     referenceBufferPtr,
+                                     count,
+                                     outputBufferPtr);
+      } // else if
+      else
+      {
+        if (numberOfChannels > 1)
+        {
+          SampleConverter::deinterleave(inputBufferPtr,
+                                        numberOfChannels,
+                                        count,
+                                        context.channelInputPtrs);
+        } // if
+
+        context.count = count;
+
+        if (numberOfThreads > 1)
+        {
+          // Release the workers.
+          pthread_barrier_wait(&context.startBarrier);
+        } // if
+
+        processChannels(&context,0);
+
+        if (numberOfThreads > 1)
+        {
+          // Wait for the workers to finish.
+          pthread_barrier_wait(&context.doneBarrier);
+        } // if
+
+        if (numberOfChannels > 1)
+        {
+          SampleConverter::interleave(context.channelOutputPtrs,
+                                      numberOfChannels,
+                                      count,
+                                      outputBufferPtr);
+        } // if
+      } // else
+
+      if (countersPtr != NULL)
+      {
+        countersPtr->stop(count * readerPtr->getNumberOfChannels());
+      } // if
+
+      if (histogramPtr != NULL)
+      {
+        clock_gettime(CLOCK_MONOTONIC,&endTime);
+
+        elapsedTime = ((endTime.tv_sec - startTime.tv_sec) * 1000000000LL) +
+                      (endTime.tv_nsec - startTime.tv_nsec);
+
+        histogramPtr->record(elapsedTime);
+
+        if ((deadline != 0) && (elapsedTime > deadline))
+        {
+          lateBlocks++;
+        } // if
+      } // if
+
+      // Output the filtered data.
+      writerPtr->writeFrames(outputBufferPtr,count);
+
+      framesConsumed += count;
+      outputOffset += (uint64_t)count * outputFrameSize;
+
+      if ((checkpointFileName != NULL) && (framesConsumed >= nextCheckpoint))
+      {
+        if (!saveCheckpoint(checkpointFileName,
+                            framesConsumed,
+                            outputOffset,
+                            writerPtr,
+                            &context,
+                            dualCancellerPtr))
+        {
+          fprintf(stderr,"Can't save checkpoint %s.\n",checkpointFileName);
+        } // if
+
+        nextCheckpoint = framesConsumed + checkpointInterval;
+      } // if
+    } // else
+  } // while
+
+  // Finalize the output header.
+  writerPtr->close();
+
+  if (histogramPtr != NULL)
+  {
+    displayLatencyHistogram(histogramPtr,blockSize,sampleRate,lateBlocks);
+    delete histogramPtr;
+  } // if
+
+  if (countersPtr != NULL)
+  {
+    displayPerformanceCounters(countersPtr);
+    delete countersPtr;
+  } // if
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Stop the worker threads.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  if (numberOfThreads > 1)
+  {
+    context.done = true;
+    pthread_barrier_wait(&context.startBarrier);
+
+    for (c = 1; c < numberOfThreads; c++)
+    {
+      pthread_join(threadsPtr[c],NULL);
+    } // for
+
+    pthread_barrier_destroy(&context.startBarrier);
+    pthread_barrier_destroy(&context.doneBarrier);
+
+    delete[] threadsPtr;
+    delete[] workerArgumentsPtr;
+  } // if
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Release resources.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  for (c = 0; c < numberOfChannels; c++)
+  {
+    if (context.cascadePtrs != NULL)
+    {
+      // This also releases the cancellers of the stages.
+      delete context.cascadePtrs[c];
+    } // if
+    else if (context.multirateCancellerPtrs != NULL)
+    {
+      // This also releases the canceller of the stage.
+      delete context.multirateCancellerPtrs[c];
+    } // else if
+    else
+    {
+      delete context.cancellerPtrs[c];
+    } // else
+
+    if (numberOfChannels > 1)
+    {
+      SampleConverter::releaseAligned(context.channelInputPtrs[c]);
+      SampleConverter::releaseAligned(context.channelOutputPtrs[c]);
+    } // if
+  } // for
+
+  if (iqCancellerPtr != NULL)
+  {
+    delete iqCancellerPtr;
+  } // if
+
+  if (dualCancellerPtr != NULL)
+  {
+    delete dualCancellerPtr;
+
+    if (stereoReference)
+    {
+      SampleConverter::releaseAligned(primaryBufferPtr);
+    } // if
+
+    SampleConverter::releaseAligned(referenceBufferPtr);
+  } // if
+
+  if (referenceReaderPtr != NULL)
+  {
+    delete referenceReaderPtr;
+    fclose(referenceStreamPtr);
+  } // if
+
+  // The cancellers are gone, so their storage can be released.
+  delete arenaPtr;
+
+  if (context.multirateCancellerPtrs != NULL)
+  {
+    delete[] context.multirateCancellerPtrs;
+  } // if
+
+  if (context.cascadePtrs != NULL)
+  {
+    delete[] context.cascadePtrs;
+  } // if
+
+  delete[] context.cancellerPtrs;
+  delete[] context.channelInputPtrs;
+  delete[] context.channelOutputPtrs;
+
+  SampleConverter::releaseAligned(inputBufferPtr);
+  SampleConverter::releaseAligned(outputBufferPtr);
+
+  delete writerPtr;
+  delete readerPtr;
+
+  if (ioPtr != NULL)
+  {
+    if (ioPtr->hasFailed())
+    {
+      fprintf(stderr,"An I/O error occurred.\n");
+    } // if
+
+    delete ioPtr;
   } // if
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
 
   return (0);
 
@@ -0,0 +1,896 @@
+//*************************************************************************
+// File name: regressionTest.cc
+//*************************************************************************
+
+//*************************************************************************
+// This program checks the noise canceller against golden outputs, and
+// it measures the throughput of the canceller in the same run, so that
+// a change that makes the canceller faster but wrong (or right but
+// slower) shows up immediately.  A fixed set of cases is run.  Some
+// cases process the speech file in the test directory, and the others
+// process a synthetic tone in white noise that is generated from an Nco
+// and rand() with a fixed seed.  Samples are presented to the canceller
+// with 16-bit full scale values, the same as noiseCanceller does.
+//
+// Each case is run several times with a new canceller.  The runs must
+// produce identical outputs, and the output of the first run is
+// compared with the golden output of the case.  The SNR of the output
+// relative to the golden output, in dB, and the largest absolute error,
+// in 16-bit units, must both be within their tolerances.  Throughput is
+// computed from the fastest run.  The program exits with a status of 1
+// if any case fails.
+//
+// Golden outputs are 32-bit float raw files named "<case>.f32" in the
+// golden directory.  After an intended change of the output, they are
+// recorded again with -w.
+//
+// To run this program type,
+//
+//     ./regressionTest -i inputFileName -g goldenDirectory -s minSnr
+//                      -e maxError -r repetitions -w,
+//
+// where,
+//
+//    inputFileName - The speech file (signed 16-bit little endian).
+//    The default is test/speechWithNoise.raw.
+//    goldenDirectory - The directory of the golden outputs.  The
+//    default is test/golden.
+//    minSnr - The smallest acceptable SNR in dB.  The default is 60.
+//    maxError - The largest acceptable absolute error in 16-bit units.
+//    The default is 1.
+//    repetitions - The number of runs of each case.  The default is 3.
+//    -w - Write the golden outputs rather than checking them.
+//*************************************************************************
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+
+#include "NlmsNoiseCanceller.h"
+#include "MultirateNoiseCanceller.h"
+#include "Nco.h"
+
+// This structure is used to consolidate user parameters.
+struct MyParameters
+{
+  char **inputFileNamePtr;
+  char **goldenDirectoryPtr;
+  float *minSnrPtr;
+  float *maxErrorPtr;
+  int *repetitionsPtr;
+  bool *recordPtr;
+};
+
+// The sources of input data.
+enum InputSource
+{
+  SOURCE_SPEECH,
+  SOURCE_TONE
+};
+
+// This structure describes one case.
+struct TestCase
+{
+  const char *namePtr;
+  InputSource source;
+  int filterOrder;
+  int delay;
+  float beta;
+
+  // A value of true selects the IPNLMS update with this alpha.
+  bool proportionateUpdate;
+  float alpha;
+
+  // A nonzero value selects the variable step-size policy.
+  float betaMin;
+
+  // A nonzero value enables the automatic freeze.
+  float freezeTolerance;
+
+  // A value greater than 1 runs the canceller at a reduced rate.
+  int decimationFactor;
+};
+
+// The number of samples per call to acceptData().  This matches the
+// default block size of noiseCanceller.
+#define BLOCK_SIZE (4000)
+
+// The synthetic input: a 440Hz tone at 8000S/s with a peak of a quarter
+// of full scale in uniform white noise of the same peak.
+#define TONE_SAMPLES (40000)
+#define TONE_SAMPLE_RATE (8000)
+#define TONE_FREQUENCY (440)
+#define TONE_AMPLITUDE (8192.0f)
+
+// The longest path name of a golden output.
+#define PATH_LENGTH (1024)
+
+static const TestCase testCases[] =
+{
+  // name                source        order delay beta
+  //   prop   alpha betaMin tolerance decimation
+  {"speech-nlms",      SOURCE_SPEECH,  8,  8, 0.1f,
+    false, 0,    0,      0,        1},
+  {"speech-ipnlms",    SOURCE_SPEECH, 64,  8, 0.1f,
+    true,  0,    0,      0,        1},
+  {"speech-decimated", SOURCE_SPEECH, 16,  8, 0.1f,
+    false, 0,    0,      0,        2},
+  {"tone-nlms",        SOURCE_TONE,   32, 32, 0.01f,
+    false, 0,    0,      0,        1},
+  {"tone-vss",         SOURCE_TONE,   32, 32, 0.05f,
+    false, 0,    0.005f, 0,        1},
+  {"tone-freeze",      SOURCE_TONE,   32, 32, 0.01f,
+    false, 0,    0,      0.1f,     1}
+};
+
+#define NUMBER_OF_CASES ((int)(sizeof(testCases) / sizeof(testCases[0])))
+
+/*****************************************************************************
+
+  Name: getUserArguments
+
+  Purpose: The purpose of this function is to retrieve the user arguments
+  that were passed to the program.  Any arguments that are specified are
+  set to reasonable default values.
+
+  Calling Sequence: exitProgram = getUserArguments(parameters)
+
+  Inputs:
+
+    parameters - A structure that contains pointers to the user parameters.
+
+  Outputs:
+
+    exitProgram - A flag that indicates whether or not the program should
+    be exited.  A value of true indicates to exit the program, and a value
+    of false indicates that the program should not be exited..
+
+*****************************************************************************/
+bool getUserArguments(int argc,char **argv,struct MyParameters parameters)
+{
+  bool exitProgram;
+  bool done;
+  int opt;
+
+  // Default not to exit program.
+  exitProgram = false;
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Default parameters.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Default to the files in the test directory.
+  *parameters.inputFileNamePtr = (char *)"test/speechWithNoise.raw";
+  *parameters.goldenDirectoryPtr = (char *)"test/golden";
+
+  // Default to tolerances that allow for a different order of
+  // floating point operations, but nothing more.
+  *parameters.minSnrPtr = 60;
+  *parameters.maxErrorPtr = 1;
+
+  // Default to enough runs for a stable throughput.
+  *parameters.repetitionsPtr = 3;
+
+  // Default to checking.
+  *parameters.recordPtr = false;
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  // Set up for loop entry.
+  done = false;
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Retrieve the command line arguments.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  while (!done)
+  {
+    // Retrieve the next option.
+    opt = getopt(argc,argv,"i:g:s:e:r:wh");
+
+    switch (opt)
+    {
+      case 'i':
+      {
+        *parameters.inputFileNamePtr = optarg;
+        break;
+      } // case
+
+      case 'g':
+      {
+        *parameters.goldenDirectoryPtr = optarg;
+        break;
+      } // case
+
+      case 's':
+      {
+        *parameters.minSnrPtr = atof(optarg);
+        break;
+      } // case
+
+      case 'e':
+      {
+        *parameters.maxErrorPtr = atof(optarg);
+        break;
+      } // case
+
+      case 'r':
+      {
+        *parameters.repetitionsPtr = atoi(optarg);
+        break;
+      } // case
+
+      case 'w':
+      {
+        *parameters.recordPtr = true;
+        break;
+      } // case
+
+      case 'h':
+      {
+        // Display usage.
+        fprintf(stderr,"./regressionTest -i inputFileName"
+                " -g goldenDirectory -s minSnr\n"
+                "                 -e maxError -r repetitions -w\n");
+
+        // Indicate that program must be exited.
+        exitProgram = true;
+        break;
+      } // case
+
+      case -1:
+      {
+        // All options consumed, so bail out.
+        done = true;
+      } // case
+    } // switch
+
+  } // while
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  if (*parameters.repetitionsPtr < 1)
+  {
+    *parameters.repetitionsPtr = 1;
+  } // if
+
+  return (exitProgram);
+
+} // getUserArguments
+
+/*****************************************************************************
+
+  Name: loadSpeech
+
+  Purpose: The purpose of this function is to load a file of signed
+  16-bit samples into memory as float values.
+
+  Calling Sequence: samplesPtr = loadSpeech(fileNamePtr,numberOfSamplesPtr)
+
+  Inputs:
+
+    fileNamePtr - The name of the file to load.
+
+    numberOfSamplesPtr - A pointer to storage for the number of samples
+    that were loaded.
+
+  Outputs:
+
+    samplesPtr - A pointer to the samples, or NULL if the file could
+    not be loaded.  The caller must release this storage with delete[].
+
+*****************************************************************************/
+static float *loadSpeech(const char *fileNamePtr,uint32_t *numberOfSamplesPtr)
+{
+  FILE *streamPtr;
+  long fileSize;
+  uint32_t i;
+  uint32_t numberOfSamples;
+  int16_t *integerSamplesPtr;
+  float *samplesPtr;
+
+  streamPtr = fopen(fileNamePtr,"rb");
+
+  if (streamPtr == NULL)
+  {
+    return (NULL);
+  } // if
+
+  // Determine the size of the file.
+  fseek(streamPtr,0,SEEK_END);
+  fileSize = ftell(streamPtr);
+  fseek(streamPtr,0,SEEK_SET);
+
+  numberOfSamples = (uint32_t)(fileSize / sizeof(int16_t));
+
+  samplesPtr = new float[numberOfSamples];
+  integerSamplesPtr = new int16_t[numberOfSamples];
+
+  numberOfSamples = fread(integerSamplesPtr,sizeof(int16_t),
+                          numberOfSamples,streamPtr);
+
+  for (i = 0; i < numberOfSamples; i++)
+  {
+    samplesPtr[i] = (float)integerSamplesPtr[i];
+  } // for
+
+  // We're done with this.
+  delete[] integerSamplesPtr;
+
+  fclose(streamPtr);
+
+  *numberOfSamplesPtr = numberOfSamples;
+
+  return (samplesPtr);
+
+} // loadSpeech
+
+/*****************************************************************************
+
+  Name: generateTone
+
+  Purpose: The purpose of this function is to generate the synthetic
+  input, a tone in uniform white noise.  The noise is taken from rand()
+  with a fixed seed, so the input is the same on every run.
+
+  Calling Sequence: samplesPtr = generateTone(numberOfSamples)
+
+  Inputs:
+
+    numberOfSamples - The number of samples to generate.
+
+  Outputs:
+
+    samplesPtr - A pointer to the samples.  The caller must release this
+    storage with delete[].
+
+*****************************************************************************/
+static float *generateTone(uint32_t numberOfSamples)
+{
+  uint32_t i;
+  float iValue, qValue;
+  float *samplesPtr;
+  Nco *myNcoPtr;
+
+  samplesPtr = new float[numberOfSamples];
+
+  myNcoPtr = new Nco(TONE_SAMPLE_RATE,TONE_FREQUENCY);
+
+  srand(1);
+
+  for (i = 0; i < numberOfSamples; i++)
+  {
+    myNcoPtr->run(&iValue,&qValue);
+
+    samplesPtr[i] = (TONE_AMPLITUDE * iValue) +
+      (2 * TONE_AMPLITUDE * (((float)rand() / RAND_MAX) - 0.5f));
+  } // for
+
+  delete myNcoPtr;
+
+  return (samplesPtr);
+
+} // generateTone
+
+/*****************************************************************************
+
+  Name: runCase
+
+  Purpose: The purpose of this function is to run a new canceller,
+  configured for a case, over the input of the case.
+
+  Calling Sequence: elapsedTime = runCase(casePtr,inputPtr,
+                                          numberOfSamples,outputPtr)
+
+  Inputs:
+
+    casePtr - A pointer to the case.
+
+    inputPtr - A pointer to the input samples.
+
+    numberOfSamples - The number of input samples.
+
+    outputPtr - A pointer to storage for the output samples.
+
+  Outputs:
+
+    elapsedTime - The time spent in acceptData(), in seconds.
+
+*****************************************************************************/
+static double runCase(const TestCase *casePtr,
+                      float *inputPtr,
+                      uint32_t numberOfSamples,
+                      float *outputPtr)
+{
+  uint32_t i;
+  uint32_t count;
+  int filterOrder;
+  int delay;
+  double elapsedTime;
+  struct timespec startTime, endTime;
+  NlmsNoiseCanceller *cancellerPtr;
+  MultirateNoiseCanceller *multirateCancellerPtr;
+
+  multirateCancellerPtr = NULL;
+
+  if (casePtr->decimationFactor > 1)
+  {
+    // The order and the delay are given at the input rate.
+    filterOrder = casePtr->filterOrder / casePtr->decimationFactor;
+    delay = casePtr->delay / casePtr->decimationFactor;
+
+    multirateCancellerPtr =
+      new MultirateNoiseCanceller(casePtr->decimationFactor,
+                                  filterOrder,
+                                  delay,
+                                  casePtr->beta);
+
+    cancellerPtr = multirateCancellerPtr->getCanceller();
+  } // if
+  else
+  {
+    cancellerPtr = new NlmsNoiseCanceller(casePtr->filterOrder,
+                                          casePtr->delay,
+                                          casePtr->beta);
+  } // else
+
+  if (casePtr->proportionateUpdate)
+  {
+    cancellerPtr->setProportionateUpdate(true,casePtr->alpha);
+  } // if
+
+  if (casePtr->betaMin > 0)
+  {
+    cancellerPtr->setVariableStepSize(true,casePtr->betaMin);
+  } // if
+
+  if (casePtr->freezeTolerance > 0)
+  {
+    cancellerPtr->setAutomaticFreeze(true,casePtr->freezeTolerance);
+  } // if
+
+  elapsedTime = 0;
+
+  for (i = 0; i < numberOfSamples; i += count)
+  {
+    count = BLOCK_SIZE;
+
+    if ((i + count) > numberOfSamples)
+    {
+      count = numberOfSamples - i;
+    } // if
+
+    clock_gettime(CLOCK_MONOTONIC,&startTime);
+
+    if (multirateCancellerPtr != NULL)
+    {
+      multirateCancellerPtr->acceptData(&inputPtr[i],count,&outputPtr[i]);
+    } // if
+    else
+    {
+      cancellerPtr->acceptData(&inputPtr[i],count,&outputPtr[i]);
+    } // else
+
+    clock_gettime(CLOCK_MONOTONIC,&endTime);
+
+    elapsedTime += (endTime.tv_sec - startTime.tv_sec) +
+                   ((endTime.tv_nsec - startTime.tv_nsec) / 1e9);
+  } // for
+
+  // Release resources.
+  if (multirateCancellerPtr != NULL)
+  {
+    delete multirateCancellerPtr;
+  } // if
+  else
+  {
+    delete cancellerPtr;
+  } // else
+
+  return (elapsedTime);
+
+} // runCase
+
+/*****************************************************************************
+
+  Name: toDecibels
+
+  Purpose: The purpose of this function is to compute a power ratio in
+  decibels.
+
+  Calling Sequence: ratio = toDecibels(numerator,denominator)
+
+  Inputs:
+
+    numerator - The power of the signal.
+
+    denominator - The power of the error.
+
+  Outputs:
+
+    ratio - The ratio in dB.  A perfect match is reported as 999 dB.
+
+*****************************************************************************/
+static double toDecibels(double numerator,double denominator)
+{
+  double ratio;
+
+  if (denominator <= 0)
+  {
+    // Avoid division by zero.
+    ratio = 999;
+  } // if
+  else
+  {
+    ratio = 10 * log10((numerator + 1e-30) / denominator);
+  } // else
+
+  return (ratio);
+
+} // toDecibels
+
+/*****************************************************************************
+
+  Name: compareOutput
+
+  Purpose: The purpose of this function is to compare an output with its
+  golden output.
+
+  Calling Sequence: compareOutput(outputPtr,goldenPtr,numberOfSamples,
+                                  snrPtr,maxErrorPtr)
+
+  Inputs:
+
+    outputPtr - A pointer to the output samples.
+
+    goldenPtr - A pointer to the golden samples.
+
+    numberOfSamples - The number of samples to compare.
+
+    snrPtr - A pointer to storage for the SNR of the output relative to
+    the golden output, in dB.
+
+    maxErrorPtr - A pointer to storage for the largest absolute error.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void compareOutput(float *outputPtr,
+                          float *goldenPtr,
+                          uint32_t numberOfSamples,
+                          double *snrPtr,
+                          double *maxErrorPtr)
+{
+  uint32_t i;
+  double signalEnergy;
+  double errorEnergy;
+  double error;
+
+  signalEnergy = 0;
+  errorEnergy = 0;
+  *maxErrorPtr = 0;
+
+  for (i = 0; i < numberOfSamples; i++)
+  {
+    error = (double)outputPtr[i] - goldenPtr[i];
+
+    signalEnergy += (double)goldenPtr[i] * goldenPtr[i];
+    errorEnergy += error * error;
+
+    if (fabs(error) > *maxErrorPtr)
+    {
+      *maxErrorPtr = fabs(error);
+    } // if
+  } // for
+
+  *snrPtr = toDecibels(signalEnergy,errorEnergy);
+
+  return;
+
+} // compareOutput
+
+/*****************************************************************************
+
+  Name: loadGolden
+
+  Purpose: The purpose of this function is to load the golden output of
+  a case.
+
+  Calling Sequence: success = loadGolden(pathPtr,goldenPtr,
+                                         numberOfSamples)
+
+  Inputs:
+
+    pathPtr - The path of the golden output.
+
+    goldenPtr - A pointer to storage for the golden samples.
+
+    numberOfSamples - The number of samples that the golden output must
+    contain.
+
+  Outputs:
+
+    success - A flag that indicates whether the golden output exists and
+    has the right length.
+
+*****************************************************************************/
+static bool loadGolden(const char *pathPtr,
+                       float *goldenPtr,
+                       uint32_t numberOfSamples)
+{
+  bool success;
+  uint32_t count;
+  float extra;
+  FILE *streamPtr;
+
+  streamPtr = fopen(pathPtr,"rb");
+
+  if (streamPtr == NULL)
+  {
+    return (false);
+  } // if
+
+  count = fread(goldenPtr,sizeof(float),numberOfSamples,streamPtr);
+
+  // The golden output must not be longer, either.
+  success = (count == numberOfSamples) &&
+            (fread(&extra,sizeof(float),1,streamPtr) == 0);
+
+  fclose(streamPtr);
+
+  return (success);
+
+} // loadGolden
+
+/*****************************************************************************
+
+  Name: saveGolden
+
+  Purpose: The purpose of this function is to record the golden output
+  of a case.
+
+  Calling Sequence: success = saveGolden(pathPtr,outputPtr,
+                                         numberOfSamples)
+
+  Inputs:
+
+    pathPtr - The path of the golden output.
+
+    outputPtr - A pointer to the output samples.
+
+    numberOfSamples - The number of samples.
+
+  Outputs:
+
+    success - A flag that indicates whether the golden output was
+    written.
+
+*****************************************************************************/
+static bool saveGolden(const char *pathPtr,
+                       float *outputPtr,
+                       uint32_t numberOfSamples)
+{
+  bool success;
+  FILE *streamPtr;
+
+  streamPtr = fopen(pathPtr,"wb");
+
+  if (streamPtr == NULL)
+  {
+    return (false);
+  } // if
+
+  success =
+    (fwrite(outputPtr,sizeof(float),numberOfSamples,streamPtr) ==
+     numberOfSamples);
+
+  if (fclose(streamPtr) != 0)
+  {
+    success = false;
+  } // if
+
+  return (success);
+
+} // saveGolden
+
+//*************************************************************************
+// Mainline code.
+//*************************************************************************
+int main(int argc,char **argv)
+{
+  int c;
+  int r;
+  bool exitProgram;
+  bool deterministic;
+  bool passed;
+  char *inputFileName;
+  char *goldenDirectory;
+  float minSnr;
+  float maxError;
+  int repetitions;
+  bool record;
+  int failures;
+  uint32_t speechSamples;
+  uint32_t numberOfSamples;
+  double elapsedTime;
+  double fastestTime;
+  double snr;
+  double largestError;
+  const char *resultPtr;
+  char path[PATH_LENGTH];
+  float *speechPtr;
+  float *tonePtr;
+  float *inputPtr;
+  float *outputPtr;
+  float *repeatPtr;
+  float *goldenPtr;
+  const TestCase *casePtr;
+  struct MyParameters parameters;
+
+  // Set up for parameter transmission.
+  parameters.inputFileNamePtr = &inputFileName;
+  parameters.goldenDirectoryPtr = &goldenDirectory;
+  parameters.minSnrPtr = &minSnr;
+  parameters.maxErrorPtr = &maxError;
+  parameters.repetitionsPtr = &repetitions;
+  parameters.recordPtr = &record;
+
+  // Retrieve the system parameters.
+  exitProgram = getUserArguments(argc,argv,parameters);
+
+  if (exitProgram)
+  {
+    // Bail out.
+    return (0);
+  } // if
+
+  speechPtr = loadSpeech(inputFileName,&speechSamples);
+
+  if (speechPtr == NULL)
+  {
+    fprintf(stderr,"Can't load %s.\n",inputFileName);
+    return (1);
+  } // if
+
+  tonePtr = generateTone(TONE_SAMPLES);
+
+  // Allocate enough storage for the longer input.
+  numberOfSamples = speechSamples;
+
+  if (numberOfSamples < TONE_SAMPLES)
+  {
+    numberOfSamples = TONE_SAMPLES;
+  } // if
+
+  outputPtr = new float[numberOfSamples];
+  repeatPtr = new float[numberOfSamples];
+  goldenPtr = new float[numberOfSamples];
+
+  failures = 0;
+
+  printf("%-18s %8s %9s %9s %11s  %s\n",
+         "case","samples","snr(dB)","maxError","Msamples/s","result");
+
+  for (c = 0; c < NUMBER_OF_CASES; c++)
+  {
+    casePtr = &testCases[c];
+
+    if (casePtr->source == SOURCE_SPEECH)
+    {
+      inputPtr = speechPtr;
+      numberOfSamples = speechSamples;
+    } // if
+    else
+    {
+      inputPtr = tonePtr;
+      numberOfSamples = TONE_SAMPLES;
+    } // else
+
+    //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+    // Run the case.
+    //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+    fastestTime = runCase(casePtr,inputPtr,numberOfSamples,outputPtr);
+    deterministic = true;
+
+    for (r = 1; r < repetitions; r++)
+    {
+      elapsedTime = runCase(casePtr,inputPtr,numberOfSamples,repeatPtr);
+
+      if (elapsedTime < fastestTime)
+      {
+        fastestTime = elapsedTime;
+      } // if
+
+      // Every run starts from a new canceller.
+      if (memcmp(outputPtr,repeatPtr,numberOfSamples * sizeof(float)) != 0)
+      {
+        deterministic = false;
+      } // if
+    } // for
+    //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+    //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+    // Check or record the output.
+    //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+    snprintf(path,sizeof(path),"%s/%s.f32",goldenDirectory,casePtr->namePtr);
+
+    snr = 0;
+    largestError = 0;
+    passed = false;
+
+    if (record)
+    {
+      if (saveGolden(path,outputPtr,numberOfSamples))
+      {
+        // A recorded output matches itself.
+        snr = 999;
+        passed = deterministic;
+        resultPtr = passed ? "recorded" : "FAIL (nondeterministic)";
+      } // if
+      else
+      {
+        resultPtr = "FAIL (can't write golden)";
+      } // else
+    } // if
+    else
+    {
+      if (loadGolden(path,goldenPtr,numberOfSamples))
+      {
+        compareOutput(outputPtr,goldenPtr,numberOfSamples,
+                      &snr,&largestError);
+
+        if (!deterministic)
+        {
+          resultPtr = "FAIL (nondeterministic)";
+        } // if
+        else if ((snr < minSnr) || (largestError > maxError))
+        {
+          resultPtr = "FAIL (tolerance)";
+        } // else if
+        else
+        {
+          passed = true;
+          resultPtr = "pass";
+        } // else
+      } // if
+      else
+      {
+        resultPtr = "FAIL (no golden)";
+      } // else
+    } // else
+
+    if (!passed)
+    {
+      failures++;
+    } // if
+    //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+    printf("%-18s %8u %9.1f %9.4f %11.2f  %s\n",
+           casePtr->namePtr,
+           numberOfSamples,
+           snr,
+           largestError,
+           (numberOfSamples / fastestTime) / 1e6,
+           resultPtr);
+  } // for
+
+  printf("\n%d of %d cases passed (minimum SNR %g dB, maximum error %g)\n",
+         NUMBER_OF_CASES - failures,NUMBER_OF_CASES,minSnr,maxError);
+
+  // Release resources.
+  delete[] speechPtr;
+  delete[] tonePtr;
+  delete[] outputPtr;
+  delete[] repeatPtr;
+  delete[] goldenPtr;
+
+  if (failures > 0)
+  {
+    return (1);
+  } // if
+
+  return (0);
+
+} // main
@@ -0,0 +1,581 @@
+//*************************************************************************
+// File name: rlsBenchmark.cc
+//*************************************************************************
+
+//*************************************************************************
+// This program compares the NLMS canceller with the transversal and the
+// lattice RLS cancellers at matched filter orders.  The input is a tone
+// in colored noise, which is white noise passed through a one-pole
+// lowpass filter.  The closer the pole is to 1, the more colored the
+// noise is, and the more slowly NLMS converges.
+//
+// The convergence of each canceller is displayed as its error, the
+// power of the difference between the reference signal and the output
+// of the canceller relative to the power of the reference, in dB, over
+// successive intervals.  The largest difference between the outputs of
+// the two RLS cancellers is displayed as well, since they compute the
+// same estimate in exact arithmetic.  Then, the processing time per
+// sample of each canceller is displayed for a range of filter orders.
+//
+// To run this program type,
+//
+//     ./rlsBenchmark -o filterOrder -d delay -b beta -l lambda
+//                    -g delta -p pole -n numberOfSamples
+//                    -i reportInterval,
+//
+// where,
+//
+//    filterOrder - The order of the adaptive filters.
+//    delay - The delay that is used to generate the reference signal.
+//    beta - The convergence factor of NLMS.
+//    lambda - The forgetting factor of RLS.
+//    delta - The regularization of RLS.
+//    pole - The pole of the filter that colors the noise, in the range
+//    of [0,1).
+//    numberOfSamples - The number of samples for the convergence run.
+//    reportInterval - The number of samples between reports.
+//*************************************************************************
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+
+#include "NlmsNoiseCanceller.h"
+#include "RlsNoiseCanceller.h"
+
+// This structure is used to consolidate user parameters.
+struct MyParameters
+{
+  int *filterOrderPtr;
+  int *delayPtr;
+  float *betaPtr;
+  float *lambdaPtr;
+  float *deltaPtr;
+  float *polePtr;
+  int *numberOfSamplesPtr;
+  int *reportIntervalPtr;
+};
+
+// The number of cancellers that are compared.
+#define NUMBER_OF_CONFIGURATIONS (3)
+
+// The number of samples per call to acceptData().
+#define BLOCK_SIZE (250)
+
+// The tone, in cycles per sample, and the peak values of the tone and
+// of the white noise that drives the coloring filter, in 16-bit units.
+#define TONE_FREQUENCY (0.05)
+#define TONE_AMPLITUDE (3000.0f)
+#define NOISE_AMPLITUDE (1000.0f)
+
+// The number of samples per filter order of the throughput runs.
+#define THROUGHPUT_SAMPLES (20000)
+
+static const char *configurationNames[NUMBER_OF_CONFIGURATIONS] =
+{
+  "nlms",
+  "rls",
+  "lattice"
+};
+
+// The filter orders of the throughput runs.
+static const int throughputOrders[] = {4, 8, 16, 32, 64};
+
+#define NUMBER_OF_ORDERS \
+  ((int)(sizeof(throughputOrders) / sizeof(throughputOrders[0])))
+
+/*****************************************************************************
+
+  Name: getUserArguments
+
+  Purpose: The purpose of this function is to retrieve the user arguments
+  that were passed to the program.  Any arguments that are specified are
+  set to reasonable default values.
+
+  Calling Sequence: exitProgram = getUserArguments(parameters)
+
+  Inputs:
+
+    parameters - A structure that contains pointers to the user parameters.
+
+  Outputs:
+
+    exitProgram - A flag that indicates whether or not the program should
+    be exited.  A value of true indicates to exit the program, and a value
+    of false indicates that the program should not be exited..
+
+*****************************************************************************/
+bool getUserArguments(int argc,char **argv,struct MyParameters parameters)
+{
+  bool exitProgram;
+  bool done;
+  int opt;
+
+  // Default not to exit program.
+  exitProgram = false;
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Default parameters.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Default to a short filter, which is where RLS pays off.
+  *parameters.filterOrderPtr = 16;
+  *parameters.delayPtr = 16;
+
+  // Default to a convergence rate of something reasonable.
+  *parameters.betaPtr = 0.1;
+
+  // Default to a memory of about 1000 samples.
+  *parameters.lambdaPtr = 0.999;
+
+  // Default to about the energy of one sample of the noise.
+  *parameters.deltaPtr = 10000;
+
+  // Default to strongly colored noise.
+  *parameters.polePtr = 0.95;
+
+  // Default to one second at 8000S/s.
+  *parameters.numberOfSamplesPtr = 8000;
+
+  // Default to reporting every 62.5ms.
+  *parameters.reportIntervalPtr = 500;
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  // Set up for loop entry.
+  done = false;
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Retrieve the command line arguments.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  while (!done)
+  {
+    // Retrieve the next option.
+    opt = getopt(argc,argv,"o:d:b:l:g:p:n:i:h");
+
+    switch (opt)
+    {
+      case 'o':
+      {
+        *parameters.filterOrderPtr = atoi(optarg);
+        break;
+      } // case
+
+      case 'd':
+      {
+        *parameters.delayPtr = atoi(optarg);
+        break;
+      } // case
+
+      case 'b':
+      {
+        *parameters.betaPtr = atof(optarg);
+        break;
+      } // case
+
+      case 'l':
+      {
+        *parameters.lambdaPtr = atof(optarg);
+        break;
+      } // case
+
+      case 'g':
+      {
+        *parameters.deltaPtr = atof(optarg);
+        break;
+      } // case
+
+      case 'p':
+      {
+        *parameters.polePtr = atof(optarg);
+        break;
+      } // case
+
+      case 'n':
+      {
+        *parameters.numberOfSamplesPtr = atoi(optarg);
+        break;
+      } // case
+
+      case 'i':
+      {
+        *parameters.reportIntervalPtr = atoi(optarg);
+        break;
+      } // case
+
+      case 'h':
+      {
+        // Display usage.
+        fprintf(stderr,"./rlsBenchmark -o filterOrder -d delay -b beta"
+                " -l lambda\n"
+                "               -g delta -p pole -n numberOfSamples"
+                " -i reportInterval\n");
+
+        // Indicate that program must be exited.
+        exitProgram = true;
+        break;
+      } // case
+
+      case -1:
+      {
+        // All options consumed, so bail out.
+        done = true;
+      } // case
+    } // switch
+
+  } // while
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  // Reports fall on block boundaries.
+  if (*parameters.reportIntervalPtr < BLOCK_SIZE)
+  {
+    *parameters.reportIntervalPtr = BLOCK_SIZE;
+  } // if
+
+  *parameters.reportIntervalPtr -=
+    *parameters.reportIntervalPtr % BLOCK_SIZE;
+
+  return (exitProgram);
+
+} // getUserArguments
+
+/*****************************************************************************
+
+  Name: generateSignal
+
+  Purpose: The purpose of this function is to generate a tone in colored
+  noise.  The noise is taken from rand() with a fixed seed, so every run
+  sees the same input.
+
+  Calling Sequence: generateSignal(signalPtr,numberOfSamples,pole)
+
+  Inputs:
+
+    signalPtr - A pointer to storage for the samples.
+
+    numberOfSamples - The number of samples to generate.
+
+    pole - The pole of the filter that colors the noise.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void generateSignal(float *signalPtr,int numberOfSamples,float pole)
+{
+  int i;
+  float noise;
+
+  srand(1);
+  noise = 0;
+
+  for (i = 0; i < numberOfSamples; i++)
+  {
+    noise = (pole * noise) +
+      (2 * NOISE_AMPLITUDE * (((float)rand() / RAND_MAX) - 0.5f));
+
+    signalPtr[i] = (TONE_AMPLITUDE * cos(2 * M_PI * TONE_FREQUENCY * i)) +
+      noise;
+  } // for
+
+  return;
+
+} // generateSignal
+
+/*****************************************************************************
+
+  Name: runCanceller
+
+  Purpose: The purpose of this function is to run one of the cancellers
+  over a block of samples.
+
+  Calling Sequence: runCanceller(configuration,nlmsPtr,rlsPtr,latticePtr,
+                                 inputPtr,count,outputPtr)
+
+  Inputs:
+
+    configuration - The index of the canceller to run.
+
+    nlmsPtr - A pointer to the NLMS canceller.
+
+    rlsPtr - A pointer to the transversal RLS canceller.
+
+    latticePtr - A pointer to the lattice RLS canceller.
+
+    inputPtr - A pointer to the input samples.
+
+    count - The number of samples.
+
+    outputPtr - A pointer to storage for the output samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void runCanceller(int configuration,
+                         NlmsNoiseCanceller *nlmsPtr,
+                         RlsNoiseCanceller *rlsPtr,
+                         RlsNoiseCanceller *latticePtr,
+                         float *inputPtr,
+                         int count,
+                         float *outputPtr)
+{
+
+  switch (configuration)
+  {
+    case 0:
+    {
+      nlmsPtr->acceptData(inputPtr,count,outputPtr);
+      break;
+    } // case
+
+    case 1:
+    {
+      rlsPtr->acceptData(inputPtr,count,outputPtr);
+      break;
+    } // case
+
+    default:
+    {
+      latticePtr->acceptData(inputPtr,count,outputPtr);
+      break;
+    } // case
+  } // switch
+
+  return;
+
+} // runCanceller
+
+//*************************************************************************
+// Mainline code.
+//*************************************************************************
+int main(int argc,char **argv)
+{
+  int i, j;
+  int c;
+  int k;
+  bool exitProgram;
+  int filterOrder;
+  int delay;
+  float beta;
+  float lambda;
+  float delta;
+  float pole;
+  int numberOfSamples;
+  int reportInterval;
+  int count;
+  int totalSamples;
+  double difference;
+  double referenceEnergy;
+  double largestDifference;
+  double errorEnergy[NUMBER_OF_CONFIGURATIONS];
+  double elapsedTime[NUMBER_OF_CONFIGURATIONS];
+  float *signalPtr;
+  float *outputPtrs[NUMBER_OF_CONFIGURATIONS];
+  struct timespec startTime, endTime;
+  NlmsNoiseCanceller *nlmsPtr;
+  RlsNoiseCanceller *rlsPtr;
+  RlsNoiseCanceller *latticePtr;
+  struct MyParameters parameters;
+
+  // Set up for parameter transmission.
+  parameters.filterOrderPtr = &filterOrder;
+  parameters.delayPtr = &delay;
+  parameters.betaPtr = &beta;
+  parameters.lambdaPtr = &lambda;
+  parameters.deltaPtr = &delta;
+  parameters.polePtr = &pole;
+  parameters.numberOfSamplesPtr = &numberOfSamples;
+  parameters.reportIntervalPtr = &reportInterval;
+
+  // Retrieve the system parameters.
+  exitProgram = getUserArguments(argc,argv,parameters);
+
+  if (exitProgram)
+  {
+    // Bail out.
+    return (0);
+  } // if
+
+  // The throughput runs may be longer than the convergence run.
+  totalSamples = numberOfSamples;
+
+  if (totalSamples < THROUGHPUT_SAMPLES)
+  {
+    totalSamples = THROUGHPUT_SAMPLES;
+  } // if
+
+  signalPtr = new float[totalSamples];
+
+  for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+  {
+    outputPtrs[c] = new float[BLOCK_SIZE];
+  } // for
+
+  generateSignal(signalPtr,totalSamples,pole);
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Convergence.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  nlmsPtr = new NlmsNoiseCanceller(filterOrder,delay,beta);
+  rlsPtr = new RlsNoiseCanceller(filterOrder,delay,lambda,delta,
+                                 RLS_TRANSVERSAL);
+  latticePtr = new RlsNoiseCanceller(filterOrder,delay,lambda,delta,
+                                     RLS_LATTICE);
+
+  printf("order %d, delay %d, beta %g, lambda %g, delta %g, pole %g\n\n",
+         filterOrder,delay,beta,lambda,delta,pole);
+
+  printf("%10s","samples");
+  for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+  {
+    printf(" %10s(dB)",configurationNames[c]);
+  } // for
+  printf(" %16s\n","rls-lattice(dB)");
+
+  referenceEnergy = 0;
+  largestDifference = 0;
+
+  for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+  {
+    errorEnergy[c] = 0;
+  } // for
+
+  for (i = 0; i < numberOfSamples; i += count)
+  {
+    count = BLOCK_SIZE;
+    if ((i + count) > numberOfSamples)
+    {
+      count = numberOfSamples - i;
+    } // if
+
+    for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+    {
+      runCanceller(c,nlmsPtr,rlsPtr,latticePtr,
+                   &signalPtr[i],count,outputPtrs[c]);
+
+      // The output is an estimate of the reference, x(n - delay).
+      for (j = 0; j < count; j++)
+      {
+        difference = outputPtrs[c][j];
+
+        if ((i + j) >= delay)
+        {
+          difference -= signalPtr[i + j - delay];
+        } // if
+
+        errorEnergy[c] += difference * difference;
+      } // for
+    } // for
+
+    for (j = 0; j < count; j++)
+    {
+      if ((i + j) >= delay)
+      {
+        referenceEnergy +=
+          signalPtr[i + j - delay] * signalPtr[i + j - delay];
+      } // if
+
+      difference = fabs(outputPtrs[1][j] - outputPtrs[2][j]);
+
+      if (difference > largestDifference)
+      {
+        largestDifference = difference;
+      } // if
+    } // for
+
+    if ((((i + count) % reportInterval) == 0) ||
+        ((i + count) == numberOfSamples))
+    {
+      printf("%10d",i + count);
+
+      for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+      {
+        printf(" %14.1f",
+               10 * log10((errorEnergy[c] + 1e-30) /
+                          (referenceEnergy + 1e-30)));
+        errorEnergy[c] = 0;
+      } // for
+
+      // Display the largest difference relative to the tone.
+      printf(" %16.1f\n",
+             20 * log10((largestDifference + 1e-30) / TONE_AMPLITUDE));
+
+      referenceEnergy = 0;
+      largestDifference = 0;
+    } // if
+  } // for
+
+  delete nlmsPtr;
+  delete rlsPtr;
+  delete latticePtr;
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Throughput.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  printf("\n%10s","order");
+  for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+  {
+    printf(" %7s(ns/sample)",configurationNames[c]);
+  } // for
+  printf("\n");
+
+  for (k = 0; k < NUMBER_OF_ORDERS; k++)
+  {
+    nlmsPtr = new NlmsNoiseCanceller(throughputOrders[k],
+                                     throughputOrders[k],
+                                     beta);
+    rlsPtr = new RlsNoiseCanceller(throughputOrders[k],
+                                   throughputOrders[k],
+                                   lambda,
+                                   delta,
+                                   RLS_TRANSVERSAL);
+    latticePtr = new RlsNoiseCanceller(throughputOrders[k],
+                                       throughputOrders[k],
+                                       lambda,
+                                       delta,
+                                       RLS_LATTICE);
+
+    printf("%10d",throughputOrders[k]);
+
+    for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+    {
+      elapsedTime[c] = 0;
+
+      for (i = 0; i < THROUGHPUT_SAMPLES; i += BLOCK_SIZE)
+      {
+        clock_gettime(CLOCK_MONOTONIC,&startTime);
+        runCanceller(c,nlmsPtr,rlsPtr,latticePtr,
+                     &signalPtr[i],BLOCK_SIZE,outputPtrs[c]);
+        clock_gettime(CLOCK_MONOTONIC,&endTime);
+
+        elapsedTime[c] += (endTime.tv_sec - startTime.tv_sec) +
+                          ((endTime.tv_nsec - startTime.tv_nsec) / 1e9);
+      } // for
+
+      printf(" %18.1f",(elapsedTime[c] * 1e9) / THROUGHPUT_SAMPLES);
+    } // for
+
+    printf("\n");
+
+    delete nlmsPtr;
+    delete rlsPtr;
+    delete latticePtr;
+  } // for
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  // Release resources.
+  delete[] signalPtr;
+
+  for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+  {
+    delete[] outputPtrs[c];
+  } // for
+
+  return (0);
+
+} // main
@@ -0,0 +1,399 @@
+//*************************************************************************
+// File name: sparseBenchmark.cc
+//*************************************************************************
+
+//*************************************************************************
+// This program compares the convergence and the cost of the NLMS update
+// with the proportionate (IPNLMS) update on a long, sparse noise path.
+// The canceller is driven with white noise, so the ideal coefficients
+// are a single unit tap at the reference delay, and all other taps are
+// zero.  Three configurations are run: NLMS, IPNLMS, and IPNLMS with the
+// active-tap mask.  The misalignment of the coefficients,
+//
+//    10 log10(||w - wIdeal||^2 / ||wIdeal||^2),
+//
+// and the number of active taps are displayed at regular intervals,
+// followed by the processing time per sample of each configuration.
+//
+// To run this program type,
+//
+//     ./sparseBenchmark -o filterOrder -d delay -b beta -p alpha
+//                       -a activeTapThreshold -n numberOfSamples
+//                       -i reportInterval,
+//
+// where,
+//
+//    filterOrder - The order of the adaptive filter.
+//    delay - The delay that is used to generate the reference signal.
+//    beta - The convergence factor.
+//    alpha - The IPNLMS mixing parameter in the range of [-1,1).
+//    activeTapThreshold - The relative threshold of the active-tap mask.
+//    numberOfSamples - The number of samples to process.
+//    reportInterval - The number of samples between reports.
+//*************************************************************************
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+
+#include "NlmsNoiseCanceller.h"
+
+// This structure is used to consolidate user parameters.
+struct MyParameters
+{
+  int *filterOrderPtr;
+  int *delayPtr;
+  float *betaPtr;
+  float *alphaPtr;
+  float *activeTapThresholdPtr;
+  int *numberOfSamplesPtr;
+  int *reportIntervalPtr;
+};
+
+// The number of configurations that are compared.
+#define NUMBER_OF_CONFIGURATIONS (3)
+
+// The number of samples per call to acceptData().
+#define BLOCK_SIZE (1000)
+
+static const char *configurationNames[NUMBER_OF_CONFIGURATIONS] =
+{
+  "nlms",
+  "ipnlms",
+  "masked"
+};
+
+/*****************************************************************************
+
+  Name: getUserArguments
+
+  Purpose: The purpose of this function is to retrieve the user arguments
+  that were passed to the program.  Any arguments that are specified are
+  set to reasonable default values.
+
+  Calling Sequence: exitProgram = getUserArguments(parameters)
+
+  Inputs:
+
+    parameters - A structure that contains pointers to the user parameters.
+
+  Outputs:
+
+    exitProgram - A flag that indicates whether or not the program should
+    be exited.  A value of true indicates to exit the program, and a value
+    of false indicates that the program should not be exited..
+
+*****************************************************************************/
+bool getUserArguments(int argc,char **argv,struct MyParameters parameters)
+{
+  bool exitProgram;
+  bool done;
+  int opt;
+
+  // Default not to exit program.
+  exitProgram = false;
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Default parameters.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Default a 1024th order filter.
+  *parameters.filterOrderPtr = 1024;
+
+  // Default to a delay in the middle of the filter.
+  *parameters.delayPtr = 300;
+
+  // Default to a convergence rate of something reasonable.
+  *parameters.betaPtr = 0.5;
+
+  // Default to an even mix of uniform and proportionate gains.
+  *parameters.alphaPtr = 0;
+
+  // Default to masking segments that are 60dB below the peak.
+  *parameters.activeTapThresholdPtr = 0.001;
+
+  // Default to 5 seconds at 8000S/s.
+  *parameters.numberOfSamplesPtr = 40000;
+
+  // Default to reporting every half second.
+  *parameters.reportIntervalPtr = 4000;
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  // Set up for loop entry.
+  done = false;
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Retrieve the command line arguments.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  while (!done)
+  {
+    // Retrieve the next option.
+    opt = getopt(argc,argv,"o:d:b:p:a:n:i:h");
+
+    switch (opt)
+    {
+      case 'o':
+      {
+        *parameters.filterOrderPtr = atoi(optarg);
+        break;
+      } // case
+
+      case 'd':
+      {
+        *parameters.delayPtr = atoi(optarg);
+        break;
+      } // case
+
+      case 'b':
+      {
+        *parameters.betaPtr = atof(optarg);
+        break;
+      } // case
+
+      case 'p':
+      {
+        *parameters.alphaPtr = atof(optarg);
+        break;
+      } // case
+
+      case 'a':
+      {
+        *parameters.activeTapThresholdPtr = atof(optarg);
+        break;
+      } // case
+
+      case 'n':
+      {
+        *parameters.numberOfSamplesPtr = atoi(optarg);
+        break;
+      } // case
+
+      case 'i':
+      {
+        *parameters.reportIntervalPtr = atoi(optarg);
+        break;
+      } // case
+
+      case 'h':
+      {
+        // Display usage.
+        fprintf(stderr,"./sparseBenchmark -o filterOrder -d delay -b beta"
+                " -p alpha -a activeTapThreshold\n"
+                "                  -n numberOfSamples -i reportInterval\n");
+
+        // Indicate that program must be exited.
+        exitProgram = true;
+        break;
+      } // case
+
+      case -1:
+      {
+        // All options consumed, so bail out.
+        done = true;
+      } // case
+    } // switch
+
+  } // while
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  // The ideal tap has to be inside the filter.
+  if (*parameters.delayPtr >= *parameters.filterOrderPtr)
+  {
+    *parameters.delayPtr = *parameters.filterOrderPtr - 1;
+  } // if
+
+  if (*parameters.reportIntervalPtr < BLOCK_SIZE)
+  {
+    *parameters.reportIntervalPtr = BLOCK_SIZE;
+  } // if
+
+  return (exitProgram);
+
+} // getUserArguments
+
+/*****************************************************************************
+
+  Name: computeMisalignment
+
+  Purpose: The purpose of this function is to compute the misalignment
+  of the coefficients of a canceller, in decibels, relative to a single
+  unit tap at the reference delay.
+
+  Calling Sequence: misalignment = computeMisalignment(cancellerPtr,
+                                                       delay,
+                                                       coefficientsPtr)
+
+  Inputs:
+
+    cancellerPtr - A pointer to the canceller.
+
+    delay - The index of the ideal unit tap.
+
+    coefficientsPtr - A pointer to scratch storage for the coefficients.
+
+  Outputs:
+
+    misalignment - The misalignment in dB.
+
+*****************************************************************************/
+static double computeMisalignment(NlmsNoiseCanceller *cancellerPtr,
+                                  int delay,
+                                  float *coefficientsPtr)
+{
+  int i;
+  double error;
+  double difference;
+
+  cancellerPtr->getCoefficients(coefficientsPtr);
+
+  error = 0;
+
+  for (i = 0; i < cancellerPtr->getFilterLength(); i++)
+  {
+    difference = coefficientsPtr[i];
+
+    if (i == delay)
+    {
+      difference -= 1;
+    } // if
+
+    error += difference * difference;
+  } // for
+
+  // Avoid the log of zero.
+  return (10 * log10(error + 1e-30));
+
+} // computeMisalignment
+
+//*************************************************************************
+// Mainline code.
+//*************************************************************************
+int main(int argc,char **argv)
+{
+  int i;
+  int c;
+  bool exitProgram;
+  int filterOrder;
+  int delay;
+  float beta;
+  float alpha;
+  float activeTapThreshold;
+  int numberOfSamples;
+  int reportInterval;
+  int count;
+  float *signalPtr;
+  float *outputPtr;
+  float *coefficientsPtr;
+  double elapsedTime[NUMBER_OF_CONFIGURATIONS];
+  struct timespec startTime, endTime;
+  NlmsNoiseCanceller *cancellerPtrs[NUMBER_OF_CONFIGURATIONS];
+  struct MyParameters parameters;
+
+  // Set up for parameter transmission.
+  parameters.filterOrderPtr = &filterOrder;
+  parameters.delayPtr = &delay;
+  parameters.betaPtr = &beta;
+  parameters.alphaPtr = &alpha;
+  parameters.activeTapThresholdPtr = &activeTapThreshold;
+  parameters.numberOfSamplesPtr = &numberOfSamples;
+  parameters.reportIntervalPtr = &reportInterval;
+
+  // Retrieve the system parameters.
+  exitProgram = getUserArguments(argc,argv,parameters);
+
+  if (exitProgram)
+  {
+    // Bail out.
+    return (0);
+  } // if
+
+  signalPtr = new float[numberOfSamples];
+  outputPtr = new float[BLOCK_SIZE];
+  coefficientsPtr = new float[filterOrder];
+
+  // Generate white noise with a peak of 0.5.
+  srand(1);
+
+  for (i = 0; i < numberOfSamples; i++)
+  {
+    signalPtr[i] = ((float)rand() / RAND_MAX) - 0.5f;
+  } // for
+
+  for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+  {
+    cancellerPtrs[c] = new NlmsNoiseCanceller(filterOrder,delay,beta);
+    elapsedTime[c] = 0;
+  } // for
+
+  cancellerPtrs[1]->setProportionateUpdate(true,alpha);
+  cancellerPtrs[2]->setProportionateUpdate(true,alpha);
+  cancellerPtrs[2]->setActiveTapThreshold(activeTapThreshold);
+
+  printf("order %d, delay %d, beta %g, alpha %g, threshold %g\n\n",
+         filterOrder,delay,beta,alpha,activeTapThreshold);
+
+  printf("%10s","samples");
+  for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+  {
+    printf(" %10s(dB)",configurationNames[c]);
+  } // for
+  printf(" %12s\n","active taps");
+
+  for (i = 0; i < numberOfSamples; i += count)
+  {
+    count = BLOCK_SIZE;
+    if ((i + count) > numberOfSamples)
+    {
+      count = numberOfSamples - i;
+    } // if
+
+    for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+    {
+      clock_gettime(CLOCK_MONOTONIC,&startTime);
+      cancellerPtrs[c]->acceptData(&signalPtr[i],count,outputPtr);
+      clock_gettime(CLOCK_MONOTONIC,&endTime);
+
+      elapsedTime[c] += (endTime.tv_sec - startTime.tv_sec) +
+                        ((endTime.tv_nsec - startTime.tv_nsec) / 1e9);
+    } // for
+
+    if ((((i + count) % reportInterval) == 0) ||
+        ((i + count) == numberOfSamples))
+    {
+      printf("%10d",i + count);
+
+      for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+      {
+        printf(" %14.1f",
+               computeMisalignment(cancellerPtrs[c],delay,coefficientsPtr));
+      } // for
+
+      printf(" %12d\n",cancellerPtrs[2]->getActiveTapCount());
+    } // if
+  } // for
+
+  printf("\n%10s %14s %10s\n","update","ns/sample","cost");
+
+  for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+  {
+    printf("%10s %14.1f %9.2fx\n",
+           configurationNames[c],
+           (elapsedTime[c] * 1e9) / numberOfSamples,
+           elapsedTime[c] / elapsedTime[0]);
+  } // for
+
+  // Release resources.
+  for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+  {
+    delete cancellerPtrs[c];
+  } // for
+
+  delete[] signalPtr;
+  delete[] outputPtr;
+  delete[] coefficientsPtr;
+
+  return (0);
+
+} // main
@@ -0,0 +1,1213 @@
+//*************************************************************************
+// File name: sweepCanceller.cc
+//*************************************************************************
+
+//*************************************************************************
+// This program searches the parameter space of the NLMS noise canceller
+// so that the filter order, delay, and convergence factor don't have to
+// be tuned by running noiseCanceller over and over by hand.  The input
+// file is loaded into memory once, and that single copy is shared by
+// all worker threads.  Each worker evaluates one (order, delay, beta)
+// combination at a time until all combinations have been evaluated.
+//
+// Each result is scored in the following manner.  If a clean reference
+// file is provided (for example, original.dat from the systemTest
+// program), the output SNR, in dB, is computed against the reference.
+// Since the canceller output, dHat(n), is an estimate of x(n - delay),
+// the reference is delayed by the same amount before comparison.  The
+// ERLE (error return loss enhancement), in dB, is always computed.  It
+// is the ratio of the power of the reference signal of the canceller,
+// d(n) = x(n - delay), to the power of the error, e(n) = d(n) - dHat(n).
+// Results are ranked by SNR when a reference is available, otherwise
+// they are ranked by ERLE.  Note that ERLE measures how well the
+// filter predicts the delayed input, so combinations for which the
+// delay is less than the filter order will trivially score well.
+//
+// To run this program type,
+//
+//     ./sweepCanceller -i inputFileName -r referenceFileName -f format
+//                      -o minOrder:maxOrder:orderStep
+//                      -d minDelay:maxDelay:delayStep
+//                      -b minBeta:maxBeta:betaStep
+//                      -n numberOfTrials -s seed -w warmup -t threads
+//                      -j > reportFileName,
+//
+// where,
+//
+//    inputFileName - The noisy input file.
+//    referenceFileName - An optional clean reference file.
+//    format - The sample format of the files: s16 (signed 16-bit
+//    little endian, the default) or f32 (32-bit float, as written by
+//    the systemTest program).
+//    minOrder:maxOrder:orderStep - The range of filter orders.
+//    minDelay:maxDelay:delayStep - The range of reference delays.
+//    minBeta:maxBeta:betaStep - The range of convergence factors.
+//    For each range, the minimum must not exceed the maximum, and the
+//    step must be positive.  Orders start at 1, and delays start at 0.
+//    numberOfTrials - The number of random trials.  A value of 0
+//    selects a grid search over the ranges above (the default).  For a
+//    random search, the steps are ignored, and beta is drawn from a
+//    log-uniform distribution.
+//    seed - The seed for the random search.
+//    warmup - The number of initial samples that are excluded from
+//    scoring so that the filter can converge.
+//    threads - The number of worker threads.  The default is the
+//    number of online processors.
+//    -j - Write the report in JSON format rather than CSV format.
+//*************************************************************************
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "NlmsNoiseCanceller.h"
+
+// This structure is used to consolidate user parameters.
+struct MyParameters
+{
+  char **inputFileNamePtr;
+  char **referenceFileNamePtr;
+  bool *floatFormatPtr;
+  int *orderRangePtr;
+  int *delayRangePtr;
+  float *betaRangePtr;
+  int *numberOfTrialsPtr;
+  unsigned int *seedPtr;
+  int *warmupPtr;
+  int *numberOfThreadsPtr;
+  bool *jsonOutputPtr;
+  bool *argumentErrorPtr;
+};
+
+// This structure describes one point in the parameter space.
+struct Trial
+{
+  int filterOrder;
+  int delay;
+  float beta;
+
+  // Output SNR in dB.  This is NAN when no reference is available.
+  double snr;
+
+  // Error return loss enhancement in dB.
+  double erle;
+
+  // The time that it took to run the canceller in seconds.
+  double processingTime;
+};
+
+// This structure is shared by all worker threads.
+struct SweepContext
+{
+  // The input samples.  All workers read this single copy.
+  float *inputPtr;
+
+  // The clean reference samples.  This is NULL if not available.
+  float *referencePtr;
+
+  // The number of samples referenced by inputPtr and referencePtr.
+  uint32_t numberOfSamples;
+
+  // The number of initial samples that are excluded from scoring.
+  uint32_t warmup;
+
+  // The list of trials to evaluate.
+  struct Trial *trialsPtr;
+  int numberOfTrials;
+
+  // The index of the next trial to hand out to a worker.
+  int nextTrial;
+  pthread_mutex_t lock;
+};
+
+/*****************************************************************************
+
+  Name: parseRange
+
+  Purpose: The purpose of this function is to parse a range argument of
+  the form min:max:step.  Any missing fields retain their prior values.
+
+  Calling Sequence: parseRange(stringPtr,rangePtr)
+
+  Inputs:
+
+    stringPtr - A pointer to the range argument.
+
+    rangePtr - A pointer to storage for the three range values.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void parseRange(const char *stringPtr,float *rangePtr)
+{
+  int i;
+  char *endPtr;
+
+  for (i = 0; i < 3; i++)
+  {
+    if (*stringPtr != ':')
+    {
+      rangePtr[i] = strtof(stringPtr,&endPtr);
+
+      if (endPtr == stringPtr)
+      {
+        // Nothing more to parse.
+        break;
+      } // if
+
+      stringPtr = endPtr;
+    } // if
+
+    if (*stringPtr != ':')
+    {
+      // Nothing more to parse.
+      break;
+    } // if
+
+    // Skip over the separator.
+    stringPtr++;
+  } // for
+
+  return;
+
+} // parseRange
+
+/*****************************************************************************
+
+  Name: parseRange
+
+  Purpose: The purpose of this function is to parse an integer range
+  argument of the form min:max:step.
+
+  Calling Sequence: parseRange(stringPtr,rangePtr)
+
+  Inputs:
+
+    stringPtr - A pointer to the range argument.
+
+    rangePtr - A pointer to storage for the three range values.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void parseRange(const char *stringPtr,int *rangePtr)
+{
+  int i;
+  float range[3];
+
+  for (i = 0; i < 3; i++)
+  {
+    range[i] = (float)rangePtr[i];
+  } // for
+
+  parseRange(stringPtr,range);
+
+  for (i = 0; i < 3; i++)
+  {
+    rangePtr[i] = (int)range[i];
+  } // for
+
+  return;
+
+} // parseRange
+
+/*****************************************************************************
+
+  Name: getUserArguments
+
+  Purpose: The purpose of this function is to retrieve the user arguments
+  that were passed to the program.  Any arguments that are specified are
+  set to reasonable default values.
+
+  Calling Sequence: exitProgram = getUserArguments(parameters)
+
+  Inputs:
+
+    parameters - A structure that contains pointers to the user parameters.
+
+  Outputs:
+
+    exitProgram - A flag that indicates whether or not the program should
+    be exited.  A value of true indicates to exit the program, and a value
+    of false indicates that the program should not be exited..  When
+    the program is exited because an argument is invalid, the flag that
+    parameters.argumentErrorPtr points to is set to true.
+
+*****************************************************************************/
+bool getUserArguments(int argc,char **argv,struct MyParameters parameters)
+{
+  bool exitProgram;
+  bool done;
+  int opt;
+
+  // Default not to exit program.
+  exitProgram = false;
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Default parameters.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // There are no default files.
+  *parameters.inputFileNamePtr = NULL;
+  *parameters.referenceFileNamePtr = NULL;
+
+  // Default to signed 16-bit samples.
+  *parameters.floatFormatPtr = false;
+
+  // Default to filter orders of 4 through 32.
+  parameters.orderRangePtr[0] = 4;
+  parameters.orderRangePtr[1] = 32;
+  parameters.orderRangePtr[2] = 4;
+
+  // Default to delays of 1 through 32.
+  parameters.delayRangePtr[0] = 1;
+  parameters.delayRangePtr[1] = 32;
+  parameters.delayRangePtr[2] = 4;
+
+  // Default to a handful of convergence rates.
+  parameters.betaRangePtr[0] = 0.01;
+  parameters.betaRangePtr[1] = 0.2;
+  parameters.betaRangePtr[2] = 0.05;
+
+  // Default to a grid search.
+  *parameters.numberOfTrialsPtr = 0;
+
+  // Default to a fixed seed so that runs are repeatable.
+  *parameters.seedPtr = 1;
+
+  // Default to scoring every sample.
+  *parameters.warmupPtr = 0;
+
+  // Default to one thread per processor.
+  *parameters.numberOfThreadsPtr = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+  // Default to CSV output.
+  *parameters.jsonOutputPtr = false;
+
+  // Default to arguments that are valid.
+  *parameters.argumentErrorPtr = false;
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  // Set up for loop entry.
+  done = false;
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Retrieve the command line arguments.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  while (!done)
+  {
+    // Retrieve the next option.
+    opt = getopt(argc,argv,"i:r:f:o:d:b:n:s:w:t:jh");
+
+    switch (opt)
+    {
+      case 'i':
+      {
+        *parameters.inputFileNamePtr = optarg;
+        break;
+      } // case
+
+      case 'r':
+      {
+        *parameters.referenceFileNamePtr = optarg;
+        break;
+      } // case
+
+      case 'f':
+      {
+        *parameters.floatFormatPtr = (strcmp(optarg,"f32") == 0);
+        break;
+      } // case
+
+      case 'o':
+      {
+        parseRange(optarg,parameters.orderRangePtr);
+
+        if ((parameters.orderRangePtr[0] < 1) ||
+            (parameters.orderRangePtr[0] > parameters.orderRangePtr[1]) ||
+            (parameters.orderRangePtr[2] < 1))
+        {
+          fprintf(stderr,"Invalid order range %s.\n",optarg);
+          *parameters.argumentErrorPtr = true;
+          exitProgram = true;
+        } // if
+        break;
+      } // case
+
+      case 'd':
+      {
+        parseRange(optarg,parameters.delayRangePtr);
+
+        if ((parameters.delayRangePtr[0] < 0) ||
+            (parameters.delayRangePtr[0] > parameters.delayRangePtr[1]) ||
+            (parameters.delayRangePtr[2] < 1))
+        {
+          fprintf(stderr,"Invalid delay range %s.\n",optarg);
+          *parameters.argumentErrorPtr = true;
+          exitProgram = true;
+        } // if
+        break;
+      } // case
+
+      case 'b':
+      {
+        parseRange(optarg,parameters.betaRangePtr);
+
+        if ((parameters.betaRangePtr[0] > parameters.betaRangePtr[1]) ||
+            (parameters.betaRangePtr[2] <= 0))
+        {
+          fprintf(stderr,"Invalid beta range %s.\n",optarg);
+          *parameters.argumentErrorPtr = true;
+          exitProgram = true;
+        } // if
+        break;
+      } // case
+
+      case 'n':
+      {
+        *parameters.numberOfTrialsPtr = atoi(optarg);
+        break;
+      } // case
+
+      case 's':
+      {
+        *parameters.seedPtr = (unsigned int)atoi(optarg);
+        break;
+      } // case
+
+      case 'w':
+      {
+        *parameters.warmupPtr = atoi(optarg);
+        break;
+      } // case
+
+      case 't':
+      {
+        *parameters.numberOfThreadsPtr = atoi(optarg);
+        break;
+      } // case
+
+      case 'j':
+      {
+        *parameters.jsonOutputPtr = true;
+        break;
+      } // case
+
+      case 'h':
+      {
+        // Display usage.
+        fprintf(stderr,"./sweepCanceller -i inputFileName"
+                " -r referenceFileName -f s16|f32\n"
+                "                 -o minOrder:maxOrder:orderStep"
+                " -d minDelay:maxDelay:delayStep\n"
+                "                 -b minBeta:maxBeta:betaStep"
+                " -n numberOfTrials -s seed\n"
+                "                 -w warmup -t threads -j\n");
+
+        // Indicate that program must be exited.
+        exitProgram = true;
+        break;
+      } // case
+
+      case -1:
+      {
+        // All options consumed, so bail out.
+        done = true;
+      } // case
+    } // switch
+
+  } // while
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  if ((!exitProgram) && (*parameters.inputFileNamePtr == NULL))
+  {
+    fprintf(stderr,"An input file must be specified with -i.\n");
+    *parameters.argumentErrorPtr = true;
+    exitProgram = true;
+  } // if
+
+  // Guard against nonsensical values.
+  if (*parameters.numberOfThreadsPtr < 1)
+  {
+    *parameters.numberOfThreadsPtr = 1;
+  } // if
+
+  return (exitProgram);
+
+} // getUserArguments
+
+/*****************************************************************************
+
+  Name: loadSamples
+
+  Purpose: The purpose of this function is to load an entire file of
+  samples into memory.  The samples are converted to float.  No scaling
+  is performed, so 16-bit samples retain the values that the
+  noiseCanceller program would present to the canceller.
+
+  Calling Sequence: samplesPtr = loadSamples(fileNamePtr,floatFormat,
+                                             numberOfSamplesPtr)
+
+  Inputs:
+
+    fileNamePtr - The name of the file to load.
+
+    floatFormat - A flag that indicates the format of the file.  A value
+    of true indicates 32-bit float samples, and a value of false
+    indicates signed 16-bit samples.
+
+    numberOfSamplesPtr - A pointer to storage for the number of samples
+    that were loaded.
+
+  Outputs:
+
+    samplesPtr - A pointer to the samples, or NULL if the file could
+    not be loaded.  The caller must release this storage with delete[].
+
+*****************************************************************************/
+static float *loadSamples(const char *fileNamePtr,
+                          bool floatFormat,
+                          uint32_t *numberOfSamplesPtr)
+{
+  FILE *streamPtr;
+  long fileSize;
+  uint32_t i;
+  uint32_t sampleSize;
+  uint32_t numberOfSamples;
+  int16_t *integerSamplesPtr;
+  float *samplesPtr;
+
+  streamPtr = fopen(fileNamePtr,"rb");
+
+  if (streamPtr == NULL)
+  {
+    return (NULL);
+  } // if
+
+  // Determine the size of the file.
+  fseek(streamPtr,0,SEEK_END);
+  fileSize = ftell(streamPtr);
+  fseek(streamPtr,0,SEEK_SET);
+
+  sampleSize = floatFormat ? sizeof(float) : sizeof(int16_t);
+  numberOfSamples = (uint32_t)(fileSize / sampleSize);
+
+  samplesPtr = new float[numberOfSamples];
+
+  if (floatFormat)
+  {
+    numberOfSamples = fread(samplesPtr,sizeof(float),numberOfSamples,
+                            streamPtr);
+  } // if
+  else
+  {
+    integerSamplesPtr = new int16_t[numberOfSamples];
+
+    numberOfSamples = fread(integerSamplesPtr,sizeof(int16_t),
+                            numberOfSamples,streamPtr);
+
+    for (i = 0; i < numberOfSamples; i++)
+    {
+      samplesPtr[i] = (float)integerSamplesPtr[i];
+    } // for
+
+    // We're done with this.
+    delete[] integerSamplesPtr;
+  } // else
+
+  fclose(streamPtr);
+
+  *numberOfSamplesPtr = numberOfSamples;
+
+  return (samplesPtr);
+
+} // loadSamples
+
+/*****************************************************************************
+
+  Name: toDecibels
+
+  Purpose: The purpose of this function is to compute a power ratio in
+  decibels.
+
+  Calling Sequence: ratio = toDecibels(numerator,denominator)
+
+  Inputs:
+
+    numerator - The power of the signal.
+
+    denominator - The power of the error.
+
+  Outputs:
+
+    ratio - The ratio in dB.  A perfect match is reported as 999 dB.
+
+*****************************************************************************/
+static double toDecibels(double numerator,double denominator)
+{
+  double ratio;
+
+  if (denominator <= 0)
+  {
+    // Avoid division by zero.
+    ratio = 999;
+  } // if
+  else
+  {
+    ratio = 10 * log10((numerator + 1e-30) / denominator);
+  } // else
+
+  return (ratio);
+
+} // toDecibels
+
+/*****************************************************************************
+
+  Name: evaluateTrial
+
+  Purpose: The purpose of this function is to run the noise canceller
+  over the input data with the parameters of a trial and to score the
+  result.
+
+  Calling Sequence: evaluateTrial(contextPtr,cancellerPtr,trialPtr,
+                                  outputPtr)
+
+  Inputs:
+
+    contextPtr - A pointer to the shared sweep context.
+
+    cancellerPtr - A pointer to the canceller of the worker.  It is
+    reconfigured with the parameters of the trial, and it must have
+    enough capacity that this doesn't allocate memory.
+
+    trialPtr - A pointer to the trial to evaluate.  The score fields
+    are filled in by this function.
+
+    outputPtr - A pointer to storage for the canceller output.  It must
+    be able to hold contextPtr->numberOfSamples samples.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void evaluateTrial(struct SweepContext *contextPtr,
+                          NlmsNoiseCanceller *cancellerPtr,
+                          struct Trial *trialPtr,
+                          float *outputPtr)
+{
+  uint32_t n;
+  uint32_t start;
+  int delay;
+  double d, e;
+  double signalPower, errorPower;
+  double referencePower, residualPower;
+  struct timespec startTime, endTime;
+
+  delay = trialPtr->delay;
+
+  // Start the trial with a fresh canceller.
+  if (!cancellerPtr->reconfigure(trialPtr->filterOrder,
+                                 delay,
+                                 trialPtr->beta))
+  {
+    // Rank a trial that can't be run last.
+    trialPtr->erle = -INFINITY;
+    trialPtr->snr = NAN;
+
+    if (contextPtr->referencePtr != NULL)
+    {
+      trialPtr->snr = -INFINITY;
+    } // if
+
+    trialPtr->processingTime = 0;
+
+    return;
+  } // if
+
+  clock_gettime(CLOCK_MONOTONIC,&startTime);
+
+  // Run the canceller over the entire input.
+  cancellerPtr->acceptData(contextPtr->inputPtr,
+                           contextPtr->numberOfSamples,
+                           outputPtr);
+
+  clock_gettime(CLOCK_MONOTONIC,&endTime);
+
+  trialPtr->processingTime = (endTime.tv_sec - startTime.tv_sec) +
+                             ((endTime.tv_nsec - startTime.tv_nsec) / 1e9);
+
+  // The first sample with a valid reference and past the warmup.
+  start = contextPtr->warmup;
+  if (start < (uint32_t)delay)
+  {
+    start = delay;
+  } // if
+
+  signalPower = 0;
+  errorPower = 0;
+  referencePower = 0;
+  residualPower = 0;
+
+  for (n = start; n < contextPtr->numberOfSamples; n++)
+  {
+    // The canceller output is an estimate of d(n) = x(n - delay).
+    d = contextPtr->inputPtr[n - delay];
+    e = d - outputPtr[n];
+    signalPower += d * d;
+    errorPower += e * e;
+
+    if (contextPtr->referencePtr != NULL)
+    {
+      d = contextPtr->referencePtr[n - delay];
+      e = d - outputPtr[n];
+      referencePower += d * d;
+      residualPower += e * e;
+    } // if
+  } // for
+
+  trialPtr->erle = toDecibels(signalPower,errorPower);
+
+  if (contextPtr->referencePtr != NULL)
+  {
+    trialPtr->snr = toDecibels(referencePower,residualPower);
+  } // if
+  else
+  {
+    trialPtr->snr = NAN;
+  } // else
+
+  return;
+
+} // evaluateTrial
+
+/*****************************************************************************
+
+  Name: sweepWorker
+
+  Purpose: The purpose of this function is to serve as the entry point
+  of a worker thread.  The worker repeatedly claims the next unevaluated
+  trial and evaluates it until no trials remain.  The worker has one
+  canceller with room for the largest order and delay of all of the
+  trials, and it is reconfigured for each trial, so that no memory is
+  allocated while trials are evaluated.
+
+  Calling Sequence: sweepWorker(argPtr)
+
+  Inputs:
+
+    argPtr - A pointer to the shared sweep context.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void *sweepWorker(void *argPtr)
+{
+  bool done;
+  int i;
+  int trialIndex;
+  int maxFilterOrder;
+  int maxDelay;
+  float *outputPtr;
+  NlmsNoiseCanceller *cancellerPtr;
+  struct SweepContext *contextPtr;
+
+  contextPtr = (struct SweepContext *)argPtr;
+
+  // Each worker has its own output buffer.
+  outputPtr = new float[contextPtr->numberOfSamples];
+
+  maxFilterOrder = 1;
+  maxDelay = 0;
+
+  // Find the largest order and delay of all of the trials.
+  for (i = 0; i < contextPtr->numberOfTrials; i++)
+  {
+    if (contextPtr->trialsPtr[i].filterOrder > maxFilterOrder)
+    {
+      maxFilterOrder = contextPtr->trialsPtr[i].filterOrder;
+    } // if
+
+    if (contextPtr->trialsPtr[i].delay > maxDelay)
+    {
+      maxDelay = contextPtr->trialsPtr[i].delay;
+    } // if
+  } // for
+
+  // Each worker has its own canceller.
+  cancellerPtr = new NlmsNoiseCanceller(maxFilterOrder,maxDelay,0);
+
+  // Set up for loop entry.
+  done = false;
+
+  while (!done)
+  {
+    // Claim the next trial.
+    pthread_mutex_lock(&contextPtr->lock);
+    trialIndex = contextPtr->nextTrial;
+    contextPtr->nextTrial++;
+    pthread_mutex_unlock(&contextPtr->lock);
+
+    if (trialIndex >= contextPtr->numberOfTrials)
+    {
+      // We're done.
+      done = true;
+    } // if
+    else
+    {
+      evaluateTrial(contextPtr,
+                    cancellerPtr,
+                    &contextPtr->trialsPtr[trialIndex],
+                    outputPtr);
+    } // else
+  } // while
+
+  // Release resources.
+  delete cancellerPtr;
+  delete[] outputPtr;
+
+  return (NULL);
+
+} // sweepWorker
+
+/*****************************************************************************
+
+  Name: compareTrials
+
+  Purpose: The purpose of this function is to order trials by descending
+  score for qsort().  SNR is used when it is available, otherwise ERLE
+  is used.
+
+  Calling Sequence: result = compareTrials(aPtr,bPtr)
+
+  Inputs:
+
+    aPtr - A pointer to the first trial.
+
+    bPtr - A pointer to the second trial.
+
+  Outputs:
+
+    result - A negative value if the first trial ranks higher, a
+    positive value if the second trial ranks higher, and 0 otherwise.
+
+*****************************************************************************/
+static int compareTrials(const void *aPtr,const void *bPtr)
+{
+  double a, b;
+  const struct Trial *trialAPtr;
+  const struct Trial *trialBPtr;
+
+  trialAPtr = (const struct Trial *)aPtr;
+  trialBPtr = (const struct Trial *)bPtr;
+
+  if (isnan(trialAPtr->snr))
+  {
+    a = trialAPtr->erle;
+    b = trialBPtr->erle;
+  } // if
+  else
+  {
+    a = trialAPtr->snr;
+    b = trialBPtr->snr;
+  } // else
+
+  if (a > b)
+  {
+    return (-1);
+  } // if
+
+  if (a < b)
+  {
+    return (1);
+  } // if
+
+  return (0);
+
+} // compareTrials
+
+/*****************************************************************************
+
+  Name: createTrials
+
+  Purpose: The purpose of this function is to create the list of trials
+  to evaluate.  Either the full grid that is described by the ranges is
+  created, or the specified number of random trials is created.
+
+  Calling Sequence: trialsPtr = createTrials(orderRange,delayRange,
+                                             betaRange,numberOfTrials,
+                                             seed,countPtr)
+
+  Inputs:
+
+    orderRange - The min:max:step range of filter orders.
+
+    delayRange - The min:max:step range of delays.
+
+    betaRange - The min:max:step range of convergence factors.
+
+    numberOfTrials - The number of random trials, or 0 for a grid.
+
+    seed - The seed for the random trials.
+
+    countPtr - A pointer to storage for the number of trials created.
+
+  Outputs:
+
+    trialsPtr - A pointer to the trials.  The caller must release this
+    storage with delete[].
+
+*****************************************************************************/
+static struct Trial *createTrials(int *orderRange,
+                                  int *delayRange,
+                                  float *betaRange,
+                                  int numberOfTrials,
+                                  unsigned int seed,
+                                  int *countPtr)
+{
+  int i, j, k;
+  int count;
+  int numberOfOrders, numberOfDelays, numberOfBetas;
+  float u;
+  struct Trial *trialsPtr;
+
+  // Guard against nonsensical orders and delays.
+  for (i = 0; i < 2; i++)
+  {
+    if (orderRange[i] < 1)
+    {
+      orderRange[i] = 1;
+    } // if
+
+    if (delayRange[i] < 0)
+    {
+      delayRange[i] = 0;
+    } // if
+  } // for
+
+  // Guard against nonsensical steps.
+  if (orderRange[2] < 1)
+  {
+    orderRange[2] = 1;
+  } // if
+
+  if (delayRange[2] < 1)
+  {
+    delayRange[2] = 1;
+  } // if
+
+  if (betaRange[2] <= 0)
+  {
+    betaRange[2] = betaRange[1] - betaRange[0] + 1;
+  } // if
+
+  if (numberOfTrials > 0)
+  {
+    trialsPtr = new struct Trial[numberOfTrials];
+
+    srand(seed);
+
+    for (i = 0; i < numberOfTrials; i++)
+    {
+      trialsPtr[i].filterOrder = orderRange[0] +
+        rand() % (orderRange[1] - orderRange[0] + 1);
+
+      trialsPtr[i].delay = delayRange[0] +
+        rand() % (delayRange[1] - delayRange[0] + 1);
+
+      u = (float)rand() / RAND_MAX;
+
+      if (betaRange[0] > 0)
+      {
+        // Draw beta from a log-uniform distribution.
+        trialsPtr[i].beta = betaRange[0] *
+          powf(betaRange[1] / betaRange[0],u);
+      } // if
+      else
+      {
+        trialsPtr[i].beta = betaRange[0] + u * (betaRange[1] - betaRange[0]);
+      } // else
+    } // for
+
+    count = numberOfTrials;
+  } // if
+  else
+  {
+    numberOfOrders = (orderRange[1] - orderRange[0]) / orderRange[2] + 1;
+    numberOfDelays = (delayRange[1] - delayRange[0]) / delayRange[2] + 1;
+    numberOfBetas = (int)((betaRange[1] - betaRange[0]) / betaRange[2] +
+                          1.0001f);
+
+    count = numberOfOrders * numberOfDelays * numberOfBetas;
+
+    if (count < 0)
+    {
+      count = 0;
+    } // if
+
+    trialsPtr = new struct Trial[count];
+
+    count = 0;
+
+    for (i = 0; i < numberOfOrders; i++)
+    {
+      for (j = 0; j < numberOfDelays; j++)
+      {
+        for (k = 0; k < numberOfBetas; k++)
+        {
+          trialsPtr[count].filterOrder = orderRange[0] + i * orderRange[2];
+          trialsPtr[count].delay = delayRange[0] + j * delayRange[2];
+          trialsPtr[count].beta = betaRange[0] + k * betaRange[2];
+          count++;
+        } // for
+      } // for
+    } // for
+  } // else
+
+  *countPtr = count;
+
+  return (trialsPtr);
+
+} // createTrials
+
+/*****************************************************************************
+
+  Name: writeReport
+
+  Purpose: The purpose of this function is to write the ranked results
+  to stdout in either CSV or JSON format.
+
+  Calling Sequence: writeReport(trialsPtr,numberOfTrials,jsonOutput)
+
+  Inputs:
+
+    trialsPtr - A pointer to the ranked trials.
+
+    numberOfTrials - The number of trials.
+
+    jsonOutput - A flag that indicates the format.  A value of true
+    indicates JSON, and a value of false indicates CSV.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void writeReport(struct Trial *trialsPtr,
+                        int numberOfTrials,
+                        bool jsonOutput)
+{
+  int i;
+  struct Trial *trialPtr;
+
+  if (jsonOutput)
+  {
+    printf("[\n");
+  } // if
+  else
+  {
+    printf("rank,order,delay,beta,snr_db,erle_db,seconds\n");
+  } // else
+
+  for (i = 0; i < numberOfTrials; i++)
+  {
+    trialPtr = &trialsPtr[i];
+
+    if (jsonOutput)
+    {
+      printf("  {\"rank\": %d, \"order\": %d, \"delay\": %d,"
+             " \"beta\": %g, ",
+             i + 1,trialPtr->filterOrder,trialPtr->delay,trialPtr->beta);
+
+      if (isnan(trialPtr->snr))
+      {
+        printf("\"snr_db\": null, ");
+      } // if
+      else
+      {
+        printf("\"snr_db\": %.3f, ",trialPtr->snr);
+      } // else
+
+      printf("\"erle_db\": %.3f, \"seconds\": %.6f}%s\n",
+             trialPtr->erle,trialPtr->processingTime,
+             (i == (numberOfTrials - 1)) ? "" : ",");
+    } // if
+    else
+    {
+      printf("%d,%d,%d,%g,",
+             i + 1,trialPtr->filterOrder,trialPtr->delay,trialPtr->beta);
+
+      if (!isnan(trialPtr->snr))
+      {
+        printf("%.3f",trialPtr->snr);
+      } // if
+
+      printf(",%.3f,%.6f\n",trialPtr->erle,trialPtr->processingTime);
+    } // else
+  } // for
+
+  if (jsonOutput)
+  {
+    printf("]\n");
+  } // if
+
+  return;
+
+} // writeReport
+
+//*************************************************************************
+// Mainline code.
+//*************************************************************************
+int main(int argc,char **argv)
+{
+  int i;
+  bool exitProgram;
+  bool argumentError;
+  char *inputFileName;
+  char *referenceFileName;
+  bool floatFormat;
+  int orderRange[3];
+  int delayRange[3];
+  float betaRange[3];
+  int numberOfTrials;
+  unsigned int seed;
+  int warmup;
+  int numberOfThreads;
+  bool jsonOutput;
+  uint32_t numberOfReferenceSamples;
+  pthread_t *threadsPtr;
+  struct SweepContext context;
+  struct MyParameters parameters;
+
+  // Set up for parameter transmission.
+  parameters.inputFileNamePtr = &inputFileName;
+  parameters.referenceFileNamePtr = &referenceFileName;
+  parameters.floatFormatPtr = &floatFormat;
+  parameters.orderRangePtr = orderRange;
+  parameters.delayRangePtr = delayRange;
+  parameters.betaRangePtr = betaRange;
+  parameters.numberOfTrialsPtr = &numberOfTrials;
+  parameters.seedPtr = &seed;
+  parameters.warmupPtr = &warmup;
+  parameters.numberOfThreadsPtr = &numberOfThreads;
+  parameters.jsonOutputPtr = &jsonOutput;
+  parameters.argumentErrorPtr = &argumentError;
+
+  // Retrieve the system parameters.
+  exitProgram = getUserArguments(argc,argv,parameters);
+
+  if (exitProgram)
+  {
+    if (argumentError)
+    {
+      // Let the caller know that the arguments were rejected.
+      return (1);
+    } // if
+
+    // Bail out.
+    return (0);
+  } // if
+
+  // Load the input once.  All workers share this copy.
+  context.inputPtr = loadSamples(inputFileName,
+                                 floatFormat,
+                                 &context.numberOfSamples);
+
+  if (context.inputPtr == NULL)
+  {
+    fprintf(stderr,"Unable to load %s.\n",inputFileName);
+    return (1);
+  } // if
+
+  context.referencePtr = NULL;
+
+  if (referenceFileName != NULL)
+  {
+    context.referencePtr = loadSamples(referenceFileName,
+                                       floatFormat,
+                                       &numberOfReferenceSamples);
+
+    if (context.referencePtr == NULL)
+    {
+      fprintf(stderr,"Unable to load %s.\n",referenceFileName);
+      delete[] context.inputPtr;
+      return (1);
+    } // if
+
+    // Only score the samples that both files have in common.
+    if (numberOfReferenceSamples < context.numberOfSamples)
+    {
+      context.numberOfSamples = numberOfReferenceSamples;
+    } // if
+  } // if
+
+  context.warmup = (uint32_t)warmup;
+
+  context.trialsPtr = createTrials(orderRange,
+                                   delayRange,
+                                   betaRange,
+                                   numberOfTrials,
+                                   seed,
+                                   &context.numberOfTrials);
+
+  context.nextTrial = 0;
+  pthread_mutex_init(&context.lock,NULL);
+
+  // There is no point in having idle threads.
+  if (numberOfThreads > context.numberOfTrials)
+  {
+    numberOfThreads = context.numberOfTrials;
+  } // if
+
+  fprintf(stderr,"Evaluating %d trials over %u samples with %d threads.\n",
+          context.numberOfTrials,context.numberOfSamples,numberOfThreads);
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Run the workers.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  threadsPtr = new pthread_t[numberOfThreads];
+
+  for (i = 0; i < numberOfThreads; i++)
+  {
+    pthread_create(&threadsPtr[i],NULL,sweepWorker,&context);
+  } // for
+
+  for (i = 0; i < numberOfThreads; i++)
+  {
+    pthread_join(threadsPtr[i],NULL);
+  } // for
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  // Rank the results.
+  qsort(context.trialsPtr,context.numberOfTrials,sizeof(struct Trial),
+        compareTrials);
+
+  writeReport(context.trialsPtr,context.numberOfTrials,jsonOutput);
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Release resources.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  pthread_mutex_destroy(&context.lock);
+  delete[] threadsPtr;
+  delete[] context.trialsPtr;
+  delete[] context.inputPtr;
+
+  if (context.referencePtr != NULL)
+  {
+    delete[] context.referencePtr;
+  } // if
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  return (0);
+
+} // main
@@ -11,7 +11,7 @@
 // To run this program type,
 // 
 //     ./noisyCosine -a amplitude -f frequency -r sampleRate
-//                     -d duration -v noiseVariance ,
+//                     -d duration -v noiseVariance -D decimationFactor,
 //
 // where,
 //
@@ -20,6 +20,9 @@
 //    sampleRate - The sample rate in samples/second.
 //    duration - The duration in seconds.
 //    noiseVariance - The variance of the noise source.
+//    decimationFactor - Run the canceller at the sample rate divided by
+//    this factor, with the filter order and the delay divided by it
+//    too.  The latency of the reduced rate stage is displayed.
 ///*************************************************************************
 
 #include <stdio.h>
@@ -28,8 +31,8 @@
 #include <unistd.h>
 #include <math.h>
 
-#include "Nco.h"
-#include "NlmsNoiseCanceller.h"
+#include "SignalGraph.h"
+#include "SignalNodes.h"
 
 // This structure is used to consolidate user parameters.
 struct MyParameters
@@ -42,8 +45,12 @@ struct MyParameters
   int *filterOrderPtr;
   int *delayPtr;
   float *betaPtr;
+  int *decimationFactorPtr;
 };
 
+// The number of samples that flow through the graph at a time.
+#define BLOCK_SIZE (1024)
+
 /*****************************************************************************
 
   Name: getUserArguments
@@ -100,6 +107,9 @@ bool getUserArguments(int argc,char **argv,struct MyParameters parameters)
 
   // Default to a convergence rate of something reasonable.
   *parameters.betaPtr = 0.1;
+
+  // Default to running the canceller at the full sample rate.
+  *parameters.decimationFactorPtr = 1;
   //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
 
   // Set up for loop entry.
@@ -111,7 +121,7 @@ bool getUserArguments(int argc,char **argv,struct MyParameters parameters)
   while (!done)
   {
     // Retrieve the next option.
-    opt = getopt(argc,argv,"a:f:r:t:v:o:d:b:h");
+    opt = getopt(argc,argv,"a:f:r:t:v:o:d:b:D:h");
 
     switch (opt)
     {
@@ -164,12 +174,19 @@ bool getUserArguments(int argc,char **argv,struct MyParameters parameters)
         break;
       } // case
 
+      case 'D':
+      {
+        *parameters.decimationFactorPtr = atoi(optarg);
+        break;
+      } // case
+
       case 'h':
       {
         // Display usage.
         fprintf(stderr,"./noisyCosine -a amplitude -f frequency -r sampleRate"
                 " -t duration -v noiseVariance"
-                " -o filterOrder -d delay -b beta\n");
+                " -o filterOrder -d delay -b beta"
+                " -D decimationFactor\n");
 
         // Indicate that program must be exited.
         exitProgram = true;
@@ -190,67 +207,13 @@ bool getUserArguments(int argc,char **argv,struct MyParameters parameters)
 
 } // getUserArguments
 
-/*****************************************************************************
-
-  Name: gauss
-
-  Purpose: The purpose of this function is to generate a random number
-  that is weighted by a Gaussian density function. 
-
-  Calling Sequence: value = gauss(sigma)
-
-  Inputs:
-
-    sigma - The standard deviation of the random process.
-
-  Outputs:
-
-    value - The generated random number.
-
-*****************************************************************************/
-float gauss(float sigma)
-{
-  float x, b, r, value;
-
-  // Get first random variable.
-  x = (float)rand();
-
-  // Scale the random variable.
-  x = x / RAND_MAX;
-
-  // Get second random variable.
-  b = (float)rand();
-
-  // Scale the random variable.
-  b = b / RAND_MAX;
-
-  // Generate the angle.
-  b = 2.0 * b * M_PI;
-
-  // Compute the magnitude.
-  r = sqrt(2.0 * sigma * sigma * log(1.0 / (1.0 - x)));
-
-  // Compute the real part of the random variable.
-  value = r * cos(b);
-
-  return (value);
-
-} // gauss
-
 //*************************************************************************
 // Mainline code.
 //*************************************************************************
 int main(int argc,char **argv)
 {
-  int i;
-  FILE *fd1;
-  FILE *fd2;
-  FILE *fd3;
-  FILE *fd4;
   bool exitProgram;
-  float noise;
-  float iValue, qValue;
-  float processedSample;
+  bool success;
   float amplitude;
   float frequency;
   float sampleRate;
@@ -259,9 +222,15 @@ int main(int argc,char **argv)
   int filterOrder;
   int delay;
   float beta;
+  int decimationFactor;
   int numberOfSamples;
-  Nco *myNcoPtr;
-  NlmsNoiseCanceller *cancellerPtr;
+  int nco;
+  int noise;
+  int adder;
+  int canceller;
+  int sink;
+  MultirateCancellerNode *multirateNodePtr;
+  SignalGraph *graphPtr;
   struct MyParameters parameters;
 
   // Set up for parameter transmission.
@@ -273,6 +242,7 @@ int main(int argc,char **argv)
   parameters.filterOrderPtr = &filterOrder;
   parameters.delayPtr = &delay;
   parameters.betaPtr = &beta;
+  parameters.decimationFactorPtr = &decimationFactor;
 
   // Retrieve the system parameters.
   exitProgram = getUserArguments(argc,argv,parameters);
@@ -286,63 +256,74 @@ int main(int argc,char **argv)
   // We derive this.
   numberOfSamples = (int)(sampleRate * duration);
 
-  // Instantiate an NCO.
-  myNcoPtr = new Nco(sampleRate,frequency);
-
-  // Instantiate a noise canceller.
-  cancellerPtr = new NlmsNoiseCanceller(filterOrder,delay,beta);
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Build the graph.  Each output port feeds the listed input ports.
+  //
+  //   nco, in-phase   -> adder, original.dat
+  //   gauss           -> adder, noise.dat
+  //   adder           -> canceller, tainted.dat
+  //   canceller       -> processed.dat
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  graphPtr = new SignalGraph(BLOCK_SIZE);
 
-  fd1 = fopen("original.dat","w");
-  fd2 = fopen("noise.dat","w");
-  fd3 = fopen("tainted.dat","w");
-  fd4 = fopen("processed.dat","w");
+  nco = graphPtr->addNode(new NcoNode(sampleRate,frequency));
+  noise = graphPtr->addNode(new GaussianNoiseNode(noiseVariance));
+  adder = graphPtr->addNode(new AdderNode());
 
-  for (i = 0; i < numberOfSamples; i++)
+  if (decimationFactor > 1)
   {
-    // Get the next sample pair.
-    myNcoPtr->run(&iValue,&qValue);
-
-    // Get noise sample.
-    noise = gauss(noiseVariance);
-
-    // Write the untainted sample to the file..
-    fwrite(&iValue,sizeof(float),1,fd1);
+    // Instantiate a reduced rate stage with proportionally fewer taps.
+    multirateNodePtr =
+      new MultirateCancellerNode(decimationFactor,
+                                 (filterOrder + decimationFactor - 1) /
+                                 decimationFactor,
+                                 delay / decimationFactor,
+                                 beta);
+
+    printf("Latency: %d samples\n",
+           multirateNodePtr->getCanceller()->getLatency());
+
+    canceller = graphPtr->addNode(multirateNodePtr);
+  } // if
+  else
+  {
+    // Instantiate a noise canceller.
+    canceller = graphPtr->addNode(new CancellerNode(filterOrder,delay,beta));
+  } // else
 
-    // Write the noise sample to the file..
-    fwrite(&noise,sizeof(float),1,fd2);
+  // Add noise to the in-phase component of the NCO, and remove it.
+  graphPtr->connect(nco,0,adder,0);
+  graphPtr->connect(noise,0,adder,1);
+  graphPtr->connect(adder,0,canceller,0);
 
-    // Add noise to sine wave.
-    iValue = iValue + noise;
+  // Write each stage to its own file.
+  sink = graphPtr->addNode(new FileSinkNode("original.dat",PORT_REAL));
+  graphPtr->connect(nco,0,sink,0);
 
-    // Write the noisy sample to the file..
-    fwrite(&iValue,sizeof(float),1,fd3);
+  sink = graphPtr->addNode(new FileSinkNode("noise.dat",PORT_REAL));
+  graphPtr->connect(noise,0,sink,0);
 
-    // Remove the noise from the sample.
-   cancellerPtr->acceptData(&iValue,1,&processedSample);
+  sink = graphPtr->addNode(new FileSinkNode("tainted.dat",PORT_REAL));
+  graphPtr->connect(adder,0,sink,0);
 
-    // Write the processed sample to the file..
-    fwrite(&processedSample,sizeof(float),1,fd4);
-  } // for
+  sink = graphPtr->addNode(new FileSinkNode("processed.dat",PORT_REAL));
+  graphPtr->connect(canceller,0,sink,0);
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
 
-  // We're done with these files.
-  fclose(fd1);
-  fclose(fd2);
-  fclose(fd3);
-  fclose(fd4);
+  success = graphPtr->prepare(1);
 
-  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
-  // Release resources.
-  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
-  if (myNcoPtr != NULL)
+  if (success)
   {
-    delete myNcoPtr;
+    // Generate, taint, and clean up the signal.
+    graphPtr->run(numberOfSamples);
   } // if
-
-  if (cancellerPtr != NULL)
+  else
   {
-    delete cancellerPtr;
-  } // if
-  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+    fprintf(stderr,"Could not prepare the signal graph\n");
+  } // else
+
+  // Release resources.  The files are closed by their nodes.
+  delete graphPtr;
 
   return (0);
 
@@ -0,0 +1,590 @@
+//*************************************************************************
+// File name: tapSweepBenchmark.cc
+//*************************************************************************
+
+//*************************************************************************
+// This program measures the NLMS canceller with its taps stored in the
+// separate layout (a coefficient array and a state array) and in the
+// interleaved layout (groups of state and weights stored together), with
+// the weights of the interleaved layout stored as float, bfloat16, or
+// IEEE half precision.  The input is a tone in white noise.
+//
+// First, the error of each configuration is displayed for a short
+// filter, the power of the difference between the reference signal and
+// the output of the canceller relative to the power of the reference,
+// in dB, over the last quarter of the run, along with the largest
+// difference between the output of each configuration and the output
+// of the separate layout.  This shows what the compact weights cost in
+// precision.
+//
+// Then, the filter order is swept over powers of 2, and the storage of
+// the taps and the processing time per tap are displayed for each
+// configuration.  The time per tap is flat while the taps fit in a
+// cache, and it steps up each time they outgrow one, so the steps move
+// to larger orders when the taps are stored more compactly.  The number
+// of samples of each run is the work divided by the order, so each run
+// performs about the same number of tap updates.  The delay is 1 sample,
+// so the delay line doesn't add to the storage.
+//
+// To run this program type,
+//
+//     ./tapSweepBenchmark -m minimumOrder -x maximumOrder -b beta
+//                         -w work -a accuracyOrder -n numberOfSamples,
+//
+// where,
+//
+//    minimumOrder - The smallest filter order of the sweep.
+//    maximumOrder - The largest filter order of the sweep.
+//    beta - The convergence factor.
+//    work - The number of tap updates of each run of the sweep.
+//    accuracyOrder - The order of the filter of the precision run.
+//    numberOfSamples - The number of samples of the precision run.
+//*************************************************************************
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+
+#include "NlmsNoiseCanceller.h"
+
+// This structure is used to consolidate user parameters.
+struct MyParameters
+{
+  int *minimumOrderPtr;
+  int *maximumOrderPtr;
+  float *betaPtr;
+  int *workPtr;
+  int *accuracyOrderPtr;
+  int *numberOfSamplesPtr;
+};
+
+// The number of tap storage configurations that are compared.
+#define NUMBER_OF_CONFIGURATIONS (4)
+
+// The number of samples per call to acceptData().
+#define BLOCK_SIZE (256)
+
+// The smallest and the largest number of samples of a run of the sweep.
+#define MINIMUM_SWEEP_SAMPLES (BLOCK_SIZE)
+#define MAXIMUM_SWEEP_SAMPLES (102400)
+
+// The tone, in cycles per sample, and the peak values of the tone and
+// of the noise, in 16-bit units.
+#define TONE_FREQUENCY (0.05)
+#define TONE_AMPLITUDE (3000.0f)
+#define NOISE_AMPLITUDE (1000.0f)
+
+static const char *configurationNames[NUMBER_OF_CONFIGURATIONS] =
+{
+  "separate",
+  "fp32",
+  "bf16",
+  "fp16"
+};
+
+static const TapLayout configurationLayouts[NUMBER_OF_CONFIGURATIONS] =
+{
+  TAPS_SEPARATE,
+  TAPS_INTERLEAVED,
+  TAPS_INTERLEAVED,
+  TAPS_INTERLEAVED
+};
+
+static const WeightFormat configurationFormats[NUMBER_OF_CONFIGURATIONS] =
+{
+  WEIGHTS_FLOAT32,
+  WEIGHTS_FLOAT32,
+  WEIGHTS_BFLOAT16,
+  WEIGHTS_FLOAT16
+};
+
+/*****************************************************************************
+
+  Name: getUserArguments
+
+  Purpose: The purpose of this function is to retrieve the user arguments
+  that were passed to the program.  Any arguments that are specified are
+  set to reasonable default values.
+
+  Calling Sequence: exitProgram = getUserArguments(parameters)
+
+  Inputs:
+
+    parameters - A structure that contains pointers to the user parameters.
+
+  Outputs:
+
+    exitProgram - A flag that indicates whether or not the program should
+    be exited.  A value of true indicates to exit the program, and a value
+    of false indicates that the program should not be exited..
+
+*****************************************************************************/
+bool getUserArguments(int argc,char **argv,struct MyParameters parameters)
+{
+  bool exitProgram;
+  bool done;
+  int opt;
+
+  // Default not to exit program.
+  exitProgram = false;
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Default parameters.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Default to a sweep from a few cache lines to well past L2.
+  *parameters.minimumOrderPtr = 8;
+  *parameters.maximumOrderPtr = 65536;
+
+  // Default to a convergence rate of something reasonable.
+  *parameters.betaPtr = 0.1;
+
+  // Default to about 16 million tap updates per run.
+  *parameters.workPtr = 1 << 24;
+
+  // Default to a short filter for the precision run.
+  *parameters.accuracyOrderPtr = 32;
+
+  // Default to two seconds at 8000S/s.
+  *parameters.numberOfSamplesPtr = 16000;
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  // Set up for loop entry.
+  done = false;
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Retrieve the command line arguments.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  while (!done)
+  {
+    // Retrieve the next option.
+    opt = getopt(argc,argv,"m:x:b:w:a:n:h");
+
+    switch (opt)
+    {
+      case 'm':
+      {
+        *parameters.minimumOrderPtr = atoi(optarg);
+        break;
+      } // case
+
+      case 'x':
+      {
+        *parameters.maximumOrderPtr = atoi(optarg);
+        break;
+      } // case
+
+      case 'b':
+      {
+        *parameters.betaPtr = atof(optarg);
+        break;
+      } // case
+
+      case 'w':
+      {
+        *parameters.workPtr = atoi(optarg);
+        break;
+      } // case
+
+      case 'a':
+      {
+        *parameters.accuracyOrderPtr = atoi(optarg);
+        break;
+      } // case
+
+      case 'n':
+      {
+        *parameters.numberOfSamplesPtr = atoi(optarg);
+        break;
+      } // case
+
+      case 'h':
+      {
+        // Display usage.
+        fprintf(stderr,"./tapSweepBenchmark -m minimumOrder"
+                " -x maximumOrder -b beta\n"
+                "                    -w work -a accuracyOrder"
+                " -n numberOfSamples\n");
+
+        // Indicate that program must be exited.
+        exitProgram = true;
+        break;
+      } // case
+
+      case -1:
+      {
+        // All options consumed, so bail out.
+        done = true;
+      } // case
+    } // switch
+
+  } // while
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  if (*parameters.minimumOrderPtr < 1)
+  {
+    *parameters.minimumOrderPtr = 1;
+  } // if
+
+  if (*parameters.maximumOrderPtr < *parameters.minimumOrderPtr)
+  {
+    *parameters.maximumOrderPtr = *parameters.minimumOrderPtr;
+  } // if
+
+  // The precision run is made in whole blocks.
+  if (*parameters.numberOfSamplesPtr < (4 * BLOCK_SIZE))
+  {
+    *parameters.numberOfSamplesPtr = 4 * BLOCK_SIZE;
+  } // if
+
+  *parameters.numberOfSamplesPtr -=
+    *parameters.numberOfSamplesPtr % (4 * BLOCK_SIZE);
+
+  return (exitProgram);
+
+} // getUserArguments
+
+/*****************************************************************************
+
+  Name: generateSignal
+
+  Purpose: The purpose of this function is to generate a tone in white
+  noise.  The noise is taken from rand() with a fixed seed, so every run
+  sees the same input.
+
+  Calling Sequence: generateSignal(signalPtr,numberOfSamples)
+
+  Inputs:
+
+    signalPtr - A pointer to storage for the samples.
+
+    numberOfSamples - The number of samples to generate.
+
+  Outputs:
+
+    None.
+
+*****************************************************************************/
+static void generateSignal(float *signalPtr,int numberOfSamples)
+{
+  int i;
+
+  srand(1);
+
+  for (i = 0; i < numberOfSamples; i++)
+  {
+    signalPtr[i] = (TONE_AMPLITUDE * cos(2 * M_PI * TONE_FREQUENCY * i)) +
+      (2 * NOISE_AMPLITUDE * (((float)rand() / RAND_MAX) - 0.5f));
+  } // for
+
+  return;
+
+} // generateSignal
+
+/*****************************************************************************
+
+  Name: createCanceller
+
+  Purpose: The purpose of this function is to create a canceller with the
+  tap storage of one of the configurations.
+
+  Calling Sequence: cancellerPtr = createCanceller(configuration,
+                                                   filterOrder,
+                                                   delay,
+                                                   beta)
+
+  Inputs:
+
+    configuration - The index of the configuration.
+
+    filterOrder - The order of the adaptive filter.
+
+    delay - The delay that is used to generate the reference signal.
+
+    beta - The convergence factor.
+
+  Outputs:
+
+    cancellerPtr - A pointer to the canceller.
+
+*****************************************************************************/
+static NlmsNoiseCanceller *createCanceller(int configuration,
+                                           int filterOrder,
+                                           int delay,
+                                           float beta)
+{
+  NlmsNoiseCanceller *cancellerPtr;
+
+  cancellerPtr = new NlmsNoiseCanceller(filterOrder,delay,beta);
+
+  cancellerPtr->setTapLayout(configurationLayouts[configuration],
+                             configurationFormats[configuration]);
+
+  return (cancellerPtr);
+
+} // createCanceller
+
+/*****************************************************************************
+
+  Name: getTapStorage
+
+  Purpose: The purpose of this function is to compute the number of bytes
+  that hold the state and the weights of a filter in one of the
+  configurations.
+
+  Calling Sequence: bytes = getTapStorage(configuration,filterOrder)
+
+  Inputs:
+
+    configuration - The index of the configuration.
+
+    filterOrder - The order of the adaptive filter.
+
+  Outputs:
+
+    bytes - The number of bytes.
+
+*****************************************************************************/
+static double getTapStorage(int configuration,int filterOrder)
+{
+  int numberOfGroups;
+  double bytes;
+
+  if (configurationLayouts[configuration] == TAPS_SEPARATE)
+  {
+    bytes = (double)filterOrder * 2 * sizeof(float);
+  } // if
+  else
+  {
+    // The interleaved layout is stored in whole groups.
+    numberOfGroups =
+      (filterOrder + NlmsNoiseCanceller::TAP_GROUP_SIZE - 1) /
+      NlmsNoiseCanceller::TAP_GROUP_SIZE;
+
+    bytes = (double)numberOfGroups * NlmsNoiseCanceller::TAP_GROUP_SIZE;
+
+    if (configurationFormats[configuration] == WEIGHTS_FLOAT32)
+    {
+      bytes *= 2 * sizeof(float);
+    } // if
+    else
+    {
+      bytes *= sizeof(float) + sizeof(uint16_t);
+    } // else
+  } // else
+
+  return (bytes);
+
+} // getTapStorage
+
+//*************************************************************************
+// Mainline code.
+//*************************************************************************
+int main(int argc,char **argv)
+{
+  int i, j;
+  int c;
+  bool exitProgram;
+  int minimumOrder;
+  int maximumOrder;
+  float beta;
+  int work;
+  int accuracyOrder;
+  int numberOfSamples;
+  int totalSamples;
+  int sweepSamples;
+  int filterOrder;
+  double difference;
+  double referenceEnergy;
+  double errorEnergy[NUMBER_OF_CONFIGURATIONS];
+  double largestDifference[NUMBER_OF_CONFIGURATIONS];
+  double elapsedTime;
+  float *signalPtr;
+  float *outputPtrs[NUMBER_OF_CONFIGURATIONS];
+  struct timespec startTime, endTime;
+  NlmsNoiseCanceller *cancellerPtrs[NUMBER_OF_CONFIGURATIONS];
+  struct MyParameters parameters;
+
+  // Set up for parameter transmission.
+  parameters.minimumOrderPtr = &minimumOrder;
+  parameters.maximumOrderPtr = &maximumOrder;
+  parameters.betaPtr = &beta;
+  parameters.workPtr = &work;
+  parameters.accuracyOrderPtr = &accuracyOrder;
+  parameters.numberOfSamplesPtr = &numberOfSamples;
+
+  // Retrieve the system parameters.
+  exitProgram = getUserArguments(argc,argv,parameters);
+
+  if (exitProgram)
+  {
+    // Bail out.
+    return (0);
+  } // if
+
+  // The sweep may need more samples than the precision run.
+  totalSamples = numberOfSamples;
+
+  if (totalSamples < MAXIMUM_SWEEP_SAMPLES)
+  {
+    totalSamples = MAXIMUM_SWEEP_SAMPLES;
+  } // if
+
+  signalPtr = new float[totalSamples];
+
+  for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+  {
+    outputPtrs[c] = new float[BLOCK_SIZE];
+  } // for
+
+  generateSignal(signalPtr,totalSamples);
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Precision.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+  {
+    cancellerPtrs[c] =
+      createCanceller(c,accuracyOrder,accuracyOrder,beta);
+
+    errorEnergy[c] = 0;
+    largestDifference[c] = 0;
+  } // for
+
+  referenceEnergy = 0;
+
+  for (i = 0; i < numberOfSamples; i += BLOCK_SIZE)
+  {
+    for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+    {
+      cancellerPtrs[c]->acceptData(&signalPtr[i],BLOCK_SIZE,outputPtrs[c]);
+    } // for
+
+    // Measure over the last quarter of the run, after convergence.
+    if (i < ((3 * numberOfSamples) / 4))
+    {
+      continue;
+    } // if
+
+    for (j = 0; j < BLOCK_SIZE; j++)
+    {
+      if ((i + j) < accuracyOrder)
+      {
+        continue;
+      } // if
+
+      // The output is an estimate of the reference, x(n - delay).
+      referenceEnergy +=
+        signalPtr[i + j - accuracyOrder] * signalPtr[i + j - accuracyOrder];
+
+      for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+      {
+        difference = outputPtrs[c][j] - signalPtr[i + j - accuracyOrder];
+        errorEnergy[c] += difference * difference;
+
+        difference = fabs(outputPtrs[c][j] - outputPtrs[0][j]);
+
+        if (difference > largestDifference[c])
+        {
+          largestDifference[c] = difference;
+        } // if
+      } // for
+    } // for
+  } // for
+
+  printf("order %d, beta %g, %d samples\n\n",
+         accuracyOrder,beta,numberOfSamples);
+
+  printf("%10s %10s %20s\n","layout","error(dB)","difference(dB)");
+
+  for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+  {
+    // Display the largest difference relative to the tone.
+    printf("%10s %10.1f %20.1f\n",
+           configurationNames[c],
+           10 * log10((errorEnergy[c] + 1e-30) / (referenceEnergy + 1e-30)),
+           20 * log10((largestDifference[c] + 1e-30) / TONE_AMPLITUDE));
+
+    delete cancellerPtrs[c];
+  } // for
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  // Sweep.
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+  printf("\n%10s %12s %12s","order","fp32(KB)","16-bit(KB)");
+  for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+  {
+    printf(" %9s(ns/tap)",configurationNames[c]);
+  } // for
+  printf("\n");
+
+  for (filterOrder = minimumOrder;
+       filterOrder <= maximumOrder;
+       filterOrder *= 2)
+  {
+    // Keep the number of tap updates about the same for every order.
+    sweepSamples = work / filterOrder;
+
+    if (sweepSamples < MINIMUM_SWEEP_SAMPLES)
+    {
+      sweepSamples = MINIMUM_SWEEP_SAMPLES;
+    } // if
+
+    if (sweepSamples > MAXIMUM_SWEEP_SAMPLES)
+    {
+      sweepSamples = MAXIMUM_SWEEP_SAMPLES;
+    } // if
+
+    sweepSamples -= sweepSamples % BLOCK_SIZE;
+
+    printf("%10d %12.1f %12.1f",
+           filterOrder,
+           getTapStorage(0,filterOrder) / 1024,
+           getTapStorage(2,filterOrder) / 1024);
+
+    for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+    {
+      cancellerPtrs[c] = createCanceller(c,filterOrder,1,beta);
+
+      // Touch the storage once so that page faults aren't timed.
+      cancellerPtrs[c]->acceptData(signalPtr,BLOCK_SIZE,outputPtrs[c]);
+
+      clock_gettime(CLOCK_MONOTONIC,&startTime);
+
+      for (i = 0; i < sweepSamples; i += BLOCK_SIZE)
+      {
+        cancellerPtrs[c]->acceptData(&signalPtr[i],BLOCK_SIZE,outputPtrs[c]);
+      } // for
+
+      clock_gettime(CLOCK_MONOTONIC,&endTime);
+
+      elapsedTime = (endTime.tv_sec - startTime.tv_sec) +
+                    ((endTime.tv_nsec - startTime.tv_nsec) / 1e9);
+
+      printf(" %17.3f",
+             (elapsedTime * 1e9) / ((double)sweepSamples * filterOrder));
+
+      // Flush so that progress shows during the long runs.
+      fflush(stdout);
+
+      delete cancellerPtrs[c];
+    } // for
+
+    printf("\n");
+  } // for
+  //_/_/_/_/_/_/_/_/_/_/_/_/_/_/
+
+  // Release resources.
+  delete[] signalPtr;
+
+  for (c = 0; c < NUMBER_OF_CONFIGURATIONS; c++)
+  {
+    delete[] outputPtrs[c];
+  } // for
+
+  return (0);
+
+} // main